@@ -67,6 +67,37 @@
 **   35      19   FAN B Pulse Width Modulation control
 **   37      26   FAN B Tachometer (pulses per revolution) 
 **
+** The pins above are the default rig's. Each rig's fan count, PWM and tach
+** BCM IDs are defined in the RIG_DEF_FILE rig definition file as comma
+** separated lists with one BCM ID per fan, in fan order. BCM pins 12 & 18
+** (PWM channel 0) and 13 & 19 (PWM channel 1) use hardware PWM, all other
+** pins use software PWM with a FAN_SOFT_PWM_PERIOD microsecond period.
+** RIG_WORKER_CNT child tasks execute the rigs. TBL_SAT_WAKEUP_TOPICID is the
+** first of RIG_WORKER_CNT consecutive topic IDs used by the main task to
+** wake a worker after it posts a controller command, see cmd_mbox.h.
+** Each rig's worker sends a StatsTlm summary every SAT_CTRL_STATS_PERIOD
+** milliseconds, see stat_sum.h.
+**
+** The VIB_MON_ options configure the low priority background task that
+** computes each rig's rate vibration spectrum every VIB_MON_PERIOD
+** milliseconds, a period of 0 disables the task. See vib_mon.h.
+**
+** SHM_EXPORT_NAME is the POSIX shared memory object that local tools map to
+** read each rig's controller state, an empty name disables the export. See
+** shm_export.h.
+**
+** FAN_TACH_SOURCE selects the tach edge source, "gpio-cdev" reads line
+** events from the FAN_TACH_DEVICE GPIO character device and "synthetic"
+** generates edges for host testing.
+**
+** The SIM_ options configure the software-in-the-loop simulation used when
+** the app is built with TBL_SAT_SIM_HW, see sim_hw.h. They're ignored by
+** the Raspberry Pi build.
+**
+** MEM_STACK_PAINT enables (1) or disables (0) stack high-water measurement,
+** see mem_mon.h. The CHILD_ real-time and MEM_ locking and prefault options
+** are described in rt_profile.h.
+**
 */
 
 #define CFG_APP_CFE_NAME     APP_CFE_NAME
@@ -78,24 +109,56 @@
 #define CFG_TBL_SAT_CMD_TOPICID         TBL_SAT_CMD_TOPICID
 #define CFG_BC_SCH_1_HZ_TOPICID         BC_SCH_1_HZ_TOPICID
 #define CFG_TBL_SAT_STATUS_TLM_TOPICID  TBL_SAT_STATUS_TLM_TOPICID
-#define CFG_MQTT_GW_TOPIC_4_TLM_TOPICID MQTT_GW_TOPIC_4_TLM_TOPICID
+#define CFG_TBL_SAT_MEM_TLM_TOPICID     TBL_SAT_MEM_TLM_TOPICID
+#define CFG_TBL_SAT_WAKEUP_TOPICID      TBL_SAT_WAKEUP_TOPICID
+#define CFG_TBL_SAT_STATS_TLM_TOPICID   TBL_SAT_STATS_TLM_TOPICID
+
+#define CFG_MEM_STACK_PAINT  MEM_STACK_PAINT
+
+#define CFG_RIG_DEF_FILE     RIG_DEF_FILE
+#define CFG_RIG_WORKER_CNT   RIG_WORKER_CNT
+
+#define CFG_SHM_EXPORT_NAME  SHM_EXPORT_NAME
 
 #define CFG_CHILD_NAME       CHILD_NAME
 #define CFG_CHILD_PERF_ID    CHILD_PERF_ID
 #define CFG_CHILD_STACK_SIZE CHILD_STACK_SIZE
 #define CFG_CHILD_PRIORITY   CHILD_PRIORITY
 
+#define CFG_VIB_MON_NAME       VIB_MON_NAME
+#define CFG_VIB_MON_PERF_ID    VIB_MON_PERF_ID
+#define CFG_VIB_MON_STACK_SIZE VIB_MON_STACK_SIZE
+#define CFG_VIB_MON_PRIORITY   VIB_MON_PRIORITY
+#define CFG_VIB_MON_PERIOD     VIB_MON_PERIOD
+
+#define CFG_CHILD_CPU_AFFINITY    CHILD_CPU_AFFINITY
+#define CFG_CHILD_RT_POLICY       CHILD_RT_POLICY
+#define CFG_CHILD_RT_PRIORITY     CHILD_RT_PRIORITY
+#define CFG_CHILD_STACK_PREFAULT  CHILD_STACK_PREFAULT
+#define CFG_MEM_LOCK_ALL          MEM_LOCK_ALL
+#define CFG_MEM_HEAP_PREFAULT     MEM_HEAP_PREFAULT
+
 #define CFG_SAT_CTRL_MQTT_PIPE_NAME   SAT_CTRL_MQTT_PIPE_NAME
 #define CFG_SAT_CTRL_MQTT_PIPE_DEPTH  SAT_CTRL_MQTT_PIPE_DEPTH
 #define CFG_SAT_CTRL_PERIOD           SAT_CTRL_PERIOD
-#define CFG_SAT_CTRL_TBL_DEF          SAT_CTRL_TBL_DEF
+#define CFG_SAT_CTRL_CDS_MAX_AGE      SAT_CTRL_CDS_MAX_AGE
+#define CFG_SAT_CTRL_STATS_PERIOD     SAT_CTRL_STATS_PERIOD
 
 #define CFG_I2C_SDA_BCM_ID    I2C_SDA_BCM_ID
 #define CFG_I2C_SCL_BCM_ID    I2C_SCL_BCM_ID
-#define CFG_FAN_A_PWM_BCM_ID  FAN_A_PWM_BCM_ID
-#define CFG_FAN_A_TACH_BCM_ID FAN_A_TACH_BCM_ID
-#define CFG_FAN_B_PWM_BCM_ID  FAN_B_PWM_BCM_ID
-#define CFG_FAN_B_TACH_BCM_ID FAN_B_TACH_BCM_ID
+#define CFG_FAN_SOFT_PWM_PERIOD   FAN_SOFT_PWM_PERIOD
+#define CFG_FAN_SOFT_PWM_PRIORITY FAN_SOFT_PWM_PRIORITY
+#define CFG_FAN_PWM_FIFO_PRIORITY FAN_PWM_FIFO_PRIORITY
+#define CFG_FAN_TACH_SOURCE       FAN_TACH_SOURCE
+#define CFG_FAN_TACH_DEVICE       FAN_TACH_DEVICE
+#define CFG_FAN_TACH_PULSE_PER_REV FAN_TACH_PULSE_PER_REV
+#define CFG_FAN_TACH_PRIORITY     FAN_TACH_PRIORITY
+
+#define CFG_SIM_RIG            SIM_RIG
+#define CFG_SIM_STEP           SIM_STEP
+#define CFG_SIM_SENSOR_PERIOD  SIM_SENSOR_PERIOD
+#define CFG_SIM_REAL_DELAY     SIM_REAL_DELAY
+#define CFG_SIM_SEED           SIM_SEED
       
 
 #define APP_CONFIG(XX) \
@@ -106,21 +169,47 @@
    XX(TBL_SAT_CMD_TOPICID,uint32) \
    XX(BC_SCH_1_HZ_TOPICID,uint32) \
    XX(TBL_SAT_STATUS_TLM_TOPICID,uint32) \
-   XX(MQTT_GW_TOPIC_4_TLM_TOPICID,uint32) \
+   XX(TBL_SAT_MEM_TLM_TOPICID,uint32) \
+   XX(TBL_SAT_WAKEUP_TOPICID,uint32) \
+   XX(TBL_SAT_STATS_TLM_TOPICID,uint32) \
+   XX(MEM_STACK_PAINT,uint32) \
+   XX(RIG_DEF_FILE,char*) \
+   XX(RIG_WORKER_CNT,uint32) \
+   XX(SHM_EXPORT_NAME,char*) \
    XX(CHILD_NAME,char*) \
    XX(CHILD_PERF_ID,uint32) \
    XX(CHILD_STACK_SIZE,uint32) \
    XX(CHILD_PRIORITY,uint32) \
+   XX(VIB_MON_NAME,char*) \
+   XX(VIB_MON_PERF_ID,uint32) \
+   XX(VIB_MON_STACK_SIZE,uint32) \
+   XX(VIB_MON_PRIORITY,uint32) \
+   XX(VIB_MON_PERIOD,uint32) \
+   XX(CHILD_CPU_AFFINITY,char*) \
+   XX(CHILD_RT_POLICY,char*) \
+   XX(CHILD_RT_PRIORITY,uint32) \
+   XX(CHILD_STACK_PREFAULT,uint32) \
+   XX(MEM_LOCK_ALL,uint32) \
+   XX(MEM_HEAP_PREFAULT,uint32) \
    XX(SAT_CTRL_MQTT_PIPE_NAME,char*) \
    XX(SAT_CTRL_MQTT_PIPE_DEPTH,uint32) \
    XX(SAT_CTRL_PERIOD,uint32) \
-   XX(SAT_CTRL_TBL_DEF,char*) \
+   XX(SAT_CTRL_CDS_MAX_AGE,uint32) \
+   XX(SAT_CTRL_STATS_PERIOD,uint32) \
    XX(I2C_SDA_BCM_ID,uint32) \
    XX(I2C_SCL_BCM_ID,uint32) \
-   XX(FAN_A_PWM_BCM_ID,uint32) \
-   XX(FAN_A_TACH_BCM_ID,uint32) \
-   XX(FAN_B_PWM_BCM_ID,uint32) \
-   XX(FAN_B_TACH_BCM_ID,uint32) \
+   XX(FAN_SOFT_PWM_PERIOD,uint32) \
+   XX(FAN_SOFT_PWM_PRIORITY,uint32) \
+   XX(FAN_PWM_FIFO_PRIORITY,uint32) \
+   XX(FAN_TACH_SOURCE,char*) \
+   XX(FAN_TACH_DEVICE,char*) \
+   XX(FAN_TACH_PULSE_PER_REV,uint32) \
+   XX(FAN_TACH_PRIORITY,uint32) \
+   XX(SIM_RIG,uint32) \
+   XX(SIM_STEP,uint32) \
+   XX(SIM_SENSOR_PERIOD,uint32) \
+   XX(SIM_REAL_DELAY,uint32) \
+   XX(SIM_SEED,uint32) \
 
 DECLARE_ENUM(Config,APP_CONFIG)
 
@@ -137,6 +226,28 @@ DECLARE_ENUM(Config,APP_CONFIG)
 #define SAT_CTRL_BASE_EID     (APP_C_FW_APP_BASE_EID + 10)
 #define SAT_CTRL_TBL_BASE_EID (APP_C_FW_APP_BASE_EID + 20)
 #define FAN_BASE_EID          (APP_C_FW_APP_BASE_EID + 30)
+#define FAN_TBL_BASE_EID      (APP_C_FW_APP_BASE_EID + 40)
+#define PWM_FIFO_BASE_EID     (APP_C_FW_APP_BASE_EID + 50)
+#define TACH_BASE_EID         (APP_C_FW_APP_BASE_EID + 60)
+#define RIG_MGR_BASE_EID      (APP_C_FW_APP_BASE_EID + 70)
+#define MEM_MON_BASE_EID      (APP_C_FW_APP_BASE_EID + 80)
+#define RT_PROFILE_BASE_EID   (APP_C_FW_APP_BASE_EID + 90)
+#define SEQ_BASE_EID          (APP_C_FW_APP_BASE_EID + 100)
+#define SEQ_TBL_BASE_EID      (APP_C_FW_APP_BASE_EID + 110)
+#define SIM_HW_BASE_EID       (APP_C_FW_APP_BASE_EID + 120)
+#define FAULT_INJ_BASE_EID    (APP_C_FW_APP_BASE_EID + 130)
+#define CMD_MBOX_BASE_EID     (APP_C_FW_APP_BASE_EID + 140)
+#define SENSOR_FILT_BASE_EID  (APP_C_FW_APP_BASE_EID + 150)
+#define SENSOR_TBL_BASE_EID   (APP_C_FW_APP_BASE_EID + 160)
+#define SHM_EXPORT_BASE_EID   (APP_C_FW_APP_BASE_EID + 170)
+#define VIB_MON_BASE_EID      (APP_C_FW_APP_BASE_EID + 180)
+#define GYRO_BIAS_BASE_EID    (APP_C_FW_APP_BASE_EID + 190)
+
+/******************************************************************************
+** RIG_MGR Macros
+*/
+
+#define RIG_MGR_JSON_FILE_MAX_CHAR  4096
 
 /******************************************************************************
 ** SAT_CTRL Table Macros
@@ -145,4 +256,25 @@ DECLARE_ENUM(Config,APP_CONFIG)
 #define SAT_CTRL_TBL_JSON_FILE_MAX_CHAR  4090 
 #define SAT_CTRL_TBL_NAME                "Control Parameters" 
 
+/******************************************************************************
+** FAN Table Macros
+*/
+
+#define FAN_TBL_JSON_FILE_MAX_CHAR  2048 
+#define FAN_TBL_NAME                "Fan Allocation" 
+
+/******************************************************************************
+** SEQ Table Macros
+*/
+
+#define SEQ_TBL_JSON_FILE_MAX_CHAR  8192
+#define SEQ_TBL_NAME                "Command Sequence"
+
+/******************************************************************************
+** SENSOR Table Macros
+*/
+
+#define SENSOR_TBL_JSON_FILE_MAX_CHAR  2048
+#define SENSOR_TBL_NAME                "Sensor Calibration"
+
 #endif /* _app_cfg_ */
@@ -0,0 +1,250 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Implement the Z axis attitude estimator
+**
+**  Notes:
+**    1. See att_est.h for details.
+**    2. Both measurements are scalar so each update is a rank one
+**       covariance correction without a matrix inverse. The covariance
+**       propagation is written out for the sparse transition matrix.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+#include <math.h>
+#include "att_est.h"
+
+
+/************************************/
+/** Local File Function Prototypes **/
+/************************************/
+
+static void Update(ATT_EST_Class_t *AttEst, double Innov,
+                   const double PHt[ATT_EST_STATE_CNT], double S);
+
+
+/******************************************************************************
+** Function: ATT_EST_Init
+**
+*/
+void ATT_EST_Init(ATT_EST_Class_t *AttEst)
+{
+
+   memset(AttEst, 0, sizeof(ATT_EST_Class_t));
+
+   AttEst->P[ATT_EST_RATE][ATT_EST_RATE] = ATT_EST_INIT_RATE_STD * ATT_EST_INIT_RATE_STD;
+   AttEst->P[ATT_EST_BIAS][ATT_EST_BIAS] = ATT_EST_INIT_BIAS_STD * ATT_EST_INIT_BIAS_STD;
+
+} /* End ATT_EST_Init() */
+
+
+/******************************************************************************
+** Function: ATT_EST_GetCov
+**
+*/
+void ATT_EST_GetCov(const ATT_EST_Class_t *AttEst, float Cov[ATT_EST_COV_CNT])
+{
+
+   uint8 Row, Col, i = 0;
+
+   for (Row=0; Row < ATT_EST_STATE_CNT; Row++)
+   {
+      for (Col=Row; Col < ATT_EST_STATE_CNT; Col++)
+      {
+         Cov[i++] = (float)AttEst->P[Row][Col];
+      }
+   }
+
+} /* End ATT_EST_GetCov() */
+
+
+/******************************************************************************
+** Function: ATT_EST_SetAngle
+**
+*/
+void ATT_EST_SetAngle(ATT_EST_Class_t *AttEst, double Angle)
+{
+
+   uint8 i;
+
+   AttEst->X[ATT_EST_ANGLE] = Angle;
+   for (i=0; i < ATT_EST_STATE_CNT; i++)
+   {
+      AttEst->P[ATT_EST_ANGLE][i] = 0.0;
+      AttEst->P[i][ATT_EST_ANGLE] = 0.0;
+   }
+
+} /* End ATT_EST_SetAngle() */
+
+
+/******************************************************************************
+** Function: ATT_EST_UpdateLight
+**
+** Notes:
+**   1. Bin i's center is at (i + 0.5) * 360/BinCnt degrees and the profile
+**      wraps from the last bin to the first.
+**
+*/
+bool ATT_EST_UpdateLight(ATT_EST_Class_t *AttEst, const ATT_EST_Param_t *Param,
+                         double Light, const float *Profile, uint16 BinCnt)
+{
+
+   double PHt[ATT_EST_STATE_CNT];
+   double BinWidth = 360.0 / BinCnt;
+   double Angle, Pos, Frac, Predicted, Slope, Innov, R, S;
+   double Peak = 0.0;
+   uint16 Bin, Next, i;
+
+   for (i=0; i < BinCnt; i++)
+   {
+      if (Profile[i] > Peak)
+      {
+         Peak = Profile[i];
+      }
+   }
+   if (Peak <= 0.0)
+   {
+      return false;
+   }
+
+   Angle = fmod(AttEst->X[ATT_EST_ANGLE], 360.0);
+   if (Angle < 0.0)
+   {
+      Angle += 360.0;
+   }
+   Pos  = Angle/BinWidth - 0.5;
+   Frac = Pos - floor(Pos);
+   Bin  = (uint16)(((int32)floor(Pos) + BinCnt) % BinCnt);
+   Next = (Bin + 1) % BinCnt;
+
+   Predicted = Profile[Bin] + Frac*(Profile[Next] - Profile[Bin]);
+   Slope     = (Profile[Next] - Profile[Bin]) / BinWidth;
+
+   Innov = Light - Predicted;
+   R     = (Param->LightStd * Peak) * (Param->LightStd * Peak);
+
+   /* H = [Slope 0 0] */
+   for (i=0; i < ATT_EST_STATE_CNT; i++)
+   {
+      PHt[i] = AttEst->P[i][ATT_EST_ANGLE] * Slope;
+   }
+   S = Slope*PHt[ATT_EST_ANGLE] + R;
+
+   if (Innov*Innov > (double)Param->Gate*Param->Gate*S)
+   {
+      AttEst->LightRejectCnt++;
+      return false;
+   }
+
+   Update(AttEst, Innov, PHt, S);
+   AttEst->LightCnt++;
+
+   return true;
+
+} /* End ATT_EST_UpdateLight() */
+
+
+/******************************************************************************
+** Function: ATT_EST_UpdateRate
+**
+*/
+void ATT_EST_UpdateRate(ATT_EST_Class_t *AttEst, const ATT_EST_Param_t *Param,
+                        double Rate, double DeltaTime)
+{
+
+   double (*P)[ATT_EST_STATE_CNT] = AttEst->P;
+   double PHt[ATT_EST_STATE_CNT];
+   double Dt = DeltaTime;
+   double Qa = (double)Param->AccelStd * Param->AccelStd;
+   double Qb = (double)Param->BiasWalk * Param->BiasWalk;
+   double S;
+   uint8  i;
+
+   if (Dt > 0.0)
+   {
+
+      AttEst->X[ATT_EST_ANGLE] += AttEst->X[ATT_EST_RATE] * Dt;
+
+      /* P = F*P*F' + Q with F = [1 Dt 0; 0 1 0; 0 0 1] */
+      P[0][0] += Dt*(2.0*P[0][1] + Dt*P[1][1]) + Qa*Dt*Dt*Dt/3.0;
+      P[0][1] += Dt*P[1][1] + Qa*Dt*Dt/2.0;
+      P[0][2] += Dt*P[1][2];
+      P[1][1] += Qa*Dt;
+      P[2][2] += Qb*Dt;
+      P[1][0]  = P[0][1];
+      P[2][0]  = P[0][2];
+
+   }
+
+   /* H = [0 1 1], the gyro measures rate plus bias */
+   for (i=0; i < ATT_EST_STATE_CNT; i++)
+   {
+      PHt[i] = P[i][ATT_EST_RATE] + P[i][ATT_EST_BIAS];
+   }
+   S = PHt[ATT_EST_RATE] + PHt[ATT_EST_BIAS] + (double)Param->RateStd * Param->RateStd;
+
+   Update(AttEst, Rate - (AttEst->X[ATT_EST_RATE] + AttEst->X[ATT_EST_BIAS]), PHt, S);
+   AttEst->RateCnt++;
+
+} /* End ATT_EST_UpdateRate() */
+
+
+/******************************************************************************
+** Function: ATT_EST_ValidParam
+**
+*/
+bool ATT_EST_ValidParam(const ATT_EST_Param_t *Param)
+{
+
+   return (Param->RateStd > 0.0 && Param->AccelStd > 0.0 && Param->BiasWalk > 0.0 &&
+           Param->LightStd > 0.0 && Param->Gate > 0.0);
+
+} /* End ATT_EST_ValidParam() */
+
+
+/******************************************************************************
+** Function: Update
+**
+** Apply a scalar measurement with innovation Innov. PHt is P*H' and S is
+** the innovation variance H*P*H' + R.
+*/
+static void Update(ATT_EST_Class_t *AttEst, double Innov,
+                   const double PHt[ATT_EST_STATE_CNT], double S)
+{
+
+   double K[ATT_EST_STATE_CNT];
+   uint8  Row, Col;
+
+   for (Row=0; Row < ATT_EST_STATE_CNT; Row++)
+   {
+      K[Row] = PHt[Row] / S;
+      AttEst->X[Row] += K[Row] * Innov;
+   }
+
+   for (Row=0; Row < ATT_EST_STATE_CNT; Row++)
+   {
+      for (Col=Row; Col < ATT_EST_STATE_CNT; Col++)
+      {
+         AttEst->P[Row][Col] -= K[Row] * PHt[Col];
+         AttEst->P[Col][Row]  = AttEst->P[Row][Col];
+      }
+   }
+
+} /* End Update() */
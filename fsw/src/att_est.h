@@ -0,0 +1,162 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Define the Z axis attitude estimator
+**
+**  Notes:
+**    1. A three state Kalman filter estimates the table's Z angle, rate and
+**       the gyro bias left after calibration, all in degrees. The angle is
+**       unwrapped and measured from the start of the sun acquisition.
+**    2. Each gyro sample propagates the state over the sample's delta time
+**       with a constant rate model driven by white angular acceleration and
+**       a random walk bias. The sample then updates the state as a
+**       measurement of rate plus bias.
+**    3. After the survey the light is a measurement of the angle through
+**       the survey's light profile, see sun_acq.h. The profile is linearly
+**       interpolated between bin centers and its slope linearizes the
+**       measurement so only the sloped parts of the profile correct the
+**       angle. A light sample whose innovation exceeds Gate standard
+**       deviations is rejected.
+**    4. The filter is fixed size and doesn't allocate. Like SUN_ACQ it
+**       doesn't use cFE or app_c_fw services so it can be built into host
+**       tools. SAT_CTRL owns one estimator per rig and only its worker
+**       calls it.
+**
+*/
+
+#ifndef _att_est_
+#define _att_est_
+
+/*
+** Includes
+*/
+
+#include "common_types.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+/* State vector indices */
+#define ATT_EST_ANGLE  0   /* Degrees */
+#define ATT_EST_RATE   1   /* Degrees/sec */
+#define ATT_EST_BIAS   2   /* Degrees/sec */
+#define ATT_EST_STATE_CNT  3   /* Must match EDS AttEstStateArray */
+#define ATT_EST_COV_CNT    6   /* Upper triangle, must match EDS AttEstCovArray */
+
+#define ATT_EST_INIT_RATE_STD  10.0   /* Degrees/sec */
+#define ATT_EST_INIT_BIAS_STD   1.0   /* Degrees/sec */
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+
+/******************************************************************************
+** Table parameters, see sat_ctrl_tbl.h
+*/
+
+typedef struct
+{
+
+   float  RateStd;    /* Gyro rate noise, deg/s */
+   float  AccelStd;   /* Angular acceleration process noise, deg/s^2 */
+   float  BiasWalk;   /* Bias random walk, deg/s per root second */
+   float  LightStd;   /* Light noise, fraction of the profile's peak */
+   float  Gate;       /* Light innovation gate, standard deviations */
+
+} ATT_EST_Param_t;
+
+
+/******************************************************************************
+** ATT_EST_Class
+*/
+
+typedef struct
+{
+
+   double  X[ATT_EST_STATE_CNT];
+   double  P[ATT_EST_STATE_CNT][ATT_EST_STATE_CNT];
+
+   uint32  RateCnt;         /* Gyro samples processed */
+   uint32  LightCnt;        /* Light samples that updated the angle */
+   uint32  LightRejectCnt;  /* Light samples rejected by the gate */
+
+} ATT_EST_Class_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: ATT_EST_Init
+**
+** Start the estimate at zero angle, rate and bias with a known angle and
+** an uncertain rate and bias.
+*/
+void ATT_EST_Init(ATT_EST_Class_t *AttEst);
+
+
+/******************************************************************************
+** Function: ATT_EST_GetCov
+**
+** Copy the covariance's upper triangle, row by row, to Cov.
+*/
+void ATT_EST_GetCov(const ATT_EST_Class_t *AttEst, float Cov[ATT_EST_COV_CNT]);
+
+
+/******************************************************************************
+** Function: ATT_EST_SetAngle
+**
+** Redefine the angle's origin, the angle is known exactly. Rate and bias
+** are unchanged.
+*/
+void ATT_EST_SetAngle(ATT_EST_Class_t *AttEst, double Angle);
+
+
+/******************************************************************************
+** Function: ATT_EST_UpdateLight
+**
+** Update the angle with a light sample. Profile holds BinCnt light values
+** at the centers of equal angle bins covering one revolution from zero.
+** Returns true if the sample passed the gate.
+*/
+bool ATT_EST_UpdateLight(ATT_EST_Class_t *AttEst, const ATT_EST_Param_t *Param,
+                         double Light, const float *Profile, uint16 BinCnt);
+
+
+/******************************************************************************
+** Function: ATT_EST_UpdateRate
+**
+** Propagate the state by DeltaTime seconds and update it with a gyro rate
+** sample in degrees/sec. A non-positive DeltaTime only updates.
+*/
+void ATT_EST_UpdateRate(ATT_EST_Class_t *AttEst, const ATT_EST_Param_t *Param,
+                        double Rate, double DeltaTime);
+
+
+/******************************************************************************
+** Function: ATT_EST_ValidParam
+**
+** Return true if every parameter is positive.
+*/
+bool ATT_EST_ValidParam(const ATT_EST_Param_t *Param);
+
+
+#endif /* _att_est_ */
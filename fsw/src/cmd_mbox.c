@@ -0,0 +1,154 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Implement the controller command mailbox class
+**
+**  Notes:
+**    1. See cmd_mbox.h for details. An entry is written before Head is
+**       released and read before Tail is released so neither side sees an
+**       entry the other is still using.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+#include <time.h>
+#include "cmd_mbox.h"
+
+
+/************************************/
+/** Local File Function Prototypes **/
+/************************************/
+
+static uint64 NowUs(void);
+
+
+/******************************************************************************
+** Function: CMD_MBOX_Constructor
+**
+*/
+void CMD_MBOX_Constructor(CMD_MBOX_Class_t *CmdMbox, uint8 RigIdx)
+{
+
+   memset(CmdMbox, 0, sizeof(CMD_MBOX_Class_t));
+
+   CmdMbox->RigIdx = RigIdx;
+
+} /* End CMD_MBOX_Constructor() */
+
+
+/******************************************************************************
+** Function: CMD_MBOX_Post
+**
+*/
+bool CMD_MBOX_Post(CMD_MBOX_Class_t *CmdMbox, const SEQ_TBL_Entry_t *Cmd)
+{
+
+   uint32 Head = __atomic_load_n(&CmdMbox->Head, __ATOMIC_RELAXED);
+   uint32 Tail = __atomic_load_n(&CmdMbox->Tail, __ATOMIC_ACQUIRE);
+   CMD_MBOX_Entry_t *Entry;
+
+   if ((Head - Tail) >= CMD_MBOX_DEPTH)
+   {
+      CmdMbox->FullCnt++;
+      CFE_EVS_SendEvent(CMD_MBOX_POST_EID, CFE_EVS_EventType_ERROR,
+                        "Rig %d command rejected, the %d entry command mailbox is full",
+                        CmdMbox->RigIdx, CMD_MBOX_DEPTH);
+      return false;
+   }
+
+   Entry = &CmdMbox->Entry[Head & (CMD_MBOX_DEPTH-1)];
+   Entry->Cmd    = *Cmd;
+   Entry->PostUs = NowUs();
+
+   __atomic_store_n(&CmdMbox->Head, Head + 1, __ATOMIC_RELEASE);
+
+   return true;
+
+} /* End CMD_MBOX_Post() */
+
+
+/******************************************************************************
+** Function: CMD_MBOX_ResetStatus
+**
+*/
+void CMD_MBOX_ResetStatus(CMD_MBOX_Class_t *CmdMbox)
+{
+
+   CmdMbox->FullCnt       = 0;
+   CmdMbox->AppliedCnt    = 0;
+   CmdMbox->LastLatencyUs = 0;
+   CmdMbox->MaxLatencyUs  = 0;
+
+} /* End CMD_MBOX_ResetStatus() */
+
+
+/******************************************************************************
+** Function: CMD_MBOX_Take
+**
+** Notes:
+**   1. The latency is measured when the command is taken, immediately
+**      before the worker applies it.
+**
+*/
+bool CMD_MBOX_Take(CMD_MBOX_Class_t *CmdMbox, SEQ_TBL_Entry_t *Cmd)
+{
+
+   uint32 Tail = __atomic_load_n(&CmdMbox->Tail, __ATOMIC_RELAXED);
+   uint32 Head = __atomic_load_n(&CmdMbox->Head, __ATOMIC_ACQUIRE);
+   const CMD_MBOX_Entry_t *Entry;
+   uint64 LatencyUs;
+
+   if (Head == Tail)
+   {
+      return false;
+   }
+
+   Entry = &CmdMbox->Entry[Tail & (CMD_MBOX_DEPTH-1)];
+   *Cmd  = Entry->Cmd;
+   LatencyUs = NowUs() - Entry->PostUs;
+
+   __atomic_store_n(&CmdMbox->Tail, Tail + 1, __ATOMIC_RELEASE);
+
+   CmdMbox->AppliedCnt++;
+   CmdMbox->LastLatencyUs = (LatencyUs > UINT32_MAX) ? UINT32_MAX : (uint32)LatencyUs;
+   if (CmdMbox->LastLatencyUs > CmdMbox->MaxLatencyUs)
+   {
+      CmdMbox->MaxLatencyUs = CmdMbox->LastLatencyUs;
+   }
+
+   return true;
+
+} /* End CMD_MBOX_Take() */
+
+
+/******************************************************************************
+** Function: NowUs
+**
+** Return CLOCK_MONOTONIC in microseconds.
+*/
+static uint64 NowUs(void)
+{
+
+   struct timespec Now;
+
+   clock_gettime(CLOCK_MONOTONIC, &Now);
+
+   return ((uint64)Now.tv_sec * 1000000ULL + (uint64)Now.tv_nsec / 1000ULL);
+
+} /* End NowUs() */
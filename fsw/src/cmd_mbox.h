@@ -0,0 +1,157 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Define the controller command mailbox class
+**
+**  Notes:
+**    1. Each rig owns one CMD_MBOX object. The set control mode, set
+**       control gains, override fan PWM and start and stop PWM playback
+**       commands are received by the app's main task, which posts them to
+**       the rig's mailbox. The rig's worker applies every posted command
+**       at the start of its next pass, before the rig's control step, so a
+**       step never sees a partially applied command and the fan's PWM
+**       registers are only written by the worker.
+**    2. The mailbox is a lock-free single producer, single consumer ring.
+**       The main task is the only producer and the rig's worker the only
+**       consumer. Head is only written by the producer and Tail by the
+**       consumer.
+**    3. Commands use the sequence table's entry format so posted and
+**       sequenced commands share one execution path.
+**    4. Command-to-effect latency is measured with CLOCK_MONOTONIC from the
+**       post to the apply, independent of the simulation's virtual clock.
+**
+*/
+
+#ifndef _cmd_mbox_
+#define _cmd_mbox_
+
+/*
+** Includes
+*/
+
+#include "app_cfg.h"
+#include "seq_tbl.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define CMD_MBOX_DEPTH  8   /* Must be a power of 2 */
+
+/*
+** Event Message IDs
+*/
+
+#define CMD_MBOX_POST_EID  (CMD_MBOX_BASE_EID + 0)
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+
+/******************************************************************************
+** Mailbox entry
+*/
+
+typedef struct
+{
+
+   SEQ_TBL_Entry_t  Cmd;
+   uint64           PostUs;
+
+} CMD_MBOX_Entry_t;
+
+
+/******************************************************************************
+** CMD_MBOX_Class
+*/
+
+typedef struct
+{
+
+   /*
+   ** Class State Data
+   */
+
+   uint8   RigIdx;
+   uint32  Head;           /* Atomic, next entry to write */
+   uint32  Tail;           /* Atomic, next entry to read */
+
+   /*
+   ** Telemetry
+   */
+
+   uint32  FullCnt;        /* Commands rejected because the mailbox was full */
+   uint32  AppliedCnt;
+   uint32  LastLatencyUs;
+   uint32  MaxLatencyUs;
+
+   CMD_MBOX_Entry_t  Entry[CMD_MBOX_DEPTH];
+
+} CMD_MBOX_Class_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: CMD_MBOX_Constructor
+**
+** Initialize a rig's command mailbox to empty.
+**
+** Notes:
+**   1. This must be called prior to any other function.
+**
+*/
+void CMD_MBOX_Constructor(CMD_MBOX_Class_t *CmdMbox, uint8 RigIdx);
+
+
+/******************************************************************************
+** Function: CMD_MBOX_Post
+**
+** Post a command for the rig's worker. Called by the app's main task.
+** Returns false if the mailbox is full.
+*/
+bool CMD_MBOX_Post(CMD_MBOX_Class_t *CmdMbox, const SEQ_TBL_Entry_t *Cmd);
+
+
+/******************************************************************************
+** Function: CMD_MBOX_ResetStatus
+**
+** Reset counters and status flags to a known reset state.
+**
+** Notes:
+**   1. Any counter or variable that is reported in HK telemetry that doesn't
+**      change the functional behavior should be reset.
+**
+*/
+void CMD_MBOX_ResetStatus(CMD_MBOX_Class_t *CmdMbox);
+
+
+/******************************************************************************
+** Function: CMD_MBOX_Take
+**
+** Copy the oldest posted command to Cmd and remove it from the mailbox.
+** Returns false if the mailbox is empty. Called by the rig's worker, which
+** must apply the command before its next call.
+*/
+bool CMD_MBOX_Take(CMD_MBOX_Class_t *CmdMbox, SEQ_TBL_Entry_t *Cmd);
+
+
+#endif /* _cmd_mbox_ */
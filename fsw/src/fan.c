@@ -16,7 +16,10 @@
 **    Implement the Fan Class methods
 **
 **  Notes:
-**    None
+**    1. The hardware PWM channels and the software PWM task are shared by
+**       every rig's FAN object so their bookkeeping is file scope. It's
+**       only modified by constructors which run in the app's main task
+**       during initialization.
 **
 */
 
@@ -25,26 +28,57 @@
 */
 
 #include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
 #include "gpio.h"
-#include "pwm.h"
 #include "app_cfg.h"
 #include "fan.h"
+#include "mem_mon.h"
 
 
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define SOFT_PWM_TASK_NAME   "TBL_SAT_SPWM"
+#define SOFT_PWM_STACK_SIZE  8192
 
 
 /**********************/
 /** Global File Data **/
 /**********************/
 
-static FAN_Class_t *Fan = NULL;
+typedef struct
+{
+
+   FAN_Class_t   *Fan;
+   FAN_Struct_t  *Actuator;
+
+} SoftPwmFan_t;
+
+static bool  PwmChannelUsed[2] = { false, false };  /* Claimed by any rig */
+
+static SoftPwmFan_t     SoftPwmFan[FAN_SOFT_PWM_MAX_FAN];
+static uint8            SoftPwmFanCnt = 0;   /* Atomic, read by the software PWM task */
+static uint32           SoftPwmPeriod;       /* Microseconds */
+static bool             SoftPwmTaskCreated = false;
+static CFE_ES_TaskId_t  SoftPwmTaskId;
 
 
 /*******************************/
 /** Local Function Prototypes **/
 /*******************************/
 
-static void ConfigPwm(FAN_Struct_t *FanObj, TBL_SAT_FanId_Enum_t FanId, int Channel);
+static void ApplyPwmTbl(FAN_Class_t *Fan);
+static void ConfigPwm(FAN_Class_t *Fan, uint8 FanIdx, int Channel, int AltFunc, bool UseFifo);
+static void ConfigSoftPwm(FAN_Class_t *Fan, uint8 FanIdx);
+static uint32 QuantizePwm(float RegTarget, float *DitherErr, bool Dither, uint16 Range);
+static int  GetPwmChannel(uint8 BcmId, int *AltFunc);
+static uint8 ParseBcmIdList(const char *BcmIdList, uint8 *BcmId, uint8 MaxCnt);
+static void SoftPwmTask(void);
+static void TimespecAddUsec(struct timespec *Time, uint32 Usec);
+
 
 /******************************************************************************
 ** Function: FAN_Constructor
@@ -53,41 +87,102 @@ static void ConfigPwm(FAN_Struct_t *FanObj, TBL_SAT_FanId_Enum_t FanId, int Chan
 **
 ** Notes:
 **   1. This must be called prior to any other function.
-**   2. Can assume gpio_map() has been called and verified
+**   2. Config->GpioMapped indicates whether IO_REG_MapGpio() has been called
+**      and verified and Config->PwmMapped does the same for IO_REG_MapPwm().
+**   3. The software PWM task is created by the first object with a software
+**      PWM fan. Later objects add their fans to the running task.
 **
 */
-void FAN_Constructor(FAN_Class_t *FanPtr, INITBL_Class_t *IniTbl)
+void FAN_Constructor(FAN_Class_t *Fan, INITBL_Class_t *IniTbl, const FAN_Config_t *Config)
 {
    
-   Fan = FanPtr;
+   uint8 i;
+   uint8 PwmBcmCnt, TachBcmCnt;
+   uint8 PwmBcmId[FAN_TBL_MAX_FAN];
+   uint8 TachBcmId[FAN_TBL_MAX_FAN];
+   int   Channel, AltFunc;
+   int32 CfeStatus;
    
    memset(Fan, 0, sizeof(FAN_Class_t));
 
-   Fan->A.PwmBcmId  = INITBL_GetIntConfig(IniTbl, CFG_FAN_A_PWM_BCM_ID);
-   Fan->A.TachBcmId = INITBL_GetIntConfig(IniTbl, CFG_FAN_A_TACH_BCM_ID);
-   Fan->B.PwmBcmId  = INITBL_GetIntConfig(IniTbl, CFG_FAN_B_PWM_BCM_ID);
-   Fan->B.TachBcmId = INITBL_GetIntConfig(IniTbl, CFG_FAN_B_TACH_BCM_ID);
+   Fan->RigIdx    = Config->RigIdx;
+   Fan->FanCnt    = Config->FanCnt;
+   Fan->PwmMapped = Config->PwmMapped;
+   Fan->PwmFifo   = Config->PwmFifo;
+   Fan->TachLine  = TACH_MAX_LINE;
+   SoftPwmPeriod  = INITBL_GetIntConfig(IniTbl, CFG_FAN_SOFT_PWM_PERIOD);
+   
+   PwmBcmCnt  = ParseBcmIdList(Config->PwmBcmId, PwmBcmId, FAN_TBL_MAX_FAN);
+   TachBcmCnt = ParseBcmIdList(Config->TachBcmId, TachBcmId, FAN_TBL_MAX_FAN);
 
-   if (pwm_map() >= 0)
+   if (Fan->FanCnt > FAN_TBL_MAX_FAN || Fan->FanCnt > PwmBcmCnt || Fan->FanCnt > TachBcmCnt)
    {
-      Fan->PwmMapped = true;
-      ConfigPwm(&Fan->A, TBL_SAT_FanId_A, PWM_CHANNEL0);
-      ConfigPwm(&Fan->B, TBL_SAT_FanId_B, PWM_CHANNEL1);
-
+      CFE_EVS_SendEvent (FAN_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR, 
+                         "Rig %d invalid fan count %d. Must be <= %d and <= the %d PWM and %d tach BCM pins defined in the rig definition file",
+                         Fan->RigIdx, Fan->FanCnt, FAN_TBL_MAX_FAN, PwmBcmCnt, TachBcmCnt);
+      Fan->FanCnt = 0;
    }
-   else
+   
+   for (i=0; i < Fan->FanCnt; i++)
    {
-      Fan->PwmMapped = false;
-      CFE_EVS_SendEvent (FAN_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR, 
-                         "PWM mapping failed. Verify chip selection in rpi_iolib config.h and PWM pin assignments in JSON ini file");
+      Fan->Actuator[i].PwmBcmId   = PwmBcmId[i];
+      Fan->Actuator[i].TachBcmId  = TachBcmId[i];
+      Fan->Actuator[i].PwmChannel = FAN_SOFT_PWM_CHANNEL;
+   }
+   
+   if (Fan->FanCnt > 0)
+   {
+      Fan->TachLine = TACH_AddLines(TachBcmId, Fan->FanCnt);
+   }
+   
+   FAN_TBL_Constructor(&Fan->Tbl, Fan->FanCnt);
+   FAN_TBL_Load(&Fan->Tbl, APP_C_FW_TblLoadOptions_REPLACE, Config->TblFilename);
+   FAN_TBL_Activate(&Fan->Tbl);
 
-   } /* End if PWM mapped */
+   ApplyPwmTbl(Fan);
+   
+   if (Config->GpioMapped)
+   {
+      
+      for (i=0; i < Fan->FanCnt; i++)
+      {
+         
+         Channel = GetPwmChannel(Fan->Actuator[i].PwmBcmId, &AltFunc);
+         
+         if (Fan->PwmMapped && Channel != FAN_SOFT_PWM_CHANNEL && !PwmChannelUsed[Channel])
+         {
+            PwmChannelUsed[Channel] = true;
+            Fan->PwmFifoChannelCnt++;
+            ConfigPwm(Fan, i, Channel, AltFunc, false);
+         }
+         else
+         {
+            ConfigSoftPwm(Fan, i);
+         }
+         
+      } /* End fan loop */
+
+      if (Fan->SoftPwmCnt > 0 && !SoftPwmTaskCreated)
+      {
+         CfeStatus = CFE_ES_CreateChildTask(&SoftPwmTaskId, SOFT_PWM_TASK_NAME, SoftPwmTask,
+                                            CFE_ES_TASK_STACK_ALLOCATE, SOFT_PWM_STACK_SIZE,
+                                            INITBL_GetIntConfig(IniTbl, CFG_FAN_SOFT_PWM_PRIORITY), 0);
+         SoftPwmTaskCreated = (CfeStatus == CFE_SUCCESS);
+         if (!SoftPwmTaskCreated)
+         {
+            CFE_EVS_SendEvent (FAN_SOFT_PWM_EID, CFE_EVS_EventType_ERROR, 
+                               "Software PWM child task creation failed for rig %d. Status = 0x%08X",
+                               Fan->RigIdx, (unsigned int)CfeStatus);
+         }
+      }
+      
+   } /* End if GPIO mapped */
     
 } /* End FAN_Constructor() */
 
 
 /******************************************************************************
-** Function: FAN_OverridePwmCmd
+** Function: FAN_OverridePwm
 **
 ** Override commanded PWM value.
 **
@@ -95,29 +190,140 @@ void FAN_Constructor(FAN_Class_t *FanPtr, INITBL_Class_t *IniTbl)
 **   1. The overridded value is not limited.
 **
 */
-bool FAN_OverridePwmCmd(void *DataObjPtr, const CFE_MSG_Message_t *MsgPtr)
+bool FAN_OverridePwm(FAN_Class_t *Fan, uint32 Duration, uint16 FanAPwm, uint16 FanBPwm)
 {
 
-   const TBL_SAT_OverrideFanPwm_CmdPayload_t *OverrideCmd = CMDMGR_PAYLOAD_PTR(MsgPtr, TBL_SAT_OverrideFanPwm_t);
-
-   if (OverrideCmd->Duration == 0)
+   if (Duration == 0)
    {
       Fan->OverridePwmCmdEnabled = false;
    }
    else
    {
       Fan->OverridePwmCmdEnabled = true;
-      Fan->OverridePwmCmdCount   = OverrideCmd->Duration;
-      Fan->A.OverridePwmCmd = OverrideCmd->FanAPwm;
-      Fan->B.OverridePwmCmd = OverrideCmd->FanBPwm;
+      Fan->OverridePwmCmdCount   = Duration;
+      Fan->Actuator[0].OverridePwmCmd = FanAPwm;
+      Fan->Actuator[1].OverridePwmCmd = FanBPwm;
       CFE_EVS_SendEvent (FAN_OVERRIDE_PWM_CMD_EID, CFE_EVS_EventType_INFORMATION,
-                         "Starting fan PWM command override for %d cycles. Fan A PWM: %d, Fan B PWM: %d",
-                         Fan->OverridePwmCmdCount, Fan->A.OverridePwmCmd, Fan->B.OverridePwmCmd);
+                         "Starting rig %d fan PWM command override for %d cycles. Fan A PWM: %d, Fan B PWM: %d",
+                         Fan->RigIdx, Fan->OverridePwmCmdCount, Fan->Actuator[0].OverridePwmCmd, Fan->Actuator[1].OverridePwmCmd);
    }
 
    return true;
 
-} /* End FAN_OverridePwmCmd() */
+} /* End FAN_OverridePwm() */
+
+
+/******************************************************************************
+** Function: FAN_StartPwmPlayback
+**
+** Notes:
+**   1. The profile is converted to register values before playback starts
+**      so the refill task only copies words. Dithering is applied across
+**      successive samples of each channel.
+**   2. The FIFO is prefilled before the channels are switched to FIFO mode.
+**   3. The profile load, the FIFO words and the channel modes are written
+**      here so this must run on the rig's worker, the only writer of the
+**      fan's PWM registers.
+**
+*/
+bool FAN_StartPwmPlayback(FAN_Class_t *Fan, const char *Filename, uint16 RepeatCnt)
+{
+
+   bool   RetStatus = false;
+   bool   Dither;
+   float  Scale;
+   float  DitherErr[PWM_FIFO_MAX_CHANNEL] = { 0.0, 0.0 };
+   uint32 Word, WordPeriod;
+   uint8  i, Channel;
+   
+   if (!FAN_ValidPwmPlayback(Fan))
+   {
+      return false;
+   }
+   
+   if (PWM_FIFO_LoadProfile(Filename, Fan->PwmFifoChannelCnt, FAN_MAX_PWM))
+   {
+      
+      Dither = (Fan->Tbl.Data.Pwm.Dither != 0);
+      Scale  = (float)Fan->PwmRange / (float)FAN_MAX_PWM;
+      
+      for (Word=0; Word < Fan->PwmFifo->WordCnt; Word++)
+      {
+         Channel = Word % Fan->PwmFifoChannelCnt;
+         Fan->PwmFifo->Word[Word] = QuantizePwm(Fan->PwmFifo->Word[Word] * Scale, &DitherErr[Channel],
+                                                Dither, Fan->PwmRange);
+      }
+      
+      /* Each channel reads one word per PWM period */
+      WordPeriod = (uint32)(((uint64)Fan->PwmClkDivisor * Fan->PwmRange * 1000000) /
+                            ((uint64)PWM_FIFO_CLK_HZ * Fan->PwmFifoChannelCnt));
+      
+      if (PWM_FIFO_Start(WordPeriod, RepeatCnt))
+      {
+         for (i=0; i < Fan->FanCnt; i++)
+         {
+            if (Fan->Actuator[i].PwmChannel != FAN_SOFT_PWM_CHANNEL)
+            {
+               ConfigPwm(Fan, i, Fan->Actuator[i].PwmChannel, -1, true);
+            }
+         }
+         Fan->PwmFifoInUse = true;
+         RetStatus = true;
+      }
+      
+   } /* End if profile loaded */
+   
+   return RetStatus;
+
+} /* End FAN_StartPwmPlayback() */
+
+
+/******************************************************************************
+** Function: FAN_StopPwmPlayback
+**
+*/
+bool FAN_StopPwmPlayback(FAN_Class_t *Fan)
+{
+
+   if (!Fan->PwmFifoInUse || !PWM_FIFO_Active())
+   {
+      CFE_EVS_SendEvent (FAN_PWM_PLAYBACK_EID, CFE_EVS_EventType_ERROR,
+                         "Stop PWM playback rejected, a profile isn't playing on rig %d", Fan->RigIdx);
+      return false;
+   }
+   
+   PWM_FIFO_Stop();
+   
+   return true;
+
+} /* End FAN_StopPwmPlayback() */
+
+
+/******************************************************************************
+** Function: FAN_ReadTach
+**
+*/
+void FAN_ReadTach(FAN_Class_t *Fan)
+{
+   
+   uint8 i;
+   const TACH_Line_t *Line;
+   
+   if (Fan->TachLine >= TACH_MAX_LINE)
+   {
+      return;
+   }
+   
+   TACH_Update(Fan->TachLine, Fan->FanCnt);
+   
+   for (i=0; i < Fan->FanCnt; i++)
+   {
+      Line = TACH_GetLine(Fan->TachLine + i);
+      Fan->Actuator[i].Rpm         = Line->Rpm;
+      Fan->Actuator[i].PulsePerSec = (uint16)lroundf(Line->PulsePerSec);
+   }
+   
+} /* End FAN_ReadTach() */
 
 
 /******************************************************************************
@@ -128,24 +334,68 @@ bool FAN_OverridePwmCmd(void *DataObjPtr, const CFE_MSG_Message_t *MsgPtr)
 ** Notes:
 **   1. Any counter or variable that is reported in HK telemetry that doesn't
 **      change the functional behavior should be reset.
+**   2. The shared PWM FIFO and TACH objects are reset by their owner.
 **
 */
-void FAN_ResetStatus(void)
+void FAN_ResetStatus(FAN_Class_t *Fan)
 {
 
-   return;
+   FAN_TBL_ResetStatus(&Fan->Tbl);
 
 } /* End FAN_ResetStatus() */
 
 
 /******************************************************************************
-** Function: FAN_SetPwm
+** Function: FAN_SetEffort
 **
 ** Notes:
-**   1. TODO - Add PWM setting
+**   1. The loops run over every fan so the trip counts are fixed and the
+**      unused allocation rows are zero. This allows the compiler to
+**      vectorize the matrix-vector product and the limit checks.
 **
 */
-bool FAN_SetPwm(TBL_SAT_FanId_Enum_t FanId, uint16 Pwm)
+bool FAN_SetEffort(FAN_Class_t *Fan, const float *Effort)
+{
+   
+   uint8  Axis, i;
+   float  Pwm[FAN_TBL_MAX_FAN];
+   bool   Limited = false;
+   
+   for (i=0; i < FAN_TBL_MAX_FAN; i++)
+   {
+      Pwm[i] = 0.0;
+   }
+   
+   for (Axis=0; Axis < FAN_TBL_AXIS_CNT; Axis++)
+   {
+      for (i=0; i < FAN_TBL_MAX_FAN; i++)
+      {
+         Pwm[i] += Fan->Tbl.Data.Alloc[Axis][i] * Effort[Axis];
+      }
+   }
+
+   for (i=0; i < FAN_TBL_MAX_FAN; i++)
+   {
+      Limited |= (Pwm[i] > (float)FAN_MAX_PWM);
+      Pwm[i] = fminf(fmaxf(Pwm[i], (float)FAN_MIN_PWM), (float)FAN_MAX_PWM);
+   }
+
+   for (i=0; i < Fan->FanCnt; i++)
+   {
+      Fan->Actuator[i].PwmTarget = Pwm[i];
+      Fan->Actuator[i].PwmCmd    = (uint16)lroundf(Pwm[i]);
+   }
+   
+   return Limited;
+   
+} /* End FAN_SetEffort() */
+
+
+/******************************************************************************
+** Function: FAN_SetPwm
+**
+*/
+bool FAN_SetPwm(FAN_Class_t *Fan, uint8 FanIdx, uint16 Pwm)
 {
    
    bool Limited = false;
@@ -158,36 +408,117 @@ bool FAN_SetPwm(TBL_SAT_FanId_Enum_t FanId, uint16 Pwm)
       Limited = true;
    }
    
-   if (FanId == TBL_SAT_FanId_A)
+   if (FanIdx < Fan->FanCnt)
    {
-      Fan->A.PwmCmd = LimitedPwm;
-      if (Fan->PwmMapped)
-      {         
-         if (Fan->OverridePwmCmdEnabled)
-         {
-            DAT_CHANNEL0 = Fan->A.OverridePwmCmd;
-         }
-         else
-         {
-            DAT_CHANNEL0 = Fan->A.PwmCmd;
-         }
-      }
+      Fan->Actuator[FanIdx].PwmTarget = LimitedPwm;
+      Fan->Actuator[FanIdx].PwmCmd    = LimitedPwm;
    }
-   else
+   
+   return Limited;
+   
+} /* End FAN_SetPwm() */
+
+
+/******************************************************************************
+** Function: FAN_ValidPwmPlayback
+**
+** Notes:
+**   1. Only the channel assignments are read and they don't change after
+**      the constructor so this can be called from the app's main task.
+**
+*/
+bool FAN_ValidPwmPlayback(const FAN_Class_t *Fan)
+{
+
+   if (Fan->PwmFifoChannelCnt == 0 || Fan->PwmFifo == NULL)
    {
-      Fan->B.PwmCmd = LimitedPwm;
-      if (Fan->PwmMapped)
-      {         
-         if (Fan->OverridePwmCmdEnabled)
-         {
-            DAT_CHANNEL1 = Fan->B.OverridePwmCmd;
-         }
-         else
+      CFE_EVS_SendEvent (FAN_PWM_PLAYBACK_EID, CFE_EVS_EventType_ERROR,
+                         "Start PWM playback rejected, rig %d has no hardware PWM channels", Fan->RigIdx);
+      return false;
+   }
+   
+   if (Fan->PwmFifoChannelCnt != (PwmChannelUsed[PWM_CHANNEL0] + PwmChannelUsed[PWM_CHANNEL1]))
+   {
+      CFE_EVS_SendEvent (FAN_PWM_PLAYBACK_EID, CFE_EVS_EventType_ERROR,
+                         "Start PWM playback rejected, rig %d shares the PWM FIFO with another rig's hardware channel",
+                         Fan->RigIdx);
+      return false;
+   }
+   
+   return true;
+
+} /* End FAN_ValidPwmPlayback() */
+
+
+/******************************************************************************
+** Function: FAN_WritePwm
+**
+** Notes:
+**   1. Software PWM fans only have their register target updated, the
+**      software PWM task reads it at the start of each PWM period.
+**   2. Override commands are raw register values so they are not scaled
+**      or dithered.
+**   3. The hardware channels are returned to data mode, with any deferred
+**      fan table PWM parameters, once a PWM FIFO playback has ended.
+**
+*/
+void FAN_WritePwm(FAN_Class_t *Fan)
+{
+   
+   uint8  i;
+   bool   Dither;
+   bool   ConfigChannels = false;
+   float  Scale;
+   FAN_Struct_t *FanObj;
+   
+   if (Fan->PwmFifoInUse && !PWM_FIFO_Active())
+   {
+      Fan->PwmFifoInUse = false;
+      ConfigChannels    = true;
+   }
+   
+   if (!Fan->PwmFifoInUse &&
+       (ConfigChannels ||
+        Fan->Tbl.Data.Pwm.Range != Fan->PwmRange ||
+        Fan->Tbl.Data.Pwm.ClkDivisor != Fan->PwmClkDivisor))
+   {
+      ApplyPwmTbl(Fan);
+      for (i=0; i < Fan->FanCnt; i++)
+      {
+         if (Fan->PwmMapped && Fan->Actuator[i].PwmChannel != FAN_SOFT_PWM_CHANNEL)
          {
-            DAT_CHANNEL1 = Fan->B.PwmCmd;
+            ConfigPwm(Fan, i, Fan->Actuator[i].PwmChannel, -1, false);
          }
       }
    }
+   
+   Dither = (Fan->Tbl.Data.Pwm.Dither != 0);
+   Scale  = (float)Fan->PwmRange / (float)FAN_MAX_PWM;
+   
+   for (i=0; i < Fan->FanCnt; i++)
+   {
+      
+      FanObj = &Fan->Actuator[i];
+      
+      if (Fan->OverridePwmCmdEnabled && i < 2)
+      {
+         FanObj->RegTarget = FanObj->OverridePwmCmd;
+         FanObj->PwmOutput = FanObj->OverridePwmCmd;
+         FanObj->DitherErr = 0.0;
+      }
+      else
+      {
+         FanObj->RegTarget = FanObj->PwmTarget * Scale;
+         FanObj->PwmOutput = QuantizePwm(FanObj->RegTarget, &FanObj->DitherErr, Dither, Fan->PwmRange);
+      }
+   
+      if (Fan->PwmMapped && !Fan->PwmFifoInUse && FanObj->PwmChannel != FAN_SOFT_PWM_CHANNEL)
+      {
+         IO_REG_PwmWrite(FanObj->PwmChannel, FanObj->PwmOutput);
+      }
+   
+   } /* End fan loop */
+   
    if (Fan->OverridePwmCmdEnabled)
    {
       Fan->OverridePwmCmdCount--;
@@ -195,41 +526,320 @@ bool FAN_SetPwm(TBL_SAT_FanId_Enum_t FanId, uint16 Pwm)
       {
          Fan->OverridePwmCmdEnabled = false;
          CFE_EVS_SendEvent (FAN_SET_PWM_EID, CFE_EVS_EventType_INFORMATION,
-                            "Override fan PWM command terminated");           
+                            "Rig %d override fan PWM command terminated", Fan->RigIdx);           
       }
    }
    
-   return Limited;
+} /* End FAN_WritePwm() */
+
+
+/******************************************************************************
+** Function: ApplyPwmTbl
+**
+** Make the fan table's PWM parameters active. The defaults are used if the
+** table has never been successfully loaded.
+*/
+static void ApplyPwmTbl(FAN_Class_t *Fan)
+{
+
+   if (Fan->Tbl.Loaded)
+   {
+      Fan->PwmRange      = Fan->Tbl.Data.Pwm.Range;
+      Fan->PwmClkDivisor = Fan->Tbl.Data.Pwm.ClkDivisor;
+   }
+   else
+   {
+      Fan->Tbl.Data.Pwm.Range      = FAN_DEF_PWM_RANGE;
+      Fan->Tbl.Data.Pwm.ClkDivisor = FAN_DEF_PWM_CLK_DIVISOR;
+      Fan->PwmRange      = FAN_DEF_PWM_RANGE;
+      Fan->PwmClkDivisor = FAN_DEF_PWM_CLK_DIVISOR;
+   }
    
-} /* End FAN_SetPwm() */
+} /* End ApplyPwmTbl() */
 
 
 /******************************************************************************
 ** Function: ConfigPwm
 **
 ** Notes:
-**   1. TODO - Document this mess and make a function
+**   1. An AltFunc of -1 reconfigures a channel without changing the pin's
+**      function.
+**   2. In FIFO mode the channel repeats the last FIFO word when the FIFO is
+**      empty so the output holds its last value when a playback ends.
+**   3. The PWM clock divisor is common to both channels so when two rigs
+**      each own a channel the last fan table that's applied sets it.
 **
 */
-static void ConfigPwm(FAN_Struct_t *FanObj, TBL_SAT_FanId_Enum_t FanId, int Channel)
+static void ConfigPwm(FAN_Class_t *Fan, uint8 FanIdx, int Channel, int AltFunc, bool UseFifo)
 {
 
-      gpio_func(FanObj->PwmBcmId, ALT5); // Alternate function 5 is PWM
+      FAN_Struct_t *FanObj = &Fan->Actuator[FanIdx];
+
+      if (AltFunc >= 0)
+      {
+         IO_REG_GpioFunc(FanObj->PwmBcmId, AltFunc);
+      }
 
+      FanObj->PwmChannel = Channel;
       FanObj->PwmChanCfg.pwm_register.pwm_bitfield.mode = PWM_CTL_MODE_PWM;
-      FanObj->PwmChanCfg.pwm_register.pwm_bitfield.rptl = PWM_RPTL_STOP;
+      FanObj->PwmChanCfg.pwm_register.pwm_bitfield.rptl = UseFifo ? PWM_RPTL_REPEAT : PWM_RPTL_STOP;
       FanObj->PwmChanCfg.pwm_register.pwm_bitfield.sbit = PWM_SBIT_LOW;
       FanObj->PwmChanCfg.pwm_register.pwm_bitfield.pola = PWM_POLA_DEFAULT;
-      FanObj->PwmChanCfg.pwm_register.pwm_bitfield.usef = PWM_USEF_DATA;
+      FanObj->PwmChanCfg.pwm_register.pwm_bitfield.usef = UseFifo ? PWM_USEF_FIFO : PWM_USEF_DATA;
       FanObj->PwmChanCfg.pwm_register.pwm_bitfield.msen = PWM_MSEN_MSRATIO;
-      FanObj->PwmChanCfg.divisor =   19;
-      FanObj->PwmChanCfg.range   = 1023;
+      FanObj->PwmChanCfg.divisor = Fan->PwmClkDivisor;
+      FanObj->PwmChanCfg.range   = Fan->PwmRange;
 
-      pwm_configure(Channel, &FanObj->PwmChanCfg);
-      pwm_enable(Channel);
+      IO_REG_PwmConfigure(Channel, &FanObj->PwmChanCfg);
 
-      CFE_EVS_SendEvent (FAN_CONSTRUCTOR_EID, CFE_EVS_EventType_INFORMATION, 
-                         "Fan %d configured on PWM Channel %d BCM Pin %d", 
-                         FanId, Channel, FanObj->PwmBcmId);
+      CFE_EVS_SendEvent (FAN_CONFIG_PWM_EID, CFE_EVS_EventType_INFORMATION, 
+                         "Rig %d fan %d configured on PWM Channel %d BCM Pin %d with range %d, clock divisor %d and %s input", 
+                         Fan->RigIdx, FanIdx, Channel, FanObj->PwmBcmId, Fan->PwmRange, Fan->PwmClkDivisor,
+                         UseFifo ? "FIFO" : "data register");
 
 } /* End ConfigPwm() */
+
+
+/******************************************************************************
+** Function: ConfigSoftPwm
+**
+** Notes:
+**   1. The entry is filled before the count is released so the software
+**      PWM task never reads a partial entry.
+**
+*/
+static void ConfigSoftPwm(FAN_Class_t *Fan, uint8 FanIdx)
+{
+
+      FAN_Struct_t *FanObj = &Fan->Actuator[FanIdx];
+
+      FanObj->PwmChannel = FAN_SOFT_PWM_CHANNEL;
+
+      if (SoftPwmFanCnt >= FAN_SOFT_PWM_MAX_FAN)
+      {
+         CFE_EVS_SendEvent (FAN_SOFT_PWM_EID, CFE_EVS_EventType_ERROR, 
+                            "Rig %d fan %d not configured, all %d software PWM fans are in use", 
+                            Fan->RigIdx, FanIdx, FAN_SOFT_PWM_MAX_FAN);
+         return;
+      }
+      
+      IO_REG_GpioFunc(FanObj->PwmBcmId, OUTPUT);
+      IO_REG_GpioClear(FanObj->PwmBcmId);
+      
+      SoftPwmFan[SoftPwmFanCnt].Fan      = Fan;
+      SoftPwmFan[SoftPwmFanCnt].Actuator = FanObj;
+      __atomic_store_n(&SoftPwmFanCnt, SoftPwmFanCnt + 1, __ATOMIC_RELEASE);
+      Fan->SoftPwmCnt++;
+      
+      CFE_EVS_SendEvent (FAN_CONSTRUCTOR_EID, CFE_EVS_EventType_INFORMATION, 
+                         "Rig %d fan %d configured for software PWM on BCM Pin %d with a %d usec period", 
+                         Fan->RigIdx, FanIdx, FanObj->PwmBcmId, SoftPwmPeriod);
+
+} /* End ConfigSoftPwm() */
+
+
+/******************************************************************************
+** Function: GetPwmChannel
+**
+** Return the hardware PWM channel and the pin's alternate function for BCM
+** pins that are routed to a PWM channel on the 40 pin header. All other pins
+** return FAN_SOFT_PWM_CHANNEL.
+*/
+static int GetPwmChannel(uint8 BcmId, int *AltFunc)
+{
+
+   int Channel = FAN_SOFT_PWM_CHANNEL;
+   
+   switch (BcmId)
+   {
+      case 12:
+         Channel  = PWM_CHANNEL0;
+         *AltFunc = ALT0;
+         break;
+      case 13:
+         Channel  = PWM_CHANNEL1;
+         *AltFunc = ALT0;
+         break;
+      case 18:
+         Channel  = PWM_CHANNEL0;
+         *AltFunc = ALT5;
+         break;
+      case 19:
+         Channel  = PWM_CHANNEL1;
+         *AltFunc = ALT5;
+         break;
+      default:
+         break;
+   }
+   
+   return Channel;
+
+} /* End GetPwmChannel() */
+
+
+/******************************************************************************
+** Function: ParseBcmIdList
+**
+** Parse a comma separated list of BCM pin IDs from a config string and return
+** the number of IDs that were parsed.
+*/
+static uint8 ParseBcmIdList(const char *BcmIdList, uint8 *BcmId, uint8 MaxCnt)
+{
+
+   uint8 Cnt = 0;
+   char  *End;
+   long  Value;
+   
+   while (Cnt < MaxCnt)
+   {
+      
+      Value = strtol(BcmIdList, &End, 10);
+      if (End == BcmIdList)
+      {
+         break;
+      }
+      
+      BcmId[Cnt++] = (uint8)Value;
+      
+      while (*End == ' ' || *End == ',')
+      {
+         End++;
+      }
+      BcmIdList = End;
+      
+   }
+   
+   return Cnt;
+
+} /* End ParseBcmIdList() */
+
+
+/******************************************************************************
+** Function: QuantizePwm
+**
+** Convert a register target to an integer register value. With dithering
+** the previous quantization error is added to the target before rounding
+** and the new error is saved so the fractional part of the target is
+** spread across successive outputs.
+**
+*/
+static uint32 QuantizePwm(float RegTarget, float *DitherErr, bool Dither, uint16 Range)
+{
+
+   float Value = RegTarget;
+   float Output;
+   
+   if (Dither)
+   {
+      Value += *DitherErr;
+   }
+   
+   Output = fminf(fmaxf(roundf(Value), 0.0), (float)Range);
+   
+   /* Bound the error so it can't wind up while the output is saturated */
+   *DitherErr = Dither ? fminf(fmaxf(Value - Output, -1.0), 1.0) : 0.0;
+   
+   return (uint32)Output;
+
+} /* End QuantizePwm() */
+
+
+/******************************************************************************
+** Function: SoftPwmTask
+**
+** Generate a PWM signal on each software PWM fan's GPIO pin. 
+**
+** Notes:
+**   1. All active pins are set at the start of a period and each pin is
+**      cleared when its on-time expires. On-times are sorted so the task
+**      sleeps until each falling edge using absolute times which prevents
+**      drift between periods.
+**   2. The duty cycle uses the same range as the hardware PWM channels so
+**      a command produces the same duty cycle on either type of fan.
+**   3. Dithering is done every period so the task keeps its own 
+**      quantization error for each fan.
+**   4. One task serves every rig. Each fan is scaled with its own rig's
+**      PWM range and dither setting.
+**
+*/
+static void SoftPwmTask(void)
+{
+
+   struct timespec PeriodStart, Edge;
+   uint32 OnTime[FAN_SOFT_PWM_MAX_FAN];
+   uint8  BcmId[FAN_SOFT_PWM_MAX_FAN];
+   float  DitherErr[FAN_SOFT_PWM_MAX_FAN] = { 0.0 };
+   uint8  FanCnt, Cnt, i, j;
+   uint32 Duty, Time;
+   uint8  Pin;
+   uint16 Range;
+   bool   Dither;
+   const FAN_Class_t *Fan;
+   
+   MEM_MON_PaintStack(TBL_SAT_MemTask_SOFT_PWM, 0);
+   
+   clock_gettime(CLOCK_MONOTONIC, &PeriodStart);
+   
+   while (true)
+   {
+      
+      /* Insertion sort the active pins by on-time */
+      Cnt    = 0;
+      FanCnt = __atomic_load_n(&SoftPwmFanCnt, __ATOMIC_ACQUIRE);
+      for (i=0; i < FanCnt; i++)
+      {
+         Fan    = SoftPwmFan[i].Fan;
+         Range  = Fan->PwmRange;
+         Dither = (Fan->Tbl.Data.Pwm.Dither != 0);
+         Duty = QuantizePwm(SoftPwmFan[i].Actuator->RegTarget, &DitherErr[i], Dither, Range);
+         Time = (uint32)(((uint64)Duty * SoftPwmPeriod) / Range);
+         Pin  = SoftPwmFan[i].Actuator->PwmBcmId;
+         if (Time > 0)
+         {
+            IO_REG_GpioSet(Pin);
+         }
+         for (j=Cnt; j > 0 && OnTime[j-1] > Time; j--)
+         {
+            OnTime[j] = OnTime[j-1];
+            BcmId[j]  = BcmId[j-1];
+         }
+         OnTime[j] = Time;
+         BcmId[j]  = Pin;
+         Cnt++;
+      }
+      
+      for (i=0; i < Cnt; i++)
+      {
+         if (OnTime[i] < SoftPwmPeriod)
+         {
+            Edge = PeriodStart;
+            TimespecAddUsec(&Edge, OnTime[i]);
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &Edge, NULL);
+            IO_REG_GpioClear(BcmId[i]);
+         }
+      }
+      
+      TimespecAddUsec(&PeriodStart, SoftPwmPeriod);
+      clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &PeriodStart, NULL);
+      
+   } /* End task loop */
+   
+} /* End SoftPwmTask() */
+
+
+/******************************************************************************
+** Function: TimespecAddUsec
+**
+*/
+static void TimespecAddUsec(struct timespec *Time, uint32 Usec)
+{
+
+   Time->tv_nsec += (long)(Usec % 1000000) * 1000;
+   Time->tv_sec  += Usec / 1000000;
+   if (Time->tv_nsec >= 1000000000L)
+   {
+      Time->tv_nsec -= 1000000000L;
+      Time->tv_sec++;
+   }
+
+} /* End TimespecAddUsec() */
@@ -16,18 +16,36 @@
 **    Define GPIO Controller class
 **
 **  Notes:
-**    1. Both fans are contained in a single object so the singleton
-**       design pattern can be used. The other option is to have one
-**       object for each fan which means one set of functions and
-**       separate data structures declared for each fan. This would
-**       require a pointer to be passed as the first parameter in each
-**       method. Since the fans are simple this seemed like overkill. 
-**       Also the filename was kept singular.
+**    1. All of a rig's fans are contained in a single object and each rig
+**       owns one object that is passed as the first parameter to each
+**       function. The filename was kept singular.
 **    2. Noctua NF-A4x10 5V PWM, https://noctua.at/en/nf-a4x10-5v-pwm
-**    3. The original design included reading the fan tachometer. This
-**       hardware wiring has been removed, but there are still some
-**       software variables that have not been removed in case it is
-**       added back in. One challenge is configuring interrupts.
+**    3. Each fan's tachometer is measured by the TACH object (see tach.h)
+**       using the fan's tach BCM pin. FAN_ReadTach() must be called once
+**       per control cycle to update the measured RPM.
+**    4. The number of fans and their BCM pins are defined in the rig
+**       definition file. A fan assigned to a BCM pin with a PWM alternate
+**       function uses a hardware PWM channel. All other fans, including a
+**       fan on a channel that is already in use by any rig, use software
+**       PWM. One child task generates software PWM for every rig's fans.
+**    5. Controllers can either command each fan's PWM directly or supply
+**       an effort vector that is mapped to all fans through the fan
+**       table's allocation matrix. In both cases FAN_WritePwm() must be
+**       called once per control cycle to write the commands to the
+**       hardware.
+**    6. Commands are in FAN_MIN_PWM..FAN_MAX_PWM units and are scaled to the
+**       fan table's PWM range when they're written. When the range can't
+**       represent a command exactly an optional first order sigma-delta
+**       stage dithers the output between adjacent register values so the
+**       average duty cycle matches the command. Hardware channels dither
+**       on each FAN_WritePwm() and software PWM dithers every PWM period.
+**    7. Precomputed profiles can be played on the hardware PWM channels
+**       through the PWM FIFO (see pwm_fifo.h). The FIFO feeds both channels
+**       so only a rig that owns every hardware channel in use can play a
+**       profile. While a profile is playing
+**       FAN_WritePwm() doesn't write the hardware channels and fan table
+**       PWM parameter changes are deferred until playback ends. Software
+**       PWM fans continue to use their computed commands.
 **    TODO - Consider adding a map command if it fails during init.
 **
 */
@@ -40,7 +58,10 @@
 */
 
 #include "app_cfg.h"
-#include "pwm.h"
+#include "io_reg.h"
+#include "fan_tbl.h"
+#include "pwm_fifo.h"
+#include "tach.h"
 
 /***********************/
 /** Macro Definitions **/
@@ -50,6 +71,12 @@
 #define FAN_MAX_PWM    2047
 #define FAN_PWM_RANGE  (FAN_MAX_PWM - FAN_MIN_PWM)
 
+#define FAN_SOFT_PWM_CHANNEL  (-1)  /* Fan isn't using a hardware PWM channel */
+#define FAN_SOFT_PWM_MAX_FAN    16  /* Software PWM fans across all rigs */
+
+#define FAN_DEF_PWM_RANGE        1023  /* Used until a valid fan table is loaded */
+#define FAN_DEF_PWM_CLK_DIVISOR    19
+
 /*
 ** Event Message IDs
 */
@@ -57,6 +84,9 @@
 #define FAN_CONSTRUCTOR_EID       (FAN_BASE_EID + 0)
 #define FAN_OVERRIDE_PWM_CMD_EID  (FAN_BASE_EID + 1)
 #define FAN_SET_PWM_EID           (FAN_BASE_EID + 2)
+#define FAN_SOFT_PWM_EID          (FAN_BASE_EID + 3)
+#define FAN_CONFIG_PWM_EID        (FAN_BASE_EID + 4)
+#define FAN_PWM_PLAYBACK_EID      (FAN_BASE_EID + 5)
 
 
 /**********************/
@@ -69,15 +99,41 @@ typedef struct
 
    uint8  PwmBcmId;
    uint8  TachBcmId;
+   int8   PwmChannel;   /* PWM_CHANNELx or FAN_SOFT_PWM_CHANNEL */
    
    uint16 PwmCmd;
+   uint16 PwmOutput;    /* Last register value written, either scaled PwmCmd or OverridePwmCmd */
    uint16 PulsePerSec;
+   float  Rpm;          /* Measured from the last tach period, zero when stopped */
    uint16 OverridePwmCmd;
    
+   float  PwmTarget;    /* Unrounded PwmCmd */
+   float  RegTarget;    /* PwmTarget scaled to register counts, read by software PWM */
+   float  DitherErr;    /* Sigma-delta quantization error */
+   
    pwm_channel_config PwmChanCfg;
    
 } FAN_Struct_t;
 
+/******************************************************************************
+** Constructor configuration
+*/
+
+typedef struct
+{
+
+   uint8       RigIdx;
+   uint8       FanCnt;
+   const char *PwmBcmId;     /* Comma separated BCM IDs, one per fan in fan order */
+   const char *TachBcmId;
+   const char *TblFilename;  /* Default fan table */
+   bool        GpioMapped;
+   bool        PwmMapped;
+   PWM_FIFO_Class_t *PwmFifo;   /* Shared by all rigs, NULL if not constructed */
+
+} FAN_Config_t;
+
+
 /******************************************************************************
 ** FAN_Class
 */
@@ -89,14 +145,29 @@ typedef struct
    ** Class State Data
    */
    
+   uint8   RigIdx;
    bool    PwmMapped;   
    bool    OverridePwmCmdEnabled;
    uint32  OverridePwmCmdCount;
 
-   FAN_Struct_t  A;
-   FAN_Struct_t  B;
+   uint8          FanCnt;
+   FAN_Struct_t   Actuator[FAN_TBL_MAX_FAN];
+   
+   uint16         PwmRange;       /* Active PWM parameters */
+   uint16         PwmClkDivisor;
    
+   FAN_TBL_Class_t  Tbl;
 
+   uint8            SoftPwmCnt;
+   uint8            TachLine;           /* First TACH line, TACH_MAX_LINE if none */
+   
+   /*
+   ** PWM FIFO profile playback
+   */
+   
+   uint8             PwmFifoChannelCnt;  /* Hardware PWM channels owned by this rig */
+   bool              PwmFifoInUse;       /* Hardware channels are in FIFO mode */
+   PWM_FIFO_Class_t *PwmFifo;
    
 } FAN_Class_t;
 
@@ -114,18 +185,50 @@ typedef struct
 **
 ** Notes:
 **   1. This must be called prior to any other function.
+**   2. The TACH object must be constructed before any FAN object and the
+**      fan table is always loaded so the fan count is validated whether or
+**      not the GPIO was successfully mapped.
 **
 */
-void FAN_Constructor(FAN_Class_t *FanPtr, INITBL_Class_t *IniTbl);
+void FAN_Constructor(FAN_Class_t *Fan, INITBL_Class_t *IniTbl, const FAN_Config_t *Config);
 
 
 /******************************************************************************
-** Function: FAN_OverridePwmCmd
+** Function: FAN_OverridePwm
 **
 ** Override the computed PWM with a value that is not limited. A duration of
-** zero will stop an override.
+** zero will stop an override. Only fans A and B (the first two fans) can be
+** overridden, any additional fans continue to use their computed commands.
+*/
+bool FAN_OverridePwm(FAN_Class_t *Fan, uint32 Duration, uint16 FanAPwm, uint16 FanBPwm);
+
+
+/******************************************************************************
+** Function: FAN_StartPwmPlayback
+**
+** Load a PWM profile file and play it on the hardware PWM channels. Profile
+** values are in FAN_MIN_PWM..FAN_MAX_PWM units with one column per hardware
+** channel in channel order. Called by the rig's worker.
+*/
+bool FAN_StartPwmPlayback(FAN_Class_t *Fan, const char *Filename, uint16 RepeatCnt);
+
+
+/******************************************************************************
+** Function: FAN_StopPwmPlayback
+**
+** Stop a PWM profile playback. The hardware channels return to the computed
+** PWM commands on the next FAN_WritePwm(). Called by the rig's worker.
+*/
+bool FAN_StopPwmPlayback(FAN_Class_t *Fan);
+
+
+/******************************************************************************
+** Function: FAN_ReadTach
+**
+** Update each fan's measured RPM and pulse rate from the tach capture
+** counters. Call once per control cycle.
 */
-bool FAN_OverridePwmCmd(void *DataObjPtr, const CFE_MSG_Message_t *MsgPtr);
+void FAN_ReadTach(FAN_Class_t *Fan);
 
 
 /******************************************************************************
@@ -138,15 +241,50 @@ bool FAN_OverridePwmCmd(void *DataObjPtr, const CFE_MSG_Message_t *MsgPtr);
 **      change the functional behavior should be reset.
 **
 */
-void FAN_ResetStatus(void);
+void FAN_ResetStatus(FAN_Class_t *Fan);
+
+
+/******************************************************************************
+** Function: FAN_SetEffort
+**
+** Map an effort vector of FAN_TBL_AXIS_CNT elements to every fan's PWM
+** command using the fan table's allocation matrix. Return value indicates
+** whether any fan's PWM value was limited.
+**
+** Notes:
+**   1. Fans can't reverse so negative allocations are limited to zero and
+**      are not reported as limited.
+**
+*/
+bool FAN_SetEffort(FAN_Class_t *Fan, const float *Effort);
 
 
 /******************************************************************************
 ** Function: FAN_SetPwm
 **
-** Return value indicates whether the PWM value was limited.
+** Set a single fan's PWM command. FanIdx is zero based. Return value
+** indicates whether the PWM value was limited.
+*/
+bool FAN_SetPwm(FAN_Class_t *Fan, uint8 FanIdx, uint16 Pwm);
+
+
+/******************************************************************************
+** Function: FAN_ValidPwmPlayback
+**
+** Return true if the rig's fans can play a PWM profile. The rig must own
+** every hardware PWM channel. Safe to call from the app's main task.
+*/
+bool FAN_ValidPwmPlayback(const FAN_Class_t *Fan);
+
+
+/******************************************************************************
+** Function: FAN_WritePwm
+**
+** Write each fan's PWM command, or override command, to the hardware. This
+** must be called once per control cycle because it also manages the
+** override duration and applies fan table PWM parameter changes.
 */
-bool FAN_SetPwm(TBL_SAT_FanId_Enum_t Fan, uint16 Pwm);
+void FAN_WritePwm(FAN_Class_t *Fan);
 
 
 #endif /* _fan_ */
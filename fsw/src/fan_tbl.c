@@ -0,0 +1,316 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Implement the fan allocation table
+**
+**  Notes:
+**    1. The static "TblData" serves as a table load buffer. Table dump data is
+**       read directly from table owner's table storage, the staged load if
+**       it hasn't been activated yet.
+**    2. The PWM parameter JSON objects are first followed by the allocation
+**       objects ordered by fan and then by axis. This makes the first
+**       PWM_JSON_OBJ_CNT + FanCnt*FAN_TBL_AXIS_CNT objects the ones that are
+**       required for an initial load.
+**    3. LoadTbl identifies the instance being loaded while CJSON calls
+**       LoadJsonData(). It's only valid during FAN_TBL_Load().
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+#include "fan_tbl.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define FAN_ALLOC_JSON_OBJ(Fan, Axis, Key) \
+   { &TblData.Alloc[Axis][Fan], sizeof(TblData.Alloc[Axis][Fan]), false, JSONNumber, true, \
+     { "fan[" #Fan "]." Key, (sizeof("fan[" #Fan "]." Key)-1)} }
+
+#define FAN_JSON_OBJS(Fan) \
+   FAN_ALLOC_JSON_OBJ(Fan, FAN_TBL_AXIS_TORQUE_Z, "torque-z"), \
+   FAN_ALLOC_JSON_OBJ(Fan, FAN_TBL_AXIS_FORCE_X,  "force-x"),  \
+   FAN_ALLOC_JSON_OBJ(Fan, FAN_TBL_AXIS_FORCE_Y,  "force-y")
+
+#define PWM_JSON_OBJ_CNT  3
+
+
+/************************************/
+/** Local File Function Prototypes **/
+/************************************/
+
+static bool LoadJsonData(size_t JsonFileLen);
+
+
+/**********************/
+/** Global File Data **/
+/**********************/
+
+static FAN_TBL_Class_t *LoadTbl = NULL;
+
+static FAN_TBL_Data_t TblData; /* Working buffer for loads */
+static char JsonBuf[FAN_TBL_JSON_FILE_MAX_CHAR];
+
+static CJSON_Obj_t JsonTblObjs[] = {
+
+   /* Table Data Address        Table Data Length                 Updated,  Data Type,  Float,  core-json query string,  length of query string(exclude '\0') */
+   
+   { &TblData.Pwm.Range,        sizeof(TblData.Pwm.Range),        false,    JSONNumber, false,  { "pwm-range",           (sizeof("pwm-range")-1)}           },
+   { &TblData.Pwm.ClkDivisor,   sizeof(TblData.Pwm.ClkDivisor),   false,    JSONNumber, false,  { "pwm-clk-divisor",     (sizeof("pwm-clk-divisor")-1)}     },
+   { &TblData.Pwm.Dither,       sizeof(TblData.Pwm.Dither),       false,    JSONNumber, false,  { "pwm-dither",          (sizeof("pwm-dither")-1)}          },
+
+   /* One entry per fan, must be kept in sync with FAN_TBL_MAX_FAN */
+   FAN_JSON_OBJS(0),
+   FAN_JSON_OBJS(1),
+   FAN_JSON_OBJS(2),
+   FAN_JSON_OBJS(3),
+   FAN_JSON_OBJS(4),
+   FAN_JSON_OBJS(5),
+   FAN_JSON_OBJS(6),
+   FAN_JSON_OBJS(7)
+
+};
+
+static const char *AxisKey[FAN_TBL_AXIS_CNT] = { "torque-z", "force-x", "force-y" };
+
+
+/******************************************************************************
+** Function: FAN_TBL_Constructor
+**
+** Notes:
+**    1. This must be called prior to any other functions
+**
+*/
+void FAN_TBL_Constructor(FAN_TBL_Class_t *FanTbl, uint8 FanCnt)
+{
+
+   CFE_PSP_MemSet(FanTbl, 0, sizeof(FAN_TBL_Class_t));
+
+   FanTbl->FanCnt     = FanCnt;
+   FanTbl->JsonObjCnt = (sizeof(JsonTblObjs)/sizeof(CJSON_Obj_t));
+
+} /* End FAN_TBL_Constructor() */
+
+
+/******************************************************************************
+** Function: FAN_TBL_Activate
+**
+** Notes:
+**  1. The acquire load pairs with the release store in LoadJsonData() so the
+**     staged data is complete when ActivatePending is seen.
+*/
+bool FAN_TBL_Activate(FAN_TBL_Class_t *FanTbl)
+{
+
+   if (!__atomic_load_n(&FanTbl->ActivatePending, __ATOMIC_ACQUIRE))
+   {
+      return false;
+   }
+
+   memcpy(&FanTbl->Data, &FanTbl->LoadData, sizeof(FAN_TBL_Data_t));
+
+   __atomic_store_n(&FanTbl->ActivatePending, false, __ATOMIC_RELEASE);
+
+   return true;
+
+} /* End FAN_TBL_Activate() */
+
+
+/******************************************************************************
+** Function: FAN_TBL_Dump
+**
+** Notes:
+**  1. Called by the owner's TBLMGR_DumpTblFuncPtr_t callback.
+**  2. Can assume valid table filename because this is a callback from
+**     the app framework table manager that has verified the file.
+**  3. File is formatted so it can be used as a load file. It does not follow
+**     the cFE table file format.
+**  4. Only the configured fans are dumped.
+*/
+bool FAN_TBL_Dump(FAN_TBL_Class_t *FanTbl, osal_id_t FileHandle)
+{
+
+   const FAN_TBL_Data_t *Data = __atomic_load_n(&FanTbl->ActivatePending, __ATOMIC_ACQUIRE) ?
+                                &FanTbl->LoadData : &FanTbl->Data;
+   char  DumpRecord[256];
+   uint8 Fan, Axis;
+
+   sprintf(DumpRecord,"   \"pwm-range\": %d,\n", Data->Pwm.Range);
+   OS_write(FileHandle, DumpRecord, strlen(DumpRecord));
+
+   sprintf(DumpRecord,"   \"pwm-clk-divisor\": %d,\n", Data->Pwm.ClkDivisor);
+   OS_write(FileHandle, DumpRecord, strlen(DumpRecord));
+
+   sprintf(DumpRecord,"   \"pwm-dither\": %d,\n", Data->Pwm.Dither);
+   OS_write(FileHandle, DumpRecord, strlen(DumpRecord));
+
+   sprintf(DumpRecord,"   \"fan\": [\n");
+   OS_write(FileHandle, DumpRecord, strlen(DumpRecord));
+
+   for (Fan=0; Fan < FanTbl->FanCnt; Fan++)
+   {
+
+      sprintf(DumpRecord,"      {");
+      OS_write(FileHandle, DumpRecord, strlen(DumpRecord));
+
+      for (Axis=0; Axis < FAN_TBL_AXIS_CNT; Axis++)
+      {
+         sprintf(DumpRecord,"\"%s\": %0.6f%s", AxisKey[Axis], Data->Alloc[Axis][Fan],
+                 (Axis < (FAN_TBL_AXIS_CNT-1)) ? ", " : "");
+         OS_write(FileHandle, DumpRecord, strlen(DumpRecord));
+      }
+
+      sprintf(DumpRecord,"}%s\n", (Fan < (FanTbl->FanCnt-1)) ? "," : "");
+      OS_write(FileHandle, DumpRecord, strlen(DumpRecord));
+
+   }
+
+   sprintf(DumpRecord,"   ]\n}\n");
+   OS_write(FileHandle, DumpRecord, strlen(DumpRecord));
+
+   return true;
+
+} /* End of FAN_TBL_Dump() */
+
+
+/******************************************************************************
+** Function: FAN_TBL_Load
+**
+** Notes:
+**  1. Must only be called from the app's main task because TblData, JsonBuf
+**     and LoadTbl are shared by all instances.
+**  2. The staging buffer belongs to the worker until the previous load has
+**     been activated so a new load is rejected in the meantime.
+*/
+bool FAN_TBL_Load(FAN_TBL_Class_t *FanTbl, APP_C_FW_TblLoadOptions_Enum_t LoadType,
+                  const char *Filename)
+{
+
+   bool  RetStatus = false;
+
+   if (__atomic_load_n(&FanTbl->ActivatePending, __ATOMIC_ACQUIRE))
+   {
+      CFE_EVS_SendEvent(FAN_TBL_LOAD_EID, CFE_EVS_EventType_ERROR,
+                        "Fan table load rejected, the previous load hasn't been activated");
+      return false;
+   }
+
+   LoadTbl = FanTbl;
+
+   if (CJSON_ProcessFile(Filename, JsonBuf, FAN_TBL_JSON_FILE_MAX_CHAR, LoadJsonData))
+   {
+      FanTbl->Loaded = true;
+      RetStatus = true;
+   }
+
+   LoadTbl = NULL;
+
+   return RetStatus;
+
+} /* End FAN_TBL_Load() */
+
+
+/******************************************************************************
+** Function: FAN_TBL_ResetStatus
+**
+*/
+void FAN_TBL_ResetStatus(FAN_TBL_Class_t *FanTbl)
+{
+
+   FanTbl->LastLoadCnt = 0;
+
+} /* End FAN_TBL_ResetStatus() */
+
+
+/******************************************************************************
+** Function: LoadJsonData
+**
+** Notes:
+**  1. An initial load must define the PWM parameters and all axes for each
+**     configured fan. After that any subset of the table can be applied on
+**     top of the active data.
+**  2. The release store publishes the staged load to FAN_TBL_Activate().
+*/
+static bool LoadJsonData(size_t JsonFileLen)
+{
+
+   bool      RetStatus = false;
+   size_t    ObjLoadCnt;
+   size_t    ReqObjCnt = PWM_JSON_OBJ_CNT + (size_t)LoadTbl->FanCnt * FAN_TBL_AXIS_CNT;
+   size_t    Obj;
+   bool      ReqObjLoaded = true;
+
+   LoadTbl->JsonFileLen = JsonFileLen;
+
+   /*
+   ** 1. Copy table owner data into local table buffer
+   ** 2. Process JSON file which updates local table buffer with JSON supplied values
+   ** 3. If valid, stage local buffer for activation
+   */
+
+   memcpy(&TblData, &LoadTbl->Data, sizeof(FAN_TBL_Data_t));
+
+   for (Obj=0; Obj < LoadTbl->JsonObjCnt; Obj++)
+   {
+      JsonTblObjs[Obj].Updated = false;
+   }
+
+   ObjLoadCnt = CJSON_LoadObjArray(JsonTblObjs, LoadTbl->JsonObjCnt, JsonBuf, LoadTbl->JsonFileLen);
+
+   for (Obj=0; Obj < ReqObjCnt; Obj++)
+   {
+      ReqObjLoaded &= JsonTblObjs[Obj].Updated;
+   }
+
+   if (!LoadTbl->Loaded && !ReqObjLoaded)
+   {
+
+      CFE_EVS_SendEvent(FAN_TBL_LOAD_EID, CFE_EVS_EventType_ERROR,
+                        "Table has never been loaded and new table doesn't define the PWM parameters and all %d axes for each of the %d configured fans",
+                        FAN_TBL_AXIS_CNT, LoadTbl->FanCnt);
+
+   }
+   else if (TblData.Pwm.Range == 0 ||
+            TblData.Pwm.ClkDivisor < FAN_TBL_MIN_PWM_CLK_DIVISOR ||
+            TblData.Pwm.ClkDivisor > FAN_TBL_MAX_PWM_CLK_DIVISOR)
+   {
+
+      CFE_EVS_SendEvent(FAN_TBL_LOAD_EID, CFE_EVS_EventType_ERROR,
+                        "Invalid PWM range %d or clock divisor %d. Range must be non-zero and the divisor must be in [%d,%d]",
+                        TblData.Pwm.Range, TblData.Pwm.ClkDivisor,
+                        FAN_TBL_MIN_PWM_CLK_DIVISOR, FAN_TBL_MAX_PWM_CLK_DIVISOR);
+
+   }
+   else
+   {
+
+      memcpy(&LoadTbl->LoadData, &TblData, sizeof(FAN_TBL_Data_t));
+      __atomic_store_n(&LoadTbl->ActivatePending, true, __ATOMIC_RELEASE);
+      LoadTbl->LastLoadCnt = ObjLoadCnt;
+      CFE_EVS_SendEvent(FAN_TBL_LOAD_EID, CFE_EVS_EventType_DEBUG,
+                        "Successfully loaded %d JSON objects",
+                        (unsigned int)ObjLoadCnt);
+      RetStatus = true;
+
+   }
+
+   return RetStatus;
+
+} /* End LoadJsonData() */
@@ -0,0 +1,219 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Manage the fan allocation table
+**
+**  Notes:
+**    1. Each rig's FAN object owns a table object and passes it to every
+**       function. Table loads are only performed by the app's main task so
+**       the JSON file buffer and the load working buffer are shared by all
+**       instances.
+**    2. The allocation (mixing) matrix maps a desired effort vector into
+**       per-fan PWM commands. It is stored by axis so each axis column is
+**       contiguous across all fans which lets FAN_SetEffort() compute every
+**       fan's command in one pass.
+**    3. The number of fans and their GPIO pin assignments are defined in
+**       the rig definition file. The table only needs to define entries for the
+**       configured fans, unused rows remain zero.
+**    4. The PWM range and clock divisor apply to both hardware PWM channels
+**       and the range also applies to software PWM. The PWM frequency is
+**       the 19.2MHz PWM clock divided by (clock divisor * range).
+**    5. The rig worker mixes with Data while the main task loads. A load is
+**       written to LoadData and the worker copies it in with
+**       FAN_TBL_Activate() between control cycles. A new load is rejected
+**       until the previous one has been activated.
+**
+*/
+
+#ifndef _fan_tbl_
+#define _fan_tbl_
+
+/*
+** Includes
+*/
+
+#include "app_cfg.h"
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define FAN_TBL_MAX_FAN  8
+
+#define FAN_TBL_MIN_PWM_CLK_DIVISOR     2
+#define FAN_TBL_MAX_PWM_CLK_DIVISOR  4095  /* 12-bit clock manager integer divisor */
+
+/*
+** Event Message IDs
+*/
+
+#define FAN_TBL_DUMP_EID  (FAN_TBL_BASE_EID + 0)
+#define FAN_TBL_LOAD_EID  (FAN_TBL_BASE_EID + 1)
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+/*
+** Effort vector axes. Torque is about the table's spin axis and the forces
+** are in the table plane for rigs that are free to translate.
+*/
+typedef enum
+{
+
+   FAN_TBL_AXIS_TORQUE_Z = 0,
+   FAN_TBL_AXIS_FORCE_X  = 1,
+   FAN_TBL_AXIS_FORCE_Y  = 2,
+   FAN_TBL_AXIS_CNT      = 3
+
+} FAN_TBL_Axis_t;
+
+
+/******************************************************************************
+** Table - Local table copy used for table loads
+**
+*/
+
+typedef struct
+{
+
+   uint16  Range;        /* PWM counts per period */
+   uint16  ClkDivisor;
+   uint16  Dither;       /* Non-zero enables sigma-delta dithering */
+
+} FAN_TBL_Pwm_t;
+
+
+typedef struct
+{
+
+   FAN_TBL_Pwm_t  Pwm;
+   float          Alloc[FAN_TBL_AXIS_CNT][FAN_TBL_MAX_FAN];
+
+} FAN_TBL_Data_t;
+
+
+/******************************************************************************
+** Class
+*/
+
+typedef struct
+{
+
+   /*
+   ** Table Data
+   */
+
+   FAN_TBL_Data_t Data;
+
+   /*
+   ** Staged load, owned by the main task until ActivatePending is set
+   */
+
+   FAN_TBL_Data_t LoadData;
+   bool           ActivatePending;  /* Atomic */
+
+   uint8   FanCnt;       /* Number of fans that must be defined in a table */
+
+   /*
+   ** Standard CJSON table data
+   */
+
+   bool    Loaded;       /* Has entire table been loaded? */
+   uint16  LastLoadCnt;
+
+   size_t  JsonObjCnt;
+   size_t  JsonFileLen;
+
+} FAN_TBL_Class_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: FAN_TBL_Constructor
+**
+** Initialize the fan allocation table object.
+**
+** Notes:
+**   1. The table values are not populated. This is done by the owner's
+**      first call to FAN_TBL_Load().
+**   2. FanCnt is the number of fans configured for the rig. An initial
+**      table load must define the PWM parameters and every axis for each of
+**      these fans.
+**
+*/
+void FAN_TBL_Constructor(FAN_TBL_Class_t *FanTbl, uint8 FanCnt);
+
+
+/******************************************************************************
+** Function: FAN_TBL_Activate
+**
+** Copy a staged table load into the active table data. Returns true if a
+** load was activated.
+**
+** Notes:
+**  1. Must be called by the rig worker between control cycles and by the
+**     owner's constructor after loading its default table.
+**
+*/
+bool FAN_TBL_Activate(FAN_TBL_Class_t *FanTbl);
+
+
+/******************************************************************************
+** Function: FAN_TBL_Dump
+**
+** Write the table data from memory to a JSON file.
+**
+** Notes:
+**  1. Called by the owner's TBLMGR_DumpTblFuncPtr_t callback.
+**
+*/
+bool FAN_TBL_Dump(FAN_TBL_Class_t *FanTbl, osal_id_t FileHandle);
+
+
+/******************************************************************************
+** Function: FAN_TBL_Load
+**
+** Copy the table data from a JSON file to the staging buffer.
+** FAN_TBL_Activate() makes the load active.
+**
+** Notes:
+**  1. Called by the owner's TBLMGR_LoadTblFuncPtr_t callback and by the
+**     owner's constructor to load its default table.
+**  2. Must only be called from the app's main task because the JSON file
+**     buffer and the load working buffer are shared by all instances.
+**
+*/
+bool FAN_TBL_Load(FAN_TBL_Class_t *FanTbl, APP_C_FW_TblLoadOptions_Enum_t LoadType,
+                  const char *Filename);
+
+
+/******************************************************************************
+** Function: FAN_TBL_ResetStatus
+**
+** Reset counters and status flags to a known reset state.  The behavior of
+** the table manager should not be impacted. The intent is to clear counters
+** and flags to a known default state for telemetry.
+**
+*/
+void FAN_TBL_ResetStatus(FAN_TBL_Class_t *FanTbl);
+
+
+#endif /* _fan_tbl_ */
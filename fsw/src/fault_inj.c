@@ -0,0 +1,446 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Implement the sensor message fault injection class
+**
+**  Notes:
+**    1. See fault_inj.h for details. PendingSet is the only field shared
+**       by the main task and the worker so it's accessed atomically. The
+**       main task only writes Pending while PendingSet is false.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+#include "fault_inj.h"
+
+
+/************************************/
+/** Local File Function Prototypes **/
+/************************************/
+
+static void   ApplyPending(FAULT_INJ_Class_t *FaultInj);
+static bool   Chance(FAULT_INJ_Class_t *FaultInj, uint8 Pct);
+static FAULT_INJ_Held_t *HoldMsg(FAULT_INJ_Class_t *FaultInj, const CFE_MSG_Message_t *MsgPtr,
+                                 size_t MsgSize, uint64 ReleaseMs);
+static uint32 Rand(FAULT_INJ_Class_t *FaultInj);
+static void   ReleaseWaiting(FAULT_INJ_Class_t *FaultInj, uint64 ReleaseMs);
+static void   Spike(FAULT_INJ_Class_t *FaultInj, FAULT_INJ_Held_t *Held);
+
+
+/******************************************************************************
+** Function: FAULT_INJ_Constructor
+**
+*/
+void FAULT_INJ_Constructor(FAULT_INJ_Class_t *FaultInj, uint8 RigIdx)
+{
+
+   memset(FaultInj, 0, sizeof(FAULT_INJ_Class_t));
+
+   FaultInj->RigIdx = RigIdx;
+
+} /* End FAULT_INJ_Constructor() */
+
+
+/******************************************************************************
+** Function: FAULT_INJ_Configure
+**
+*/
+bool FAULT_INJ_Configure(FAULT_INJ_Class_t *FaultInj, const FAULT_INJ_Config_t *Config)
+{
+
+   if (__atomic_load_n(&FaultInj->PendingSet, __ATOMIC_ACQUIRE))
+   {
+      CFE_EVS_SendEvent(FAULT_INJ_CMD_EID, CFE_EVS_EventType_ERROR,
+                        "Set sensor fault command rejected, rig %d's previous configuration hasn't been applied",
+                        FaultInj->RigIdx);
+      return false;
+   }
+
+   if (Config->DropPct > 100 || Config->DupPct > 100 || Config->ReorderPct > 100 || Config->SpikePct > 100)
+   {
+      CFE_EVS_SendEvent(FAULT_INJ_CMD_EID, CFE_EVS_EventType_ERROR,
+                        "Set sensor fault command rejected, percentages must be <= 100. Drop %d, dup %d, reorder %d, spike %d",
+                        Config->DropPct, Config->DupPct, Config->ReorderPct, Config->SpikePct);
+      return false;
+   }
+
+   FaultInj->Pending = *Config;
+   __atomic_store_n(&FaultInj->PendingSet, true, __ATOMIC_RELEASE);
+
+   CFE_EVS_SendEvent(FAULT_INJ_CMD_EID, CFE_EVS_EventType_INFORMATION,
+                     "Rig %d sensor fault posted: delay %d+%d ms, drop %d%% x%d, dup %d%%, reorder %d%%, spike %d%% (%.3f rad/s, %u lux)",
+                     FaultInj->RigIdx, Config->DelayMs, Config->JitterMs, Config->DropPct, Config->DropBurst,
+                     Config->DupPct, Config->ReorderPct, Config->SpikePct, Config->SpikeRate,
+                     (unsigned int)Config->SpikeLux);
+
+   return true;
+
+} /* End FAULT_INJ_Configure() */
+
+
+/******************************************************************************
+** Function: FAULT_INJ_Input
+**
+** Notes:
+**   1. A message that arrives while earlier messages are waiting to be
+**      reordered releases them after itself, even when it's dropped.
+**
+*/
+bool FAULT_INJ_Input(FAULT_INJ_Class_t *FaultInj, const CFE_MSG_Message_t *MsgPtr, uint64 NowMs)
+{
+
+   const FAULT_INJ_Config_t *Config = &FaultInj->Config;
+   FAULT_INJ_Held_t *Held;
+   FAULT_INJ_Held_t *Dup;
+   size_t  MsgSize = 0;
+   uint32  DelayMs;
+   uint64  ReleaseMs;
+
+   ApplyPending(FaultInj);
+
+   if (!FaultInj->Enabled)
+   {
+      return true;
+   }
+
+   FaultInj->InCnt++;
+   CFE_MSG_GetSize(MsgPtr, &MsgSize);
+
+   if (FaultInj->DropRemaining > 0)
+   {
+      FaultInj->DropRemaining--;
+      FaultInj->DropCnt++;
+      ReleaseWaiting(FaultInj, NowMs);
+   }
+   else if (Chance(FaultInj, Config->DropPct))
+   {
+      FaultInj->DropRemaining = (Config->DropBurst > 1) ? (Config->DropBurst - 1) : 0;
+      FaultInj->DropCnt++;
+      ReleaseWaiting(FaultInj, NowMs);
+   }
+   else
+   {
+
+      DelayMs = Config->DelayMs;
+      if (Config->JitterMs > 0)
+      {
+         DelayMs += Rand(FaultInj) % ((uint32)Config->JitterMs + 1);
+      }
+      if (DelayMs > FaultInj->MaxDelayMs)
+      {
+         FaultInj->MaxDelayMs = (uint16)((DelayMs > 0xFFFF) ? 0xFFFF : DelayMs);
+      }
+      ReleaseMs = NowMs + DelayMs;
+
+      Held = HoldMsg(FaultInj, MsgPtr, MsgSize, ReleaseMs);
+      ReleaseWaiting(FaultInj, ReleaseMs);
+      if (Held != NULL)
+      {
+
+         if (Chance(FaultInj, Config->SpikePct))
+         {
+            Spike(FaultInj, Held);
+         }
+
+         if (Chance(FaultInj, Config->DupPct))
+         {
+            Dup = HoldMsg(FaultInj, CFE_MSG_PTR(Held->Msg.TelemetryHeader), MsgSize, ReleaseMs);
+            if (Dup != NULL)
+            {
+               FaultInj->DupCnt++;
+            }
+         }
+
+         if (Chance(FaultInj, Config->ReorderPct))
+         {
+            Held->WaitForNext = true;
+            FaultInj->ReorderCnt++;
+         }
+
+      } /* End if held */
+
+   } /* End if not dropped */
+
+   return false;
+
+} /* End FAULT_INJ_Input() */
+
+
+/******************************************************************************
+** Function: FAULT_INJ_NextReleaseMs
+**
+*/
+uint64 FAULT_INJ_NextReleaseMs(const FAULT_INJ_Class_t *FaultInj)
+{
+
+   uint64 NextMs = UINT64_MAX;
+   uint8  i;
+
+   for (i=0; i < FAULT_INJ_MAX_HELD; i++)
+   {
+      if (FaultInj->Held[i].InUse && !FaultInj->Held[i].WaitForNext &&
+          FaultInj->Held[i].ReleaseMs < NextMs)
+      {
+         NextMs = FaultInj->Held[i].ReleaseMs;
+      }
+   }
+
+   return NextMs;
+
+} /* End FAULT_INJ_NextReleaseMs() */
+
+
+/******************************************************************************
+** Function: FAULT_INJ_Output
+**
+** Notes:
+**   1. The returned slot is freed but its contents aren't overwritten until
+**      the next FAULT_INJ_Input() call.
+**
+*/
+const CFE_MSG_Message_t *FAULT_INJ_Output(FAULT_INJ_Class_t *FaultInj, uint64 NowMs)
+{
+
+   FAULT_INJ_Held_t *Next = NULL;
+   FAULT_INJ_Held_t *Held;
+   uint8 i;
+
+   ApplyPending(FaultInj);
+
+   if (FaultInj->HeldCnt == 0)
+   {
+      return NULL;
+   }
+
+   for (i=0; i < FAULT_INJ_MAX_HELD; i++)
+   {
+
+      Held = &FaultInj->Held[i];
+
+      if (!FaultInj->Enabled)
+      {
+         Held->WaitForNext = false;
+         Held->ReleaseMs   = NowMs;
+      }
+
+      if (Held->InUse && !Held->WaitForNext && Held->ReleaseMs <= NowMs)
+      {
+         if (Next == NULL || Held->ReleaseMs < Next->ReleaseMs ||
+             (Held->ReleaseMs == Next->ReleaseMs && (int32)(Held->Order - Next->Order) < 0))
+         {
+            Next = Held;
+         }
+      }
+
+   } /* End held loop */
+
+   if (Next == NULL)
+   {
+      return NULL;
+   }
+
+   Next->InUse = false;
+   FaultInj->HeldCnt--;
+
+   return CFE_MSG_PTR(Next->Msg.TelemetryHeader);
+
+} /* End FAULT_INJ_Output() */
+
+
+/******************************************************************************
+** Function: FAULT_INJ_ResetStatus
+**
+*/
+void FAULT_INJ_ResetStatus(FAULT_INJ_Class_t *FaultInj)
+{
+
+   FaultInj->InCnt       = 0;
+   FaultInj->DropCnt     = 0;
+   FaultInj->DupCnt      = 0;
+   FaultInj->ReorderCnt  = 0;
+   FaultInj->SpikeCnt    = 0;
+   FaultInj->OverflowCnt = 0;
+   FaultInj->MaxDelayMs  = 0;
+
+} /* End FAULT_INJ_ResetStatus() */
+
+
+/******************************************************************************
+** Function: ApplyPending
+**
+** Apply a configuration posted by the main task.
+*/
+static void ApplyPending(FAULT_INJ_Class_t *FaultInj)
+{
+
+   const FAULT_INJ_Config_t *Config = &FaultInj->Config;
+
+   if (!__atomic_load_n(&FaultInj->PendingSet, __ATOMIC_ACQUIRE))
+   {
+      return;
+   }
+
+   FaultInj->Config = FaultInj->Pending;
+   __atomic_store_n(&FaultInj->PendingSet, false, __ATOMIC_RELEASE);
+
+   FaultInj->Enabled = (Config->DropPct > 0 || Config->DupPct > 0 || Config->ReorderPct > 0 ||
+                        Config->SpikePct > 0 || Config->DelayMs > 0 || Config->JitterMs > 0);
+   FaultInj->Rng           = (Config->Seed != 0) ? Config->Seed : (0x9E3779B9u ^ (FaultInj->RigIdx + 1));
+   FaultInj->DropRemaining = 0;
+
+   CFE_EVS_SendEvent(FAULT_INJ_CONFIG_EID, CFE_EVS_EventType_INFORMATION,
+                     "Rig %d sensor fault injection %s",
+                     FaultInj->RigIdx, FaultInj->Enabled ? "enabled" : "disabled");
+
+} /* End ApplyPending() */
+
+
+/******************************************************************************
+** Function: Chance
+**
+** Return true with a probability of Pct percent.
+*/
+static bool Chance(FAULT_INJ_Class_t *FaultInj, uint8 Pct)
+{
+
+   if (Pct == 0)
+   {
+      return false;
+   }
+
+   return ((Rand(FaultInj) % 100) < Pct);
+
+} /* End Chance() */
+
+
+/******************************************************************************
+** Function: HoldMsg
+**
+** Copy a message into a free slot. Returns NULL and counts an overflow if
+** the hold queue is full.
+*/
+static FAULT_INJ_Held_t *HoldMsg(FAULT_INJ_Class_t *FaultInj, const CFE_MSG_Message_t *MsgPtr,
+                                 size_t MsgSize, uint64 ReleaseMs)
+{
+
+   FAULT_INJ_Held_t *Held;
+   uint8 i;
+
+   for (i=0; i < FAULT_INJ_MAX_HELD; i++)
+   {
+
+      Held = &FaultInj->Held[i];
+
+      if (!Held->InUse)
+      {
+         memcpy(&Held->Msg, MsgPtr, (MsgSize < sizeof(Held->Msg)) ? MsgSize : sizeof(Held->Msg));
+         Held->InUse       = true;
+         Held->WaitForNext = false;
+         Held->Order       = FaultInj->NextOrder++;
+         Held->ReleaseMs   = ReleaseMs;
+         FaultInj->HeldCnt++;
+         return Held;
+      }
+
+   }
+
+   FaultInj->OverflowCnt++;
+
+   return NULL;
+
+} /* End HoldMsg() */
+
+
+/******************************************************************************
+** Function: Rand
+**
+** xorshift32, repeatable for a given seed.
+*/
+static uint32 Rand(FAULT_INJ_Class_t *FaultInj)
+{
+
+   uint32 x = FaultInj->Rng;
+
+   x ^= x << 13;
+   x ^= x >> 17;
+   x ^= x << 5;
+   FaultInj->Rng = x;
+
+   return x;
+
+} /* End Rand() */
+
+
+/******************************************************************************
+** Function: ReleaseWaiting
+**
+** Release messages waiting to be reordered after the message that just
+** arrived. Their release time is pushed back to the new message's.
+*/
+static void ReleaseWaiting(FAULT_INJ_Class_t *FaultInj, uint64 ReleaseMs)
+{
+
+   FAULT_INJ_Held_t *Held;
+   uint8 i;
+
+   for (i=0; i < FAULT_INJ_MAX_HELD; i++)
+   {
+
+      Held = &FaultInj->Held[i];
+
+      if (Held->InUse && Held->WaitForNext)
+      {
+         Held->WaitForNext = false;
+         Held->Order       = FaultInj->NextOrder++;
+         if (Held->ReleaseMs < ReleaseMs)
+         {
+            Held->ReleaseMs = ReleaseMs;
+         }
+      }
+
+   }
+
+} /* End ReleaseWaiting() */
+
+
+/******************************************************************************
+** Function: Spike
+**
+** Add a spike to the held message's Z rate and light values. Messages too
+** short to hold a payload are left for the controller to reject.
+*/
+static void Spike(FAULT_INJ_Class_t *FaultInj, FAULT_INJ_Held_t *Held)
+{
+
+   MQTT_GW_TblSatSensorTlm_Payload_t *Payload = &Held->Msg.Payload;
+   size_t MsgSize = 0;
+
+   if (CFE_MSG_GetSize(CFE_MSG_PTR(Held->Msg.TelemetryHeader), &MsgSize) != CFE_SUCCESS ||
+       MsgSize < sizeof(MQTT_GW_TblSatSensorTlm_t))
+   {
+      return;
+   }
+
+   Payload->RateZ += (Rand(FaultInj) & 1) ? FaultInj->Config.SpikeRate : -FaultInj->Config.SpikeRate;
+   Payload->LuxA  += FaultInj->Config.SpikeLux;
+   Payload->LuxB  += FaultInj->Config.SpikeLux;
+
+   FaultInj->SpikeCnt++;
+
+} /* End Spike() */
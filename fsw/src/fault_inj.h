@@ -0,0 +1,230 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Define the sensor message fault injection class
+**
+**  Notes:
+**    1. Each rig owns one FAULT_INJ object that sits between its worker's
+**       MQTT pipe and its controller. It's used to measure how much sensor
+**       latency and loss SUN_ACQ tolerates. Injection is off by default and
+**       sensor messages then pass straight to the controller.
+**    2. When injection is on every message is copied into a small hold
+**       queue with a release time of now + DelayMs + a uniform jitter of up
+**       to JitterMs. Held messages are released in release time order so
+**       jitter larger than the sensor period reorders messages naturally.
+**    3. Each message is independently subject to:
+**         - Starting a burst of DropBurst dropped messages (DropPct)
+**         - Duplication, both copies are released together (DupPct)
+**         - Being held until after the next message (ReorderPct)
+**         - A value spike of +/-SpikeRate rad/s on the Z rate and +SpikeLux
+**           on both light sensors (SpikePct)
+**       Probabilities are in percent and drawn from a seeded generator so
+**       a test run is repeatable.
+**    4. The SetSensorFault command is received by the main task. It posts
+**       the new configuration and the worker applies it before it handles
+**       the rig's next message. A command is rejected while the previous
+**       configuration is still pending. Disabling injection releases every
+**       held message at the worker's next pass.
+**
+*/
+
+#ifndef _fault_inj_
+#define _fault_inj_
+
+/*
+** Includes
+*/
+
+#include "app_cfg.h"
+#include "mqtt_gw_eds_typedefs.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define FAULT_INJ_MAX_HELD  16
+
+/*
+** Event Message IDs
+*/
+
+#define FAULT_INJ_CMD_EID     (FAULT_INJ_BASE_EID + 0)
+#define FAULT_INJ_CONFIG_EID  (FAULT_INJ_BASE_EID + 1)
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+
+/******************************************************************************
+** Injection configuration, all zeros disables injection
+*/
+
+typedef struct
+{
+
+   uint8   DropPct;
+   uint8   DropBurst;    /* Messages per drop burst, 0 is treated as 1 */
+   uint8   DupPct;
+   uint8   ReorderPct;
+   uint8   SpikePct;
+   uint16  DelayMs;
+   uint16  JitterMs;
+   float   SpikeRate;    /* rad/s */
+   uint32  SpikeLux;
+   uint32  Seed;         /* 0 uses a seed derived from the rig index */
+
+} FAULT_INJ_Config_t;
+
+
+/******************************************************************************
+** Held message
+*/
+
+typedef struct
+{
+
+   bool    InUse;
+   bool    WaitForNext;  /* Reordered, released after the next message */
+   uint32  Order;        /* Breaks release time ties in arrival order */
+   uint64  ReleaseMs;
+
+   MQTT_GW_TblSatSensorTlm_t  Msg;
+
+} FAULT_INJ_Held_t;
+
+
+/******************************************************************************
+** FAULT_INJ_Class
+*/
+
+typedef struct
+{
+
+   /*
+   ** Class State Data
+   */
+
+   uint8   RigIdx;
+   bool    Enabled;
+   bool    PendingSet;   /* Atomic, a posted configuration is waiting */
+
+   FAULT_INJ_Config_t  Pending;
+   FAULT_INJ_Config_t  Config;
+
+   uint32  Rng;
+   uint8   DropRemaining;
+   uint32  NextOrder;
+   uint8   HeldCnt;
+
+   /*
+   ** Telemetry
+   */
+
+   uint32  InCnt;
+   uint32  DropCnt;
+   uint32  DupCnt;
+   uint32  ReorderCnt;
+   uint32  SpikeCnt;
+   uint32  OverflowCnt;   /* Messages dropped because the hold queue was full */
+   uint16  MaxDelayMs;    /* Longest delay applied by DelayMs and JitterMs */
+
+   FAULT_INJ_Held_t  Held[FAULT_INJ_MAX_HELD];
+
+} FAULT_INJ_Class_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: FAULT_INJ_Constructor
+**
+** Initialize a rig's fault injection object with injection disabled.
+**
+** Notes:
+**   1. This must be called prior to any other function.
+**
+*/
+void FAULT_INJ_Constructor(FAULT_INJ_Class_t *FaultInj, uint8 RigIdx);
+
+
+/******************************************************************************
+** Function: FAULT_INJ_Configure
+**
+** Post a new injection configuration for the rig's worker to apply. Called
+** by the app's main task.
+*/
+bool FAULT_INJ_Configure(FAULT_INJ_Class_t *FaultInj, const FAULT_INJ_Config_t *Config);
+
+
+/******************************************************************************
+** Function: FAULT_INJ_Input
+**
+** Pass a received sensor message through the injection stage. Returns true
+** if injection is disabled and the caller should forward the message to
+** the controller itself. Otherwise the message has been copied, dropped or
+** held and FAULT_INJ_Output() returns it when it's due.
+**
+** Notes:
+**   1. Must be called from the rig's worker. NowMs is the rig manager's
+**      clock in milliseconds.
+**
+*/
+bool FAULT_INJ_Input(FAULT_INJ_Class_t *FaultInj, const CFE_MSG_Message_t *MsgPtr, uint64 NowMs);
+
+
+/******************************************************************************
+** Function: FAULT_INJ_NextReleaseMs
+**
+** Return the release time of the next held message or UINT64_MAX if no
+** held message has a release time.
+*/
+uint64 FAULT_INJ_NextReleaseMs(const FAULT_INJ_Class_t *FaultInj);
+
+
+/******************************************************************************
+** Function: FAULT_INJ_Output
+**
+** Return the next held message that is due or NULL if none are due. Call
+** until NULL is returned. The message is valid until the next call.
+**
+** Notes:
+**   1. Must be called from the rig's worker once per pass, even when no
+**      message was received, so a posted configuration is applied and
+**      delayed messages are released.
+**
+*/
+const CFE_MSG_Message_t *FAULT_INJ_Output(FAULT_INJ_Class_t *FaultInj, uint64 NowMs);
+
+
+/******************************************************************************
+** Function: FAULT_INJ_ResetStatus
+**
+** Reset counters and status flags to a known reset state.
+**
+** Notes:
+**   1. Any counter or variable that is reported in HK telemetry that doesn't
+**      change the functional behavior should be reset.
+**
+*/
+void FAULT_INJ_ResetStatus(FAULT_INJ_Class_t *FaultInj);
+
+
+#endif /* _fault_inj_ */
@@ -0,0 +1,329 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Implement the online gyro bias estimator
+**
+**  Notes:
+**    1. See gyro_bias.h for details.
+**    2. The window statistics use Welford's update so a small rate
+**       deviation isn't lost subtracting two large sums. The fit's sums are
+**       doubles with temperatures centered on GYRO_BIAS_TEMP_REF for the
+**       same reason.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <math.h>
+#include <string.h>
+#include "gyro_bias.h"
+
+
+/************************************/
+/** Local File Function Prototypes **/
+/************************************/
+
+static void AddToFit(GYRO_BIAS_Fit_t *Fit, const float Mean[GYRO_BIAS_AXIS_CNT],
+                     double Temp, float Memory);
+static void TestWindow(GYRO_BIAS_Class_t *GyroBias, const GYRO_BIAS_Param_t *Param,
+                       double Temp);
+
+
+/******************************************************************************
+** Function: GYRO_BIAS_Constructor
+**
+*/
+void GYRO_BIAS_Constructor(GYRO_BIAS_Class_t *GyroBias)
+{
+
+   memset(GyroBias, 0, sizeof(GYRO_BIAS_Class_t));
+
+} /* End GYRO_BIAS_Constructor() */
+
+
+/******************************************************************************
+** Function: GYRO_BIAS_Correct
+**
+** Notes:
+**   1. The bias is limited to MaxBias so a slope fitted over a narrow
+**      temperature range isn't extrapolated into a large correction.
+**
+*/
+void GYRO_BIAS_Correct(GYRO_BIAS_Class_t *GyroBias, const GYRO_BIAS_Param_t *Param,
+                       float Rate[GYRO_BIAS_AXIS_CNT], float TempC, bool TempValid)
+{
+
+   const GYRO_BIAS_Fit_t *Fit = &GyroBias->Fit;
+   double TempMean, TempVar, BiasMean, Slope, Bias;
+   uint8  i;
+
+   if (!Param->Enabled || Fit->W <= 0.0)
+   {
+      for (i=0; i < GYRO_BIAS_AXIS_CNT; i++)
+      {
+         GyroBias->Bias[i]     = 0.0;
+         GyroBias->TempCoef[i] = 0.0;
+      }
+      return;
+   }
+
+   TempMean = Fit->T/Fit->W;
+   TempVar  = Fit->TT/Fit->W - TempMean*TempMean;
+
+   for (i=0; i < GYRO_BIAS_AXIS_CNT; i++)
+   {
+
+      BiasMean = Fit->B[i]/Fit->W;
+      Slope    = 0.0;
+      Bias     = BiasMean;
+
+      if (TempVar >= (double)Param->MinTempStd*Param->MinTempStd)
+      {
+         Slope = (Fit->TB[i]/Fit->W - TempMean*BiasMean)/TempVar;
+         if (TempValid)
+         {
+            Bias += Slope*((TempC - GYRO_BIAS_TEMP_REF) - TempMean);
+         }
+      }
+
+      if (Bias > Param->MaxBias)
+      {
+         Bias = Param->MaxBias;
+      }
+      else if (Bias < -Param->MaxBias)
+      {
+         Bias = -Param->MaxBias;
+      }
+
+      GyroBias->Bias[i]     = (float)Bias;
+      GyroBias->TempCoef[i] = (float)Slope;
+      Rate[i] -= (float)Bias;
+
+   } /* End axis loop */
+
+} /* End GYRO_BIAS_Correct() */
+
+
+/******************************************************************************
+** Function: GYRO_BIAS_Reset
+**
+*/
+void GYRO_BIAS_Reset(GYRO_BIAS_Class_t *GyroBias)
+{
+
+   memset(&GyroBias->Window, 0, sizeof(GYRO_BIAS_Window_t));
+   memset(&GyroBias->Fit, 0, sizeof(GYRO_BIAS_Fit_t));
+   GyroBias->PrevQuiet = false;
+   GyroBias->Still     = false;
+
+} /* End GYRO_BIAS_Reset() */
+
+
+/******************************************************************************
+** Function: GYRO_BIAS_ResetStatus
+**
+*/
+void GYRO_BIAS_ResetStatus(GYRO_BIAS_Class_t *GyroBias)
+{
+
+   GyroBias->StillCnt  = 0;
+   GyroBias->MovingCnt = 0;
+
+} /* End GYRO_BIAS_ResetStatus() */
+
+
+/******************************************************************************
+** Function: GYRO_BIAS_Update
+**
+** Notes:
+**   1. Without a temperature the window is fitted at the fit's mean
+**      temperature so it moves the intercept without changing the slope.
+**
+*/
+void GYRO_BIAS_Update(GYRO_BIAS_Class_t *GyroBias, const GYRO_BIAS_Param_t *Param,
+                      const float Rate[GYRO_BIAS_AXIS_CNT], float TempC, bool TempValid,
+                      bool FansOff)
+{
+
+   GYRO_BIAS_Window_t *Window = &GyroBias->Window;
+   double Temp, Delta;
+   uint8  i;
+
+   if (!Param->Enabled || !FansOff)
+   {
+      Window->Count       = 0;
+      GyroBias->PrevQuiet = false;
+      GyroBias->Still     = false;
+      return;
+   }
+
+   if (Window->Count == 0)
+   {
+      memset(Window, 0, sizeof(GYRO_BIAS_Window_t));
+   }
+
+   Window->Count++;
+   for (i=0; i < GYRO_BIAS_AXIS_CNT; i++)
+   {
+      Delta = Rate[i] - Window->Mean[i];
+      Window->Mean[i] += Delta/Window->Count;
+      Window->M2[i]   += Delta*(Rate[i] - Window->Mean[i]);
+   }
+
+   if (Window->Count >= Param->WindowLen)
+   {
+      if (TempValid)
+      {
+         Temp = TempC - GYRO_BIAS_TEMP_REF;
+      }
+      else
+      {
+         Temp = (GyroBias->Fit.W > 0.0) ? GyroBias->Fit.T/GyroBias->Fit.W : 0.0;
+      }
+      TestWindow(GyroBias, Param, Temp);
+      Window->Count = 0;
+   }
+
+} /* End GYRO_BIAS_Update() */
+
+
+/******************************************************************************
+** Function: GYRO_BIAS_ValidParam
+**
+*/
+bool GYRO_BIAS_ValidParam(const GYRO_BIAS_Param_t *Param)
+{
+
+   if (Param->Enabled > 1)
+   {
+      CFE_EVS_SendEvent(GYRO_BIAS_PARAM_EID, CFE_EVS_EventType_ERROR,
+                        "Invalid gyro bias estimator enabled value %d. Must be 0 or 1",
+                        Param->Enabled);
+      return false;
+   }
+
+   if (Param->WindowLen < 2)
+   {
+      CFE_EVS_SendEvent(GYRO_BIAS_PARAM_EID, CFE_EVS_EventType_ERROR,
+                        "Invalid gyro bias window length %d. Must be at least 2",
+                        Param->WindowLen);
+      return false;
+   }
+
+   if (!(Param->StillStd > 0.0) || !(Param->MaxBias > 0.0))
+   {
+      CFE_EVS_SendEvent(GYRO_BIAS_PARAM_EID, CFE_EVS_EventType_ERROR,
+                        "Invalid gyro bias still std %0.6f or max bias %0.6f. Both must be greater than 0",
+                        Param->StillStd, Param->MaxBias);
+      return false;
+   }
+
+   if (!(Param->Memory >= 1.0))
+   {
+      CFE_EVS_SendEvent(GYRO_BIAS_PARAM_EID, CFE_EVS_EventType_ERROR,
+                        "Invalid gyro bias memory %0.2f. Must be at least 1 window",
+                        Param->Memory);
+      return false;
+   }
+
+   if (!(Param->MinTempStd > 0.0))
+   {
+      CFE_EVS_SendEvent(GYRO_BIAS_PARAM_EID, CFE_EVS_EventType_ERROR,
+                        "Invalid gyro bias minimum temperature std %0.3f. Must be greater than 0",
+                        Param->MinTempStd);
+      return false;
+   }
+
+   return true;
+
+} /* End GYRO_BIAS_ValidParam() */
+
+
+/******************************************************************************
+** Function: AddToFit
+**
+** Forget part of the fit and add a still window's mean at Temp.
+*/
+static void AddToFit(GYRO_BIAS_Fit_t *Fit, const float Mean[GYRO_BIAS_AXIS_CNT],
+                     double Temp, float Memory)
+{
+
+   double Keep = 1.0 - 1.0/Memory;
+   uint8  i;
+
+   Fit->W  = Keep*Fit->W  + 1.0;
+   Fit->T  = Keep*Fit->T  + Temp;
+   Fit->TT = Keep*Fit->TT + Temp*Temp;
+   for (i=0; i < GYRO_BIAS_AXIS_CNT; i++)
+   {
+      Fit->B[i]  = Keep*Fit->B[i]  + Mean[i];
+      Fit->TB[i] = Keep*Fit->TB[i] + Temp*Mean[i];
+   }
+
+} /* End AddToFit() */
+
+
+/******************************************************************************
+** Function: TestWindow
+**
+** Test a complete window and add it to the fit if the table was still.
+*/
+static void TestWindow(GYRO_BIAS_Class_t *GyroBias, const GYRO_BIAS_Param_t *Param,
+                       double Temp)
+{
+
+   const GYRO_BIAS_Window_t *Window = &GyroBias->Window;
+   float  Mean[GYRO_BIAS_AXIS_CNT];
+   double Std;
+   bool   Quiet = true;
+   bool   Steady;
+   uint8  i;
+
+   for (i=0; i < GYRO_BIAS_AXIS_CNT; i++)
+   {
+      Mean[i] = (float)Window->Mean[i];
+      Std = sqrt(Window->M2[i]/(Window->Count - 1));
+      if (Std > Param->StillStd || fabsf(Mean[i]) > Param->MaxBias)
+      {
+         Quiet = false;
+      }
+   }
+
+   Steady = Quiet && GyroBias->PrevQuiet;
+   for (i=0; Steady && i < GYRO_BIAS_AXIS_CNT; i++)
+   {
+      if (fabsf(Mean[i] - GyroBias->PrevMean[i]) > Param->StillStd)
+      {
+         Steady = false;
+      }
+   }
+
+   GyroBias->PrevQuiet = Quiet;
+   memcpy(GyroBias->PrevMean, Mean, sizeof(Mean));
+
+   GyroBias->Still = Steady;
+   if (Steady)
+   {
+      AddToFit(&GyroBias->Fit, Mean, Temp, Param->Memory);
+      GyroBias->StillCnt++;
+   }
+   else
+   {
+      GyroBias->MovingCnt++;
+   }
+
+} /* End TestWindow() */
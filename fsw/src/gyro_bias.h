@@ -0,0 +1,205 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Define the online gyro bias estimator
+**
+**  Notes:
+**    1. Each rig's SAT_CTRL object owns one estimator. It learns the bias
+**       left in the calibrated rates while the table is still and
+**       subtracts it from every calibrated rate sample, so a bias the
+**       sensor table doesn't remove isn't integrated into the survey
+**       rotation.
+**    2. Rate samples are collected in windows of WindowLen samples while
+**       the fans are off. A window is still when each axis' standard
+**       deviation is at most StillStd, each axis' mean is at most MaxBias
+**       and the means agree with the previous window's to within StillStd.
+**       The last test rejects a table that is still spinning down. Any fan
+**       output restarts the test.
+**    3. The mean of each still window is added to a weighted linear fit of
+**       bias versus the gyro's die temperature. The fit's sums are scaled
+**       by 1 - 1/Memory before each window is added so it tracks a bias
+**       that wanders over time. The fit's slope is used once the standard
+**       deviation of the fitted temperatures reaches MinTempStd, until
+**       then the bias is the weighted mean of the still windows.
+**    4. The estimator has no cFE dependencies beyond its parameter
+**       validation event. It's only called by the rig's worker.
+**
+*/
+
+#ifndef _gyro_bias_
+#define _gyro_bias_
+
+/*
+** Includes
+*/
+
+#include "app_cfg.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define GYRO_BIAS_AXIS_CNT   3      /* Must match EDS GyroAxisArray */
+#define GYRO_BIAS_TEMP_REF   25.0   /* Deg C, the fit's sums are centered here */
+
+/*
+** Event Message IDs
+*/
+
+#define GYRO_BIAS_PARAM_EID  (GYRO_BIAS_BASE_EID + 0)
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+
+/******************************************************************************
+** Table parameters
+*/
+
+typedef struct
+{
+
+   uint16  Enabled;      /* 0 leaves the calibrated rates unchanged */
+   uint16  WindowLen;    /* Rate samples in each still test window */
+   float   StillStd;     /* Largest still rate standard deviation, rad/s */
+   float   MaxBias;      /* Largest believable bias, rad/s */
+   float   Memory;       /* Still windows remembered by the fit */
+   float   MinTempStd;   /* Temperature spread needed to fit a slope, deg C */
+
+} GYRO_BIAS_Param_t;
+
+
+/******************************************************************************
+** Still test window
+*/
+
+typedef struct
+{
+
+   uint16  Count;
+   double  Mean[GYRO_BIAS_AXIS_CNT];
+   double  M2[GYRO_BIAS_AXIS_CNT];     /* Sum of squared deviations from the mean */
+
+} GYRO_BIAS_Window_t;
+
+
+/******************************************************************************
+** Weighted bias versus temperature sums, temperatures relative to
+** GYRO_BIAS_TEMP_REF
+*/
+
+typedef struct
+{
+
+   double  W;
+   double  T;
+   double  TT;
+   double  B[GYRO_BIAS_AXIS_CNT];
+   double  TB[GYRO_BIAS_AXIS_CNT];
+
+} GYRO_BIAS_Fit_t;
+
+
+/******************************************************************************
+** GYRO_BIAS_Class
+*/
+
+typedef struct
+{
+
+   GYRO_BIAS_Window_t  Window;
+   bool    PrevQuiet;                        /* Previous window passed the deviation test */
+   float   PrevMean[GYRO_BIAS_AXIS_CNT];
+
+   GYRO_BIAS_Fit_t  Fit;
+
+   bool    Still;                            /* The last window was still */
+   uint32  StillCnt;                         /* Still windows added to the fit */
+   uint32  MovingCnt;                        /* Complete windows that weren't still */
+   float   Bias[GYRO_BIAS_AXIS_CNT];         /* Subtracted from the last rate sample, rad/s */
+   float   TempCoef[GYRO_BIAS_AXIS_CNT];     /* Bias slope, rad/s per deg C */
+
+} GYRO_BIAS_Class_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: GYRO_BIAS_Constructor
+**
+** Initialize the estimator with no bias learned.
+**
+*/
+void GYRO_BIAS_Constructor(GYRO_BIAS_Class_t *GyroBias);
+
+
+/******************************************************************************
+** Function: GYRO_BIAS_Correct
+**
+** Subtract the estimated bias at TempC from a calibrated rate vector. When
+** TempValid is false the bias at the fit's mean temperature is used.
+**
+*/
+void GYRO_BIAS_Correct(GYRO_BIAS_Class_t *GyroBias, const GYRO_BIAS_Param_t *Param,
+                       float Rate[GYRO_BIAS_AXIS_CNT], float TempC, bool TempValid);
+
+
+/******************************************************************************
+** Function: GYRO_BIAS_Reset
+**
+** Forget the learned bias. Called when the sensor calibration changes.
+**
+*/
+void GYRO_BIAS_Reset(GYRO_BIAS_Class_t *GyroBias);
+
+
+/******************************************************************************
+** Function: GYRO_BIAS_ResetStatus
+**
+** Reset the window counters.
+**
+*/
+void GYRO_BIAS_ResetStatus(GYRO_BIAS_Class_t *GyroBias);
+
+
+/******************************************************************************
+** Function: GYRO_BIAS_Update
+**
+** Add a calibrated rate sample, before the bias correction, to the still
+** test. FansOff is true when no fan has a non-zero output.
+**
+*/
+void GYRO_BIAS_Update(GYRO_BIAS_Class_t *GyroBias, const GYRO_BIAS_Param_t *Param,
+                      const float Rate[GYRO_BIAS_AXIS_CNT], float TempC, bool TempValid,
+                      bool FansOff);
+
+
+/******************************************************************************
+** Function: GYRO_BIAS_ValidParam
+**
+** Validate the estimator's table parameters. Sends an error event and
+** returns false if a parameter is invalid.
+**
+*/
+bool GYRO_BIAS_ValidParam(const GYRO_BIAS_Param_t *Param);
+
+
+#endif /* _gyro_bias_ */
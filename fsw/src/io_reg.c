@@ -0,0 +1,335 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Implement the GPIO and PWM register access interface
+**
+**  Notes:
+**    1. See io_reg.h for details.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+#include "gpio.h"
+#include "pwm.h"
+#include "io_reg.h"
+
+
+/**********************/
+/** Global File Data **/
+/**********************/
+
+#ifdef TBL_SAT_SIM_HW
+static IO_REG_SimBank_t SimBank;
+#endif
+
+
+/******************************************************************************
+** Function: IO_REG_MapGpio
+**
+*/
+bool IO_REG_MapGpio(void)
+{
+
+#ifdef TBL_SAT_SIM_HW
+   memset(SimBank.GpioFunc, INPUT, sizeof(SimBank.GpioFunc));
+   SimBank.GpioLevel = 0;
+   return true;
+#else
+   return (gpio_map() >= 0);
+#endif
+
+} /* End IO_REG_MapGpio() */
+
+
+/******************************************************************************
+** Function: IO_REG_MapPwm
+**
+*/
+bool IO_REG_MapPwm(void)
+{
+
+#ifdef TBL_SAT_SIM_HW
+   memset(SimBank.Pwm, 0, sizeof(SimBank.Pwm));
+   memset(SimBank.PwmWriteCnt, 0, sizeof(SimBank.PwmWriteCnt));
+   IO_REG_PwmFifoClear();
+   return true;
+#else
+   return (pwm_map() >= 0);
+#endif
+
+} /* End IO_REG_MapPwm() */
+
+
+/******************************************************************************
+** Function: IO_REG_GpioFunc
+**
+*/
+void IO_REG_GpioFunc(uint8 BcmId, int Func)
+{
+
+#ifdef TBL_SAT_SIM_HW
+   if (BcmId < IO_REG_GPIO_PIN_CNT)
+   {
+      SimBank.GpioFunc[BcmId] = (uint8)Func;
+   }
+#else
+   gpio_func(BcmId, Func);
+#endif
+
+} /* End IO_REG_GpioFunc() */
+
+
+/******************************************************************************
+** Function: IO_REG_GpioSet
+**
+*/
+void IO_REG_GpioSet(uint8 BcmId)
+{
+
+#ifdef TBL_SAT_SIM_HW
+   if (BcmId < IO_REG_GPIO_PIN_CNT)
+   {
+      __atomic_or_fetch(&SimBank.GpioLevel, ((uint64)1 << BcmId), __ATOMIC_RELAXED);
+   }
+#else
+   gpio_set(BcmId);
+#endif
+
+} /* End IO_REG_GpioSet() */
+
+
+/******************************************************************************
+** Function: IO_REG_GpioClear
+**
+*/
+void IO_REG_GpioClear(uint8 BcmId)
+{
+
+#ifdef TBL_SAT_SIM_HW
+   if (BcmId < IO_REG_GPIO_PIN_CNT)
+   {
+      __atomic_and_fetch(&SimBank.GpioLevel, ~((uint64)1 << BcmId), __ATOMIC_RELAXED);
+   }
+#else
+   gpio_clear(BcmId);
+#endif
+
+} /* End IO_REG_GpioClear() */
+
+
+/******************************************************************************
+** Function: IO_REG_PwmBank
+**
+** Notes:
+**   1. rpi_iolib doesn't export the PWM block's base address so it is
+**      computed from the channel 0 data register's address.
+**
+*/
+volatile uint32 *IO_REG_PwmBank(void)
+{
+
+#ifdef TBL_SAT_SIM_HW
+   return SimBank.Pwm;
+#else
+   return ((volatile uint32 *)&DAT_CHANNEL0) - IO_REG_PWM_DAT1;
+#endif
+
+} /* End IO_REG_PwmBank() */
+
+
+/******************************************************************************
+** Function: IO_REG_PwmConfigure
+**
+** Notes:
+**   1. The simulated bank records the range and the clock divisor. The
+**      control register fields are not modeled.
+**
+*/
+void IO_REG_PwmConfigure(int Channel, pwm_channel_config *ChanCfg)
+{
+
+#ifdef TBL_SAT_SIM_HW
+   if (Channel == PWM_CHANNEL0)
+   {
+      SimBank.Pwm[IO_REG_PWM_RNG1] = ChanCfg->range;
+      SimBank.PwmClkDivisor[0]     = ChanCfg->divisor;
+   }
+   else
+   {
+      SimBank.Pwm[IO_REG_PWM_RNG2] = ChanCfg->range;
+      SimBank.PwmClkDivisor[1]     = ChanCfg->divisor;
+   }
+#else
+   pwm_configure(Channel, ChanCfg);
+   pwm_enable(Channel);
+#endif
+
+} /* End IO_REG_PwmConfigure() */
+
+
+/******************************************************************************
+** Function: IO_REG_PwmFifoClear
+**
+*/
+void IO_REG_PwmFifoClear(void)
+{
+
+   volatile uint32 *PwmBank = IO_REG_PwmBank();
+
+#ifdef TBL_SAT_SIM_HW
+   SimBank.PwmFifoHead = 0;
+   SimBank.PwmFifoCnt  = 0;
+   PwmBank[IO_REG_PWM_STA] = IO_REG_PWM_STA_EMPT1;
+#else
+   PwmBank[IO_REG_PWM_CTL] |= IO_REG_PWM_CTL_CLRF1;
+   PwmBank[IO_REG_PWM_STA]  = (IO_REG_PWM_STA_WERR1 | IO_REG_PWM_STA_RERR1);
+#endif
+
+} /* End IO_REG_PwmFifoClear() */
+
+
+/******************************************************************************
+** Function: IO_REG_PwmFifoStatus
+**
+** Notes:
+**   1. The hardware error flags are cleared by writing a 1 to them.
+**
+*/
+uint32 IO_REG_PwmFifoStatus(void)
+{
+
+   volatile uint32 *PwmBank = IO_REG_PwmBank();
+   uint32 Status = PwmBank[IO_REG_PWM_STA];
+
+#ifdef TBL_SAT_SIM_HW
+   PwmBank[IO_REG_PWM_STA] &= ~(IO_REG_PWM_STA_WERR1 | IO_REG_PWM_STA_RERR1);
+#else
+   PwmBank[IO_REG_PWM_STA] = Status & (IO_REG_PWM_STA_WERR1 | IO_REG_PWM_STA_RERR1);
+#endif
+
+   return Status;
+
+} /* End IO_REG_PwmFifoStatus() */
+
+
+/******************************************************************************
+** Function: IO_REG_PwmFifoWrite
+**
+*/
+void IO_REG_PwmFifoWrite(uint32 Word)
+{
+
+   volatile uint32 *PwmBank = IO_REG_PwmBank();
+
+#ifdef TBL_SAT_SIM_HW
+   if (SimBank.PwmFifoCnt < IO_REG_PWM_FIFO_DEPTH)
+   {
+      SimBank.PwmFifo[(SimBank.PwmFifoHead + SimBank.PwmFifoCnt) % IO_REG_PWM_FIFO_DEPTH] = Word;
+      SimBank.PwmFifoCnt++;
+      PwmBank[IO_REG_PWM_STA] &= ~IO_REG_PWM_STA_EMPT1;
+      if (SimBank.PwmFifoCnt == IO_REG_PWM_FIFO_DEPTH)
+      {
+         PwmBank[IO_REG_PWM_STA] |= IO_REG_PWM_STA_FULL1;
+      }
+   }
+   else
+   {
+      PwmBank[IO_REG_PWM_STA] |= IO_REG_PWM_STA_WERR1;
+   }
+#else
+   PwmBank[IO_REG_PWM_FIF1] = Word;
+#endif
+
+} /* End IO_REG_PwmFifoWrite() */
+
+
+/******************************************************************************
+** Function: IO_REG_PwmWrite
+**
+*/
+void IO_REG_PwmWrite(int Channel, uint32 Value)
+{
+
+   volatile uint32 *PwmBank = IO_REG_PwmBank();
+
+   if (Channel == PWM_CHANNEL0)
+   {
+      PwmBank[IO_REG_PWM_DAT1] = Value;
+   }
+   else
+   {
+      PwmBank[IO_REG_PWM_DAT2] = Value;
+   }
+
+#ifdef TBL_SAT_SIM_HW
+   SimBank.PwmWriteCnt[(Channel == PWM_CHANNEL0) ? 0 : 1]++;
+#endif
+
+} /* End IO_REG_PwmWrite() */
+
+
+/******************************************************************************
+** Function: IO_REG_SimBank
+**
+*/
+IO_REG_SimBank_t *IO_REG_SimBank(void)
+{
+
+#ifdef TBL_SAT_SIM_HW
+   return &SimBank;
+#else
+   return NULL;
+#endif
+
+} /* End IO_REG_SimBank() */
+
+
+/******************************************************************************
+** Function: IO_REG_SimPwmFifoPop
+**
+*/
+bool IO_REG_SimPwmFifoPop(uint32 *Word)
+{
+
+#ifdef TBL_SAT_SIM_HW
+   bool RetStatus = false;
+
+   if (SimBank.PwmFifoCnt > 0)
+   {
+      *Word = SimBank.PwmFifo[SimBank.PwmFifoHead];
+      SimBank.PwmFifoHead = (SimBank.PwmFifoHead + 1) % IO_REG_PWM_FIFO_DEPTH;
+      SimBank.PwmFifoCnt--;
+      SimBank.Pwm[IO_REG_PWM_STA] &= ~IO_REG_PWM_STA_FULL1;
+      if (SimBank.PwmFifoCnt == 0)
+      {
+         SimBank.Pwm[IO_REG_PWM_STA] |= IO_REG_PWM_STA_EMPT1;
+      }
+      RetStatus = true;
+   }
+   else
+   {
+      SimBank.Pwm[IO_REG_PWM_STA] |= IO_REG_PWM_STA_RERR1;
+   }
+
+   return RetStatus;
+#else
+   return false;
+#endif
+
+} /* End IO_REG_SimPwmFifoPop() */
@@ -0,0 +1,213 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Define the GPIO and PWM register access interface
+**
+**  Notes:
+**    1. All GPIO and PWM peripheral accesses go through this interface so
+**       the Raspberry Pi registers mapped by rpi_iolib can be replaced by a
+**       simulated register bank. Defining TBL_SAT_SIM_HW at build time (see
+**       CMakeLists.txt) selects the simulated bank.
+**    2. The PWM register bank follows the BCM2835 PWM block's word layout
+**       so code that reads or writes registers behaves the same on either
+**       bank. On the target the bank is located from rpi_iolib's
+**       DAT_CHANNEL0 register.
+**    3. The simulated bank models register storage and the PWM FIFO's
+**       depth and status flags. It doesn't model any timing so simulations
+**       and tests drain the FIFO with IO_REG_SimPwmFifoPop() and read the
+**       bank to observe what the app wrote.
+**
+*/
+
+#ifndef _io_reg_
+#define _io_reg_
+
+/*
+** Includes
+*/
+
+#include "app_cfg.h"
+#include "pwm.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+/*
+** BCM2835 PWM block register word offsets
+*/
+
+#define IO_REG_PWM_CTL   0
+#define IO_REG_PWM_STA   1
+#define IO_REG_PWM_DMAC  2
+#define IO_REG_PWM_RNG1  4
+#define IO_REG_PWM_DAT1  5
+#define IO_REG_PWM_FIF1  6
+#define IO_REG_PWM_RNG2  8
+#define IO_REG_PWM_DAT2  9
+#define IO_REG_PWM_WORD_CNT  10
+
+#define IO_REG_PWM_CTL_CLRF1  (1 << 6)   /* Write 1 to clear the FIFO */
+
+#define IO_REG_PWM_STA_FULL1  (1 << 0)
+#define IO_REG_PWM_STA_EMPT1  (1 << 1)
+#define IO_REG_PWM_STA_WERR1  (1 << 2)   /* Write when FIFO full */
+#define IO_REG_PWM_STA_RERR1  (1 << 3)   /* Read when FIFO empty */
+
+#define IO_REG_PWM_FIFO_DEPTH  16        /* 32-bit words shared by both channels */
+
+#define IO_REG_GPIO_PIN_CNT  54
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+
+/******************************************************************************
+** Simulated register bank
+*/
+
+typedef struct
+{
+
+   uint32  Pwm[IO_REG_PWM_WORD_CNT];
+   uint32  PwmClkDivisor[2];
+   uint8   GpioFunc[IO_REG_GPIO_PIN_CNT];
+   uint64  GpioLevel;          /* One bit per BCM pin */
+   uint32  PwmWriteCnt[2];     /* Number of DAT register writes per channel */
+
+   uint32  PwmFifo[IO_REG_PWM_FIFO_DEPTH];
+   uint8   PwmFifoHead;
+   uint8   PwmFifoCnt;
+
+} IO_REG_SimBank_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: IO_REG_MapGpio
+**
+** Map the GPIO peripheral. Returns true if successful.
+*/
+bool IO_REG_MapGpio(void);
+
+
+/******************************************************************************
+** Function: IO_REG_MapPwm
+**
+** Map the PWM peripheral. Returns true if successful.
+*/
+bool IO_REG_MapPwm(void);
+
+
+/******************************************************************************
+** Function: IO_REG_GpioFunc
+**
+*/
+void IO_REG_GpioFunc(uint8 BcmId, int Func);
+
+
+/******************************************************************************
+** Function: IO_REG_GpioSet
+**
+*/
+void IO_REG_GpioSet(uint8 BcmId);
+
+
+/******************************************************************************
+** Function: IO_REG_GpioClear
+**
+*/
+void IO_REG_GpioClear(uint8 BcmId);
+
+
+/******************************************************************************
+** Function: IO_REG_PwmBank
+**
+** Return a pointer to the first word of the PWM register bank. Use the
+** IO_REG_PWM_xxx offsets to access individual registers.
+*/
+volatile uint32 *IO_REG_PwmBank(void);
+
+
+/******************************************************************************
+** Function: IO_REG_PwmConfigure
+**
+** Configure and enable a PWM channel.
+*/
+void IO_REG_PwmConfigure(int Channel, pwm_channel_config *ChanCfg);
+
+
+/******************************************************************************
+** Function: IO_REG_PwmFifoClear
+**
+** Clear the PWM FIFO and its error flags.
+*/
+void IO_REG_PwmFifoClear(void);
+
+
+/******************************************************************************
+** Function: IO_REG_PwmFifoStatus
+**
+** Return the PWM status register. Use the IO_REG_PWM_STA_xxx bit masks to
+** test individual flags. The error flags are cleared after they're read.
+*/
+uint32 IO_REG_PwmFifoStatus(void);
+
+
+/******************************************************************************
+** Function: IO_REG_PwmFifoWrite
+**
+** Write a word to the PWM FIFO. When both channels use the FIFO their data
+** is interleaved starting with channel 0.
+*/
+void IO_REG_PwmFifoWrite(uint32 Word);
+
+
+/******************************************************************************
+** Function: IO_REG_PwmWrite
+**
+** Write a value to a PWM channel's data register.
+*/
+void IO_REG_PwmWrite(int Channel, uint32 Value);
+
+
+/******************************************************************************
+** Function: IO_REG_SimBank
+**
+** Return the simulated register bank or NULL when the app is built for the
+** Raspberry Pi hardware.
+*/
+IO_REG_SimBank_t *IO_REG_SimBank(void);
+
+
+/******************************************************************************
+** Function: IO_REG_SimPwmFifoPop
+**
+** Remove the oldest word from the simulated PWM FIFO, emulating the PWM
+** block reading the FIFO at the start of a PWM period. Returns false if
+** the FIFO is empty, which sets the read error flag, or if the app is built
+** for the Raspberry Pi hardware.
+*/
+bool IO_REG_SimPwmFifoPop(uint32 *Word);
+
+
+#endif /* _io_reg_ */
@@ -0,0 +1,216 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Implement the memory monitor class
+**
+**  Notes:
+**    1. See mem_mon.h for details.
+**    2. Stacks grow down on every platform this app runs on.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#define _GNU_SOURCE  /* pthread_getattr_np() */
+
+#include <pthread.h>
+#include <string.h>
+#include "mem_mon.h"
+
+
+/************************************/
+/** Local File Function Prototypes **/
+/************************************/
+
+static bool GetStackBounds(uint8 **Low, uint32 *Size);
+
+
+/**********************/
+/** Global File Data **/
+/**********************/
+
+static MEM_MON_Class_t *MemMon = NULL;
+
+
+/******************************************************************************
+** Function: MEM_MON_Constructor
+**
+*/
+void MEM_MON_Constructor(MEM_MON_Class_t *MemMonPtr, INITBL_Class_t *IniTbl)
+{
+
+   MemMon = MemMonPtr;
+
+   memset(MemMon, 0, sizeof(MEM_MON_Class_t));
+
+   MemMon->StackPaint = (INITBL_GetIntConfig(IniTbl, CFG_MEM_STACK_PAINT) != 0);
+
+   if (MemMon->StackPaint)
+   {
+      MEM_MON_PaintStack(TBL_SAT_MemTask_MAIN, 0);
+   }
+   else
+   {
+      CFE_EVS_SendEvent (MEM_MON_CONSTRUCTOR_EID, CFE_EVS_EventType_INFORMATION,
+                         "Stack painting disabled, stack high-water marks won't be reported");
+   }
+
+} /* End MEM_MON_Constructor() */
+
+
+/******************************************************************************
+** Function: MEM_MON_GetStackUsage
+**
+** Notes:
+**   1. The scan reads other tasks' stacks while they run. A byte that is
+**      overwritten during the scan is either counted now or on the next
+**      call so the result is never less than the true high-water mark at
+**      the start of the scan.
+**
+*/
+uint8 MEM_MON_GetStackUsage(TBL_SAT_StackUsage_t *Usage, uint8 MaxCnt)
+{
+
+   const MEM_MON_Stack_t *Stack;
+   const volatile uint8  *Byte;
+   const volatile uint8  *PaintEnd;
+   uint8  StackCnt = __atomic_load_n(&MemMon->StackCnt, __ATOMIC_ACQUIRE);
+   uint8  UsageCnt = 0;
+   uint8  i;
+
+   if (StackCnt > MEM_MON_MAX_STACK)
+   {
+      StackCnt = MEM_MON_MAX_STACK;
+   }
+
+   for (i=0; i < StackCnt && UsageCnt < MaxCnt; i++)
+   {
+
+      Stack = &MemMon->Stack[i];
+
+      if (__atomic_load_n(&Stack->Valid, __ATOMIC_ACQUIRE))
+      {
+
+         Byte     = Stack->Low;
+         PaintEnd = Stack->Low + Stack->PaintLen;
+         while (Byte < PaintEnd && *Byte == MEM_MON_PAINT_BYTE)
+         {
+            Byte++;
+         }
+
+         Usage[UsageCnt].Task      = Stack->Task;
+         Usage[UsageCnt].Instance  = Stack->Instance;
+         Usage[UsageCnt].Size      = Stack->Size;
+         Usage[UsageCnt].HighWater = Stack->Size - (uint32)(Byte - Stack->Low);
+         UsageCnt++;
+
+      }
+
+   } /* End stack loop */
+
+   return UsageCnt;
+
+} /* End MEM_MON_GetStackUsage() */
+
+
+/******************************************************************************
+** Function: MEM_MON_PaintStack
+**
+** Notes:
+**   1. noinline keeps this function's frame, and memset's frame below it,
+**      inside MEM_MON_PAINT_MARGIN of the address used as the paint limit.
+**
+*/
+__attribute__((noinline)) void MEM_MON_PaintStack(TBL_SAT_MemTask_Enum_t Task, uint8 Instance)
+{
+
+   MEM_MON_Stack_t *Stack;
+   uint8  *Frame = (uint8 *)__builtin_frame_address(0);
+   uint8  *Low;
+   uint32  Size;
+   uint8   Slot;
+
+   if (MemMon == NULL || !MemMon->StackPaint)
+   {
+      return;
+   }
+
+   if (!GetStackBounds(&Low, &Size) || Frame < Low + MEM_MON_PAINT_MARGIN || Frame > Low + Size)
+   {
+      if (__atomic_add_fetch(&MemMon->PaintErrCnt, 1, __ATOMIC_RELAXED) == 1)
+      {
+         CFE_EVS_SendEvent (MEM_MON_PAINT_EID, CFE_EVS_EventType_ERROR,
+                            "Unable to determine the stack bounds of task %d instance %d",
+                            Task, Instance);
+      }
+      return;
+   }
+
+   Slot = __atomic_fetch_add(&MemMon->StackCnt, 1, __ATOMIC_RELAXED);
+   if (Slot >= MEM_MON_MAX_STACK)
+   {
+      CFE_EVS_SendEvent (MEM_MON_PAINT_EID, CFE_EVS_EventType_ERROR,
+                         "Stack of task %d instance %d not painted, all %d stack slots are in use",
+                         Task, Instance, MEM_MON_MAX_STACK);
+      return;
+   }
+
+   Stack = &MemMon->Stack[Slot];
+   Stack->Task     = Task;
+   Stack->Instance = Instance;
+   Stack->Low      = Low;
+   Stack->Size     = Size;
+   Stack->PaintLen = (uint32)(Frame - Low) - MEM_MON_PAINT_MARGIN;
+
+   memset(Low, MEM_MON_PAINT_BYTE, Stack->PaintLen);
+
+   __atomic_store_n(&Stack->Valid, true, __ATOMIC_RELEASE);
+
+} /* End MEM_MON_PaintStack() */
+
+
+/******************************************************************************
+** Function: GetStackBounds
+**
+** Get the calling thread's lowest stack address and stack size. The guard
+** page, if any, isn't included.
+*/
+static bool GetStackBounds(uint8 **Low, uint32 *Size)
+{
+
+   pthread_attr_t  Attr;
+   void   *StackAddr;
+   size_t  StackSize;
+   bool    RetStatus = false;
+
+   if (pthread_getattr_np(pthread_self(), &Attr) == 0)
+   {
+
+      if (pthread_attr_getstack(&Attr, &StackAddr, &StackSize) == 0)
+      {
+         *Low  = (uint8 *)StackAddr;
+         *Size = (uint32)StackSize;
+         RetStatus = true;
+      }
+
+      pthread_attr_destroy(&Attr);
+
+   }
+
+   return RetStatus;
+
+} /* End GetStackBounds() */
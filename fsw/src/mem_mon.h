@@ -0,0 +1,145 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Define the memory monitor class
+**
+**  Notes:
+**    1. Use the Singleton design pattern. The memory monitor measures each
+**       app task's stack high-water mark using stack painting. Each task
+**       calls MEM_MON_PaintStack() once when it starts. The unused part of
+**       its stack, below the caller's frame, is filled with a known byte
+**       pattern and MEM_MON_GetStackUsage() scans up from the bottom of
+**       the stack for the first overwritten byte.
+**    2. Painting commits every stack page so a task's resident size grows
+**       to its full stack size. MEM_STACK_PAINT in the ini file disables
+**       painting when memory is tight and the stacks are already sized.
+**    3. Stack bounds come from pthread_getattr_np() so the stack size is
+**       the size actually allocated by OSAL, which may be rounded up from
+**       the requested size.
+**    4. The high-water mark can't be reset because repainting a running
+**       task's stack isn't safe.
+**
+*/
+
+#ifndef _mem_mon_
+#define _mem_mon_
+
+/*
+** Includes
+*/
+
+#include "app_cfg.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define MEM_MON_MAX_STACK     9     /* Must match EDS StackUsageArray */
+#define MEM_MON_PAINT_BYTE    0xA5
+#define MEM_MON_PAINT_MARGIN  512   /* Bytes left unpainted below the caller's frame */
+
+/*
+** Event Message IDs
+*/
+
+#define MEM_MON_CONSTRUCTOR_EID  (MEM_MON_BASE_EID + 0)
+#define MEM_MON_PAINT_EID        (MEM_MON_BASE_EID + 1)
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+
+/******************************************************************************
+** Painted task stack
+*/
+
+typedef struct
+{
+
+   bool    Valid;      /* Atomic, set after the remaining fields are written */
+   TBL_SAT_MemTask_Enum_t Task;
+   uint8   Instance;
+   uint8  *Low;        /* Lowest stack address */
+   uint32  Size;
+   uint32  PaintLen;   /* Bytes painted starting at Low */
+
+} MEM_MON_Stack_t;
+
+
+/******************************************************************************
+** MEM_MON_Class
+*/
+
+typedef struct
+{
+
+   /*
+   ** Class State Data
+   */
+
+   bool    StackPaint;
+   uint8   StackCnt;   /* Atomic, slots reserved by MEM_MON_PaintStack() */
+   uint32  PaintErrCnt;
+
+   MEM_MON_Stack_t  Stack[MEM_MON_MAX_STACK];
+
+} MEM_MON_Class_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: MEM_MON_Constructor
+**
+** Initialize the memory monitor object to a known state and paint the
+** calling task's stack.
+**
+** Notes:
+**   1. This must be called by the app's main task prior to any other
+**      function and prior to creating any child tasks.
+**
+*/
+void MEM_MON_Constructor(MEM_MON_Class_t *MemMonPtr, INITBL_Class_t *IniTbl);
+
+
+/******************************************************************************
+** Function: MEM_MON_GetStackUsage
+**
+** Fill Usage with up to MaxCnt painted stacks and return the number filled.
+*/
+uint8 MEM_MON_GetStackUsage(TBL_SAT_StackUsage_t *Usage, uint8 MaxCnt);
+
+
+/******************************************************************************
+** Function: MEM_MON_PaintStack
+**
+** Register and paint the calling task's stack. Task and Instance identify
+** the task in telemetry.
+**
+** Notes:
+**   1. Must be called by the task that owns the stack, once, as early as
+**      possible so startup usage is measured.
+**
+*/
+void MEM_MON_PaintStack(TBL_SAT_MemTask_Enum_t Task, uint8 Instance);
+
+
+#endif /* _mem_mon_ */
@@ -0,0 +1,435 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Implement the PWM FIFO playback class
+**
+**  Notes:
+**    1. See pwm_fifo.h for details.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include "pwm_fifo.h"
+#include "mem_mon.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define REFILL_TASK_NAME   "TBL_SAT_PFIFO"
+#define REFILL_STACK_SIZE  8192
+#define START_SEM_NAME     "TBL_SAT_PFIFO"
+
+#define READ_CHUNK_LEN   128
+#define MAX_LINE_LEN     128
+
+
+/**********************/
+/** Global File Data **/
+/**********************/
+
+static PWM_FIFO_Class_t *PwmFifo = NULL;
+
+
+/*******************************/
+/** Local Function Prototypes **/
+/*******************************/
+
+static void FillFifo(void);
+static bool ParseLine(char *Line, uint32 LineNum, uint32 MaxValue);
+static void RefillTask(void);
+
+
+/******************************************************************************
+** Function: PWM_FIFO_Constructor
+**
+*/
+void PWM_FIFO_Constructor(PWM_FIFO_Class_t *PwmFifoPtr, uint32 TaskPriority)
+{
+
+   int32 Status;
+
+   PwmFifo = PwmFifoPtr;
+
+   memset(PwmFifo, 0, sizeof(PWM_FIFO_Class_t));
+
+   PwmFifo->State = PWM_FIFO_IDLE;
+
+   Status = OS_BinSemCreate(&PwmFifo->StartSem, START_SEM_NAME, 0, 0);
+   if (Status == OS_SUCCESS)
+   {
+      Status = CFE_ES_CreateChildTask(&PwmFifo->TaskId, REFILL_TASK_NAME, RefillTask,
+                                      CFE_ES_TASK_STACK_ALLOCATE, REFILL_STACK_SIZE,
+                                      TaskPriority, 0);
+      PwmFifo->TaskCreated = (Status == CFE_SUCCESS);
+   }
+
+   if (!PwmFifo->TaskCreated)
+   {
+      CFE_EVS_SendEvent (PWM_FIFO_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                         "PWM FIFO refill task creation failed. Status = 0x%08X",
+                         (unsigned int)Status);
+   }
+
+} /* End PWM_FIFO_Constructor() */
+
+
+/******************************************************************************
+** Function: PWM_FIFO_Active
+**
+*/
+bool PWM_FIFO_Active(void)
+{
+
+   return (PwmFifo != NULL && PwmFifo->State != PWM_FIFO_IDLE);
+
+} /* End PWM_FIFO_Active() */
+
+
+/******************************************************************************
+** Function: PWM_FIFO_LoadProfile
+**
+** Notes:
+**   1. The file is read in chunks so the only storage needed for a profile
+**      is the profile buffer itself.
+**   2. Lines longer than MAX_LINE_LEN are truncated.
+**
+*/
+bool PWM_FIFO_LoadProfile(const char *Filename, uint8 ChannelCnt, uint32 MaxValue)
+{
+
+   bool      RetStatus = true;
+   osal_id_t FileHandle;
+   int32     ReadLen, i;
+   char      Chunk[READ_CHUNK_LEN];
+   char      Line[MAX_LINE_LEN];
+   size_t    LineLen = 0;
+   uint32    LineNum = 0;
+
+   if (PWM_FIFO_Active())
+   {
+      CFE_EVS_SendEvent (PWM_FIFO_LOAD_EID, CFE_EVS_EventType_ERROR,
+                         "Load profile rejected, a profile is currently playing");
+      return false;
+   }
+
+   if (ChannelCnt == 0 || ChannelCnt > PWM_FIFO_MAX_CHANNEL)
+   {
+      CFE_EVS_SendEvent (PWM_FIFO_LOAD_EID, CFE_EVS_EventType_ERROR,
+                         "Load profile rejected, invalid channel count %d", ChannelCnt);
+      return false;
+   }
+
+   if (OS_OpenCreate(&FileHandle, Filename, OS_FILE_FLAG_NONE, OS_READ_ONLY) != OS_SUCCESS)
+   {
+      CFE_EVS_SendEvent (PWM_FIFO_LOAD_EID, CFE_EVS_EventType_ERROR,
+                         "Load profile open failed for %s", Filename);
+      return false;
+   }
+
+   PwmFifo->ChannelCnt = ChannelCnt;
+   PwmFifo->WordCnt    = 0;
+
+   while (RetStatus && (ReadLen = OS_read(FileHandle, Chunk, sizeof(Chunk))) > 0)
+   {
+      for (i=0; RetStatus && i < ReadLen; i++)
+      {
+         if (Chunk[i] == '\n')
+         {
+            Line[LineLen] = '\0';
+            RetStatus = ParseLine(Line, ++LineNum, MaxValue);
+            LineLen = 0;
+         }
+         else if (LineLen < (sizeof(Line)-1))
+         {
+            Line[LineLen++] = Chunk[i];
+         }
+      }
+   }
+
+   if (RetStatus && LineLen > 0)
+   {
+      Line[LineLen] = '\0';
+      RetStatus = ParseLine(Line, ++LineNum, MaxValue);
+   }
+
+   OS_close(FileHandle);
+
+   if (RetStatus && PwmFifo->WordCnt == 0)
+   {
+      CFE_EVS_SendEvent (PWM_FIFO_LOAD_EID, CFE_EVS_EventType_ERROR,
+                         "Load profile file %s doesn't contain any samples", Filename);
+      RetStatus = false;
+   }
+
+   if (RetStatus)
+   {
+      strncpy(PwmFifo->Filename, Filename, OS_MAX_PATH_LEN-1);
+      PwmFifo->Filename[OS_MAX_PATH_LEN-1] = '\0';
+   }
+   else
+   {
+      PwmFifo->WordCnt = 0;
+   }
+
+   return RetStatus;
+
+} /* End PWM_FIFO_LoadProfile() */
+
+
+/******************************************************************************
+** Function: PWM_FIFO_ResetStatus
+**
+*/
+void PWM_FIFO_ResetStatus(void)
+{
+
+   if (PwmFifo != NULL)
+   {
+      PwmFifo->UnderrunCnt = 0;
+   }
+
+} /* End PWM_FIFO_ResetStatus() */
+
+
+/******************************************************************************
+** Function: PWM_FIFO_Start
+**
+** Notes:
+**   1. The refill delay is half the time it takes the hardware to read a
+**      full FIFO, limited to at least 1ms.
+**
+*/
+bool PWM_FIFO_Start(uint32 WordPeriod, uint16 RepeatCnt)
+{
+
+   if (!PwmFifo->TaskCreated || PWM_FIFO_Active() || PwmFifo->WordCnt == 0)
+   {
+      CFE_EVS_SendEvent (PWM_FIFO_START_EID, CFE_EVS_EventType_ERROR,
+                         "Start playback rejected. Refill task created %d, active %d, profile words %d",
+                         PwmFifo->TaskCreated, PWM_FIFO_Active(), (unsigned int)PwmFifo->WordCnt);
+      return false;
+   }
+
+   PwmFifo->WordPeriod   = WordPeriod;
+   PwmFifo->RefillDelay  = (WordPeriod * (IO_REG_PWM_FIFO_DEPTH/2)) / 1000;
+   if (PwmFifo->RefillDelay == 0)
+   {
+      PwmFifo->RefillDelay = 1;
+   }
+
+   PwmFifo->RepeatCnt    = RepeatCnt;
+   PwmFifo->PassCnt      = 0;
+   PwmFifo->NextWord     = 0;
+   PwmFifo->WordsWritten = 0;
+   PwmFifo->StopReq      = false;
+   PwmFifo->State        = PWM_FIFO_PLAYING;
+
+   IO_REG_PwmFifoClear();
+   FillFifo();
+   IO_REG_PwmFifoStatus();  /* Discard error flags from the prefill */
+
+   CFE_EVS_SendEvent (PWM_FIFO_START_EID, CFE_EVS_EventType_INFORMATION,
+                      "Started playback of %s: %d words, %d channel(s), %d usec/word, repeat %d, refill every %d ms",
+                      PwmFifo->Filename, (unsigned int)PwmFifo->WordCnt, PwmFifo->ChannelCnt,
+                      (unsigned int)PwmFifo->WordPeriod, PwmFifo->RepeatCnt,
+                      (unsigned int)PwmFifo->RefillDelay);
+
+   OS_BinSemGive(PwmFifo->StartSem);
+
+   return true;
+
+} /* End PWM_FIFO_Start() */
+
+
+/******************************************************************************
+** Function: PWM_FIFO_Stop
+**
+*/
+void PWM_FIFO_Stop(void)
+{
+
+   if (PWM_FIFO_Active())
+   {
+      PwmFifo->StopReq = true;
+   }
+
+} /* End PWM_FIFO_Stop() */
+
+
+/******************************************************************************
+** Function: FillFifo
+**
+** Write profile words until the FIFO is full or the last pass has been
+** written.
+**
+** Notes:
+**   1. The status register is read directly rather than with
+**      IO_REG_PwmFifoStatus() so the error flags are preserved for the
+**      refill task's underrun check.
+**
+*/
+static void FillFifo(void)
+{
+
+   volatile uint32 *PwmBank = IO_REG_PwmBank();
+
+   while (PwmFifo->State == PWM_FIFO_PLAYING &&
+          !(PwmBank[IO_REG_PWM_STA] & IO_REG_PWM_STA_FULL1))
+   {
+
+      IO_REG_PwmFifoWrite(PwmFifo->Word[PwmFifo->NextWord++]);
+      PwmFifo->WordsWritten++;
+
+      if (PwmFifo->NextWord >= PwmFifo->WordCnt)
+      {
+         PwmFifo->NextWord = 0;
+         PwmFifo->PassCnt++;
+         if (PwmFifo->RepeatCnt != 0 && PwmFifo->PassCnt >= PwmFifo->RepeatCnt)
+         {
+            PwmFifo->State = PWM_FIFO_DRAINING;
+         }
+      }
+
+   } /* End while FIFO not full */
+
+} /* End FillFifo() */
+
+
+/******************************************************************************
+** Function: ParseLine
+**
+** Parse one profile line and append its values to the profile buffer.
+** Blank lines and comments are accepted without adding any values.
+*/
+static bool ParseLine(char *Line, uint32 LineNum, uint32 MaxValue)
+{
+
+   char  *Ptr = Line;
+   char  *End;
+   uint32 Value;
+   uint8  Channel;
+
+   while (isspace((unsigned char)*Ptr))
+   {
+      Ptr++;
+   }
+
+   if (*Ptr == '\0' || *Ptr == '#')
+   {
+      return true;
+   }
+
+   if ((PwmFifo->WordCnt + PwmFifo->ChannelCnt) > PWM_FIFO_MAX_WORDS)
+   {
+      CFE_EVS_SendEvent (PWM_FIFO_LOAD_EID, CFE_EVS_EventType_ERROR,
+                         "Load profile line %d exceeds the %d word profile buffer",
+                         (unsigned int)LineNum, PWM_FIFO_MAX_WORDS);
+      return false;
+   }
+
+   for (Channel=0; Channel < PwmFifo->ChannelCnt; Channel++)
+   {
+
+      Value = (uint32)strtoul(Ptr, &End, 10);
+
+      if (End == Ptr || Value > MaxValue)
+      {
+         CFE_EVS_SendEvent (PWM_FIFO_LOAD_EID, CFE_EVS_EventType_ERROR,
+                            "Load profile line %d requires %d values in [0,%d]",
+                            (unsigned int)LineNum, PwmFifo->ChannelCnt, (unsigned int)MaxValue);
+         return false;
+      }
+
+      PwmFifo->Word[PwmFifo->WordCnt + Channel] = Value;
+      Ptr = End;
+
+   }
+
+   PwmFifo->WordCnt += PwmFifo->ChannelCnt;
+
+   return true;
+
+} /* End ParseLine() */
+
+
+/******************************************************************************
+** Function: RefillTask
+**
+** Pend for a start request and then keep the FIFO topped up until the
+** profile has drained or a stop is requested.
+**
+** Notes:
+**   1. A read error while playing means the hardware found the FIFO empty
+**      before the profile was complete. The channel repeats its last value
+**      (RPTL) so the output holds rather than dropping to zero.
+**
+*/
+static void RefillTask(void)
+{
+
+   uint32 Status;
+
+   MEM_MON_PaintStack(TBL_SAT_MemTask_PWM_FIFO, 0);
+
+   while (OS_BinSemTake(PwmFifo->StartSem) == OS_SUCCESS)
+   {
+
+      while (PwmFifo->State != PWM_FIFO_IDLE)
+      {
+
+         Status = IO_REG_PwmFifoStatus();
+
+         if (PwmFifo->StopReq)
+         {
+            IO_REG_PwmFifoClear();
+            PwmFifo->State = PWM_FIFO_IDLE;
+            CFE_EVS_SendEvent (PWM_FIFO_STOP_EID, CFE_EVS_EventType_INFORMATION,
+                               "Playback stopped after %d words with %d underruns",
+                               (unsigned int)PwmFifo->WordsWritten, PwmFifo->UnderrunCnt);
+         }
+         else if (PwmFifo->State == PWM_FIFO_PLAYING)
+         {
+            if (Status & IO_REG_PWM_STA_RERR1)
+            {
+               PwmFifo->UnderrunCnt++;
+            }
+            FillFifo();
+         }
+         else if (Status & IO_REG_PWM_STA_EMPT1)
+         {
+            PwmFifo->State = PWM_FIFO_IDLE;
+            CFE_EVS_SendEvent (PWM_FIFO_STOP_EID, CFE_EVS_EventType_INFORMATION,
+                               "Playback completed %d passes, %d words with %d underruns",
+                               PwmFifo->PassCnt, (unsigned int)PwmFifo->WordsWritten, PwmFifo->UnderrunCnt);
+         }
+
+         if (PwmFifo->State != PWM_FIFO_IDLE)
+         {
+            OS_TaskDelay(PwmFifo->RefillDelay);
+         }
+
+      } /* End while active */
+
+   } /* End task loop */
+
+} /* End RefillTask() */
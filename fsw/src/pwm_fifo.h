@@ -0,0 +1,188 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Define the PWM FIFO playback class
+**
+**  Notes:
+**    1. Use the Singleton design pattern. The object is owned by RIG_MGR
+**       and used by the FAN object that owns the hardware PWM channels. The
+**       FAN object converts profiles to register values and switches the
+**       channels between data and FIFO modes.
+**    2. A profile is a precomputed sequence of PWM commands such as a test
+**       sweep, a chirp or a timed slew. The PWM block reads one FIFO word at
+**       the start of each PWM period so the sample timing is set by the
+**       hardware and not by the scheduler.
+**    3. A refill child task tops up the FIFO from the profile buffer. It
+**       sleeps for half the time it takes the hardware to drain the FIFO so
+**       the CPU wakes once per batch of samples instead of once per sample.
+**    4. Profile files are text with one sample per line and one whitespace
+**       separated value per FIFO channel. Blank lines and lines starting
+**       with '#' are ignored. When both hardware channels are used the
+**       values are interleaved in the FIFO starting with channel 0.
+**
+*/
+
+#ifndef _pwm_fifo_
+#define _pwm_fifo_
+
+/*
+** Includes
+*/
+
+#include "app_cfg.h"
+#include "io_reg.h"
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define PWM_FIFO_MAX_CHANNEL   2
+#define PWM_FIFO_MAX_WORDS  8192  /* Profile buffer size, both channels */
+
+#define PWM_FIFO_CLK_HZ  19200000  /* PWM clock source before the divisor */
+
+/*
+** Event Message IDs
+*/
+
+#define PWM_FIFO_CONSTRUCTOR_EID  (PWM_FIFO_BASE_EID + 0)
+#define PWM_FIFO_LOAD_EID         (PWM_FIFO_BASE_EID + 1)
+#define PWM_FIFO_START_EID        (PWM_FIFO_BASE_EID + 2)
+#define PWM_FIFO_STOP_EID         (PWM_FIFO_BASE_EID + 3)
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+typedef enum
+{
+
+   PWM_FIFO_IDLE     = 0,
+   PWM_FIFO_PLAYING  = 1,
+   PWM_FIFO_DRAINING = 2   /* Profile written, waiting for the FIFO to empty */
+
+} PWM_FIFO_State_t;
+
+
+/******************************************************************************
+** PWM_FIFO_Class
+*/
+
+typedef struct
+{
+
+   /*
+   ** Class State Data
+   */
+
+   volatile uint8  State;     /* PWM_FIFO_State_t */
+   volatile bool   StopReq;
+
+   bool            TaskCreated;
+   osal_id_t       StartSem;
+   CFE_ES_TaskId_t TaskId;
+
+   uint8   ChannelCnt;        /* FIFO words per sample */
+   uint32  WordPeriod;        /* Microseconds the hardware takes to read one word */
+   uint32  RefillDelay;       /* Milliseconds between refills */
+
+   uint16  RepeatCnt;         /* Number of passes, zero repeats until stopped */
+   uint16  PassCnt;
+   uint32  NextWord;
+   uint32  WordsWritten;
+   uint16  UnderrunCnt;
+
+   char    Filename[OS_MAX_PATH_LEN];
+
+   /*
+   ** Profile buffer. Loaded in command units and converted in place to
+   ** register values by the owner before playback starts.
+   */
+
+   uint32  WordCnt;
+   uint32  Word[PWM_FIFO_MAX_WORDS];
+
+} PWM_FIFO_Class_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: PWM_FIFO_Constructor
+**
+** Initialize the PWM FIFO object and create the refill child task.
+**
+** Notes:
+**   1. This must be called prior to any other function.
+**   2. Only construct the object when the PWM peripheral is mapped.
+**
+*/
+void PWM_FIFO_Constructor(PWM_FIFO_Class_t *PwmFifoPtr, uint32 TaskPriority);
+
+
+/******************************************************************************
+** Function: PWM_FIFO_Active
+**
+** Return true while a profile is playing or the FIFO is draining.
+*/
+bool PWM_FIFO_Active(void);
+
+
+/******************************************************************************
+** Function: PWM_FIFO_LoadProfile
+**
+** Load a profile file into the profile buffer. ChannelCnt is the number of
+** values required on each line and every value must be <= MaxValue.
+** Returns true if the file was successfully loaded.
+*/
+bool PWM_FIFO_LoadProfile(const char *Filename, uint8 ChannelCnt, uint32 MaxValue);
+
+
+/******************************************************************************
+** Function: PWM_FIFO_ResetStatus
+**
+** Reset counters and status flags to a known reset state.
+*/
+void PWM_FIFO_ResetStatus(void);
+
+
+/******************************************************************************
+** Function: PWM_FIFO_Start
+**
+** Clear and prefill the FIFO and start the refill task. WordPeriod is the
+** number of microseconds the hardware takes to read one FIFO word. A
+** RepeatCnt of zero plays the profile until PWM_FIFO_Stop() is called.
+**
+** Notes:
+**   1. Call this before the PWM channels are switched to FIFO mode so the
+**      hardware never reads an empty FIFO.
+**
+*/
+bool PWM_FIFO_Start(uint32 WordPeriod, uint16 RepeatCnt);
+
+
+/******************************************************************************
+** Function: PWM_FIFO_Stop
+**
+** Request the refill task to stop playback and clear the FIFO.
+*/
+void PWM_FIFO_Stop(void);
+
+
+#endif /* _pwm_fifo_ */
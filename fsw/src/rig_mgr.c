@@ -0,0 +1,1223 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Implement the rig manager class
+**
+**  Notes:
+**    1. See rig_mgr.h for details.
+**    2. The static "RigDefData" serves as the rig definition file load
+**       buffer. It's copied to the rig manager after the definitions have
+**       been validated.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+#include <time.h>
+#include "rig_mgr.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define RIG_DEF_JSON_OBJ(Rig, Field, Type, Key) \
+   { &RigDefData[Rig].Field, sizeof(RigDefData[Rig].Field), false, Type, false, \
+     { "rig[" #Rig "]." Key, (sizeof("rig[" #Rig "]." Key)-1)} }
+
+#define RIG_DEF_JSON_OBJS(Rig) \
+   RIG_DEF_JSON_OBJ(Rig, Name,             JSONString, "name"),               \
+   RIG_DEF_JSON_OBJ(Rig, Worker,           JSONNumber, "worker"),             \
+   RIG_DEF_JSON_OBJ(Rig, SensorTlmTopicId, JSONNumber, "sensor-tlm-topicid"), \
+   RIG_DEF_JSON_OBJ(Rig, SatCtrlTbl,       JSONString, "sat-ctrl-tbl"),       \
+   RIG_DEF_JSON_OBJ(Rig, FanCnt,           JSONNumber, "fan-cnt"),            \
+   RIG_DEF_JSON_OBJ(Rig, FanPwmBcmId,      JSONString, "fan-pwm-bcm-id"),     \
+   RIG_DEF_JSON_OBJ(Rig, FanTachBcmId,     JSONString, "fan-tach-bcm-id"),    \
+   RIG_DEF_JSON_OBJ(Rig, FanTbl,           JSONString, "fan-tbl"),            \
+   RIG_DEF_JSON_OBJ(Rig, SensorTbl,        JSONString, "sensor-tbl")
+
+#define RIG_DEF_JSON_OBJ_CNT  9
+
+
+/************************************/
+/** Local File Function Prototypes **/
+/************************************/
+
+static void   ConstructRigs(void);
+static void   CreateVibMon(void);
+static int32  CreateWorkers(void);
+static void   DispatchSensorTlm(RIG_MGR_Worker_t *Worker, const CFE_SB_Buffer_t *SbBufPtr, uint64 Now);
+static RIG_MGR_Worker_t *FindWorker(const CHILDMGR_Class_t *ChildMgr);
+static bool   LoadRigDefJsonData(size_t JsonFileLen);
+static uint64 NowMs(bool SimClock);
+static bool   PostCmd(uint8 Rig, const SEQ_TBL_Entry_t *Cmd);
+static void   WakeRig(uint8 Rig);
+static bool   TblRigValid(void);
+static bool   ValidRig(uint8 Rig, const char *CmdName);
+static bool   VibMonTask(CHILDMGR_Class_t *ChildMgr);
+static bool   WorkerTask(CHILDMGR_Class_t *ChildMgr);
+static int32  WorkerTimeout(const RIG_MGR_Worker_t *Worker, uint64 Now);
+
+/* Table manager callbacks, must match TBLMGR_DumpTblFuncPtr_t and TBLMGR_LoadTblFuncPtr_t */
+static bool   DumpFanTbl(osal_id_t FileHandle);
+static bool   DumpSatCtrlTbl(osal_id_t FileHandle);
+static bool   DumpSensorTbl(osal_id_t FileHandle);
+static bool   DumpSeqTbl(osal_id_t FileHandle);
+static bool   LoadFanTbl(APP_C_FW_TblLoadOptions_Enum_t LoadType, const char *Filename);
+static bool   LoadSatCtrlTbl(APP_C_FW_TblLoadOptions_Enum_t LoadType, const char *Filename);
+static bool   LoadSeqTbl(APP_C_FW_TblLoadOptions_Enum_t LoadType, const char *Filename);
+static bool   LoadSensorTbl(APP_C_FW_TblLoadOptions_Enum_t LoadType, const char *Filename);
+
+
+/**********************/
+/** Global File Data **/
+/**********************/
+
+static RIG_MGR_Class_t *RigMgr = NULL;
+
+static RIG_MGR_RigDef_t RigDefData[RIG_MGR_MAX_RIG];  /* Working buffer for loads */
+static char JsonBuf[RIG_MGR_JSON_FILE_MAX_CHAR];
+
+static CJSON_Obj_t JsonRigDefObjs[] = {
+
+   /* One entry per rig, must be kept in sync with RIG_MGR_MAX_RIG */
+   RIG_DEF_JSON_OBJS(0),
+   RIG_DEF_JSON_OBJS(1),
+   RIG_DEF_JSON_OBJS(2),
+   RIG_DEF_JSON_OBJS(3)
+
+};
+
+
+/******************************************************************************
+** Function: RIG_MGR_Constructor
+**
+** Notes:
+**   1. The shared hardware services must be constructed before the rigs and
+**      tach capture can only start after every rig has added its lines.
+**   2. Table IDs are defined by the registration order and must match the
+**      EDS TblId definition. New tables are appended so existing IDs used
+**      by ground procedures don't change.
+**
+*/
+int32 RIG_MGR_Constructor(RIG_MGR_Class_t *RigMgrPtr, INITBL_Class_t *IniTbl,
+                          TBLMGR_Class_t *TblMgr)
+{
+
+   const char *RigDefFile = INITBL_GetStrConfig(IniTbl, CFG_RIG_DEF_FILE);
+   int32 RetStatus;
+
+   RigMgr = RigMgrPtr;
+
+   memset(RigMgr, 0, sizeof(RIG_MGR_Class_t));
+
+   RigMgr->IniTbl     = IniTbl;
+   RigMgr->ExecPeriod = INITBL_GetIntConfig(IniTbl, CFG_SAT_CTRL_PERIOD);
+   RigMgr->WorkerCnt  = INITBL_GetIntConfig(IniTbl, CFG_RIG_WORKER_CNT);
+   RigMgr->VibMonPeriod = INITBL_GetIntConfig(IniTbl, CFG_VIB_MON_PERIOD);
+
+   if (RigMgr->WorkerCnt == 0 || RigMgr->WorkerCnt > RIG_MGR_MAX_WORKER)
+   {
+      CFE_EVS_SendEvent (RIG_MGR_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                         "Invalid worker count %d. Must be in [1,%d], using 1",
+                         RigMgr->WorkerCnt, RIG_MGR_MAX_WORKER);
+      RigMgr->WorkerCnt = 1;
+   }
+
+   if (!CJSON_ProcessFile(RigDefFile, JsonBuf, RIG_MGR_JSON_FILE_MAX_CHAR, LoadRigDefJsonData))
+   {
+      CFE_EVS_SendEvent (RIG_MGR_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                         "Rig definition file %s load failed, no rigs will be controlled", RigDefFile);
+   }
+
+   if (IO_REG_MapGpio()) // map peripherals
+   {
+
+      RigMgr->GpioMapped = true;
+      RigMgr->PwmMapped  = IO_REG_MapPwm();
+
+      if (!RigMgr->PwmMapped)
+      {
+         CFE_EVS_SendEvent (RIG_MGR_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                            "PWM mapping failed. Verify chip selection in rpi_iolib config.h and PWM pin assignments in the rig definition file");
+      }
+
+   }
+   else
+   {
+      CFE_EVS_SendEvent (RIG_MGR_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                         "GPIO mapping failed. Verify chip selection in rpi_iolib config.h");
+
+   } /* End if IO mapped */
+
+   TACH_Constructor(&RigMgr->Tach, IniTbl);
+
+   if (RigMgr->PwmMapped)
+   {
+      PWM_FIFO_Constructor(&RigMgr->PwmFifo, INITBL_GetIntConfig(IniTbl, CFG_FAN_PWM_FIFO_PRIORITY));
+   }
+
+   ConstructRigs();
+
+   SIM_HW_Constructor(&RigMgr->SimHw, IniTbl, RigMgr->RigCnt);
+   SHM_EXPORT_Constructor(&RigMgr->ShmExport, INITBL_GetStrConfig(IniTbl, CFG_SHM_EXPORT_NAME), RigMgr->RigCnt);
+
+   TACH_Start(IniTbl);
+
+   TBLMGR_RegisterTbl(TblMgr, SAT_CTRL_TBL_NAME, LoadSatCtrlTbl, DumpSatCtrlTbl);
+   TBLMGR_RegisterTbl(TblMgr, SENSOR_TBL_NAME, LoadSensorTbl, DumpSensorTbl);
+   TBLMGR_RegisterTbl(TblMgr, FAN_TBL_NAME, LoadFanTbl, DumpFanTbl);
+   TBLMGR_RegisterTbl(TblMgr, SEQ_TBL_NAME, LoadSeqTbl, DumpSeqTbl);
+
+   RetStatus = CreateWorkers();
+   CreateVibMon();
+
+   return RetStatus;
+
+} /* End RIG_MGR_Constructor() */
+
+
+/******************************************************************************
+** Function: RIG_MGR_ResetStatus
+**
+*/
+void RIG_MGR_ResetStatus(void)
+{
+
+   uint8 i;
+
+   for (i=0; i < RigMgr->WorkerCnt; i++)
+   {
+      CHILDMGR_ResetStatus(&RigMgr->Worker[i].ChildMgr);
+      RigMgr->Worker[i].PipeErrCnt     = 0;
+      RigMgr->Worker[i].PipePeakMsgCnt = 0;
+      RigMgr->Worker[i].PipePeakBytes  = 0;
+   }
+
+   for (i=0; i < RigMgr->RigCnt; i++)
+   {
+      SAT_CTRL_ResetStatus(&RigMgr->Rig[i]);
+      FAULT_INJ_ResetStatus(&RigMgr->FaultInj[i]);
+   }
+
+   PWM_FIFO_ResetStatus();
+   TACH_ResetStatus();
+
+} /* End RIG_MGR_ResetStatus() */
+
+
+/******************************************************************************
+** Function: RIG_MGR_AbortSeqCmd
+**
+*/
+bool RIG_MGR_AbortSeqCmd(void *DataObjPtr, const CFE_MSG_Message_t *MsgPtr)
+{
+
+   const TBL_SAT_AbortSeq_CmdPayload_t *AbortSeq = CMDMGR_PAYLOAD_PTR(MsgPtr, TBL_SAT_AbortSeq_t);
+
+   if (!ValidRig(AbortSeq->Rig, "Abort sequence"))
+   {
+      return false;
+   }
+
+   if (!SEQ_Abort(&RigMgr->Rig[AbortSeq->Rig].Seq))
+   {
+      return false;
+   }
+
+   WakeRig(AbortSeq->Rig);
+
+   return true;
+
+} /* End RIG_MGR_AbortSeqCmd() */
+
+
+/******************************************************************************
+** Function: RIG_MGR_OverrideFanPwmCmd
+**
+*/
+bool RIG_MGR_OverrideFanPwmCmd(void *DataObjPtr, const CFE_MSG_Message_t *MsgPtr)
+{
+
+   const TBL_SAT_OverrideFanPwm_CmdPayload_t *OverrideCmd = CMDMGR_PAYLOAD_PTR(MsgPtr, TBL_SAT_OverrideFanPwm_t);
+   SEQ_TBL_Entry_t Cmd;
+
+   if (!ValidRig(OverrideCmd->Rig, "Override fan PWM"))
+   {
+      return false;
+   }
+
+   memset(&Cmd, 0, sizeof(SEQ_TBL_Entry_t));
+   Cmd.Cmd      = SEQ_TBL_CMD_OVERRIDE_FAN_PWM;
+   Cmd.Duration = OverrideCmd->Duration;
+   Cmd.FanAPwm  = OverrideCmd->FanAPwm;
+   Cmd.FanBPwm  = OverrideCmd->FanBPwm;
+
+   return PostCmd(OverrideCmd->Rig, &Cmd);
+
+} /* End RIG_MGR_OverrideFanPwmCmd() */
+
+
+/******************************************************************************
+** Function: RIG_MGR_PauseSeqCmd
+**
+*/
+bool RIG_MGR_PauseSeqCmd(void *DataObjPtr, const CFE_MSG_Message_t *MsgPtr)
+{
+
+   const TBL_SAT_PauseSeq_CmdPayload_t *PauseSeq = CMDMGR_PAYLOAD_PTR(MsgPtr, TBL_SAT_PauseSeq_t);
+
+   if (!ValidRig(PauseSeq->Rig, "Pause sequence"))
+   {
+      return false;
+   }
+
+   if (!SEQ_Pause(&RigMgr->Rig[PauseSeq->Rig].Seq))
+   {
+      return false;
+   }
+
+   WakeRig(PauseSeq->Rig);
+
+   return true;
+
+} /* End RIG_MGR_PauseSeqCmd() */
+
+
+/******************************************************************************
+** Function: RIG_MGR_SetCtrlGainsCmd
+**
+*/
+bool RIG_MGR_SetCtrlGainsCmd(void *DataObjPtr, const CFE_MSG_Message_t *MsgPtr)
+{
+
+   const TBL_SAT_SetCtrlGains_CmdPayload_t *SetCtrlGains = CMDMGR_PAYLOAD_PTR(MsgPtr, TBL_SAT_SetCtrlGains_t);
+   SEQ_TBL_Entry_t Cmd;
+
+   if (!ValidRig(SetCtrlGains->Rig, "Set control gains"))
+   {
+      return false;
+   }
+
+   memset(&Cmd, 0, sizeof(SEQ_TBL_Entry_t));
+   Cmd.Cmd      = SEQ_TBL_CMD_SET_CTRL_GAINS;
+   Cmd.PosGain  = SetCtrlGains->PosGain;
+   Cmd.RateGain = SetCtrlGains->RateGain;
+
+   return PostCmd(SetCtrlGains->Rig, &Cmd);
+
+} /* End RIG_MGR_SetCtrlGainsCmd() */
+
+
+/******************************************************************************
+** Function: RIG_MGR_SetCtrlModeCmd
+**
+*/
+bool RIG_MGR_SetCtrlModeCmd(void *DataObjPtr, const CFE_MSG_Message_t *MsgPtr)
+{
+
+   const TBL_SAT_SetCtrlMode_CmdPayload_t *SetCtrlMode = CMDMGR_PAYLOAD_PTR(MsgPtr, TBL_SAT_SetCtrlMode_t);
+   SEQ_TBL_Entry_t Cmd;
+
+   if (!ValidRig(SetCtrlMode->Rig, "Set control mode"))
+   {
+      return false;
+   }
+
+   if (SetCtrlMode->NewMode < TBL_SAT_CtrlMode_IDLE || SetCtrlMode->NewMode > TBL_SAT_CtrlMode_SUN_ACQ)
+   {
+      CFE_EVS_SendEvent (RIG_MGR_CMD_EID, CFE_EVS_EventType_ERROR,
+                         "Set control mode command rejected, mode %d must be in [%d,%d]",
+                         SetCtrlMode->NewMode, TBL_SAT_CtrlMode_IDLE, TBL_SAT_CtrlMode_SUN_ACQ);
+      return false;
+   }
+
+   memset(&Cmd, 0, sizeof(SEQ_TBL_Entry_t));
+   Cmd.Cmd  = SEQ_TBL_CMD_SET_CTRL_MODE;
+   Cmd.Mode = SetCtrlMode->NewMode;
+
+   return PostCmd(SetCtrlMode->Rig, &Cmd);
+
+} /* End RIG_MGR_SetCtrlModeCmd() */
+
+
+/******************************************************************************
+** Function: RIG_MGR_SetSensorFaultCmd
+**
+*/
+bool RIG_MGR_SetSensorFaultCmd(void *DataObjPtr, const CFE_MSG_Message_t *MsgPtr)
+{
+
+   const TBL_SAT_SetSensorFault_CmdPayload_t *SetSensorFault = CMDMGR_PAYLOAD_PTR(MsgPtr, TBL_SAT_SetSensorFault_t);
+   FAULT_INJ_Config_t Config;
+
+   if (!ValidRig(SetSensorFault->Rig, "Set sensor fault"))
+   {
+      return false;
+   }
+
+   Config.DropPct    = SetSensorFault->DropPct;
+   Config.DropBurst  = SetSensorFault->DropBurst;
+   Config.DupPct     = SetSensorFault->DupPct;
+   Config.ReorderPct = SetSensorFault->ReorderPct;
+   Config.SpikePct   = SetSensorFault->SpikePct;
+   Config.DelayMs    = SetSensorFault->DelayMs;
+   Config.JitterMs   = SetSensorFault->JitterMs;
+   Config.SpikeRate  = SetSensorFault->SpikeRate;
+   Config.SpikeLux   = SetSensorFault->SpikeLux;
+   Config.Seed       = SetSensorFault->Seed;
+
+   return FAULT_INJ_Configure(&RigMgr->FaultInj[SetSensorFault->Rig], &Config);
+
+} /* End RIG_MGR_SetSensorFaultCmd() */
+
+
+/******************************************************************************
+** Function: RIG_MGR_SetTblRigCmd
+**
+*/
+bool RIG_MGR_SetTblRigCmd(void *DataObjPtr, const CFE_MSG_Message_t *MsgPtr)
+{
+
+   const TBL_SAT_SetTblRig_CmdPayload_t *SetTblRig = CMDMGR_PAYLOAD_PTR(MsgPtr, TBL_SAT_SetTblRig_t);
+
+   if (!ValidRig(SetTblRig->Rig, "Set table rig"))
+   {
+      return false;
+   }
+
+   RigMgr->TblRig = SetTblRig->Rig;
+
+   CFE_EVS_SendEvent (RIG_MGR_CMD_EID, CFE_EVS_EventType_INFORMATION,
+                      "Table load and dump commands now apply to rig %d (%s)",
+                      RigMgr->TblRig, RigMgr->RigDef[RigMgr->TblRig].Name);
+
+   return true;
+
+} /* End RIG_MGR_SetTblRigCmd() */
+
+
+/******************************************************************************
+** Function: RIG_MGR_StartPwmPlaybackCmd
+**
+*/
+bool RIG_MGR_StartPwmPlaybackCmd(void *DataObjPtr, const CFE_MSG_Message_t *MsgPtr)
+{
+
+   const TBL_SAT_StartPwmPlayback_CmdPayload_t *PlaybackCmd = CMDMGR_PAYLOAD_PTR(MsgPtr, TBL_SAT_StartPwmPlayback_t);
+   SEQ_TBL_Entry_t Cmd;
+
+   if (!ValidRig(PlaybackCmd->Rig, "Start PWM playback"))
+   {
+      return false;
+   }
+
+   if (!FAN_ValidPwmPlayback(&RigMgr->Rig[PlaybackCmd->Rig].Fan))
+   {
+      return false;
+   }
+
+   memset(&Cmd, 0, sizeof(SEQ_TBL_Entry_t));
+   Cmd.Cmd       = SEQ_TBL_CMD_START_PWM_PLAYBACK;
+   Cmd.RepeatCnt = PlaybackCmd->RepeatCnt;
+   strncpy(Cmd.Filename, PlaybackCmd->Filename, OS_MAX_PATH_LEN-1);
+
+   return PostCmd(PlaybackCmd->Rig, &Cmd);
+
+} /* End RIG_MGR_StartPwmPlaybackCmd() */
+
+
+/******************************************************************************
+** Function: RIG_MGR_StartSeqCmd
+**
+*/
+bool RIG_MGR_StartSeqCmd(void *DataObjPtr, const CFE_MSG_Message_t *MsgPtr)
+{
+
+   const TBL_SAT_StartSeq_CmdPayload_t *StartSeq = CMDMGR_PAYLOAD_PTR(MsgPtr, TBL_SAT_StartSeq_t);
+
+   if (!ValidRig(StartSeq->Rig, "Start sequence"))
+   {
+      return false;
+   }
+
+   if (!SEQ_Start(&RigMgr->Rig[StartSeq->Rig].Seq))
+   {
+      return false;
+   }
+
+   WakeRig(StartSeq->Rig);
+
+   return true;
+
+} /* End RIG_MGR_StartSeqCmd() */
+
+
+/******************************************************************************
+** Function: RIG_MGR_StopPwmPlaybackCmd
+**
+*/
+bool RIG_MGR_StopPwmPlaybackCmd(void *DataObjPtr, const CFE_MSG_Message_t *MsgPtr)
+{
+
+   const TBL_SAT_StopPwmPlayback_CmdPayload_t *PlaybackCmd = CMDMGR_PAYLOAD_PTR(MsgPtr, TBL_SAT_StopPwmPlayback_t);
+   SEQ_TBL_Entry_t Cmd;
+
+   if (!ValidRig(PlaybackCmd->Rig, "Stop PWM playback"))
+   {
+      return false;
+   }
+
+   memset(&Cmd, 0, sizeof(SEQ_TBL_Entry_t));
+   Cmd.Cmd = SEQ_TBL_CMD_STOP_PWM_PLAYBACK;
+
+   return PostCmd(PlaybackCmd->Rig, &Cmd);
+
+} /* End RIG_MGR_StopPwmPlaybackCmd() */
+
+
+/******************************************************************************
+** Function: ConstructRigs
+**
+*/
+static void ConstructRigs(void)
+{
+
+   uint8 i;
+   RIG_MGR_RigDef_t  *RigDef;
+   RIG_MGR_Worker_t  *Worker;
+   SAT_CTRL_Config_t  Config;
+
+   for (i=0; i < RigMgr->RigCnt; i++)
+   {
+
+      RigDef = &RigMgr->RigDef[i];
+
+      Config.RigIdx            = i;
+      Config.Name              = RigDef->Name;
+      Config.SensorTlmTopicId  = RigDef->SensorTlmTopicId;
+      Config.TblFilename       = RigDef->SatCtrlTbl;
+      Config.SensorTblFilename = RigDef->SensorTbl;
+      Config.Fan.RigIdx        = i;
+      Config.Fan.FanCnt        = (uint8)RigDef->FanCnt;
+      Config.Fan.PwmBcmId      = RigDef->FanPwmBcmId;
+      Config.Fan.TachBcmId     = RigDef->FanTachBcmId;
+      Config.Fan.TblFilename   = RigDef->FanTbl;
+      Config.Fan.GpioMapped    = RigMgr->GpioMapped;
+      Config.Fan.PwmMapped     = RigMgr->PwmMapped;
+      Config.Fan.PwmFifo       = RigMgr->PwmMapped ? &RigMgr->PwmFifo : NULL;
+
+      SAT_CTRL_Constructor(&RigMgr->Rig[i], RigMgr->IniTbl, &Config);
+      FAULT_INJ_Constructor(&RigMgr->FaultInj[i], i);
+
+      Worker = &RigMgr->Worker[RigDef->Worker];
+      Worker->Rig[Worker->RigCnt++] = i;
+
+      CFE_EVS_SendEvent (RIG_MGR_CONSTRUCTOR_EID, CFE_EVS_EventType_INFORMATION,
+                         "Rig %d (%s) constructed with %d fans on worker %d using sensor topic ID %d",
+                         i, RigDef->Name, RigMgr->Rig[i].Fan.FanCnt, RigDef->Worker,
+                         (int)RigDef->SensorTlmTopicId);
+
+   } /* End rig loop */
+
+} /* End ConstructRigs() */
+
+
+/******************************************************************************
+** Function: CreateVibMon
+**
+** Create the vibration monitor background task unless its period is 0.
+*/
+static void CreateVibMon(void)
+{
+
+   CHILDMGR_TaskInit_t ChildTaskInit;
+
+   if (RigMgr->VibMonPeriod == 0)
+   {
+      CFE_EVS_SendEvent (RIG_MGR_CONSTRUCTOR_EID, CFE_EVS_EventType_INFORMATION,
+                         "Vibration monitor disabled, rate notches are inactive");
+      return;
+   }
+
+   /* Constructor sends error events */
+   ChildTaskInit.TaskName  = INITBL_GetStrConfig(RigMgr->IniTbl, CFG_VIB_MON_NAME);
+   ChildTaskInit.PerfId    = INITBL_GetIntConfig(RigMgr->IniTbl, CFG_VIB_MON_PERF_ID);
+   ChildTaskInit.StackSize = INITBL_GetIntConfig(RigMgr->IniTbl, CFG_VIB_MON_STACK_SIZE);
+   ChildTaskInit.Priority  = INITBL_GetIntConfig(RigMgr->IniTbl, CFG_VIB_MON_PRIORITY);
+   CHILDMGR_Constructor(&RigMgr->VibMonChildMgr,
+                        ChildMgr_TaskMainCallback,
+                        VibMonTask,
+                        &ChildTaskInit);
+
+} /* End CreateVibMon() */
+
+
+/******************************************************************************
+** Function: CreateWorkers
+**
+** Notes:
+**   1. Worker 0 uses the ini file's task and pipe names. Additional workers
+**      append their index to the names and to the child perf ID.
+**   2. A worker's pipe must exist before its task is created.
+**
+*/
+static int32 CreateWorkers(void)
+{
+
+   int32  RetStatus = CFE_SUCCESS;
+   int32  Status;
+   uint8  w, i;
+   RIG_MGR_Worker_t   *Worker;
+   CHILDMGR_TaskInit_t ChildTaskInit;
+
+   for (w=0; w < RigMgr->WorkerCnt; w++)
+   {
+
+      Worker = &RigMgr->Worker[w];
+
+      if (w == 0)
+      {
+         strncpy(Worker->TaskName, INITBL_GetStrConfig(RigMgr->IniTbl, CFG_CHILD_NAME), OS_MAX_API_NAME-1);
+         strncpy(Worker->PipeName, INITBL_GetStrConfig(RigMgr->IniTbl, CFG_SAT_CTRL_MQTT_PIPE_NAME), OS_MAX_API_NAME-1);
+      }
+      else
+      {
+         snprintf(Worker->TaskName, OS_MAX_API_NAME, "%.*s%d", OS_MAX_API_NAME-3,
+                  INITBL_GetStrConfig(RigMgr->IniTbl, CFG_CHILD_NAME), w);
+         snprintf(Worker->PipeName, OS_MAX_API_NAME, "%.*s%d", OS_MAX_API_NAME-3,
+                  INITBL_GetStrConfig(RigMgr->IniTbl, CFG_SAT_CTRL_MQTT_PIPE_NAME), w);
+      }
+
+      Worker->PipeDepth = INITBL_GetIntConfig(RigMgr->IniTbl, CFG_SAT_CTRL_MQTT_PIPE_DEPTH);
+      Status = CFE_SB_CreatePipe(&Worker->MqttPipe, Worker->PipeDepth, Worker->PipeName);
+      Worker->PipeCreated = (Status == CFE_SUCCESS);
+
+      Worker->WakeupMid = CFE_SB_ValueToMsgId(INITBL_GetIntConfig(RigMgr->IniTbl, CFG_TBL_SAT_WAKEUP_TOPICID) + w);
+      CFE_MSG_Init(CFE_MSG_PTR(Worker->WakeupMsg), Worker->WakeupMid, sizeof(CFE_MSG_TelemetryHeader_t));
+
+      if (Worker->PipeCreated)
+      {
+         CFE_SB_Subscribe(Worker->WakeupMid, Worker->MqttPipe);
+         for (i=0; i < Worker->RigCnt; i++)
+         {
+            CFE_SB_Subscribe(RigMgr->Rig[Worker->Rig[i]].MqttSensorTlmMid, Worker->MqttPipe);
+         }
+      }
+      else
+      {
+         CFE_EVS_SendEvent (RIG_MGR_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                            "Worker %d SB pipe %s creation failed. Status = 0x%08X",
+                            w, Worker->PipeName, (unsigned int)Status);
+      }
+
+      /* Constructor sends error events */
+      ChildTaskInit.TaskName  = Worker->TaskName;
+      ChildTaskInit.PerfId    = INITBL_GetIntConfig(RigMgr->IniTbl, CFG_CHILD_PERF_ID) + w;
+      ChildTaskInit.StackSize = INITBL_GetIntConfig(RigMgr->IniTbl, CFG_CHILD_STACK_SIZE);
+      ChildTaskInit.Priority  = INITBL_GetIntConfig(RigMgr->IniTbl, CFG_CHILD_PRIORITY);
+      Status = CHILDMGR_Constructor(&Worker->ChildMgr,
+                                    ChildMgr_TaskMainCallback,
+                                    WorkerTask,
+                                    &ChildTaskInit);
+      if (Status != CFE_SUCCESS)
+      {
+         RetStatus = Status;
+      }
+
+   } /* End worker loop */
+
+   return RetStatus;
+
+} /* End CreateWorkers() */
+
+
+/******************************************************************************
+** Function: DispatchSensorTlm
+**
+** Route a sensor message to its rig's fault injection stage, which returns
+** it for immediate delivery when injection is disabled. Wakeup messages only
+** end the worker's pend.
+*/
+static void DispatchSensorTlm(RIG_MGR_Worker_t *Worker, const CFE_SB_Buffer_t *SbBufPtr, uint64 Now)
+{
+
+   CFE_SB_MsgId_t  MsgId = CFE_SB_INVALID_MSG_ID;
+   uint8  i;
+
+   if (CFE_MSG_GetMsgId(&SbBufPtr->Msg, &MsgId) == CFE_SUCCESS)
+   {
+
+      if (CFE_SB_MsgId_Equal(MsgId, Worker->WakeupMid))
+      {
+         return;
+      }
+
+      for (i=0; i < Worker->RigCnt; i++)
+      {
+         if (CFE_SB_MsgId_Equal(MsgId, RigMgr->Rig[Worker->Rig[i]].MqttSensorTlmMid))
+         {
+            if (FAULT_INJ_Input(&RigMgr->FaultInj[Worker->Rig[i]], &SbBufPtr->Msg, Now))
+            {
+               SAT_CTRL_SetSensorTlm(&RigMgr->Rig[Worker->Rig[i]], &SbBufPtr->Msg);
+            }
+            return;
+         }
+      }
+
+      CFE_EVS_SendEvent(RIG_MGR_WORKER_EID, CFE_EVS_EventType_ERROR,
+                        "%s received invalid MQTT packet, MID = 0x%04X",
+                        Worker->TaskName, CFE_SB_MsgIdToValue(MsgId));
+
+   } /* End if got message ID */
+
+} /* End DispatchSensorTlm() */
+
+
+/******************************************************************************
+** Function: FindWorker
+**
+** Return the worker that owns a child manager or NULL if none do.
+*/
+static RIG_MGR_Worker_t *FindWorker(const CHILDMGR_Class_t *ChildMgr)
+{
+
+   uint8 w;
+
+   for (w=0; w < RigMgr->WorkerCnt; w++)
+   {
+      if (&RigMgr->Worker[w].ChildMgr == ChildMgr)
+      {
+         return &RigMgr->Worker[w];
+      }
+   }
+
+   return NULL;
+
+} /* End FindWorker() */
+
+
+/******************************************************************************
+** Function: LoadRigDefJsonData
+**
+** Notes:
+**  1. Rigs must be defined in order starting with rig[0] and every rig
+**     must define all of its objects.
+**  2. Rigs beyond RIG_MGR_MAX_RIG are ignored.
+**
+*/
+static bool LoadRigDefJsonData(size_t JsonFileLen)
+{
+
+   size_t  ObjCnt = sizeof(JsonRigDefObjs)/sizeof(CJSON_Obj_t);
+   size_t  Obj;
+   uint8   Rig, PrevRig, DefObjCnt;
+   uint8   RigCnt = 0;
+
+   memset(RigDefData, 0, sizeof(RigDefData));
+
+   for (Obj=0; Obj < ObjCnt; Obj++)
+   {
+      JsonRigDefObjs[Obj].Updated = false;
+   }
+
+   CJSON_LoadObjArray(JsonRigDefObjs, ObjCnt, JsonBuf, JsonFileLen);
+
+   for (Rig=0; Rig < RIG_MGR_MAX_RIG; Rig++)
+   {
+
+      DefObjCnt = 0;
+      for (Obj=0; Obj < RIG_DEF_JSON_OBJ_CNT; Obj++)
+      {
+         DefObjCnt += JsonRigDefObjs[Rig*RIG_DEF_JSON_OBJ_CNT + Obj].Updated;
+      }
+
+      if (DefObjCnt == 0)
+      {
+         break;
+      }
+
+      if (DefObjCnt < RIG_DEF_JSON_OBJ_CNT)
+      {
+         CFE_EVS_SendEvent(RIG_MGR_LOAD_DEF_EID, CFE_EVS_EventType_ERROR,
+                           "Rig %d definition only contains %d of %d objects",
+                           Rig, DefObjCnt, RIG_DEF_JSON_OBJ_CNT);
+         return false;
+      }
+
+      if (RigDefData[Rig].Worker >= RigMgr->WorkerCnt)
+      {
+         CFE_EVS_SendEvent(RIG_MGR_LOAD_DEF_EID, CFE_EVS_EventType_ERROR,
+                           "Rig %d worker %d must be less than the worker count %d",
+                           Rig, RigDefData[Rig].Worker, RigMgr->WorkerCnt);
+         return false;
+      }
+
+      for (PrevRig=0; PrevRig < Rig; PrevRig++)
+      {
+         if (RigDefData[PrevRig].SensorTlmTopicId == RigDefData[Rig].SensorTlmTopicId)
+         {
+            CFE_EVS_SendEvent(RIG_MGR_LOAD_DEF_EID, CFE_EVS_EventType_ERROR,
+                              "Rig %d sensor topic ID %d is already used by rig %d",
+                              Rig, (int)RigDefData[Rig].SensorTlmTopicId, PrevRig);
+            return false;
+         }
+      }
+
+      RigCnt++;
+
+   } /* End rig loop */
+
+   if (RigCnt == 0)
+   {
+      CFE_EVS_SendEvent(RIG_MGR_LOAD_DEF_EID, CFE_EVS_EventType_ERROR,
+                        "Rig definition file doesn't define rig[0]");
+      return false;
+   }
+
+   memcpy(RigMgr->RigDef, RigDefData, sizeof(RigDefData));
+   RigMgr->RigCnt = RigCnt;
+
+   return true;
+
+} /* End LoadRigDefJsonData() */
+
+
+/******************************************************************************
+** Function: NowMs
+**
+** Return CLOCK_MONOTONIC in milliseconds or, when SimClock is true, the
+** simulation's virtual clock.
+*/
+static uint64 NowMs(bool SimClock)
+{
+
+   struct timespec Now;
+
+   if (SimClock)
+   {
+      return SIM_HW_NowMs(&RigMgr->SimHw);
+   }
+
+   clock_gettime(CLOCK_MONOTONIC, &Now);
+
+   return ((uint64)Now.tv_sec * 1000ULL + (uint64)Now.tv_nsec / 1000000ULL);
+
+} /* End NowMs() */
+
+
+/******************************************************************************
+** Function: PostCmd
+**
+** Post a controller command to the rig's mailbox and wake the rig's worker.
+**
+** Notes:
+**   1. A wakeup is sent for every command. Checking whether the worker
+**      already has a wakeup queued would race with the worker draining the
+**      mailbox and commands arrive at ground command rates.
+**
+*/
+static bool PostCmd(uint8 Rig, const SEQ_TBL_Entry_t *Cmd)
+{
+
+   if (!CMD_MBOX_Post(&RigMgr->Rig[Rig].CmdMbox, Cmd))
+   {
+      return false;
+   }
+
+   WakeRig(Rig);
+
+   return true;
+
+} /* End PostCmd() */
+
+
+/******************************************************************************
+** Function: TblRigValid
+**
+*/
+static bool TblRigValid(void)
+{
+
+   if (RigMgr->TblRig >= RigMgr->RigCnt)
+   {
+      CFE_EVS_SendEvent (RIG_MGR_CMD_EID, CFE_EVS_EventType_ERROR,
+                         "Table command rejected, table rig %d isn't defined", RigMgr->TblRig);
+      return false;
+   }
+
+   return true;
+
+} /* End TblRigValid() */
+
+
+/******************************************************************************
+** Function: ValidRig
+**
+*/
+static bool ValidRig(uint8 Rig, const char *CmdName)
+{
+
+   if (Rig >= RigMgr->RigCnt)
+   {
+      CFE_EVS_SendEvent (RIG_MGR_CMD_EID, CFE_EVS_EventType_ERROR,
+                         "%s command rejected, invalid rig %d. Must be less than %d",
+                         CmdName, Rig, RigMgr->RigCnt);
+      return false;
+   }
+
+   return true;
+
+} /* End ValidRig() */
+
+
+/******************************************************************************
+** Function: VibMonTask
+**
+** Notes:
+**   1. The delay comes first so the first analysis happens after the rigs
+**      have had a period to collect samples.
+**   2. Each rig is analyzed with its control table's current filter sample
+**      rate and notch parameters.
+**
+*/
+static bool VibMonTask(CHILDMGR_Class_t *ChildMgr)
+{
+
+   SAT_CTRL_Class_t *SatCtrl;
+   uint8 i;
+
+   if (!RigMgr->VibMonStarted)
+   {
+      MEM_MON_PaintStack(TBL_SAT_MemTask_VIB_MON, 0);
+      RigMgr->VibMonStarted = true;
+   }
+
+   OS_TaskDelay(RigMgr->VibMonPeriod);
+
+   for (i=0; i < RigMgr->RigCnt; i++)
+   {
+      SatCtrl = &RigMgr->Rig[i];
+      VIB_MON_Analyze(&SatCtrl->VibMon, SatCtrl->Tbl.Data.Filter.SampleHz, &SatCtrl->Tbl.Data.VibNotch);
+   }
+
+   return true;
+
+} /* End VibMonTask() */
+
+
+/******************************************************************************
+** Function: WakeRig
+**
+** Send a wakeup to the rig's worker so a request from the main task is
+** applied without waiting for the rig's next sensor message or timeout.
+*/
+static void WakeRig(uint8 Rig)
+{
+
+   RIG_MGR_Worker_t *Worker = &RigMgr->Worker[RigMgr->RigDef[Rig].Worker];
+
+   if (Worker->PipeCreated)
+   {
+      CFE_SB_TransmitMsg(CFE_MSG_PTR(Worker->WakeupMsg), true);
+   }
+
+} /* End WakeRig() */
+
+
+/******************************************************************************
+** Function: WorkerTask
+**
+** Notes:
+**   1. All queued sensor messages are read before the rigs are executed so
+**      a SUN_ACQ rig always uses its latest sensor data.
+**   2. Only the first pipe read error is reported with an event to prevent
+**      flooding and the worker delays for an execution period after each
+**      error.
+**   3. The worker applies the ini file's real-time profile to itself and
+**      paints its stack on the first call, see rt_profile.h and mem_mon.h.
+**   4. The simulated rig's worker steps the simulation, polls its pipe for
+**      the simulated sensor message and sleeps the real delay after its
+**      rigs execute so a run is paced by the virtual clock.
+**   5. Sensor messages held by a rig's fault injection stage are delivered
+**      when they're due, just before the rig executes.
+**
+*/
+static bool WorkerTask(CHILDMGR_Class_t *ChildMgr)
+{
+
+   RIG_MGR_Worker_t *Worker = FindWorker(ChildMgr);
+   CFE_SB_Buffer_t  *SbBufPtr;
+   const CFE_MSG_Message_t *FaultMsg;
+   int32   SbStatus;
+   size_t  MsgSize;
+   uint16  MsgCnt;
+   uint32  MsgBytes;
+   uint64  Now;
+   uint8   i;
+   bool    SimWorker;
+
+   if (Worker == NULL)
+   {
+      CFE_EVS_SendEvent(RIG_MGR_WORKER_EID, CFE_EVS_EventType_ERROR,
+                        "Worker task terminating, child manager isn't assigned to a worker");
+      return false;
+   }
+
+   if (!Worker->Started)
+   {
+      RT_PROFILE_ApplyChild(Worker->TaskName);
+      MEM_MON_PaintStack(TBL_SAT_MemTask_WORKER, (uint8)(Worker - RigMgr->Worker));
+      Worker->Started = true;
+   }
+
+   SimWorker = RigMgr->SimHw.Enabled &&
+               RigMgr->RigDef[RigMgr->SimHw.Rig].Worker == (Worker - RigMgr->Worker);
+
+   if (SimWorker)
+   {
+      SIM_HW_Step(&RigMgr->SimHw, &RigMgr->Rig[RigMgr->SimHw.Rig].Fan,
+                  RigMgr->Rig[RigMgr->SimHw.Rig].MqttSensorTlmMid);
+   }
+
+   if (Worker->PipeCreated)
+   {
+
+      SbStatus = CFE_SB_ReceiveBuffer(&SbBufPtr, Worker->MqttPipe,
+                                      SimWorker ? CFE_SB_POLL : WorkerTimeout(Worker, NowMs(false)));
+
+      MsgCnt   = 0;
+      MsgBytes = 0;
+      while (SbStatus == CFE_SUCCESS)
+      {
+         if (CFE_MSG_GetSize(&SbBufPtr->Msg, &MsgSize) == CFE_SUCCESS)
+         {
+            MsgBytes += MsgSize;
+         }
+         MsgCnt++;
+         DispatchSensorTlm(Worker, SbBufPtr, NowMs(SimWorker));
+         SbStatus = CFE_SB_ReceiveBuffer(&SbBufPtr, Worker->MqttPipe, CFE_SB_POLL);
+      }
+
+      if (MsgCnt > Worker->PipePeakMsgCnt)
+      {
+         Worker->PipePeakMsgCnt = MsgCnt;
+         Worker->PipePeakBytes  = MsgBytes;
+      }
+
+      if (SbStatus != CFE_SB_TIME_OUT && SbStatus != CFE_SB_NO_MESSAGE)
+      {
+         if (++Worker->PipeErrCnt == 1)
+         {
+            CFE_EVS_SendEvent(RIG_MGR_WORKER_EID, CFE_EVS_EventType_ERROR,
+                              "%s SB pipe read failed. Status = 0x%08X",
+                              Worker->TaskName, (unsigned int)SbStatus);
+         }
+         OS_TaskDelay(RigMgr->ExecPeriod);
+      }
+
+   }
+   else
+   {
+      OS_TaskDelay(RigMgr->ExecPeriod);
+   }
+
+   Now = NowMs(SimWorker);
+   for (i=0; i < Worker->RigCnt; i++)
+   {
+      while ((FaultMsg = FAULT_INJ_Output(&RigMgr->FaultInj[Worker->Rig[i]], Now)) != NULL)
+      {
+         SAT_CTRL_SetSensorTlm(&RigMgr->Rig[Worker->Rig[i]], FaultMsg);
+      }
+      if (SAT_CTRL_Execute(&RigMgr->Rig[Worker->Rig[i]], Now))
+      {
+         SHM_EXPORT_Publish(&RigMgr->ShmExport, Worker->Rig[i], &RigMgr->Rig[Worker->Rig[i]], Now);
+      }
+   }
+
+   if (SimWorker)
+   {
+      OS_TaskDelay(RigMgr->SimHw.RealDelayMs);
+   }
+
+   return true;
+
+} /* End WorkerTask() */
+
+
+/******************************************************************************
+** Function: WorkerTimeout
+**
+** Return the number of milliseconds until the worker's next periodic rig is
+** due. SUN_ACQ rigs are driven by their sensor messages so they don't
+** shorten the timeout unless fault injection is holding a message for them.
+*/
+static int32 WorkerTimeout(const RIG_MGR_Worker_t *Worker, uint64 Now)
+{
+
+   uint64 Timeout = RigMgr->ExecPeriod;
+   uint64 DueMs;
+   const SAT_CTRL_Class_t *SatCtrl;
+   uint8  i;
+
+   for (i=0; i < Worker->RigCnt; i++)
+   {
+
+      SatCtrl = &RigMgr->Rig[Worker->Rig[i]];
+
+      DueMs = FAULT_INJ_NextReleaseMs(&RigMgr->FaultInj[Worker->Rig[i]]);
+      if (SatCtrl->Mode != TBL_SAT_CtrlMode_SUN_ACQ && SatCtrl->NextExecTime < DueMs)
+      {
+         DueMs = SatCtrl->NextExecTime;
+      }
+
+      if (DueMs <= Now)
+      {
+         Timeout = 0;
+      }
+      else if ((DueMs - Now) < Timeout)
+      {
+         Timeout = DueMs - Now;
+      }
+
+   }
+
+   return (Timeout == 0) ? CFE_SB_POLL : (int32)Timeout;
+
+} /* End WorkerTimeout() */
+
+
+/******************************************************************************
+** Function: DumpFanTbl
+**
+** Dump the fan table of the rig selected by RIG_MGR_SetTblRigCmd().
+*/
+static bool DumpFanTbl(osal_id_t FileHandle)
+{
+
+   return TblRigValid() && FAN_TBL_Dump(&RigMgr->Rig[RigMgr->TblRig].Fan.Tbl, FileHandle);
+
+} /* End DumpFanTbl() */
+
+
+/******************************************************************************
+** Function: DumpSatCtrlTbl
+**
+** Dump the controller table of the rig selected by RIG_MGR_SetTblRigCmd().
+*/
+static bool DumpSatCtrlTbl(osal_id_t FileHandle)
+{
+
+   return TblRigValid() && SAT_CTRL_TBL_Dump(&RigMgr->Rig[RigMgr->TblRig].Tbl, FileHandle);
+
+} /* End DumpSatCtrlTbl() */
+
+
+/******************************************************************************
+** Function: DumpSensorTbl
+**
+** Dump the sensor table of the rig selected by RIG_MGR_SetTblRigCmd().
+*/
+static bool DumpSensorTbl(osal_id_t FileHandle)
+{
+
+   return TblRigValid() && SENSOR_TBL_Dump(&RigMgr->Rig[RigMgr->TblRig].SensorTbl, FileHandle);
+
+} /* End DumpSensorTbl() */
+
+
+/******************************************************************************
+** Function: DumpSeqTbl
+**
+** Dump the sequence table of the rig selected by RIG_MGR_SetTblRigCmd().
+*/
+static bool DumpSeqTbl(osal_id_t FileHandle)
+{
+
+   return TblRigValid() && SEQ_TBL_Dump(&RigMgr->Rig[RigMgr->TblRig].Seq.Tbl, FileHandle);
+
+} /* End DumpSeqTbl() */
+
+
+/******************************************************************************
+** Function: LoadFanTbl
+**
+** Load the fan table of the rig selected by RIG_MGR_SetTblRigCmd().
+*/
+static bool LoadFanTbl(APP_C_FW_TblLoadOptions_Enum_t LoadType, const char *Filename)
+{
+
+   return TblRigValid() && FAN_TBL_Load(&RigMgr->Rig[RigMgr->TblRig].Fan.Tbl, LoadType, Filename);
+
+} /* End LoadFanTbl() */
+
+
+/******************************************************************************
+** Function: LoadSatCtrlTbl
+**
+** Load the controller table of the rig selected by RIG_MGR_SetTblRigCmd().
+*/
+static bool LoadSatCtrlTbl(APP_C_FW_TblLoadOptions_Enum_t LoadType, const char *Filename)
+{
+
+   return TblRigValid() && SAT_CTRL_TBL_Load(&RigMgr->Rig[RigMgr->TblRig].Tbl, LoadType, Filename);
+
+} /* End LoadSatCtrlTbl() */
+
+
+/******************************************************************************
+** Function: LoadSeqTbl
+**
+** Load the sequence table of the rig selected by RIG_MGR_SetTblRigCmd().
+** Notes:
+**   1. The worker reads the table while a sequence is active so a load is
+**      rejected until the sequence completes or is aborted.
+**
+*/
+static bool LoadSeqTbl(APP_C_FW_TblLoadOptions_Enum_t LoadType, const char *Filename)
+{
+
+   if (!TblRigValid())
+   {
+      return false;
+   }
+
+   if (SEQ_Active(&RigMgr->Rig[RigMgr->TblRig].Seq))
+   {
+      CFE_EVS_SendEvent (RIG_MGR_CMD_EID, CFE_EVS_EventType_ERROR,
+                         "Sequence table load rejected, rig %d sequence is active. Abort it first",
+                         RigMgr->TblRig);
+      return false;
+   }
+
+   return SEQ_TBL_Load(&RigMgr->Rig[RigMgr->TblRig].Seq.Tbl, LoadType, Filename);
+
+} /* End LoadSeqTbl() */
+
+
+/******************************************************************************
+** Function: LoadSensorTbl
+**
+** Load the sensor table of the rig selected by RIG_MGR_SetTblRigCmd().
+*/
+static bool LoadSensorTbl(APP_C_FW_TblLoadOptions_Enum_t LoadType, const char *Filename)
+{
+
+   return TblRigValid() && SENSOR_TBL_Load(&RigMgr->Rig[RigMgr->TblRig].SensorTbl, LoadType, Filename);
+
+} /* End LoadSensorTbl() */
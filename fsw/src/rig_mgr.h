@@ -0,0 +1,302 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Define the rig manager class
+**
+**  Notes:
+**    1. Use the Singleton design pattern. The rig manager lets one app
+**       instance drive several Table Sat rigs. It owns each rig's SAT_CTRL
+**       object, the hardware services shared by all rigs (GPIO and PWM
+**       mapping, the PWM FIFO and tach capture) and a pool of worker child
+**       tasks that run the rigs' control steps.
+**    2. Rigs are defined in a JSON rig definition file named in the JSON
+**       ini file. Each rig has a name, a worker, a sensor telemetry topic
+**       ID, its fans' BCM pins and its default control and fan tables.
+**       Sensor topic IDs must be unique.
+**    3. Each worker has its own SB pipe subscribed to its rigs' sensor
+**       topics. A worker pends on its pipe until the next periodic rig is
+**       due, routes sensor messages to their rig by message ID and then
+**       executes each of its rigs. A rig's SAT_CTRL object is only accessed
+**       by its worker and by commands from the app's main task.
+**    4. The table manager has one entry per table type. Table load and
+**       dump commands apply to the rig selected by the SetTblRig command,
+**       rig 0 by default. All other commands identify the rig in their
+**       payload. A rig's sequence table can't be loaded while its sequence
+**       is active.
+**    5. When the app is built with TBL_SAT_SIM_HW the rig manager owns the
+**       SIM_HW simulation. The simulated rig's worker steps the simulation
+**       instead of pending on its pipe and runs its rigs on the virtual
+**       clock, see sim_hw.h. Other workers keep real time.
+**    6. Each rig's sensor messages pass through the rig's FAULT_INJ stage
+**       before they reach its controller, see fault_inj.h.
+**    7. The set control mode, set control gains, override fan PWM and
+**       start and stop PWM playback commands are posted to the rig's
+**       command mailbox. The main task then sends a header only wakeup
+**       message on the worker's wakeup topic so a worker pending on its
+**       pipe applies the command immediately. The sequence start, abort and
+**       pause requests send the same wakeup.
+**    8. After each control cycle a worker publishes the rig's state to the
+**       shared memory telemetry segment, see shm_export.h.
+**    9. A low priority background task analyzes each rig's rate vibration
+**       spectrum every VIB_MON_PERIOD milliseconds and retunes the rig's
+**       rate notch, see vib_mon.h. It doesn't use the workers' real-time
+**       profile so it never preempts a control step.
+**
+*/
+
+#ifndef _rig_mgr_
+#define _rig_mgr_
+
+/*
+** Includes
+*/
+
+#include "app_cfg.h"
+#include "sat_ctrl.h"
+#include "pwm_fifo.h"
+#include "tach.h"
+#include "mem_mon.h"
+#include "rt_profile.h"
+#include "sim_hw.h"
+#include "fault_inj.h"
+#include "shm_export.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define RIG_MGR_MAX_RIG      4
+#define RIG_MGR_MAX_WORKER   4
+
+#define RIG_MGR_NAME_LEN          SAT_CTRL_RIG_NAME_LEN
+#define RIG_MGR_BCM_ID_LIST_LEN   32
+
+/*
+** Event Message IDs
+*/
+
+#define RIG_MGR_CONSTRUCTOR_EID  (RIG_MGR_BASE_EID + 0)
+#define RIG_MGR_LOAD_DEF_EID     (RIG_MGR_BASE_EID + 1)
+#define RIG_MGR_CMD_EID          (RIG_MGR_BASE_EID + 2)
+#define RIG_MGR_WORKER_EID       (RIG_MGR_BASE_EID + 3)
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+
+/******************************************************************************
+** Rig definition file entry
+*/
+
+typedef struct
+{
+
+   char    Name[RIG_MGR_NAME_LEN];
+   uint16  Worker;
+   uint32  SensorTlmTopicId;
+   char    SatCtrlTbl[OS_MAX_PATH_LEN];
+   uint16  FanCnt;
+   char    FanPwmBcmId[RIG_MGR_BCM_ID_LIST_LEN];
+   char    FanTachBcmId[RIG_MGR_BCM_ID_LIST_LEN];
+   char    FanTbl[OS_MAX_PATH_LEN];
+   char    SensorTbl[OS_MAX_PATH_LEN];
+
+} RIG_MGR_RigDef_t;
+
+
+/******************************************************************************
+** Worker child task
+*/
+
+typedef struct
+{
+
+   CHILDMGR_Class_t  ChildMgr;
+
+   bool              PipeCreated;
+   CFE_SB_PipeId_t   MqttPipe;
+   uint16            PipeDepth;
+   uint32            PipeErrCnt;
+   uint16            PipePeakMsgCnt;  /* Most messages read in one wake up */
+   uint32            PipePeakBytes;
+   CFE_SB_MsgId_t    WakeupMid;
+   CFE_MSG_TelemetryHeader_t  WakeupMsg;
+   bool              Started;         /* First call setup done */
+
+   uint8             RigCnt;
+   uint8             Rig[RIG_MGR_MAX_RIG];
+
+   char              TaskName[OS_MAX_API_NAME];
+   char              PipeName[OS_MAX_API_NAME];
+
+} RIG_MGR_Worker_t;
+
+
+/******************************************************************************
+** RIG_MGR_Class
+*/
+
+typedef struct
+{
+
+   /*
+   ** Framework References
+   */
+
+   INITBL_Class_t *IniTbl;
+
+   /*
+   ** Class State Data
+   */
+
+   bool    GpioMapped;
+   bool    PwmMapped;
+
+   uint8   RigCnt;
+   uint8   WorkerCnt;
+   uint8   TblRig;       /* Rig used by table load and dump commands */
+   uint32  ExecPeriod;   /* Longest worker pend in milliseconds */
+
+   TACH_Class_t       Tach;
+   PWM_FIFO_Class_t   PwmFifo;
+   SIM_HW_Class_t     SimHw;
+   SHM_EXPORT_Class_t ShmExport;
+
+   CHILDMGR_Class_t   VibMonChildMgr;
+   uint32             VibMonPeriod;    /* Milliseconds between analyses, 0 disables the task */
+   bool               VibMonStarted;   /* First call setup done */
+
+   RIG_MGR_RigDef_t   RigDef[RIG_MGR_MAX_RIG];
+   SAT_CTRL_Class_t   Rig[RIG_MGR_MAX_RIG];
+   FAULT_INJ_Class_t  FaultInj[RIG_MGR_MAX_RIG];
+   RIG_MGR_Worker_t   Worker[RIG_MGR_MAX_WORKER];
+
+} RIG_MGR_Class_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: RIG_MGR_Constructor
+**
+** Load the rig definition file, construct each rig and the shared hardware
+** services, register the rig tables and start the worker and vibration
+** monitor tasks.
+**
+** Notes:
+**   1. This must be called prior to any other function.
+**   2. Returns CFE_SUCCESS if every worker task was created. The vibration
+**      monitor task isn't needed to control the rigs so its creation
+**      status isn't returned.
+**
+*/
+int32 RIG_MGR_Constructor(RIG_MGR_Class_t *RigMgrPtr, INITBL_Class_t *IniTbl,
+                          TBLMGR_Class_t *TblMgr);
+
+
+/******************************************************************************
+** Function: RIG_MGR_ResetStatus
+**
+** Reset counters and status flags to a known reset state.
+**
+** Notes:
+**   1. Any counter or variable that is reported in HK telemetry that doesn't
+**      change the functional behavior should be reset.
+**
+*/
+void RIG_MGR_ResetStatus(void);
+
+
+/******************************************************************************
+** Function: RIG_MGR_AbortSeqCmd
+**
+*/
+bool RIG_MGR_AbortSeqCmd(void *DataObjPtr, const CFE_MSG_Message_t *MsgPtr);
+
+
+/******************************************************************************
+** Function: RIG_MGR_OverrideFanPwmCmd
+**
+*/
+bool RIG_MGR_OverrideFanPwmCmd(void *DataObjPtr, const CFE_MSG_Message_t *MsgPtr);
+
+
+/******************************************************************************
+** Function: RIG_MGR_PauseSeqCmd
+**
+*/
+bool RIG_MGR_PauseSeqCmd(void *DataObjPtr, const CFE_MSG_Message_t *MsgPtr);
+
+
+/******************************************************************************
+** Function: RIG_MGR_SetCtrlGainsCmd
+**
+*/
+bool RIG_MGR_SetCtrlGainsCmd(void *DataObjPtr, const CFE_MSG_Message_t *MsgPtr);
+
+
+/******************************************************************************
+** Function: RIG_MGR_SetCtrlModeCmd
+**
+*/
+bool RIG_MGR_SetCtrlModeCmd(void *DataObjPtr, const CFE_MSG_Message_t *MsgPtr);
+
+
+/******************************************************************************
+** Function: RIG_MGR_SetSensorFaultCmd
+**
+** Configure the rig's sensor message fault injection. All zero values
+** disable injection.
+*/
+bool RIG_MGR_SetSensorFaultCmd(void *DataObjPtr, const CFE_MSG_Message_t *MsgPtr);
+
+
+/******************************************************************************
+** Function: RIG_MGR_SetTblRigCmd
+**
+** Select the rig used by subsequent table load and dump commands.
+*/
+bool RIG_MGR_SetTblRigCmd(void *DataObjPtr, const CFE_MSG_Message_t *MsgPtr);
+
+
+/******************************************************************************
+** Function: RIG_MGR_StartPwmPlaybackCmd
+**
+*/
+bool RIG_MGR_StartPwmPlaybackCmd(void *DataObjPtr, const CFE_MSG_Message_t *MsgPtr);
+
+
+/******************************************************************************
+** Function: RIG_MGR_StartSeqCmd
+**
+** Start the rig's loaded command sequence or resume a paused sequence.
+*/
+bool RIG_MGR_StartSeqCmd(void *DataObjPtr, const CFE_MSG_Message_t *MsgPtr);
+
+
+/******************************************************************************
+** Function: RIG_MGR_StopPwmPlaybackCmd
+**
+*/
+bool RIG_MGR_StopPwmPlaybackCmd(void *DataObjPtr, const CFE_MSG_Message_t *MsgPtr);
+
+
+#endif /* _rig_mgr_ */
@@ -0,0 +1,384 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Implement the real-time execution profile class
+**
+**  Notes:
+**    1. See rt_profile.h for details.
+**    2. Setting a real-time policy and locking memory require root or the
+**       CAP_SYS_NICE and CAP_IPC_LOCK capabilities.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#define _GNU_SOURCE  /* CPU affinity */
+
+#include <errno.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "rt_profile.h"
+
+
+/************************************/
+/** Local File Function Prototypes **/
+/************************************/
+
+static void FormatCpuList(const cpu_set_t *CpuSet, char *CpuList, size_t Len);
+static bool ParseCpuList(const char *CpuList, cpu_set_t *CpuSet);
+static int  ParsePolicy(const char *PolicyStr);
+static const char *PolicyStr(int Policy);
+static void PrefaultHeap(uint32 Bytes);
+static void PrefaultStack(uint32 Bytes);
+
+
+/**********************/
+/** Global File Data **/
+/**********************/
+
+static RT_PROFILE_Class_t *RtProfile = NULL;
+
+
+/******************************************************************************
+** Function: RT_PROFILE_Constructor
+**
+*/
+void RT_PROFILE_Constructor(RT_PROFILE_Class_t *RtProfilePtr, INITBL_Class_t *IniTbl)
+{
+
+   RtProfile = RtProfilePtr;
+
+   memset(RtProfile, 0, sizeof(RT_PROFILE_Class_t));
+
+   strncpy(RtProfile->CpuAffinity, INITBL_GetStrConfig(IniTbl, CFG_CHILD_CPU_AFFINITY), RT_PROFILE_CPU_LIST_LEN-1);
+   RtProfile->Policy        = ParsePolicy(INITBL_GetStrConfig(IniTbl, CFG_CHILD_RT_POLICY));
+   RtProfile->Priority      = INITBL_GetIntConfig(IniTbl, CFG_CHILD_RT_PRIORITY);
+   RtProfile->StackPrefault = INITBL_GetIntConfig(IniTbl, CFG_CHILD_STACK_PREFAULT);
+   RtProfile->MemLockAll    = (INITBL_GetIntConfig(IniTbl, CFG_MEM_LOCK_ALL) != 0);
+   RtProfile->HeapPrefault  = INITBL_GetIntConfig(IniTbl, CFG_MEM_HEAP_PREFAULT);
+
+   if (RtProfile->StackPrefault > 0 &&
+       RtProfile->StackPrefault + RT_PROFILE_STACK_MARGIN > INITBL_GetIntConfig(IniTbl, CFG_CHILD_STACK_SIZE))
+   {
+      CFE_EVS_SendEvent (RT_PROFILE_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                         "Invalid child stack prefault %u. Must leave %d bytes of the %u byte stack, prefault disabled",
+                         (unsigned int)RtProfile->StackPrefault, RT_PROFILE_STACK_MARGIN,
+                         (unsigned int)INITBL_GetIntConfig(IniTbl, CFG_CHILD_STACK_SIZE));
+      RtProfile->StackPrefault = 0;
+   }
+
+   if (RtProfile->Policy == SCHED_FIFO || RtProfile->Policy == SCHED_RR)
+   {
+      if (RtProfile->Priority < sched_get_priority_min(RtProfile->Policy) ||
+          RtProfile->Priority > sched_get_priority_max(RtProfile->Policy))
+      {
+         CFE_EVS_SendEvent (RT_PROFILE_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                            "Invalid child RT priority %d for policy %s. Must be in [%d,%d], using OSAL's policy",
+                            RtProfile->Priority, PolicyStr(RtProfile->Policy),
+                            sched_get_priority_min(RtProfile->Policy), sched_get_priority_max(RtProfile->Policy));
+         RtProfile->Policy = RT_PROFILE_INHERIT;
+      }
+   }
+
+   if (RtProfile->MemLockAll)
+   {
+      if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0)
+      {
+         RtProfile->MemLocked = true;
+      }
+      else
+      {
+         CFE_EVS_SendEvent (RT_PROFILE_MEM_EID, CFE_EVS_EventType_ERROR,
+                            "mlockall() failed: %s", strerror(errno));
+      }
+   }
+
+   if (RtProfile->HeapPrefault > 0)
+   {
+      PrefaultHeap(RtProfile->HeapPrefault);
+   }
+
+   CFE_EVS_SendEvent (RT_PROFILE_MEM_EID, CFE_EVS_EventType_INFORMATION,
+                      "RT memory profile: mlockall %s, heap prefault %u bytes",
+                      RtProfile->MemLocked ? "enabled" : "disabled",
+                      (unsigned int)RtProfile->HeapPrefaulted);
+
+} /* End RT_PROFILE_Constructor() */
+
+
+/******************************************************************************
+** Function: RT_PROFILE_ApplyChild
+**
+*/
+void RT_PROFILE_ApplyChild(const char *TaskName)
+{
+
+   cpu_set_t   CpuSet;
+   char        CpuList[RT_PROFILE_CPU_LIST_LEN];
+   struct sched_param SchedParam;
+   int   Policy;
+   int   Status;
+
+   if (RtProfile == NULL)
+   {
+      return;
+   }
+
+   if (strcmp(RtProfile->CpuAffinity, "all") != 0)
+   {
+      if (ParseCpuList(RtProfile->CpuAffinity, &CpuSet))
+      {
+         Status = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &CpuSet);
+         if (Status != 0)
+         {
+            CFE_EVS_SendEvent (RT_PROFILE_CHILD_EID, CFE_EVS_EventType_ERROR,
+                               "%s CPU affinity %s failed: %s", TaskName, RtProfile->CpuAffinity, strerror(Status));
+         }
+      }
+      else
+      {
+         CFE_EVS_SendEvent (RT_PROFILE_CHILD_EID, CFE_EVS_EventType_ERROR,
+                            "%s invalid CPU affinity list \"%s\"", TaskName, RtProfile->CpuAffinity);
+      }
+   }
+
+   if (RtProfile->Policy != RT_PROFILE_INHERIT)
+   {
+      memset(&SchedParam, 0, sizeof(SchedParam));
+      SchedParam.sched_priority = (RtProfile->Policy == SCHED_OTHER) ? 0 : RtProfile->Priority;
+      Status = pthread_setschedparam(pthread_self(), RtProfile->Policy, &SchedParam);
+      if (Status != 0)
+      {
+         CFE_EVS_SendEvent (RT_PROFILE_CHILD_EID, CFE_EVS_EventType_ERROR,
+                            "%s RT policy %s priority %d failed: %s", TaskName,
+                            PolicyStr(RtProfile->Policy), SchedParam.sched_priority, strerror(Status));
+      }
+   }
+
+   if (RtProfile->StackPrefault > 0)
+   {
+      PrefaultStack(RtProfile->StackPrefault);
+   }
+
+   /* Report the state the kernel actually applied */
+
+   if (pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &CpuSet) == 0)
+   {
+      FormatCpuList(&CpuSet, CpuList, sizeof(CpuList));
+   }
+   else
+   {
+      strcpy(CpuList, "unknown");
+   }
+
+   if (pthread_getschedparam(pthread_self(), &Policy, &SchedParam) != 0)
+   {
+      Policy = RT_PROFILE_INHERIT;
+      SchedParam.sched_priority = 0;
+   }
+
+   CFE_EVS_SendEvent (RT_PROFILE_CHILD_EID, CFE_EVS_EventType_INFORMATION,
+                      "%s RT profile: policy %s priority %d, CPUs %s, stack prefault %u bytes, mlockall %s",
+                      TaskName, PolicyStr(Policy), SchedParam.sched_priority, CpuList,
+                      (unsigned int)RtProfile->StackPrefault, RtProfile->MemLocked ? "enabled" : "disabled");
+
+} /* End RT_PROFILE_ApplyChild() */
+
+
+/******************************************************************************
+** Function: FormatCpuList
+**
+** Format a CPU set as a comma separated list, truncated to Len.
+*/
+static void FormatCpuList(const cpu_set_t *CpuSet, char *CpuList, size_t Len)
+{
+
+   size_t Used = 0;
+   int    Cpu;
+
+   CpuList[0] = '\0';
+   for (Cpu=0; Cpu < CPU_SETSIZE && Used < Len; Cpu++)
+   {
+      if (CPU_ISSET(Cpu, CpuSet))
+      {
+         Used += snprintf(&CpuList[Used], Len - Used, "%s%d", (Used > 0) ? "," : "", Cpu);
+      }
+   }
+
+} /* End FormatCpuList() */
+
+
+/******************************************************************************
+** Function: ParseCpuList
+**
+** Parse a comma separated list of CPU numbers. Every CPU must be configured.
+*/
+static bool ParseCpuList(const char *CpuList, cpu_set_t *CpuSet)
+{
+
+   long  CpuCnt = sysconf(_SC_NPROCESSORS_CONF);
+   const char *Next = CpuList;
+   char *End;
+   long  Cpu;
+   bool  CpuFound = false;
+
+   CPU_ZERO(CpuSet);
+
+   while (*Next != '\0')
+   {
+
+      Cpu = strtol(Next, &End, 10);
+      if (End == Next || Cpu < 0 || Cpu >= CpuCnt || Cpu >= CPU_SETSIZE)
+      {
+         return false;
+      }
+      CPU_SET(Cpu, CpuSet);
+      CpuFound = true;
+
+      while (*End == ' ')
+      {
+         End++;
+      }
+      if (*End == ',')
+      {
+         End++;
+      }
+      else if (*End != '\0')
+      {
+         return false;
+      }
+      Next = End;
+
+   }
+
+   return CpuFound;
+
+} /* End ParseCpuList() */
+
+
+/******************************************************************************
+** Function: ParsePolicy
+**
+*/
+static int ParsePolicy(const char *PolicyStr)
+{
+
+   int Policy = RT_PROFILE_INHERIT;
+
+   if (strcmp(PolicyStr, "other") == 0)
+   {
+      Policy = SCHED_OTHER;
+   }
+   else if (strcmp(PolicyStr, "fifo") == 0)
+   {
+      Policy = SCHED_FIFO;
+   }
+   else if (strcmp(PolicyStr, "rr") == 0)
+   {
+      Policy = SCHED_RR;
+   }
+   else if (strcmp(PolicyStr, "inherit") != 0)
+   {
+      CFE_EVS_SendEvent (RT_PROFILE_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                         "Invalid child RT policy \"%s\". Must be inherit, other, fifo or rr, using inherit",
+                         PolicyStr);
+   }
+
+   return Policy;
+
+} /* End ParsePolicy() */
+
+
+/******************************************************************************
+** Function: PolicyStr
+**
+*/
+static const char *PolicyStr(int Policy)
+{
+
+   const char *Str = "unknown";
+
+   switch (Policy)
+   {
+      case SCHED_OTHER: Str = "other"; break;
+      case SCHED_FIFO:  Str = "fifo";  break;
+      case SCHED_RR:    Str = "rr";    break;
+      default: break;
+   }
+
+   return Str;
+
+} /* End PolicyStr() */
+
+
+/******************************************************************************
+** Function: PrefaultHeap
+**
+** Notes:
+**   1. Heap trimming and mmap allocations are disabled first so the
+**      prefaulted pages stay in the heap after they're freed and later
+**      allocations reuse them.
+**
+*/
+static void PrefaultHeap(uint32 Bytes)
+{
+
+   long  PageSize = sysconf(_SC_PAGESIZE);
+   volatile uint8 *Heap;
+   uint32 i;
+
+   mallopt(M_TRIM_THRESHOLD, -1);
+   mallopt(M_MMAP_MAX, 0);
+
+   Heap = malloc(Bytes);
+   if (Heap != NULL)
+   {
+      for (i=0; i < Bytes; i += PageSize)
+      {
+         Heap[i] = 0;
+      }
+      free((void *)Heap);
+      RtProfile->HeapPrefaulted = Bytes;
+   }
+   else
+   {
+      CFE_EVS_SendEvent (RT_PROFILE_MEM_EID, CFE_EVS_EventType_ERROR,
+                         "Heap prefault of %u bytes failed", (unsigned int)Bytes);
+   }
+
+} /* End PrefaultHeap() */
+
+
+/******************************************************************************
+** Function: PrefaultStack
+**
+** Touch Bytes of stack below the caller. Bytes must be less than the task's
+** stack size.
+*/
+static __attribute__((noinline)) void PrefaultStack(uint32 Bytes)
+{
+
+   volatile uint8 Stack[Bytes];
+
+   memset((void *)Stack, 0, Bytes);
+
+} /* End PrefaultStack() */
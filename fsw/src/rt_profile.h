@@ -0,0 +1,126 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Define the real-time execution profile class
+**
+**  Notes:
+**    1. Use the Singleton design pattern. The profile applies the ini
+**       file's real-time options so a control task can be isolated from the
+**       other processes on the Pi such as the sensor publisher and the MQTT
+**       broker.
+**    2. Process wide memory options are applied by the constructor:
+**       MEM_LOCK_ALL locks current and future pages with mlockall() and
+**       MEM_HEAP_PREFAULT faults in and keeps the given number of heap
+**       bytes so later allocations don't page fault.
+**    3. Child task options are applied by each worker task to itself with
+**       RT_PROFILE_ApplyChild() when it starts:
+**         CHILD_CPU_AFFINITY   Comma separated CPU list, "all" is no change
+**         CHILD_RT_POLICY      "inherit" (OSAL's), "other", "fifo" or "rr"
+**         CHILD_RT_PRIORITY    Linux priority for "fifo" and "rr"
+**         CHILD_STACK_PREFAULT Stack bytes to fault in, 0 disables
+**    4. Each option's effective state is read back from the kernel and
+**       reported in an event so a misconfigured or unprivileged run is
+**       obvious. Failed options are reported and the app continues.
+**
+*/
+
+#ifndef _rt_profile_
+#define _rt_profile_
+
+/*
+** Includes
+*/
+
+#include "app_cfg.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define RT_PROFILE_CPU_LIST_LEN  32
+#define RT_PROFILE_INHERIT       (-1)  /* Keep OSAL's scheduling policy */
+#define RT_PROFILE_STACK_MARGIN  4096  /* Stack left untouched by the prefault */
+
+/*
+** Event Message IDs
+*/
+
+#define RT_PROFILE_CONSTRUCTOR_EID  (RT_PROFILE_BASE_EID + 0)
+#define RT_PROFILE_MEM_EID          (RT_PROFILE_BASE_EID + 1)
+#define RT_PROFILE_CHILD_EID        (RT_PROFILE_BASE_EID + 2)
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+
+/******************************************************************************
+** RT_PROFILE_Class
+*/
+
+typedef struct
+{
+
+   /*
+   ** Configuration
+   */
+
+   char    CpuAffinity[RT_PROFILE_CPU_LIST_LEN];
+   int     Policy;          /* RT_PROFILE_INHERIT or a SCHED_ policy */
+   int     Priority;
+   uint32  StackPrefault;
+   bool    MemLockAll;
+   uint32  HeapPrefault;
+
+   /*
+   ** Effective State
+   */
+
+   bool    MemLocked;
+   uint32  HeapPrefaulted;
+
+} RT_PROFILE_Class_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: RT_PROFILE_Constructor
+**
+** Load the real-time options and apply the process wide memory options.
+**
+** Notes:
+**   1. Call from the app's main task before any child tasks are created so
+**      MEM_LOCK_ALL also locks their stacks.
+**
+*/
+void RT_PROFILE_Constructor(RT_PROFILE_Class_t *RtProfilePtr, INITBL_Class_t *IniTbl);
+
+
+/******************************************************************************
+** Function: RT_PROFILE_ApplyChild
+**
+** Apply the child task options to the calling task and report the effective
+** state. TaskName is only used in the event message.
+*/
+void RT_PROFILE_ApplyChild(const char *TaskName);
+
+
+#endif /* _rt_profile_ */
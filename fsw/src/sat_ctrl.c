@@ -24,34 +24,32 @@
 ** Include Files:
 */
 
+#include <stddef.h>
 #include <string.h>
 #include <math.h>
-#include "gpio.h"
 #include "app_cfg.h"
 #include "sat_ctrl.h"
 
 #define RAD_2_DEG 57.29577951326093
 
-/**********************/
-/** Global File Data **/
-/**********************/
-
-static SAT_CTRL_Class_t *SatCtrl = NULL;
-
-
 /*******************************/
 /** Local Function Prototypes **/
 /*******************************/
 
-static bool GetMqttMessages(bool PendForMsg);
-static void SunAcqMode(void);
-static void TestMode(void);
+static uint32 CdsStateCrc(const SAT_CTRL_CdsState_t *CdsState);
+static bool CtrlStepDue(const SAT_CTRL_Class_t *SatCtrl, uint64 NowMs);
+static void RegisterCds(SAT_CTRL_Class_t *SatCtrl, uint32 MaxAge);
+static void RunCmd(SAT_CTRL_Class_t *SatCtrl, const SEQ_TBL_Entry_t *Entry);
+static bool FansOff(const FAN_Class_t *Fan);
+static void SaveCdsState(SAT_CTRL_Class_t *SatCtrl, uint64 NowMs);
+static void SunAcqMode(SAT_CTRL_Class_t *SatCtrl);
+static void TestMode(SAT_CTRL_Class_t *SatCtrl);
 
 
 /******************************************************************************
 ** Function: SAT_CTRL_Constructor
 **
-** Initialize the Table Sat Controller object to a known state
+** Initialize a rig's controller object to a known state
 **
 ** Notes:
 **   1. This must be called prior to any other function.
@@ -59,26 +57,29 @@ static void TestMode(void);
 **      data that requires the table parameters.
 **
 */
-void SAT_CTRL_Constructor(SAT_CTRL_Class_t *SatCtrlPtr, INITBL_Class_t *IniTbl,
-                          TBLMGR_Class_t *TblMgr)
+void SAT_CTRL_Constructor(SAT_CTRL_Class_t *SatCtrl, INITBL_Class_t *IniTbl,
+                          const SAT_CTRL_Config_t *Config)
 {
    
-   int32  SbStatus;
-   
-   SatCtrl = SatCtrlPtr;
-   
    memset(SatCtrl, 0, sizeof(SAT_CTRL_Class_t));  
    
+   SatCtrl->IniTbl = IniTbl;
+   SatCtrl->RigIdx = Config->RigIdx;
+   strncpy(SatCtrl->RigName, Config->Name, SAT_CTRL_RIG_NAME_LEN-1);
+   
    SAT_CTRL_TBL_Constructor(&SatCtrl->Tbl);
-   TBLMGR_RegisterTblWithDef(TblMgr, SAT_CTRL_TBL_NAME,
-                             SAT_CTRL_TBL_LoadCmd, SAT_CTRL_TBL_DumpCmd,  
-                             INITBL_GetStrConfig(IniTbl, CFG_SAT_CTRL_TBL_DEF));      
+   SAT_CTRL_TBL_Load(&SatCtrl->Tbl, APP_C_FW_TblLoadOptions_REPLACE, Config->TblFilename);
+   SAT_CTRL_TBL_Activate(&SatCtrl->Tbl);
+   
+   SENSOR_TBL_Constructor(&SatCtrl->SensorTbl);
+   SENSOR_TBL_Load(&SatCtrl->SensorTbl, APP_C_FW_TblLoadOptions_REPLACE, Config->SensorTblFilename);
+   SENSOR_TBL_Activate(&SatCtrl->SensorTbl);
                     
    SatCtrl->Mode = TBL_SAT_CtrlMode_IDLE;
    SatCtrl->InitMode = true;
    SatCtrl->ExecPeriod = INITBL_GetIntConfig(IniTbl, CFG_SAT_CTRL_PERIOD);
    SatCtrl->ExecPerSec = 1000 / SatCtrl->ExecPeriod;
-   SatCtrl->SunAcqMode.State = TBL_SAT_SunAcqState_UNDEF;
+   SatCtrl->SunAcqMode.State = SUN_ACQ_STATE_UNDEF;
  
    /*
    ** Using ceil() causes last step to be limited if range is not an even number of steps
@@ -86,64 +87,98 @@ void SAT_CTRL_Constructor(SAT_CTRL_Class_t *SatCtrlPtr, INITBL_Class_t *IniTbl,
    */
    SatCtrl->TestMode.PwmPerStep = (uint16)ceil((float)FAN_PWM_RANGE / (float)(SatCtrl->Tbl.Data.Test.Steps-1));
 
-   if (gpio_map() >= 0) // map peripherals
-   {
-
-      SatCtrl->GpioMapped = true;
-      FAN_Constructor(&SatCtrl->Fan, IniTbl);
-
-   }
-   else
-   {
-      SatCtrl->GpioMapped = false;
-      CFE_EVS_SendEvent (SAT_CTRL_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR, 
-                         "GPIO mapping failed. Verify chip selection in rpi_iolib config.h");
-
-   } /* End if IO mapped */
+   FAN_Constructor(&SatCtrl->Fan, IniTbl, &Config->Fan);
+   SEQ_Constructor(&SatCtrl->Seq, Config->RigIdx);
+   CMD_MBOX_Constructor(&SatCtrl->CmdMbox, Config->RigIdx);
+   STAT_SUM_Constructor(&SatCtrl->StatSum, Config->RigIdx, INITBL_GetIntConfig(IniTbl, CFG_SAT_CTRL_STATS_PERIOD),
+                        CFE_SB_ValueToMsgId(INITBL_GetIntConfig(IniTbl, CFG_TBL_SAT_STATS_TLM_TOPICID)));
+   VIB_MON_Constructor(&SatCtrl->VibMon, Config->RigIdx);
+   GYRO_BIAS_Constructor(&SatCtrl->GyroBias);
+   SatCtrl->GyroVersion = SatCtrl->SensorTbl.GyroVersion;
+   ATT_EST_Init(&SatCtrl->AttEst);
  
-   SatCtrl->MqttSensorTlmMid = CFE_SB_ValueToMsgId(INITBL_GetIntConfig(IniTbl, CFG_MQTT_GW_TOPIC_4_TLM_TOPICID));
-   SbStatus = CFE_SB_CreatePipe(&SatCtrl->MqttPipe, INITBL_GetIntConfig(IniTbl, CFG_SAT_CTRL_MQTT_PIPE_DEPTH), INITBL_GetStrConfig(IniTbl, CFG_SAT_CTRL_MQTT_PIPE_NAME));  
-   if (SbStatus == CFE_SUCCESS)
-   {
-      SbStatus = CFE_SB_Subscribe(SatCtrl->MqttSensorTlmMid, SatCtrl->MqttPipe);
-   }
-   else
-   {
-      CFE_EVS_SendEvent (SAT_CTRL_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR, 
-                         "SB pipe creation failed. Status = 0x%0X04", SbStatus);
-   }
+   SatCtrl->MqttSensorTlmMid = CFE_SB_ValueToMsgId(Config->SensorTlmTopicId);
+
+   RegisterCds(SatCtrl, INITBL_GetIntConfig(IniTbl, CFG_SAT_CTRL_CDS_MAX_AGE));
 
 } /* End SAT_CTRL_Constructor() */
 
 
 /******************************************************************************
-** Function: SAT_CTRL_ChildTask
+** Function: SAT_CTRL_Execute
 **
 ** Notes:
 **   1. Control mode must be run prior to managing the execution time because
 **      a TimeInMode value of zero is used as an initialization flag.
+**   2. Table loads staged by the main task are activated with the posted
+**      commands so a cycle never sees a partially copied table.
+**   3. The sequencer runs on every pass. SUN_ACQ only steps its control law
+**      when a new sensor message has arrived and the other modes step on
+**      the execution period. A sequence command that changes the mode
+**      applies to the same pass.
 */
-bool SAT_CTRL_ChildTask(CHILDMGR_Class_t *ChildMgr)
+bool SAT_CTRL_Execute(SAT_CTRL_Class_t *SatCtrl, uint64 NowMs)
 {
    
+   const SEQ_TBL_Entry_t *SeqEntry;
+   SEQ_TBL_Entry_t  PostedCmd;
+   bool CtrlStep;
+   
+   while (CMD_MBOX_Take(&SatCtrl->CmdMbox, &PostedCmd))
+   {
+      RunCmd(SatCtrl, &PostedCmd);
+   }
+   
+   SAT_CTRL_TBL_Activate(&SatCtrl->Tbl);
+   SENSOR_TBL_Activate(&SatCtrl->SensorTbl);
+   FAN_TBL_Activate(&SatCtrl->Fan.Tbl);
+   
+   STAT_SUM_Send(&SatCtrl->StatSum, NowMs);
+   
+   CtrlStep = CtrlStepDue(SatCtrl, NowMs);
+   SEQ_Step(&SatCtrl->Seq, NowMs, CtrlStep);
+   while ((SeqEntry = SEQ_NextDueCmd(&SatCtrl->Seq)) != NULL)
+   {
+      RunCmd(SatCtrl, SeqEntry);
+      CtrlStep = CtrlStepDue(SatCtrl, NowMs);
+   }
+   
+   if (!CtrlStep)
+   {
+      return false;
+   }
+   
    switch (SatCtrl->Mode)
    {
       case TBL_SAT_CtrlMode_TEST:
-         TestMode();
+         TestMode(SatCtrl);
          break;
          
       case TBL_SAT_CtrlMode_SUN_ACQ:
-         SunAcqMode(); // Pends for MQTT message
+         SunAcqMode(SatCtrl);
          break;
 
       default:
          // TBL_SAT_CtrlMode_IDLE;
-         // Pending for messages makes it easy to do overrides
-         GetMqttMessages(true);
          break;
       
    } // End mode switch
    
+   SatCtrl->Mqtt.NewSensorTlm = false;
+   
+   FAN_ReadTach(&SatCtrl->Fan);
+   FAN_WritePwm(&SatCtrl->Fan);
+   
+   /* Unconfigured fans are left with a zero sample count */
+   if (SatCtrl->Fan.FanCnt > 0)
+   {
+      STAT_SUM_Update(&SatCtrl->StatSum, STAT_SUM_CHAN_FAN_A_PWM, SatCtrl->Fan.Actuator[0].PwmCmd);
+   }
+   if (SatCtrl->Fan.FanCnt > 1)
+   {
+      STAT_SUM_Update(&SatCtrl->StatSum, STAT_SUM_CHAN_FAN_B_PWM, SatCtrl->Fan.Actuator[1].PwmCmd);
+   }
+   
    //TODO: Fix time in mode 
    SatCtrl->ExecCntr++;
    if (SatCtrl->ExecCntr % SatCtrl->ExecPerSec)
@@ -151,14 +186,13 @@ bool SAT_CTRL_ChildTask(CHILDMGR_Class_t *ChildMgr)
       SatCtrl->TimeInMode++;
    }
 
-   if (SatCtrl->Mode != TBL_SAT_CtrlMode_SUN_ACQ)
-   {
-      OS_TaskDelay(SatCtrl->ExecPeriod);
-   }
-
+   SatCtrl->NextExecTime = NowMs + SatCtrl->ExecPeriod;
+   
+   SaveCdsState(SatCtrl, NowMs);
+   
    return true;
    
-} /* End SAT_CTRL_ChildTask() */
+} /* End SAT_CTRL_Execute() */
 
 
 /******************************************************************************
@@ -171,198 +205,540 @@ bool SAT_CTRL_ChildTask(CHILDMGR_Class_t *ChildMgr)
 **      change the functional behavior should be reset.
 **
 */
-void SAT_CTRL_ResetStatus(void)
+void SAT_CTRL_ResetStatus(SAT_CTRL_Class_t *SatCtrl)
 {
 
-   SAT_CTRL_TBL_ResetStatus();
+   SAT_CTRL_TBL_ResetStatus(&SatCtrl->Tbl);
+   SENSOR_TBL_ResetStatus(&SatCtrl->SensorTbl);
 
-   FAN_ResetStatus();
+   FAN_ResetStatus(&SatCtrl->Fan);
+   
+   SEQ_ResetStatus(&SatCtrl->Seq);
+   
+   CMD_MBOX_ResetStatus(&SatCtrl->CmdMbox);
+   
+   GYRO_BIAS_ResetStatus(&SatCtrl->GyroBias);
    
 } /* End SAT_CTRL_ResetStatus() */
 
 
 /******************************************************************************
-** Function: SAT_CTRL_SetModeCmd
+** Function: SAT_CTRL_SetCtrlGains
 **
-** TODO - Add mode range protection
 */
-bool SAT_CTRL_SetModeCmd(void *DataObjPtr, const CFE_MSG_Message_t *MsgPtr)
+bool SAT_CTRL_SetCtrlGains(SAT_CTRL_Class_t *SatCtrl, float PosGain, float RateGain)
 {
    
-   const TBL_SAT_SetCtrlMode_CmdPayload_t *SetCtrlMode = CMDMGR_PAYLOAD_PTR(MsgPtr, TBL_SAT_SetCtrlMode_t);
    bool RetStatus = true;
-   TBL_SAT_CtrlMode_Enum_t PrevMode = SatCtrl->Mode;
  
-   SatCtrl->Mode = SetCtrlMode->NewMode;
-   SatCtrl->InitMode = true;
-   SatCtrl->TimeInMode = 0;
+   float PrevPosGain  = SatCtrl->Tbl.Data.PosGain;
+   float PrevRateGain = SatCtrl->Tbl.Data.RateGain;
+
+   SatCtrl->Tbl.Data.PosGain  = PosGain;
+   SatCtrl->Tbl.Data.RateGain = RateGain;
    
-   CFE_EVS_SendEvent (SAT_CTRL_SET_MODE_EID, CFE_EVS_EventType_INFORMATION, 
-                      "Control mode changed from %d to %d", PrevMode, SatCtrl->Mode);
+   CFE_EVS_SendEvent (SAT_CTRL_SET_CTRL_GAINS_EID, CFE_EVS_EventType_INFORMATION, 
+                      "Rig %d (Pos,Rate) control gains changed from (%0.6f,%0.6f) to (%0.6f,%0.6f)",
+                      SatCtrl->RigIdx, PrevPosGain,PrevRateGain,SatCtrl->Tbl.Data.PosGain,SatCtrl->Tbl.Data.RateGain);
   
    return RetStatus;   
    
-} /* End SAT_CTRL_SetModeCmd() */
+} /* End SAT_CTRL_SetCtrlGains() */
 
 
 /******************************************************************************
-** Function: SAT_CTRL_SetCtrlGainsCmd
+** Function: SAT_CTRL_SetMode
 **
 */
-bool SAT_CTRL_SetCtrlGainsCmd(void *DataObjPtr, const CFE_MSG_Message_t *MsgPtr)
+bool SAT_CTRL_SetMode(SAT_CTRL_Class_t *SatCtrl, TBL_SAT_CtrlMode_Enum_t NewMode)
 {
    
-   const TBL_SAT_SetCtrlGains_CmdPayload_t *SetCtrlGains = CMDMGR_PAYLOAD_PTR(MsgPtr, TBL_SAT_SetCtrlGains_t);
    bool RetStatus = true;
+   TBL_SAT_CtrlMode_Enum_t PrevMode = SatCtrl->Mode;
  
-   float PrevPosGain  = SatCtrl->Tbl.Data.PosGain;
-   float PrevRateGain = SatCtrl->Tbl.Data.RateGain;
-
-   SatCtrl->Tbl.Data.PosGain  = SetCtrlGains->PosGain;
-   SatCtrl->Tbl.Data.RateGain = SetCtrlGains->RateGain;
+   if (NewMode < TBL_SAT_CtrlMode_IDLE || NewMode > TBL_SAT_CtrlMode_SUN_ACQ)
+   {
+      CFE_EVS_SendEvent (SAT_CTRL_SET_MODE_EID, CFE_EVS_EventType_ERROR, 
+                         "Rig %d invalid control mode %d, must be in [%d,%d]",
+                         SatCtrl->RigIdx, NewMode, TBL_SAT_CtrlMode_IDLE, TBL_SAT_CtrlMode_SUN_ACQ);
+      return false;
+   }
    
-   CFE_EVS_SendEvent (SAT_CTRL_SET_CTRL_GAINS_EID, CFE_EVS_EventType_INFORMATION, 
-                      "(Pos,Rate) control gains changed from (%0.6f,%0.6f) to (%0.6f,%0.6f)",
-                      PrevPosGain,PrevRateGain,SatCtrl->Tbl.Data.PosGain,SatCtrl->Tbl.Data.RateGain);
+   SatCtrl->Mode = NewMode;
+   SatCtrl->InitMode = true;
+   SatCtrl->TimeInMode = 0;
+   
+   CFE_EVS_SendEvent (SAT_CTRL_SET_MODE_EID, CFE_EVS_EventType_INFORMATION, 
+                      "Rig %d control mode changed from %d to %d", SatCtrl->RigIdx, PrevMode, SatCtrl->Mode);
   
    return RetStatus;   
    
-} /* End SAT_CTRL_SetCtrlGainsCmd() */
+} /* End SAT_CTRL_SetMode() */
 
 
 /******************************************************************************
-** Function: GetMqttMessages
+** Function: SAT_CTRL_SetSensorTlm
+**
+** Notes:
+**   1. Every message holds the last known value of each field. Only a
+**      message with a fresh Z rate and delta time triggers a SUN_ACQ step
+**      and adds to the step's rotation. Multiple rate messages received
+**      between steps are all integrated. Light only messages update the
+**      light values for the next step.
+**   2. Only fresh samples are passed to the filter chains. A decimated rate
+**      chain only triggers a step when it outputs a sample. The step's
+**      rotation is the estimated angle's change over every sample since
+**      the previous step.
+**   3. The gyro bias estimate is removed from the calibrated rates before
+**      they're used. Statistics summaries use the raw rates.
+**   4. The attitude estimator processes every fresh rate sample. A light
+**      filter output only updates it after the rate in the same message
+**      has propagated the angle to the message's time.
 **
 ** TODO: Expand beyond rate & provide status & delte time
 */
-static bool GetMqttMessages(bool PendForMsg)
+void SAT_CTRL_SetSensorTlm(SAT_CTRL_Class_t *SatCtrl, const CFE_MSG_Message_t *MsgPtr)
 {
    
-   int32  SbStatus = CFE_SUCCESS;
-   int32  SysStatus;
+   const MQTT_GW_TblSatSensorTlm_Payload_t *Payload = CMDMGR_PAYLOAD_PTR(MsgPtr, MQTT_GW_TblSatSensorTlm_t);
+   SAT_CTRL_Sensor_t *Sensor = &SatCtrl->Sensor;
+   size_t MsgSize = 0;
+   float  Raw[SENSOR_TBL_CHAN_CNT];
+   float *Cal = SatCtrl->SensorCal;
+   float  Notched;
+   float  Filtered;
+   bool   LightFresh = false;
+   uint8  i;
+   
+   if (CFE_MSG_GetSize(MsgPtr, &MsgSize) != CFE_SUCCESS || MsgSize < sizeof(MQTT_GW_TblSatSensorTlm_t))
+   {
+      if (++SatCtrl->Mqtt.InvalidCnt == 1)
+      {
+         CFE_EVS_SendEvent(SAT_CTRL_SENSOR_TLM_EID, CFE_EVS_EventType_ERROR,
+                           "Rig %d sensor message rejected, length %d is less than %d",
+                           SatCtrl->RigIdx, (int)MsgSize, (int)sizeof(MQTT_GW_TblSatSensorTlm_t));
+      }
+      return;
+   }
+   
+   Sensor->LuxA       = Payload->LuxA;
+   Sensor->LuxB       = Payload->LuxB;
+   Sensor->RateX      = Payload->RateX;
+   Sensor->RateY      = Payload->RateY;
+   Sensor->RateZ      = Payload->RateZ;
+   Sensor->DeltaTime  = Payload->DeltaTime;
+   
+   Raw[SENSOR_TBL_CHAN_RATE_X] = Payload->RateX;
+   Raw[SENSOR_TBL_CHAN_RATE_Y] = Payload->RateY;
+   Raw[SENSOR_TBL_CHAN_RATE_Z] = Payload->RateZ;
+   Raw[SENSOR_TBL_CHAN_LUX_A]  = (float)Payload->LuxA;
+   Raw[SENSOR_TBL_CHAN_LUX_B]  = (float)Payload->LuxB;
+   SENSOR_TBL_Calibrate(&SatCtrl->SensorTbl, Raw, Cal);
+   
+   if (Payload->FreshMask & MQTT_GW_TblSatSensorFresh_TEMP)
+   {
+      SatCtrl->DieTemp      = Payload->Temp;
+      SatCtrl->DieTempValid = true;
+   }
+   
+   if (SatCtrl->GyroVersion != SatCtrl->SensorTbl.GyroVersion)
+   {
+      GYRO_BIAS_Reset(&SatCtrl->GyroBias);
+      SatCtrl->GyroVersion = SatCtrl->SensorTbl.GyroVersion;
+   }
+   if ((Payload->FreshMask & SAT_CTRL_SENSOR_GYRO_FRESH) == SAT_CTRL_SENSOR_GYRO_FRESH)
+   {
+      GYRO_BIAS_Update(&SatCtrl->GyroBias, &SatCtrl->SensorTbl.Data.BiasEst, &Cal[SENSOR_TBL_CHAN_RATE_X],
+                       SatCtrl->DieTemp, SatCtrl->DieTempValid, FansOff(&SatCtrl->Fan));
+   }
+   GYRO_BIAS_Correct(&SatCtrl->GyroBias, &SatCtrl->SensorTbl.Data.BiasEst, &Cal[SENSOR_TBL_CHAN_RATE_X],
+                     SatCtrl->DieTemp, SatCtrl->DieTempValid);
+   
+   if (Payload->FreshMask & MQTT_GW_TblSatSensorFresh_RATE_X)
+   {
+      STAT_SUM_Update(&SatCtrl->StatSum, STAT_SUM_CHAN_RATE_X, Payload->RateX);
+   }
+   if (Payload->FreshMask & MQTT_GW_TblSatSensorFresh_RATE_Y)
+   {
+      STAT_SUM_Update(&SatCtrl->StatSum, STAT_SUM_CHAN_RATE_Y, Payload->RateY);
+   }
+   if (Payload->FreshMask & MQTT_GW_TblSatSensorFresh_RATE_Z)
+   {
+      STAT_SUM_Update(&SatCtrl->StatSum, STAT_SUM_CHAN_RATE_Z, Payload->RateZ);
+   }
+   
+   if (SatCtrl->FilterVersion != SatCtrl->Tbl.FilterVersion)
+   {
+      for (i=0; i < SAT_CTRL_TBL_FILT_CNT; i++)
+      {
+         SENSOR_FILT_Reset(&SatCtrl->Filt[i]);
+      }
+      VIB_MON_ResetFilter(&SatCtrl->VibMon);
+      SatCtrl->FilterVersion = SatCtrl->Tbl.FilterVersion;
+   }
+   
+   if (Payload->FreshMask & (MQTT_GW_TblSatSensorFresh_LUX_A | MQTT_GW_TblSatSensorFresh_LUX_B))
+   {
+      if (SENSOR_FILT_Apply(&SatCtrl->Filt[SAT_CTRL_TBL_FILT_LIGHT], &SatCtrl->Tbl.FiltCoef[SAT_CTRL_TBL_FILT_LIGHT],
+                            Cal[SENSOR_TBL_CHAN_LUX_A] + Cal[SENSOR_TBL_CHAN_LUX_B], &Filtered))
+      {
+         Sensor->TotalLight = (Filtered > 0.0) ? (uint32)(Filtered + 0.5) : 0;
+         STAT_SUM_Update(&SatCtrl->StatSum, STAT_SUM_CHAN_TOTAL_LIGHT, Sensor->TotalLight);
+         LightFresh = true;
+      }
+   }
+   
+   SatCtrl->Mqtt.FreshMask = Payload->FreshMask;
+   if ((Payload->FreshMask & SAT_CTRL_SENSOR_STEP_FRESH) == SAT_CTRL_SENSOR_STEP_FRESH)
+   {
+      Sensor->StepTime += Payload->DeltaTime;
+      Notched = VIB_MON_Filter(&SatCtrl->VibMon, Cal[SENSOR_TBL_CHAN_RATE_Z]);
+      ATT_EST_UpdateRate(&SatCtrl->AttEst, &SatCtrl->Tbl.Data.AttEst, Notched*RAD_2_DEG, Payload->DeltaTime);
+      if (SENSOR_FILT_Apply(&SatCtrl->Filt[SAT_CTRL_TBL_FILT_RATE], &SatCtrl->Tbl.FiltCoef[SAT_CTRL_TBL_FILT_RATE],
+                            Notched, &Filtered))
+      {
+         Sensor->SpinRate = Filtered*RAD_2_DEG;
+         SatCtrl->Mqtt.NewSensorTlm = true;
+      }
+   }
+   
+   if (LightFresh && SUN_ACQ_ProfileValid(&SatCtrl->SunAcqMode))
+   {
+      ATT_EST_UpdateLight(&SatCtrl->AttEst, &SatCtrl->Tbl.Data.AttEst, Sensor->TotalLight,
+                          SatCtrl->SunAcqMode.ProfileLight, SUN_ACQ_PROFILE_BINS);
+   }
+   
+   if (SatCtrl->Mode == TBL_SAT_CtrlMode_SUN_ACQ)
+   {
+      Sensor->AngleDelta = SatCtrl->AttEst.X[ATT_EST_ANGLE] - SatCtrl->StepAngle;
+   }
+   else
+   {
+      Sensor->AngleDelta = 0.0;
+   }
 
-   CFE_SB_Buffer_t  *SbBufPtr;
-   CFE_SB_MsgId_t   MsgId = CFE_SB_INVALID_MSG_ID;
+} /* End SAT_CTRL_SetSensorTlm() */
 
-   SatCtrl->Mqtt.NewSensorTlm = false;
 
-   if (PendForMsg)
+/******************************************************************************
+** Function: CdsStateCrc
+**
+*/
+static uint32 CdsStateCrc(const SAT_CTRL_CdsState_t *CdsState)
+{
+
+   return CFE_ES_CalculateCRC(CdsState, offsetof(SAT_CTRL_CdsState_t, Crc), 0, CFE_ES_CrcType_CRC_16);
+
+} /* End CdsStateCrc() */
+
+
+/******************************************************************************
+** Function: CtrlStepDue
+**
+** Return true if the current mode's control step is due on this pass.
+*/
+static bool CtrlStepDue(const SAT_CTRL_Class_t *SatCtrl, uint64 NowMs)
+{
+
+   if (SatCtrl->Mode == TBL_SAT_CtrlMode_SUN_ACQ)
    {
-      SbStatus = CFE_SB_ReceiveBuffer(&SbBufPtr, SatCtrl->MqttPipe, CFE_SB_PEND_FOREVER);
+      return SatCtrl->Mqtt.NewSensorTlm;
    }
-   else
+
+   return (NowMs >= SatCtrl->NextExecTime);
+
+} /* End CtrlStepDue() */
+
+
+/******************************************************************************
+** Function: FansOff
+**
+** Return true if every fan's last output is zero. A PWM FIFO profile
+** drives the fans without updating their outputs.
+*/
+static bool FansOff(const FAN_Class_t *Fan)
+{
+
+   uint8 i;
+   
+   if (Fan->PwmFifoInUse)
    {
-      OS_printf("*****Child polling for messages\n");
-      SbStatus = CFE_SB_ReceiveBuffer(&SbBufPtr, SatCtrl->MqttPipe, CFE_SB_POLL);
+      return false;
    }
    
-   if (SbStatus == CFE_SUCCESS)
+   for (i=0; i < Fan->FanCnt; i++)
    {
-      SysStatus = CFE_MSG_GetMsgId(&SbBufPtr->Msg, &MsgId);
-
-      if (SysStatus == CFE_SUCCESS)
+      if (Fan->Actuator[i].PwmOutput != 0)
       {
+         return false;
+      }
+   }
+   
+   return true;
+
+} /* End FansOff() */
+
 
-         if (CFE_SB_MsgId_Equal(MsgId,SatCtrl->MqttSensorTlmMid))
+/******************************************************************************
+** Function: RegisterCds
+**
+** Register the rig's CDS block and restore the saved state if it's valid.
+**
+** Notes:
+**   1. cFE validates its own CRC when the block is restored. The state's
+**      CRC also detects a block that was never completely written.
+**   2. The restored mode resumes without its initialization step so
+**      SUN_ACQ continues from the saved survey, acquire or hold state.
+**
+*/
+static void RegisterCds(SAT_CTRL_Class_t *SatCtrl, uint32 MaxAge)
+{
+
+   SAT_CTRL_CdsState_t *CdsState = &SatCtrl->CdsState;
+   char    CdsName[OS_MAX_API_NAME];
+   const char *Discard = NULL;
+   int32   Status;
+   uint32  Age;
+
+   snprintf(CdsName, sizeof(CdsName), "SatCtrlRig%d", SatCtrl->RigIdx);
+
+   SatCtrl->CdsSavePeriod = SAT_CTRL_CDS_SAVE_PERIOD;
+   if (MaxAge > 0 && MaxAge*500 < SatCtrl->CdsSavePeriod)
+   {
+      SatCtrl->CdsSavePeriod = MaxAge*500;
+   }
+
+   Status = CFE_ES_RegisterCDS(&SatCtrl->CdsHandle, sizeof(SAT_CTRL_CdsState_t), CdsName);
+
+   if (Status == CFE_SUCCESS)
+   {
+      SatCtrl->CdsEnabled = true;
+   }
+   else if (Status == CFE_ES_CDS_ALREADY_EXISTS)
+   {
+
+      SatCtrl->CdsEnabled = true;
+
+      if (MaxAge == 0)
+      {
+         Discard = "restore disabled";
+      }
+      else if (CFE_ES_RestoreFromCDS(CdsState, SatCtrl->CdsHandle) != CFE_SUCCESS)
+      {
+         Discard = "cFE CDS restore failed";
+      }
+      else if (CdsState->Version != SAT_CTRL_CDS_VERSION || CdsState->Size != sizeof(SAT_CTRL_CdsState_t) ||
+               CdsState->Crc != CdsStateCrc(CdsState))
+      {
+         Discard = "invalid version, size or CRC";
+      }
+      else if (strncmp(CdsState->RigName, SatCtrl->RigName, SAT_CTRL_RIG_NAME_LEN) != 0)
+      {
+         Discard = "saved by a different rig";
+      }
+      else
+      {
+         Age = CFE_TIME_Subtract(CFE_TIME_GetTime(), CdsState->SaveTime).Seconds;
+         if (Age > MaxAge)
          {
-            MQTT_GW_TblSatSensorTlm_t *SensorTlm = (MQTT_GW_TblSatSensorTlm_t *)&SbBufPtr->Msg;
-            SatCtrl->Mqtt.NewSensorTlm = true;
-            OS_printf("MQTT sensor payload: DT: %.6f, RateX: %.6f, RateY: %.6f, RateZ: %.6f, LuxA: %d, LuxB: %d\n",
-                      SensorTlm->Payload.DeltaTime, SensorTlm->Payload.RateX, SensorTlm->Payload.RateY, 
-                      SensorTlm->Payload.RateZ, SensorTlm->Payload.LuxA, SensorTlm->Payload.LuxB);
-            memcpy(&SatCtrl->Mqtt.SensorTlm, &SbBufPtr->Msg, sizeof(MQTT_GW_TblSatSensorTlm_t));
-         } 
+            CFE_EVS_SendEvent(SAT_CTRL_CDS_EID, CFE_EVS_EventType_INFORMATION,
+                              "Rig %d saved state discarded, %u seconds old exceeds %u",
+                              SatCtrl->RigIdx, (unsigned int)Age, (unsigned int)MaxAge);
+         }
          else
-         {   
-            CFE_EVS_SendEvent(SATCTRL_GET_MQTT_MSG_EID, CFE_EVS_EventType_ERROR,
-                              "Received invalid MQTT packet, MID = 0x%04X", 
-                              CFE_SB_MsgIdToValue(MsgId));
+         {
+            SatCtrl->Mode       = CdsState->Mode;
+            SatCtrl->InitMode   = (CdsState->Mode == TBL_SAT_CtrlMode_IDLE);
+            SatCtrl->TimeInMode = CdsState->TimeInMode;
+            SatCtrl->Sensor     = CdsState->Sensor;
+            SatCtrl->TestMode   = CdsState->TestMode;
+            SatCtrl->SunAcqMode = CdsState->SunAcqMode;
+            SatCtrl->AttEst     = CdsState->AttEst;
+            SatCtrl->StepAngle  = CdsState->StepAngle;
+
+            if (CdsState->OverrideEnabled && CdsState->OverrideCount > 0)
+            {
+               FAN_OverridePwm(&SatCtrl->Fan, CdsState->OverrideCount,
+                               CdsState->OverridePwm[0], CdsState->OverridePwm[1]);
+            }
+
+            CFE_EVS_SendEvent(SAT_CTRL_CDS_EID, CFE_EVS_EventType_INFORMATION,
+                              "Rig %d warm restart, restored mode %d and SunAcq state %d saved %u seconds ago",
+                              SatCtrl->RigIdx, SatCtrl->Mode, SatCtrl->SunAcqMode.State, (unsigned int)Age);
          }
+      }
 
-      } /* End if got message ID */
-   } /* End if received buffer */
-   
-   return SatCtrl->Mqtt.NewSensorTlm;
+      if (Discard != NULL)
+      {
+         CFE_EVS_SendEvent(SAT_CTRL_CDS_EID, CFE_EVS_EventType_INFORMATION,
+                           "Rig %d saved state discarded, %s", SatCtrl->RigIdx, Discard);
+      }
+
+   }
+   else
+   {
+      CFE_EVS_SendEvent(SAT_CTRL_CDS_EID, CFE_EVS_EventType_ERROR,
+                        "Rig %d CDS %s registration failed, state won't be preserved. Status = 0x%08X",
+                        SatCtrl->RigIdx, CdsName, (unsigned int)Status);
+   }
 
-} /* End GetMqttMessages() */
+} /* End RegisterCds() */
+
+
+/******************************************************************************
+** Function: RunCmd
+**
+** Execute a sequence entry or a command posted to the rig's mailbox.
+*/
+static void RunCmd(SAT_CTRL_Class_t *SatCtrl, const SEQ_TBL_Entry_t *Entry)
+{
+
+   switch (Entry->Cmd)
+   {
+      case SEQ_TBL_CMD_SET_CTRL_MODE:
+         SAT_CTRL_SetMode(SatCtrl, Entry->Mode);
+         break;
+
+      case SEQ_TBL_CMD_SET_CTRL_GAINS:
+         SAT_CTRL_SetCtrlGains(SatCtrl, Entry->PosGain, Entry->RateGain);
+         break;
+
+      case SEQ_TBL_CMD_OVERRIDE_FAN_PWM:
+         FAN_OverridePwm(&SatCtrl->Fan, Entry->Duration, Entry->FanAPwm, Entry->FanBPwm);
+         break;
+
+      case SEQ_TBL_CMD_START_PWM_PLAYBACK:
+         FAN_StartPwmPlayback(&SatCtrl->Fan, Entry->Filename, Entry->RepeatCnt);
+         break;
+
+      case SEQ_TBL_CMD_STOP_PWM_PLAYBACK:
+         FAN_StopPwmPlayback(&SatCtrl->Fan);
+         break;
+
+      default:
+         CFE_EVS_SendEvent(SEQ_STATE_EID, CFE_EVS_EventType_ERROR,
+                           "Rig %d undefined sequence or posted command %d", SatCtrl->RigIdx, Entry->Cmd);
+         break;
+   }
+
+} /* End RunCmd() */
+
+
+/******************************************************************************
+** Function: SaveCdsState
+**
+** Notes:
+**   1. CdsState holds the last saved state so it's compared with the
+**      current state before it's rebuilt. The override count and the
+**      estimator state change every step and are only saved periodically.
+**
+*/
+static void SaveCdsState(SAT_CTRL_Class_t *SatCtrl, uint64 NowMs)
+{
+
+   SAT_CTRL_CdsState_t *CdsState = &SatCtrl->CdsState;
+   bool Changed;
+
+   if (!SatCtrl->CdsEnabled)
+   {
+      return;
+   }
+
+   Changed = (CdsState->Mode               != SatCtrl->Mode ||
+              CdsState->SunAcqMode.State   != SatCtrl->SunAcqMode.State ||
+              CdsState->TestMode.CurStep   != SatCtrl->TestMode.CurStep ||
+              CdsState->OverrideEnabled    != SatCtrl->Fan.OverridePwmCmdEnabled ||
+              CdsState->OverridePwm[0]     != SatCtrl->Fan.Actuator[0].OverridePwmCmd ||
+              CdsState->OverridePwm[1]     != SatCtrl->Fan.Actuator[1].OverridePwmCmd);
+
+   if (!Changed && NowMs < SatCtrl->CdsSaveTime + SatCtrl->CdsSavePeriod)
+   {
+      return;
+   }
+   SatCtrl->CdsSaveTime = NowMs;
+
+   memset(CdsState, 0, sizeof(SAT_CTRL_CdsState_t));
+
+   CdsState->Version  = SAT_CTRL_CDS_VERSION;
+   CdsState->Size     = sizeof(SAT_CTRL_CdsState_t);
+   strncpy(CdsState->RigName, SatCtrl->RigName, SAT_CTRL_RIG_NAME_LEN);
+   CdsState->SaveTime = CFE_TIME_GetTime();
+
+   CdsState->Mode       = SatCtrl->Mode;
+   CdsState->TimeInMode = SatCtrl->TimeInMode;
+   CdsState->Sensor     = SatCtrl->Sensor;
+   CdsState->TestMode   = SatCtrl->TestMode;
+   CdsState->SunAcqMode = SatCtrl->SunAcqMode;
+   CdsState->AttEst     = SatCtrl->AttEst;
+   CdsState->StepAngle  = SatCtrl->StepAngle;
+
+   CdsState->OverrideEnabled = SatCtrl->Fan.OverridePwmCmdEnabled;
+   CdsState->OverrideCount   = SatCtrl->Fan.OverridePwmCmdCount;
+   CdsState->OverridePwm[0]  = SatCtrl->Fan.Actuator[0].OverridePwmCmd;
+   CdsState->OverridePwm[1]  = SatCtrl->Fan.Actuator[1].OverridePwmCmd;
+
+   CdsState->Crc = CdsStateCrc(CdsState);
+
+   CFE_ES_CopyToCDS(SatCtrl->CdsHandle, CdsState);
+
+} /* End SaveCdsState() */
 
 
 /******************************************************************************
 ** Function: SunAcqMode 
 **
 */
-static void SunAcqMode(void)
+static void SunAcqMode(SAT_CTRL_Class_t *SatCtrl)
 {
 
-   double LightDelta, AngleDelta, Ctrl;
+   SUN_ACQ_Param_t Param;
+   double AngleDelta;
+   double StepTime;
+   uint8  PrevState;
 
    if (SatCtrl->InitMode)
    {
       SatCtrl->InitMode = false;
-      SatCtrl->Sensor.SpinRate = 0.0;
-      SatCtrl->Sensor.SpinRate = 0.0;      
-      SatCtrl->SunAcqMode.State = TBL_SAT_SunAcqState_SURVEY;
-      SatCtrl->SunAcqMode.SurveyMaxLight = 0;
-      SatCtrl->SunAcqMode.SurveyRotation = 0.0;
-      SatCtrl->SunAcqMode.LightIntensity = LIGHT_UNDEF;
-   }
-   
-   if (GetMqttMessages(true))
-   {
-      SatCtrl->Sensor.TotalLight = 
-          SatCtrl->Mqtt.SensorTlm.Payload.LuxA + 
-          SatCtrl->Mqtt.SensorTlm.Payload.LuxB;
-          
-      SatCtrl->Sensor.SpinRate = SatCtrl->Mqtt.SensorTlm.Payload.RateZ*RAD_2_DEG;;
-      AngleDelta = SatCtrl->Sensor.SpinRate * SatCtrl->Mqtt.SensorTlm.Payload.DeltaTime;
-      
+      SUN_ACQ_Init(&SatCtrl->SunAcqMode);
+      ATT_EST_SetAngle(&SatCtrl->AttEst, 0.0);
+      SatCtrl->StepAngle = 0.0;
+      SatCtrl->Sensor.AngleDelta = 0.0;
+      SatCtrl->Sensor.StepTime   = 0.0;
    }
    
-   switch (SatCtrl->SunAcqMode.State)
-   {
-      case TBL_SAT_SunAcqState_SURVEY:
-          SatCtrl->SunAcqMode.FanAPwmCmd = 0.0;
-          SatCtrl->SunAcqMode.FanBPwmCmd = SatCtrl->Tbl.Data.SurveyFanPwm;
-          SatCtrl->SunAcqMode.SurveyRotation += AngleDelta;
-          OS_printf("SatCtrl->SunAcqMode.SurveyRotation: %.6f\n", SatCtrl->SunAcqMode.SurveyRotation);
-          if (SatCtrl->SunAcqMode.SurveyRotation < 360.0)
-          {
-             if (SatCtrl->Sensor.TotalLight > SatCtrl->SunAcqMode.SurveyMaxLight)
-             {
-                SatCtrl->SunAcqMode.SurveyMaxLight = SatCtrl->Sensor.TotalLight;
-             }
-          }
-          else
-          {
-             SatCtrl->SunAcqMode.State = TBL_SAT_SunAcqState_ACQUIRE;
-             SatCtrl->SunAcqMode.AcquireTolerance = 
-                (double)SatCtrl->SunAcqMode.SurveyMaxLight * 0.1;
-          }
-          break;
-      case TBL_SAT_SunAcqState_ACQUIRE:
-          // Leave fans in survey mode config to get within 10% of maxlight
-          LightDelta = fabs((double)SatCtrl->SunAcqMode.SurveyMaxLight - (double)SatCtrl->Sensor.TotalLight);
-          if (LightDelta < SatCtrl->SunAcqMode.AcquireTolerance)
-          {
-             SatCtrl->SunAcqMode.State = TBL_SAT_SunAcqState_HOLD;
-          } 
-          break;
-      case TBL_SAT_SunAcqState_HOLD:
-          Ctrl = SatCtrl->Sensor.SpinRate * SatCtrl->Tbl.Data.RateGain +
-                 AngleDelta * SatCtrl->Tbl.Data.PosGain;
-          OS_printf("Ctrl: %.6f\n", Ctrl);
-          SatCtrl->SunAcqMode.FanAPwmCmd = 0.0;
-          SatCtrl->SunAcqMode.FanBPwmCmd = 0.0;
-          break;
-      default:
-          SatCtrl->InitMode = true;
-          CFE_EVS_SendEvent(SATCTRL_SUN_ACQ_EID, CFE_EVS_EventType_ERROR,
-             "Invlaid SunAcq state %d, resetting the controller", 
-             SatCtrl->SunAcqMode.State);
+   /* Only called when new sensor telemetry has been received */
+   AngleDelta = SatCtrl->Sensor.AngleDelta;
+   SatCtrl->StepAngle += AngleDelta;
+   SatCtrl->Sensor.AngleDelta = 0.0;
+   StepTime = SatCtrl->Sensor.StepTime;
+   SatCtrl->Sensor.StepTime = 0.0;
+   
+   Param.SurveyFanPwm = (float)SatCtrl->Tbl.Data.SurveyFanPwm;
+   Param.PosGain      = SatCtrl->Tbl.Data.PosGain;
+   Param.RateGain     = SatCtrl->Tbl.Data.RateGain;
+   Param.Slew         = SatCtrl->Tbl.Data.Slew;
+   
+   PrevState = SatCtrl->SunAcqMode.State;
+   if (SUN_ACQ_Step(&SatCtrl->SunAcqMode, &Param, SatCtrl->Sensor.TotalLight,
+                    SatCtrl->Sensor.SpinRate, AngleDelta, StepTime))
+   {
+      if (PrevState == SUN_ACQ_STATE_SURVEY && SatCtrl->SunAcqMode.State == SUN_ACQ_STATE_ACQUIRE)
+      {
+         CFE_EVS_SendEvent(SATCTRL_SUN_ACQ_EID, CFE_EVS_EventType_INFORMATION,
+            "Rig %d survey complete, light source at %.1f deg, brightest sample at %.1f deg, slew model %s",
+            SatCtrl->RigIdx, SatCtrl->SunAcqMode.SourceAngle, SatCtrl->SunAcqMode.SurveyMaxLightAngle,
+            SatCtrl->SunAcqMode.Slew.ModelValid ? "valid" : "invalid");
+      }
+   }
+   else
+   {
+      SatCtrl->InitMode = true;
+      CFE_EVS_SendEvent(SATCTRL_SUN_ACQ_EID, CFE_EVS_EventType_ERROR,
+         "Rig %d invlaid SunAcq state %d, resetting the controller", 
+         SatCtrl->RigIdx, SatCtrl->SunAcqMode.State);
    }
    
-   FAN_SetPwm(TBL_SAT_FanId_A, SatCtrl->SunAcqMode.FanAPwmCmd);
-   FAN_SetPwm(TBL_SAT_FanId_B, SatCtrl->SunAcqMode.FanBPwmCmd);
+   FAN_SetEffort(&SatCtrl->Fan, SatCtrl->SunAcqMode.Effort);
    
    return;
    
@@ -373,9 +749,11 @@ static void SunAcqMode(void)
 ** Function: TestMode 
 **
 */
-static void TestMode(void)
+static void TestMode(SAT_CTRL_Class_t *SatCtrl)
 {
  
+   uint8 i;
+   
    if (SatCtrl->InitMode)
    {
       SatCtrl->InitMode = false;
@@ -386,14 +764,16 @@ static void TestMode(void)
                                         SatCtrl->ExecPerSec;
       
       CFE_EVS_SendEvent (SAT_CTRL_TEST_MODE_EID, CFE_EVS_EventType_INFORMATION, 
-                         "Test mode initialized: Steps %d, CyclesPerStep %d, PwmPerStep %d, TimeInStep %d",
-                         SatCtrl->Tbl.Data.Test.Steps, SatCtrl->TestMode.CyclesPerStep,
+                         "Rig %d test mode initialized: Steps %d, CyclesPerStep %d, PwmPerStep %d, TimeInStep %d",
+                         SatCtrl->RigIdx, SatCtrl->Tbl.Data.Test.Steps, SatCtrl->TestMode.CyclesPerStep,
                          SatCtrl->TestMode.PwmPerStep, SatCtrl->Tbl.Data.Test.TimeInStep);
    
    }
    
-   FAN_SetPwm(TBL_SAT_FanId_A, SatCtrl->TestMode.CurPwm);
-   FAN_SetPwm(TBL_SAT_FanId_B, SatCtrl->TestMode.CurPwm);
+   for (i=0; i < SatCtrl->Fan.FanCnt; i++)
+   {
+      FAN_SetPwm(&SatCtrl->Fan, i, SatCtrl->TestMode.CurPwm);
+   }
    
    SatCtrl->TestMode.CyclesInStep++;
    
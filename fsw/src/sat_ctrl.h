@@ -16,10 +16,54 @@
 **    Define the Table Sat controller class
 **
 **  Notes:
-**    1. Conceptually GPIO could be a separate object but since 
-**       mapping is the only function performed by the GPIO object 
-**       it's part of SAT_CTRL. Also since SAT_CTRL contains all
-**       of the GPIO objects connected to the GPIO it makes it easy.
+**    1. Each rig owns one SAT_CTRL object that is passed as the first
+**       parameter to each function. The objects are owned by RIG_MGR which
+**       maps the GPIO peripherals that are shared by all rigs, routes each
+**       rig's sensor telemetry and calls SAT_CTRL_Execute() from the worker
+**       task assigned to the rig.
+**    2. A rig in SUN_ACQ mode runs a control step each time new rate
+**       sensor telemetry arrives. All other modes run a step every
+**       ExecPeriod milliseconds.
+**    3. The controller state is saved to a Critical Data Store (CDS) block
+**       after a control step that changes the mode, the SUN_ACQ state, the
+**       test mode step or the fan override. The estimator state is
+**       otherwise saved every SAT_CTRL_CDS_SAVE_PERIOD milliseconds, or
+**       half the maximum age if that's shorter so the last save is always
+**       young enough to restore. The block is protected by a CRC and holds
+**       the mode, sun acquisition state and survey results, the sensor
+**       estimates, the attitude estimator's state and covariance and an
+**       active fan override. When the app restarts the
+**       saved state is restored if it belongs to the same rig and is no
+**       older than SAT_CTRL_CDS_MAX_AGE seconds, so a rig in SUN_ACQ
+**       resumes where it left off instead of repeating the survey. A
+**       maximum age of zero disables the restore.
+**    4. Each rig has a command sequencer that runs at the start of each
+**       control step, see seq.h.
+**    5. Sensor messages are calibrated by the rig's sensor table and the
+**       calibrated Z rate and total light are filtered by the control
+**       table's sensor filter chains as messages arrive. The raw and
+**       calibrated sensor values are kept for telemetry and SpinRate and
+**       TotalLight hold the filtered values used by the controller.
+**    6. Ground commands that change the controller state are posted to the
+**       rig's command mailbox by the main task and applied by the worker at
+**       the start of SAT_CTRL_Execute(), see cmd_mbox.h. The mode, gain and
+**       fan override functions are only called by the worker. Table loads
+**       are staged by the main task and activated at the same point.
+**    7. The worker accumulates each rig's raw rates, total light and fan
+**       commands and sends a StatsTlm summary each interval, see
+**       stat_sum.h.
+**    8. The calibrated Z rate passes through the rig's vibration notch
+**       before the rate filter chain. The rates before the notch are
+**       analyzed by the rig manager's background task, see vib_mon.h.
+**    9. The rig's gyro bias estimator learns the bias left in the
+**       calibrated rates while the fans are off and removes it before the
+**       rates are used, see gyro_bias.h. The gyro's die temperature is
+**       optional and isn't saved in the CDS.
+**   10. Each calibrated Z rate sample, after the notch, propagates and
+**       updates the rig's attitude estimator. Once the SUN_ACQ survey has a
+**       complete light profile each filtered light sample also updates the
+**       estimated angle. SUN_ACQ's AngleDelta is the estimated angle's
+**       change since the previous step, see att_est.h.
 **
 */
 
@@ -33,13 +77,28 @@
 
 #include "app_cfg.h"
 #include "sat_ctrl_tbl.h"
+#include "sensor_tbl.h"
 #include "fan.h"
+#include "seq.h"
+#include "cmd_mbox.h"
+#include "stat_sum.h"
+#include "sun_acq.h"
 
 
 /***********************/
 /** Macro Definitions **/
 /***********************/
 
+#define SAT_CTRL_RIG_NAME_LEN       16
+#define SAT_CTRL_CDS_VERSION         7  /* Increment when SAT_CTRL_CdsState_t changes */
+#define SAT_CTRL_CDS_SAVE_PERIOD  1000  /* Longest milliseconds between CDS saves */
+
+/* Sensor fields that must be fresh to trigger a SUN_ACQ control step */
+#define SAT_CTRL_SENSOR_STEP_FRESH  (MQTT_GW_TblSatSensorFresh_DELTA_TIME | MQTT_GW_TblSatSensorFresh_RATE_Z)
+
+/* Sensor fields that must be fresh to update the gyro bias estimate */
+#define SAT_CTRL_SENSOR_GYRO_FRESH  (MQTT_GW_TblSatSensorFresh_RATE_X | MQTT_GW_TblSatSensorFresh_RATE_Y | \
+                                     MQTT_GW_TblSatSensorFresh_RATE_Z)
 
 /*
 ** Event Message IDs
@@ -48,10 +107,10 @@
 #define SAT_CTRL_CONSTRUCTOR_EID    (SAT_CTRL_BASE_EID + 0)
 #define SAT_CTRL_SET_MODE_EID       (SAT_CTRL_BASE_EID + 1)
 #define SAT_CTRL_SET_CTRL_GAINS_EID (SAT_CTRL_BASE_EID + 2)
-#define SAT_CTRL_CHILD_TASK_EID     (SAT_CTRL_BASE_EID + 3)
 #define SATCTRL_SUN_ACQ_EID         (SAT_CTRL_BASE_EID + 4)
 #define SAT_CTRL_TEST_MODE_EID      (SAT_CTRL_BASE_EID + 5)
-#define SATCTRL_GET_MQTT_MSG_EID    (SAT_CTRL_BASE_EID + 6)
+#define SAT_CTRL_CDS_EID            (SAT_CTRL_BASE_EID + 6)
+#define SAT_CTRL_SENSOR_TLM_EID     (SAT_CTRL_BASE_EID + 7)
 
 /**********************/
 /** Type Definitions **/
@@ -69,30 +128,51 @@
 
 
 /******************************************************************************
-** SAT_CTRL_Class
+** Constructor configuration
 */
 
-typedef enum
+typedef struct
 {
-   LIGHT_UNDEF      = 1,
-   LIGHT_INCREASING = 2,
-   LIGHT_DECREASING = 3
-   
-} SAT_CTRL_LightIntensity_t;
 
+   uint8         RigIdx;
+   const char   *Name;            /* Identifies the rig's saved CDS state */
+   uint32        SensorTlmTopicId;
+   const char   *TblFilename;     /* Default control parameter table */
+   const char   *SensorTblFilename; /* Default sensor calibration table */
+   FAN_Config_t  Fan;
+
+} SAT_CTRL_Config_t;
+
+
+/******************************************************************************
+** SAT_CTRL_Class
+*/
 
 typedef struct
 {
-   bool                       NewSensorTlm;
-   MQTT_GW_TblSatSensorTlm_t  SensorTlm;
+   bool    NewSensorTlm;
+   uint16  FreshMask;     /* MQTT_GW_TblSatSensorFresh bits of the last message */
+   uint32  InvalidCnt;    /* Messages rejected because they're too short */
    
 } SAT_CTRL_Mqtt_t;
 
 
+/*
+** Values read from the sensor messages. The messages are read in place
+** from the SB buffer so only these values are kept.
+*/
 typedef struct
 {
+   uint32  LuxA;
+   uint32  LuxB;
+   float   RateX;       /* Radians/sec */
+   float   RateY;
+   float   RateZ;
+   float   DeltaTime;
    uint32  TotalLight;
-   double  SpinRate;
+   double  SpinRate;    /* Degrees/sec */
+   double  AngleDelta;  /* SUN_ACQ rotation since the last step, degrees */
+   double  StepTime;    /* Rate sample time since the last SUN_ACQ step, seconds */
    
 } SAT_CTRL_Sensor_t;
 
@@ -107,20 +187,36 @@ typedef struct
    
 } SAT_CTRL_TestMode_t;
 
+
+
+/******************************************************************************
+** Critical Data Store state
+*/
+
 typedef struct
 {
 
-   TBL_SAT_SunAcqState_Enum_t  State;
-   double  PosErr;
-   double  RateErr;
-   uint16  FanAPwmCmd;
-   uint16  FanBPwmCmd;
-   uint32  SurveyMaxLight;
-   double  SurveyRotation;
-   double  AcquireTolerance;
-   SAT_CTRL_LightIntensity_t  LightIntensity;
-   
-} SAT_CTRL_SunAcqMode_t;
+   uint32  Version;
+   uint32  Size;
+   char    RigName[SAT_CTRL_RIG_NAME_LEN];
+   CFE_TIME_SysTime_t  SaveTime;
+
+   TBL_SAT_CtrlMode_Enum_t  Mode;
+   uint32                   TimeInMode;
+   SAT_CTRL_Sensor_t        Sensor;
+   SAT_CTRL_TestMode_t      TestMode;
+   SUN_ACQ_Class_t          SunAcqMode;
+   ATT_EST_Class_t          AttEst;
+   double                   StepAngle;
+
+   bool    OverrideEnabled;
+   uint32  OverrideCount;
+   uint16  OverridePwm[2];
+
+   uint32  Crc;   /* Must be last, covers every preceding byte */
+
+} SAT_CTRL_CdsState_t;
+
 
 typedef struct
 {
@@ -136,25 +232,52 @@ typedef struct
    ** Class State Data
    */
 
-   bool    GpioMapped;
+   uint8   RigIdx;
    
    uint32  ExecPeriod;  // Execution period in milliseconds
    uint16  ExecPerSec;                   
    uint32  ExecCntr;
+   uint64  NextExecTime;  // CLOCK_MONOTONIC milliseconds
 
-   CFE_SB_PipeId_t   MqttPipe;
    CFE_SB_MsgId_t    MqttSensorTlmMid;
    SAT_CTRL_Mqtt_t   Mqtt;
    SAT_CTRL_Sensor_t Sensor;
    FAN_Class_t       Fan;
    
+   bool                  CdsEnabled;
+   CFE_ES_CDSHandle_t    CdsHandle;
+   SAT_CTRL_CdsState_t   CdsState;       /* Last saved state */
+   uint32                CdsSavePeriod;  /* Milliseconds */
+   uint64                CdsSaveTime;    /* CLOCK_MONOTONIC milliseconds */
+   char                  RigName[SAT_CTRL_RIG_NAME_LEN];
+
    TBL_SAT_CtrlMode_Enum_t  Mode;
    bool                     InitMode;
    uint32                   TimeInMode;
    SAT_CTRL_TBL_Class_t     Tbl;
    
    SAT_CTRL_TestMode_t      TestMode;
-   SAT_CTRL_SunAcqMode_t    SunAcqMode;
+   SUN_ACQ_Class_t          SunAcqMode;
+   
+   SEQ_Class_t              Seq;
+   CMD_MBOX_Class_t         CmdMbox;
+   STAT_SUM_Class_t         StatSum;
+   
+   SENSOR_TBL_Class_t       SensorTbl;
+   float                    SensorCal[SENSOR_TBL_CHAN_CNT];  /* Calibrated sensor values */
+   
+   SENSOR_FILT_Class_t      Filt[SAT_CTRL_TBL_FILT_CNT];
+   uint16                   FilterVersion;  /* Table filter version of the filter state */
+   
+   VIB_MON_Class_t          VibMon;
+   
+   GYRO_BIAS_Class_t        GyroBias;
+   uint16                   GyroVersion;    /* Sensor table gyro version of the bias estimate */
+   float                    DieTemp;        /* Last gyro die temperature, deg C */
+   bool                     DieTempValid;
+   
+   ATT_EST_Class_t          AttEst;
+   double                   StepAngle;      /* Estimated angle at the last SUN_ACQ step, degrees */
          
 } SAT_CTRL_Class_t;
 
@@ -167,21 +290,34 @@ typedef struct
 /******************************************************************************
 ** Function: SAT_CTRL_Constructor
 **
-** Initialize the GPIO Controller object to a known state
+** Initialize a rig's controller object to a known state
 **
 ** Notes:
 **   1. This must be called prior to any other function.
+**   2. The default tables are loaded by the constructor.
+**   3. The rig's CDS block is registered and, on a warm restart, the saved
+**      controller state is restored.
 **
 */
-void SAT_CTRL_Constructor(SAT_CTRL_Class_t *GpioCtrlPtr, INITBL_Class_t *IniTbl,
-                          TBLMGR_Class_t *TblMgr);
+void SAT_CTRL_Constructor(SAT_CTRL_Class_t *SatCtrl, INITBL_Class_t *IniTbl,
+                          const SAT_CTRL_Config_t *Config);
 
 
 /******************************************************************************
-** Function: SAT_CTRL_ChildTask
+** Function: SAT_CTRL_Execute
+**
+** Apply posted commands, run a control step if one is due and write the
+** fan commands. NowMs is CLOCK_MONOTONIC in milliseconds. Returns true if a
+** step was run.
+**
+** Notes:
+**   1. Sequence commands that are due are executed before the control mode
+**      so they take effect in the current step.
+**   2. Posted commands are applied even when no step is due so a mode
+**      change takes effect as soon as the worker wakes up.
 **
 */
-bool SAT_CTRL_ChildTask(CHILDMGR_Class_t *ChildMgr);
+bool SAT_CTRL_Execute(SAT_CTRL_Class_t *SatCtrl, uint64 NowMs);
 
 
 /******************************************************************************
@@ -194,21 +330,39 @@ bool SAT_CTRL_ChildTask(CHILDMGR_Class_t *ChildMgr);
 **      change the functional behavior should be reset.
 **
 */
-void SAT_CTRL_ResetStatus(void);
+void SAT_CTRL_ResetStatus(SAT_CTRL_Class_t *SatCtrl);
 
 
 /******************************************************************************
-** Function: SAT_CTRL_SetModeCmd
+** Function: SAT_CTRL_SetCtrlGains
 **
+** Must be called from the rig's worker, the main task posts the command to
+** the rig's mailbox.
 */
-bool SAT_CTRL_SetModeCmd(void *DataObjPtr, const CFE_MSG_Message_t *MsgPtr);
+bool SAT_CTRL_SetCtrlGains(SAT_CTRL_Class_t *SatCtrl, float PosGain, float RateGain);
 
 
 /******************************************************************************
-** Function: SAT_CTRL_SetCtrlGainsCmd
+** Function: SAT_CTRL_SetMode
+**
+** Must be called from the rig's worker, the main task posts the command to
+** the rig's mailbox. Returns false if NewMode isn't a defined control mode.
+*/
+bool SAT_CTRL_SetMode(SAT_CTRL_Class_t *SatCtrl, TBL_SAT_CtrlMode_Enum_t NewMode);
+
+
+/******************************************************************************
+** Function: SAT_CTRL_SetSensorTlm
+**
+** Read a sensor telemetry message from the rig's MQTT topic. Must be called
+** from the task that calls SAT_CTRL_Execute() for the rig.
+**
+** Notes:
+**   1. The message is read in place and isn't referenced after the call
+**      returns so the caller can pass a received SB buffer.
 **
 */
-bool SAT_CTRL_SetCtrlGainsCmd(void *DataObjPtr, const CFE_MSG_Message_t *MsgPtr);
+void SAT_CTRL_SetSensorTlm(SAT_CTRL_Class_t *SatCtrl, const CFE_MSG_Message_t *MsgPtr);
 
 
 #endif /* _sat_ctrl_ */
@@ -17,7 +17,10 @@
 **
 **  Notes:
 **    1. The static "TblData" serves as a table load buffer. Table dump data is
-**       read directly from table owner's table storage.
+**       read directly from table owner's table storage, the staged load if
+**       it hasn't been activated yet.
+**    2. LoadTbl identifies the instance being loaded while CJSON calls
+**       LoadJsonData(). It's only valid during SAT_CTRL_TBL_Load().
 **
 */
 
@@ -33,6 +36,17 @@
 /** Macro Definitions **/
 /***********************/
 
+#define FILT_JSON_OBJ(Idx, Field, Float, Key) \
+   { &TblData.Filter.Chain[Idx].Field, sizeof(TblData.Filter.Chain[Idx].Field), false, JSONNumber, Float, \
+     { Key, (sizeof(Key)-1)} }
+
+#define FILT_JSON_OBJS(Idx, Prefix) \
+   FILT_JSON_OBJ(Idx, Bias,        true,  Prefix ".bias"),          \
+   FILT_JSON_OBJ(Idx, MedianLen,   false, Prefix ".median-len"),    \
+   FILT_JSON_OBJ(Idx, LpfOrder,    false, Prefix ".lpf-order"),     \
+   FILT_JSON_OBJ(Idx, LpfCutoffHz, true,  Prefix ".lpf-cutoff-hz"), \
+   FILT_JSON_OBJ(Idx, Decimation,  false, Prefix ".decimation")
+
 
 /**********************/
 /** Type Definitions **/
@@ -43,6 +57,7 @@
 /** Local File Function Prototypes **/
 /************************************/
 
+static bool DesignFilters(SENSOR_FILT_Coef_t *Coef, const SAT_CTRL_TBL_Filter_t *Filter);
 static bool LoadJsonData(size_t JsonFileLen);
 
 
@@ -50,9 +65,13 @@ static bool LoadJsonData(size_t JsonFileLen);
 /** Global File Data **/
 /**********************/
 
-static SAT_CTRL_TBL_Class_t *SatCtrlTbl = NULL;
+static SAT_CTRL_TBL_Class_t *LoadTbl = NULL;
 
 static SAT_CTRL_TBL_Data_t TblData; /* Working buffer for loads */
+static SENSOR_FILT_Coef_t  FiltCoef[SAT_CTRL_TBL_FILT_CNT];
+
+static const char *FiltName[SAT_CTRL_TBL_FILT_CNT] = { "rate-filter", "light-filter" };
+static char JsonBuf[SAT_CTRL_TBL_JSON_FILE_MAX_CHAR];
 
 static CJSON_Obj_t JsonTblObjs[] = {
 
@@ -62,7 +81,22 @@ static CJSON_Obj_t JsonTblObjs[] = {
    { &TblData.PosGain,          sizeof(TblData.PosGain),          false,    JSONNumber, true,   { "pos-gain",            (sizeof("pos-gain")-1)}            },
    { &TblData.RateGain,         sizeof(TblData.RateGain),         false,    JSONNumber, true,   { "rate-gain",           (sizeof("rate-gain")-1)}           },
    { &TblData.Test.Steps,       sizeof(TblData.Test.Steps),       false,    JSONNumber, false,  { "test-steps",          (sizeof("test-steps")-1)}          },
-   { &TblData.Test.TimeInStep,  sizeof(TblData.Test.TimeInStep),  false,    JSONNumber, false,  { "test-time-in-step",   (sizeof("test-time-in-step")-1)}   }
+   { &TblData.Test.TimeInStep,  sizeof(TblData.Test.TimeInStep),  false,    JSONNumber, false,  { "test-time-in-step",   (sizeof("test-time-in-step")-1)}   },
+   { &TblData.Filter.SampleHz,  sizeof(TblData.Filter.SampleHz),  false,    JSONNumber, true,   { "filter-sample-hz",    (sizeof("filter-sample-hz")-1)}    },
+   FILT_JSON_OBJS(SAT_CTRL_TBL_FILT_RATE,  "rate-filter"),
+   FILT_JSON_OBJS(SAT_CTRL_TBL_FILT_LIGHT, "light-filter"),
+   { &TblData.VibNotch.Enabled, sizeof(TblData.VibNotch.Enabled), false,    JSONNumber, false,  { "vib-notch.enabled",   (sizeof("vib-notch.enabled")-1)}   },
+   { &TblData.VibNotch.Q,       sizeof(TblData.VibNotch.Q),       false,    JSONNumber, true,   { "vib-notch.q",         (sizeof("vib-notch.q")-1)}         },
+   { &TblData.VibNotch.MinAmp,  sizeof(TblData.VibNotch.MinAmp),  false,    JSONNumber, true,   { "vib-notch.min-amp",   (sizeof("vib-notch.min-amp")-1)}   },
+   { &TblData.AttEst.RateStd,   sizeof(TblData.AttEst.RateStd),   false,    JSONNumber, true,   { "att-est.rate-std",    (sizeof("att-est.rate-std")-1)}    },
+   { &TblData.AttEst.AccelStd,  sizeof(TblData.AttEst.AccelStd),  false,    JSONNumber, true,   { "att-est.accel-std",   (sizeof("att-est.accel-std")-1)}   },
+   { &TblData.AttEst.BiasWalk,  sizeof(TblData.AttEst.BiasWalk),  false,    JSONNumber, true,   { "att-est.bias-walk",   (sizeof("att-est.bias-walk")-1)}   },
+   { &TblData.AttEst.LightStd,  sizeof(TblData.AttEst.LightStd),  false,    JSONNumber, true,   { "att-est.light-std",   (sizeof("att-est.light-std")-1)}   },
+   { &TblData.AttEst.Gate,      sizeof(TblData.AttEst.Gate),      false,    JSONNumber, true,   { "att-est.gate",        (sizeof("att-est.gate")-1)}        },
+   { &TblData.Slew.FanPwm,      sizeof(TblData.Slew.FanPwm),      false,    JSONNumber, false,  { "slew.fan-pwm",        (sizeof("slew.fan-pwm")-1)}        },
+   { &TblData.Slew.MaxRate,     sizeof(TblData.Slew.MaxRate),     false,    JSONNumber, true,   { "slew.max-rate",       (sizeof("slew.max-rate")-1)}       },
+   { &TblData.Slew.PosTol,      sizeof(TblData.Slew.PosTol),      false,    JSONNumber, true,   { "slew.pos-tol",        (sizeof("slew.pos-tol")-1)}        },
+   { &TblData.Slew.RateTol,     sizeof(TblData.Slew.RateTol),     false,    JSONNumber, true,   { "slew.rate-tol",       (sizeof("slew.rate-tol")-1)}       }
 
 };
 
@@ -74,11 +108,9 @@ static CJSON_Obj_t JsonTblObjs[] = {
 **    1. This must be called prior to any other functions
 **
 */
-void SAT_CTRL_TBL_Constructor(SAT_CTRL_TBL_Class_t *SatCtrlTblPtr)
+void SAT_CTRL_TBL_Constructor(SAT_CTRL_TBL_Class_t *SatCtrlTbl)
 {
 
-   SatCtrlTbl = SatCtrlTblPtr;
-
    CFE_PSP_MemSet(SatCtrlTbl, 0, sizeof(SAT_CTRL_TBL_Class_t));   
    
    SatCtrlTbl->JsonObjCnt = (sizeof(JsonTblObjs)/sizeof(CJSON_Obj_t));
@@ -87,10 +119,37 @@ void SAT_CTRL_TBL_Constructor(SAT_CTRL_TBL_Class_t *SatCtrlTblPtr)
 
 
 /******************************************************************************
-** Function: SAT_CTRL_TBL_DumpCmd
+** Function: SAT_CTRL_TBL_Activate
+**
+** Notes:
+**  1. The acquire load pairs with the release store in LoadJsonData() so the
+**     staged data is complete when ActivatePending is seen. FilterVersion is
+**     only changed after the copy.
+*/
+bool SAT_CTRL_TBL_Activate(SAT_CTRL_TBL_Class_t *SatCtrlTbl)
+{
+
+   if (!__atomic_load_n(&SatCtrlTbl->ActivatePending, __ATOMIC_ACQUIRE))
+   {
+      return false;
+   }
+
+   memcpy(&SatCtrlTbl->Data, &SatCtrlTbl->LoadData, sizeof(SAT_CTRL_TBL_Data_t));
+   memcpy(SatCtrlTbl->FiltCoef, SatCtrlTbl->LoadFiltCoef, sizeof(SatCtrlTbl->FiltCoef));
+   SatCtrlTbl->FilterVersion++;
+
+   __atomic_store_n(&SatCtrlTbl->ActivatePending, false, __ATOMIC_RELEASE);
+
+   return true;
+
+} /* End SAT_CTRL_TBL_Activate() */
+
+
+/******************************************************************************
+** Function: SAT_CTRL_TBL_Dump
 **
 ** Notes:
-**  1. Function signature must match TBLMGR_DumpTblFuncPtr_t.
+**  1. Called by the owner's TBLMGR_DumpTblFuncPtr_t callback.
 **  2. Can assume valid table filename because this is a callback from 
 **     the app framework table manager that has verified the file.
 **  3. DumpType is unused.
@@ -99,20 +158,50 @@ void SAT_CTRL_TBL_Constructor(SAT_CTRL_TBL_Class_t *SatCtrlTblPtr)
 **  5. Creates a new dump file, overwriting anything that may have existed
 **     previously
 */
-bool SAT_CTRL_TBL_DumpCmd(osal_id_t FileHandle)
+bool SAT_CTRL_TBL_Dump(SAT_CTRL_TBL_Class_t *SatCtrlTbl, osal_id_t FileHandle)
 {
 
-   char DumpRecord[256];
-   sprintf(DumpRecord,"   \"pos-gain\": %0.6f,\n", SatCtrlTbl->Data.PosGain);
+   const SAT_CTRL_TBL_Data_t *Data = __atomic_load_n(&SatCtrlTbl->ActivatePending, __ATOMIC_ACQUIRE) ?
+                                     &SatCtrlTbl->LoadData : &SatCtrlTbl->Data;
+   const SENSOR_FILT_Param_t *Chain;
+   char  DumpRecord[256];
+   uint8 i;
+
+   sprintf(DumpRecord,"   \"pos-gain\": %0.6f,\n", Data->PosGain);
+   OS_write(FileHandle, DumpRecord, strlen(DumpRecord));
+
+   sprintf(DumpRecord,"   \"rate-gain\": %0.6f,\n", Data->RateGain);
+   OS_write(FileHandle, DumpRecord, strlen(DumpRecord));
+
+   sprintf(DumpRecord,"   \"steps\": %d,\n", Data->Test.Steps);
+   OS_write(FileHandle, DumpRecord, strlen(DumpRecord));
+
+   sprintf(DumpRecord,"   \"time-in-step\": %d,\n", Data->Test.TimeInStep);
+   OS_write(FileHandle, DumpRecord, strlen(DumpRecord));
+
+   sprintf(DumpRecord,"   \"filter-sample-hz\": %0.6f,\n", Data->Filter.SampleHz);
    OS_write(FileHandle, DumpRecord, strlen(DumpRecord));
 
-   sprintf(DumpRecord,"   \"rate-gain\": %0.6f,\n", SatCtrlTbl->Data.RateGain);
+   for (i=0; i < SAT_CTRL_TBL_FILT_CNT; i++)
+   {
+      Chain = &Data->Filter.Chain[i];
+      sprintf(DumpRecord,"   \"%s\": {\"bias\": %0.6f, \"median-len\": %d, \"lpf-order\": %d, \"lpf-cutoff-hz\": %0.6f, \"decimation\": %d},\n",
+              FiltName[i], Chain->Bias, Chain->MedianLen, Chain->LpfOrder, Chain->LpfCutoffHz, Chain->Decimation);
+      OS_write(FileHandle, DumpRecord, strlen(DumpRecord));
+   }
+
+   sprintf(DumpRecord,"   \"vib-notch\": {\"enabled\": %d, \"q\": %0.6f, \"min-amp\": %0.6f},\n",
+           Data->VibNotch.Enabled, Data->VibNotch.Q, Data->VibNotch.MinAmp);
    OS_write(FileHandle, DumpRecord, strlen(DumpRecord));
 
-   sprintf(DumpRecord,"   \"steps\": %d,\n", SatCtrlTbl->Data.Test.Steps);
+   sprintf(DumpRecord,"   \"att-est\": {\"rate-std\": %0.6f, \"accel-std\": %0.6f, \"bias-walk\": %0.6f, \"light-std\": %0.6f, \"gate\": %0.6f},\n",
+           Data->AttEst.RateStd, Data->AttEst.AccelStd, Data->AttEst.BiasWalk,
+           Data->AttEst.LightStd, Data->AttEst.Gate);
    OS_write(FileHandle, DumpRecord, strlen(DumpRecord));
 
-   sprintf(DumpRecord,"   \"time-in-step\": %d,\n", SatCtrlTbl->Data.Test.TimeInStep);
+   sprintf(DumpRecord,"   \"slew\": {\"fan-pwm\": %d, \"max-rate\": %0.6f, \"pos-tol\": %0.6f, \"rate-tol\": %0.6f}\n",
+           Data->Slew.FanPwm, Data->Slew.MaxRate, Data->Slew.PosTol,
+           Data->Slew.RateTol);
    OS_write(FileHandle, DumpRecord, strlen(DumpRecord));
 
    sprintf(DumpRecord,"   }\n");
@@ -120,36 +209,51 @@ bool SAT_CTRL_TBL_DumpCmd(osal_id_t FileHandle)
 
    return true;
    
-} /* End of SAT_CTRL_TBL_DumpCmd() */
+} /* End of SAT_CTRL_TBL_Dump() */
 
 
 /******************************************************************************
-** Function: SAT_CTRL_TBL_LoadCmd
+** Function: SAT_CTRL_TBL_Load
 **
 ** Notes:
-**  1. Function signature must match TBLMGR_LoadTblFuncPtr_t.
+**  1. Must only be called from the app's main task because TblData, FiltCoef,
+**     JsonBuf and LoadTbl are shared by all instances.
+**  2. The staging buffer belongs to the worker until the previous load has
+**     been activated so a new load is rejected in the meantime.
 */
-bool SAT_CTRL_TBL_LoadCmd(APP_C_FW_TblLoadOptions_Enum_t LoadType, const char *Filename)
+bool SAT_CTRL_TBL_Load(SAT_CTRL_TBL_Class_t *SatCtrlTbl, APP_C_FW_TblLoadOptions_Enum_t LoadType,
+                       const char *Filename)
 {
 
    bool  RetStatus = false;
 
-   if (CJSON_ProcessFile(Filename, SatCtrlTbl->JsonBuf, SAT_CTRL_TBL_JSON_FILE_MAX_CHAR, LoadJsonData))
+   if (__atomic_load_n(&SatCtrlTbl->ActivatePending, __ATOMIC_ACQUIRE))
+   {
+      CFE_EVS_SendEvent(SAT_CTRL_TBL_LOAD_EID, CFE_EVS_EventType_ERROR,
+                        "Control table load rejected, the previous load hasn't been activated");
+      return false;
+   }
+
+   LoadTbl = SatCtrlTbl;
+   
+   if (CJSON_ProcessFile(Filename, JsonBuf, SAT_CTRL_TBL_JSON_FILE_MAX_CHAR, LoadJsonData))
    {
       SatCtrlTbl->Loaded = true;
       RetStatus = true;
    }
 
+   LoadTbl = NULL;
+   
    return RetStatus;
    
-} /* End SAT_CTRL_TBL_LoadCmd() */
+} /* End SAT_CTRL_TBL_Load() */
 
 
 /******************************************************************************
 ** Function: SAT_CTRL_TBL_ResetStatus
 **
 */
-void SAT_CTRL_TBL_ResetStatus(void)
+void SAT_CTRL_TBL_ResetStatus(SAT_CTRL_TBL_Class_t *SatCtrlTbl)
 {
 
    SatCtrlTbl->LastLoadCnt = 0;
@@ -157,11 +261,43 @@ void SAT_CTRL_TBL_ResetStatus(void)
 } /* End SAT_CTRL_TBL_ResetStatus() */
 
 
+/******************************************************************************
+** Function: DesignFilters
+**
+** Compute every chain's coefficients. Returns false if any chain is invalid.
+*/
+static bool DesignFilters(SENSOR_FILT_Coef_t *Coef, const SAT_CTRL_TBL_Filter_t *Filter)
+{
+
+   uint8 i;
+
+   if (!(Filter->SampleHz > 0.0))
+   {
+      CFE_EVS_SendEvent(SAT_CTRL_TBL_LOAD_EID, CFE_EVS_EventType_ERROR, 
+                        "Invalid filter sample rate %0.4f Hz. Must be greater than 0", Filter->SampleHz);
+      return false;
+   }
+
+   for (i=0; i < SAT_CTRL_TBL_FILT_CNT; i++)
+   {
+      if (!SENSOR_FILT_Design(&Coef[i], &Filter->Chain[i], Filter->SampleHz, FiltName[i]))
+      {
+         return false;
+      }
+   }
+
+   return true;
+
+} /* End DesignFilters() */
+
+
 /******************************************************************************
 ** Function: LoadJsonData
 ** 
 ** Notes:
-**  1. See file prologue for full/partial table load scenarios
+**  1. An initial load must define every object. After that any subset of the
+**     table can be applied on top of the active data.
+**  2. The release store publishes the staged load to SAT_CTRL_TBL_Activate().
 */
 static bool LoadJsonData(size_t JsonFileLen)
 {
@@ -170,32 +306,62 @@ static bool LoadJsonData(size_t JsonFileLen)
    size_t    ObjLoadCnt;
 
 
-   SatCtrlTbl->JsonFileLen = JsonFileLen;
+   LoadTbl->JsonFileLen = JsonFileLen;
 
    /* 
    ** 1. Copy table owner data into local table buffer
    ** 2. Process JSON file which updates local table buffer with JSON supplied values
-   ** 3. If valid, copy local buffer over owner's data 
+   ** 3. If valid, stage local buffer for activation
    */
    
-   memcpy(&TblData, &SatCtrlTbl->Data, sizeof(SAT_CTRL_TBL_Data_t));
+   memcpy(&TblData, &LoadTbl->Data, sizeof(SAT_CTRL_TBL_Data_t));
    
-   ObjLoadCnt = CJSON_LoadObjArray(JsonTblObjs, SatCtrlTbl->JsonObjCnt, SatCtrlTbl->JsonBuf, SatCtrlTbl->JsonFileLen);
+   ObjLoadCnt = CJSON_LoadObjArray(JsonTblObjs, LoadTbl->JsonObjCnt, JsonBuf, LoadTbl->JsonFileLen);
 
    /* Only accept fixed sized bin arrays */
-   if (!SatCtrlTbl->Loaded && (ObjLoadCnt != SatCtrlTbl->JsonObjCnt))
+   if (!LoadTbl->Loaded && (ObjLoadCnt != LoadTbl->JsonObjCnt))
    {
 
       CFE_EVS_SendEvent(SAT_CTRL_TBL_LOAD_EID, CFE_EVS_EventType_ERROR, 
                         "Table has never been loaded and new table only contains %d of %d data objects",
-                        (unsigned int)ObjLoadCnt, (unsigned int)SatCtrlTbl->JsonObjCnt);
+                        (unsigned int)ObjLoadCnt, (unsigned int)LoadTbl->JsonObjCnt);
+   
+   }
+   else if (!DesignFilters(FiltCoef, &TblData.Filter))
+   {
+      
+      CFE_EVS_SendEvent(SAT_CTRL_TBL_LOAD_EID, CFE_EVS_EventType_ERROR, 
+                        "Table load rejected, invalid sensor filter definition");
+   
+   }
+   else if (!VIB_MON_ValidNotch(&TblData.VibNotch))
+   {
+      
+      CFE_EVS_SendEvent(SAT_CTRL_TBL_LOAD_EID, CFE_EVS_EventType_ERROR, 
+                        "Table load rejected, invalid vibration notch definition");
+   
+   }
+   else if (!ATT_EST_ValidParam(&TblData.AttEst))
+   {
+      
+      CFE_EVS_SendEvent(SAT_CTRL_TBL_LOAD_EID, CFE_EVS_EventType_ERROR, 
+                        "Table load rejected, attitude estimator parameters must be greater than 0");
+   
+   }
+   else if (!SLEW_ValidParam(&TblData.Slew))
+   {
+      
+      CFE_EVS_SendEvent(SAT_CTRL_TBL_LOAD_EID, CFE_EVS_EventType_ERROR, 
+                        "Table load rejected, slew parameters must be greater than 0");
    
    }
    else
    {
       
-      memcpy(&SatCtrlTbl->Data, &TblData, sizeof(SAT_CTRL_TBL_Data_t));
-      SatCtrlTbl->LastLoadCnt = ObjLoadCnt;
+      memcpy(&LoadTbl->LoadData, &TblData, sizeof(SAT_CTRL_TBL_Data_t));
+      memcpy(LoadTbl->LoadFiltCoef, FiltCoef, sizeof(FiltCoef));
+      __atomic_store_n(&LoadTbl->ActivatePending, true, __ATOMIC_RELEASE);
+      LoadTbl->LastLoadCnt = ObjLoadCnt;
       CFE_EVS_SendEvent(SAT_CTRL_TBL_LOAD_EID, CFE_EVS_EventType_DEBUG, 
                         "Successfully loaded %d JSON objects",
                         (unsigned int)ObjLoadCnt);
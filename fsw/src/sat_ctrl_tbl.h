@@ -16,9 +16,24 @@
 **    Manage the Table Sat control parameter table
 **
 **  Notes:
-**    1. Use the Singleton design pattern. A pointer to the table object
-**       is passed to the constructor and saved for all other operations.
-**       This is a table-specific file so it doesn't need to be re-entrant.
+**    1. Each rig owns a table object and passes it to every function. Table
+**       loads are only performed by the app's main task so the JSON file
+**       buffer and the load working buffer are shared by all instances.
+**    2. The table defines the sensor preprocessing filter chains, see
+**       sensor_filt.h. Their coefficients are computed when the table is
+**       loaded and FilterVersion is incremented so the controller restarts
+**       its filters. A load with an invalid chain is rejected.
+**    3. The table's vibration notch parameters control the rate notch that
+**       tracks the strongest vibration peak, see vib_mon.h.
+**    4. The table's attitude estimator parameters tune the Kalman filter
+**       that estimates the rig's angle, see att_est.h.
+**    5. The table's slew parameters limit the sun acquisition's slew to
+**       the light source and set its hold hand over, see slew.h.
+**    6. The rig worker uses Data and FiltCoef while the main task loads. A
+**       load is written to LoadData/LoadFiltCoef and the worker copies it in
+**       with SAT_CTRL_TBL_Activate() between control cycles, incrementing
+**       FilterVersion after the copy. A new load is rejected until the
+**       previous one has been activated.
 **
 */
 
@@ -30,6 +45,10 @@
 */
 
 #include "app_cfg.h"
+#include "sensor_filt.h"
+#include "vib_mon.h"
+#include "att_est.h"
+#include "slew.h"
 
 /***********************/
 /** Macro Definitions **/
@@ -42,6 +61,14 @@
 #define SAT_CTRL_TBL_DUMP_EID  (SAT_CTRL_TBL_BASE_EID + 0)
 #define SAT_CTRL_TBL_LOAD_EID  (SAT_CTRL_TBL_BASE_EID + 1)
 
+/*
+** Sensor filter chains
+*/
+
+#define SAT_CTRL_TBL_FILT_RATE   0   /* Z rate, rad/s */
+#define SAT_CTRL_TBL_FILT_LIGHT  1   /* Total light, LuxA + LuxB */
+#define SAT_CTRL_TBL_FILT_CNT    2
+
 
 /**********************/
 /** Type Definitions **/
@@ -62,13 +89,26 @@ typedef struct
 } SAT_CTRL_TBL_Test_t;
 
 
+typedef struct
+{
+
+   float  SampleHz;     /* Sensor message rate the chains are designed for */
+   SENSOR_FILT_Param_t  Chain[SAT_CTRL_TBL_FILT_CNT];
+
+} SAT_CTRL_TBL_Filter_t;
+
+
 typedef struct
 {
    
    uint16 SurveyFanPwm;
    float  PosGain;
    float  RateGain;
-   SAT_CTRL_TBL_Test_t Test;
+   SAT_CTRL_TBL_Test_t   Test;
+   SAT_CTRL_TBL_Filter_t Filter;
+   VIB_MON_NotchParam_t  VibNotch;
+   ATT_EST_Param_t       AttEst;
+   SLEW_Param_t          Slew;
    
 } SAT_CTRL_TBL_Data_t;
 
@@ -86,6 +126,21 @@ typedef struct
    
    SAT_CTRL_TBL_Data_t Data;
    
+   /*
+   ** Values derived from the table data
+   */
+   
+   SENSOR_FILT_Coef_t  FiltCoef[SAT_CTRL_TBL_FILT_CNT];
+   uint16              FilterVersion;
+   
+   /*
+   ** Staged load, owned by the main task until ActivatePending is set
+   */
+   
+   SAT_CTRL_TBL_Data_t LoadData;
+   SENSOR_FILT_Coef_t  LoadFiltCoef[SAT_CTRL_TBL_FILT_CNT];
+   bool                ActivatePending;  /* Atomic */
+   
    /*
    ** Standard CJSON table data
    */
@@ -94,7 +149,6 @@ typedef struct
    uint16  LastLoadCnt;
    
    size_t  JsonObjCnt;
-   char    JsonBuf[SAT_CTRL_TBL_JSON_FILE_MAX_CHAR];   
    size_t  JsonFileLen;
    
 } SAT_CTRL_TBL_Class_t;
@@ -111,37 +165,54 @@ typedef struct
 ** Initialize the Control Table table object.
 **
 ** Notes:
-**   1. The table values are not populated. This is done when the table is 
-**      registered with the table manager.
+**   1. The table values are not populated. This is done by the owner's
+**      first call to SAT_CTRL_TBL_Load().
 **
 */
 void SAT_CTRL_TBL_Constructor(SAT_CTRL_TBL_Class_t *SatCtrlTblPtr);
 
 
 /******************************************************************************
-** Function: SAT_CTRL_TBL_DumpCmd
+** Function: SAT_CTRL_TBL_Activate
+**
+** Copy a staged table load into the active table data and filter
+** coefficients. Returns true if a load was activated.
+**
+** Notes:
+**  1. Must be called by the rig worker between control cycles and by the
+**     owner's constructor after loading its default table.
+**
+*/
+bool SAT_CTRL_TBL_Activate(SAT_CTRL_TBL_Class_t *SatCtrlTbl);
+
+
+/******************************************************************************
+** Function: SAT_CTRL_TBL_Dump
 **
-** Command to write the table data from memory to a JSON file.
+** Write the table data from memory to a JSON file.
 **
 ** Notes:
-**  1. Function signature must match TBLMGR_DumpTblFuncPtr_t.
+**  1. Called by the owner's TBLMGR_DumpTblFuncPtr_t callback.
 **
 */
-bool SAT_CTRL_TBL_DumpCmd(osal_id_t FileHandle);
+bool SAT_CTRL_TBL_Dump(SAT_CTRL_TBL_Class_t *SatCtrlTbl, osal_id_t FileHandle);
 
 
 /******************************************************************************
-** Function: SAT_CTRL_TBL_LoadCmd
+** Function: SAT_CTRL_TBL_Load
 **
-** Command to copy the table data from a JSON file to memory.
+** Copy the table data from a JSON file to the staging buffer.
+** SAT_CTRL_TBL_Activate() makes the load active.
 **
 ** Notes:
-**  1. Function signature must match TBLMGR_LoadTblFuncPtr_t.
-**  2. Can assume valid table file name because this is a callback from 
-**     the app framework table manager.
+**  1. Called by the owner's TBLMGR_LoadTblFuncPtr_t callback and by the
+**     owner's constructor to load its default table.
+**  2. Must only be called from the app's main task because the JSON file
+**     buffer and the load working buffer are shared by all instances.
 **
 */
-bool SAT_CTRL_TBL_LoadCmd(APP_C_FW_TblLoadOptions_Enum_t LoadType, const char *Filename);
+bool SAT_CTRL_TBL_Load(SAT_CTRL_TBL_Class_t *SatCtrlTbl, APP_C_FW_TblLoadOptions_Enum_t LoadType,
+                       const char *Filename);
 
 
 /******************************************************************************
@@ -152,7 +223,7 @@ bool SAT_CTRL_TBL_LoadCmd(APP_C_FW_TblLoadOptions_Enum_t LoadType, const char *F
 ** and flags to a known default state for telemetry.
 **
 */
-void SAT_CTRL_TBL_ResetStatus(void);
+void SAT_CTRL_TBL_ResetStatus(SAT_CTRL_TBL_Class_t *SatCtrlTbl);
 
 
 #endif /* _histogram_tbl_ */
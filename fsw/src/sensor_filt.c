@@ -0,0 +1,208 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Implement the sensor preprocessing filter chain
+**
+**  Notes:
+**    1. See sensor_filt.h for details.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <math.h>
+#include <string.h>
+#include "sensor_filt.h"
+
+
+/************************************/
+/** Local File Function Prototypes **/
+/************************************/
+
+static float Median(const SENSOR_FILT_Class_t *SensorFilt);
+
+
+/******************************************************************************
+** Function: SENSOR_FILT_Apply
+**
+*/
+bool SENSOR_FILT_Apply(SENSOR_FILT_Class_t *SensorFilt, const SENSOR_FILT_Coef_t *Coef,
+                       float In, float *Out)
+{
+
+   float X = In - Coef->Bias;
+   float Y;
+
+   if (Coef->MedianLen > 1)
+   {
+      SensorFilt->Median[SensorFilt->MedianNext] = X;
+      SensorFilt->MedianNext = (SensorFilt->MedianNext + 1) % Coef->MedianLen;
+      if (SensorFilt->MedianCnt < Coef->MedianLen)
+      {
+         SensorFilt->MedianCnt++;
+      }
+      X = Median(SensorFilt);
+   }
+
+   if (Coef->LpfOrder > 0)
+   {
+      if (!SensorFilt->LpfPrimed)
+      {
+         SensorFilt->X1 = SensorFilt->X2 = X;
+         SensorFilt->Y1 = SensorFilt->Y2 = X;
+         SensorFilt->LpfPrimed = true;
+      }
+      Y = Coef->B0*X + Coef->B1*SensorFilt->X1 + Coef->B2*SensorFilt->X2
+        - Coef->A1*SensorFilt->Y1 - Coef->A2*SensorFilt->Y2;
+      SensorFilt->X2 = SensorFilt->X1;
+      SensorFilt->X1 = X;
+      SensorFilt->Y2 = SensorFilt->Y1;
+      SensorFilt->Y1 = Y;
+      X = Y;
+   }
+
+   if (++SensorFilt->DecimCnt < Coef->Decimation)
+   {
+      return false;
+   }
+
+   SensorFilt->DecimCnt = 0;
+   *Out = X;
+
+   return true;
+
+} /* End SENSOR_FILT_Apply() */
+
+
+/******************************************************************************
+** Function: SENSOR_FILT_Design
+**
+** Notes:
+**   1. The cutoff is prewarped so the digital filter's -3 dB point is at
+**      LpfCutoffHz. The second order filter is a Butterworth biquad.
+**
+*/
+bool SENSOR_FILT_Design(SENSOR_FILT_Coef_t *Coef, const SENSOR_FILT_Param_t *Param,
+                        float SampleHz, const char *Name)
+{
+
+   SENSOR_FILT_Coef_t NewCoef;
+   double K, Norm;
+
+   if (Param->MedianLen == 0 || Param->MedianLen > SENSOR_FILT_MAX_MEDIAN || (Param->MedianLen % 2) == 0)
+   {
+      CFE_EVS_SendEvent(SENSOR_FILT_DESIGN_EID, CFE_EVS_EventType_ERROR,
+                        "Invalid %s filter median length %d. Must be odd and in [1,%d]",
+                        Name, Param->MedianLen, SENSOR_FILT_MAX_MEDIAN);
+      return false;
+   }
+
+   if (Param->LpfOrder > 2)
+   {
+      CFE_EVS_SendEvent(SENSOR_FILT_DESIGN_EID, CFE_EVS_EventType_ERROR,
+                        "Invalid %s filter low-pass order %d. Must be 0, 1 or 2",
+                        Name, Param->LpfOrder);
+      return false;
+   }
+
+   if (Param->LpfOrder > 0 && !(Param->LpfCutoffHz > 0.0 && Param->LpfCutoffHz < 0.5*SampleHz))
+   {
+      CFE_EVS_SendEvent(SENSOR_FILT_DESIGN_EID, CFE_EVS_EventType_ERROR,
+                        "Invalid %s filter low-pass cutoff %0.4f Hz. Must be greater than 0 and less than half the %0.4f Hz sample rate",
+                        Name, Param->LpfCutoffHz, SampleHz);
+      return false;
+   }
+
+   if (Param->Decimation == 0)
+   {
+      CFE_EVS_SendEvent(SENSOR_FILT_DESIGN_EID, CFE_EVS_EventType_ERROR,
+                        "Invalid %s filter decimation 0. Must be at least 1", Name);
+      return false;
+   }
+
+   memset(&NewCoef, 0, sizeof(SENSOR_FILT_Coef_t));
+   NewCoef.Bias       = Param->Bias;
+   NewCoef.MedianLen  = (uint8)Param->MedianLen;
+   NewCoef.LpfOrder   = (uint8)Param->LpfOrder;
+   NewCoef.Decimation = Param->Decimation;
+   NewCoef.B0         = 1.0;
+
+   if (Param->LpfOrder > 0)
+   {
+      K = tan(M_PI * Param->LpfCutoffHz / SampleHz);
+      if (Param->LpfOrder == 1)
+      {
+         NewCoef.B0 = K / (1.0 + K);
+         NewCoef.B1 = NewCoef.B0;
+         NewCoef.A1 = (K - 1.0) / (1.0 + K);
+      }
+      else
+      {
+         Norm = 1.0 / (1.0 + M_SQRT2*K + K*K);
+         NewCoef.B0 = K*K*Norm;
+         NewCoef.B1 = 2.0*NewCoef.B0;
+         NewCoef.B2 = NewCoef.B0;
+         NewCoef.A1 = 2.0*(K*K - 1.0)*Norm;
+         NewCoef.A2 = (1.0 - M_SQRT2*K + K*K)*Norm;
+      }
+   }
+
+   *Coef = NewCoef;
+
+   return true;
+
+} /* End SENSOR_FILT_Design() */
+
+
+/******************************************************************************
+** Function: SENSOR_FILT_Reset
+**
+*/
+void SENSOR_FILT_Reset(SENSOR_FILT_Class_t *SensorFilt)
+{
+
+   memset(SensorFilt, 0, sizeof(SENSOR_FILT_Class_t));
+
+} /* End SENSOR_FILT_Reset() */
+
+
+/******************************************************************************
+** Function: Median
+**
+** Return the median of the buffered samples. An insertion sort of at most
+** SENSOR_FILT_MAX_MEDIAN values is cheaper than a running order statistic.
+*/
+static float Median(const SENSOR_FILT_Class_t *SensorFilt)
+{
+
+   float  Sorted[SENSOR_FILT_MAX_MEDIAN];
+   float  V;
+   uint8  i, j;
+
+   for (i=0; i < SensorFilt->MedianCnt; i++)
+   {
+      V = SensorFilt->Median[i];
+      for (j=i; j > 0 && Sorted[j-1] > V; j--)
+      {
+         Sorted[j] = Sorted[j-1];
+      }
+      Sorted[j] = V;
+   }
+
+   return Sorted[SensorFilt->MedianCnt/2];
+
+} /* End Median() */
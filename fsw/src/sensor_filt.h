@@ -0,0 +1,152 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Define the sensor preprocessing filter chain
+**
+**  Notes:
+**    1. A chain filters one sensor channel with these stages in order:
+**         - Bias removal, the bias is subtracted from each sample
+**         - Spike rejection, the median of the last MedianLen samples
+**         - Butterworth low-pass, first or second order
+**         - Decimation, one output every Decimation samples
+**       A stage with a bias of 0, a median length of 1, a low-pass order
+**       of 0 or a decimation of 1 passes samples through unchanged.
+**    2. The parameters come from a table. SENSOR_FILT_Design() validates
+**       them and precomputes the low-pass coefficients with the bilinear
+**       transform at table load so a sample only costs a few multiplies.
+**    3. The filter state is fixed size and allocation free. The low-pass
+**       state is primed with the first sample so a chain starts without a
+**       step transient.
+**
+*/
+
+#ifndef _sensor_filt_
+#define _sensor_filt_
+
+/*
+** Includes
+*/
+
+#include "app_cfg.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define SENSOR_FILT_MAX_MEDIAN  7
+
+/*
+** Event Message IDs
+*/
+
+#define SENSOR_FILT_DESIGN_EID  (SENSOR_FILT_BASE_EID + 0)
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+
+/******************************************************************************
+** Table parameters
+*/
+
+typedef struct
+{
+
+   float   Bias;
+   uint16  MedianLen;    /* Odd, 1 disables */
+   uint16  LpfOrder;     /* 0 disables, 1 or 2 */
+   float   LpfCutoffHz;
+   uint16  Decimation;   /* 1 outputs every sample */
+
+} SENSOR_FILT_Param_t;
+
+
+/******************************************************************************
+** Precomputed coefficients
+**
+** y[n] = B0*x[n] + B1*x[n-1] + B2*x[n-2] - A1*y[n-1] - A2*y[n-2]
+*/
+
+typedef struct
+{
+
+   float   Bias;
+   uint8   MedianLen;
+   uint8   LpfOrder;
+   uint16  Decimation;
+   float   B0, B1, B2;
+   float   A1, A2;
+
+} SENSOR_FILT_Coef_t;
+
+
+/******************************************************************************
+** SENSOR_FILT_Class
+*/
+
+typedef struct
+{
+
+   float   Median[SENSOR_FILT_MAX_MEDIAN];
+   uint8   MedianNext;
+   uint8   MedianCnt;
+
+   bool    LpfPrimed;
+   float   X1, X2;
+   float   Y1, Y2;
+
+   uint16  DecimCnt;
+
+} SENSOR_FILT_Class_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: SENSOR_FILT_Apply
+**
+** Filter one sample. Returns true and writes the filtered value to Out when
+** the decimation stage outputs a sample.
+*/
+bool SENSOR_FILT_Apply(SENSOR_FILT_Class_t *SensorFilt, const SENSOR_FILT_Coef_t *Coef,
+                       float In, float *Out);
+
+
+/******************************************************************************
+** Function: SENSOR_FILT_Design
+**
+** Validate a chain's parameters and compute its coefficients for sensor
+** samples arriving at SampleHz. Name identifies the chain in error events.
+** Returns false and leaves Coef unchanged if a parameter is invalid.
+*/
+bool SENSOR_FILT_Design(SENSOR_FILT_Coef_t *Coef, const SENSOR_FILT_Param_t *Param,
+                        float SampleHz, const char *Name);
+
+
+/******************************************************************************
+** Function: SENSOR_FILT_Reset
+**
+** Clear the filter state so the next sample restarts the chain.
+*/
+void SENSOR_FILT_Reset(SENSOR_FILT_Class_t *SensorFilt);
+
+
+#endif /* _sensor_filt_ */
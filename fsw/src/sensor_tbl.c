@@ -0,0 +1,420 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Implement the sensor calibration table
+**
+**  Notes:
+**    1. The static "TblData" serves as a table load buffer. Table dump data is
+**       read directly from table owner's table storage, the staged load if
+**       it hasn't been activated yet.
+**    2. LoadTbl identifies the instance being loaded while CJSON calls
+**       LoadJsonData(). It's only valid during SENSOR_TBL_Load().
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+#include "sensor_tbl.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define GYRO_JSON_OBJ(Field, Key) \
+   { &TblData.Gyro.Field, sizeof(TblData.Gyro.Field), false, JSONNumber, true, \
+     { "gyro." Key, (sizeof("gyro." Key)-1)} }
+
+#define MISALIGN_JSON_OBJS(Row) \
+   GYRO_JSON_OBJ(Misalign[Row][0], "misalign[" #Row "].x"), \
+   GYRO_JSON_OBJ(Misalign[Row][1], "misalign[" #Row "].y"), \
+   GYRO_JSON_OBJ(Misalign[Row][2], "misalign[" #Row "].z")
+
+#define LIGHT_JSON_OBJS(Idx, Key) \
+   { &TblData.Light[Idx].Gain,   sizeof(TblData.Light[Idx].Gain),   false, JSONNumber, true, \
+     { Key ".gain",   (sizeof(Key ".gain")-1)} },                                           \
+   { &TblData.Light[Idx].Offset, sizeof(TblData.Light[Idx].Offset), false, JSONNumber, true, \
+     { Key ".offset", (sizeof(Key ".offset")-1)} }
+
+#define BIAS_EST_JSON_OBJ(Field, Float, Key) \
+   { &TblData.BiasEst.Field, sizeof(TblData.BiasEst.Field), false, JSONNumber, Float, \
+     { "gyro-bias-est." Key, (sizeof("gyro-bias-est." Key)-1)} }
+
+
+/************************************/
+/** Local File Function Prototypes **/
+/************************************/
+
+static void FuseCal(SENSOR_TBL_Cal_t *Cal, const SENSOR_TBL_Data_t *Data);
+static bool LoadJsonData(size_t JsonFileLen);
+
+
+/**********************/
+/** Global File Data **/
+/**********************/
+
+static SENSOR_TBL_Class_t *LoadTbl = NULL;
+
+static SENSOR_TBL_Data_t TblData; /* Working buffer for loads */
+static char JsonBuf[SENSOR_TBL_JSON_FILE_MAX_CHAR];
+
+static CJSON_Obj_t JsonTblObjs[] = {
+
+   /* Table Data Address, Table Data Length, Updated, Data Type, Float, core-json query string, length of query string(exclude '\0') */
+
+   GYRO_JSON_OBJ(Bias[0],  "bias-x"),
+   GYRO_JSON_OBJ(Bias[1],  "bias-y"),
+   GYRO_JSON_OBJ(Bias[2],  "bias-z"),
+   GYRO_JSON_OBJ(Scale[0], "scale-x"),
+   GYRO_JSON_OBJ(Scale[1], "scale-y"),
+   GYRO_JSON_OBJ(Scale[2], "scale-z"),
+   MISALIGN_JSON_OBJS(0),
+   MISALIGN_JSON_OBJS(1),
+   MISALIGN_JSON_OBJS(2),
+   LIGHT_JSON_OBJS(0, "light-a"),
+   LIGHT_JSON_OBJS(1, "light-b"),
+   BIAS_EST_JSON_OBJ(Enabled,    false, "enabled"),
+   BIAS_EST_JSON_OBJ(WindowLen,  false, "window-len"),
+   BIAS_EST_JSON_OBJ(StillStd,   true,  "still-std"),
+   BIAS_EST_JSON_OBJ(MaxBias,    true,  "max-bias"),
+   BIAS_EST_JSON_OBJ(Memory,     true,  "memory"),
+   BIAS_EST_JSON_OBJ(MinTempStd, true,  "min-temp-std")
+
+};
+
+static const char AxisKey[SENSOR_TBL_GYRO_AXIS_CNT] = { 'x', 'y', 'z' };
+
+
+/******************************************************************************
+** Function: SENSOR_TBL_Constructor
+**
+** Notes:
+**    1. This must be called prior to any other functions
+**
+*/
+void SENSOR_TBL_Constructor(SENSOR_TBL_Class_t *SensorTbl)
+{
+
+   uint8 Chan;
+
+   CFE_PSP_MemSet(SensorTbl, 0, sizeof(SENSOR_TBL_Class_t));
+
+   for (Chan=0; Chan < SENSOR_TBL_CHAN_CNT; Chan++)
+   {
+      SensorTbl->Cal.Gain[Chan][Chan] = 1.0;
+   }
+
+   SensorTbl->JsonObjCnt = (sizeof(JsonTblObjs)/sizeof(CJSON_Obj_t));
+
+} /* End SENSOR_TBL_Constructor() */
+
+
+/******************************************************************************
+** Function: SENSOR_TBL_Activate
+**
+** Notes:
+**  1. The acquire load pairs with the release store in LoadJsonData() so the
+**     staged data is complete when ActivatePending is seen. GyroVersion is
+**     only changed after the copy.
+*/
+bool SENSOR_TBL_Activate(SENSOR_TBL_Class_t *SensorTbl)
+{
+
+   bool GyroChanged;
+
+   if (!__atomic_load_n(&SensorTbl->ActivatePending, __ATOMIC_ACQUIRE))
+   {
+      return false;
+   }
+
+   GyroChanged = (memcmp(&SensorTbl->Data.Gyro, &SensorTbl->LoadData.Gyro, sizeof(SENSOR_TBL_Gyro_t)) != 0);
+
+   memcpy(&SensorTbl->Data, &SensorTbl->LoadData, sizeof(SENSOR_TBL_Data_t));
+   memcpy(&SensorTbl->Cal,  &SensorTbl->LoadCal,  sizeof(SENSOR_TBL_Cal_t));
+   if (GyroChanged)
+   {
+      SensorTbl->GyroVersion++;
+   }
+
+   __atomic_store_n(&SensorTbl->ActivatePending, false, __ATOMIC_RELEASE);
+
+   return true;
+
+} /* End SENSOR_TBL_Activate() */
+
+
+/******************************************************************************
+** Function: SENSOR_TBL_Calibrate
+**
+*/
+void SENSOR_TBL_Calibrate(const SENSOR_TBL_Class_t *SensorTbl,
+                          const float Raw[SENSOR_TBL_CHAN_CNT], float Cal[SENSOR_TBL_CHAN_CNT])
+{
+
+   const SENSOR_TBL_Cal_t *Fused = &SensorTbl->Cal;
+   uint8 Row, Col;
+   float Sum;
+
+   for (Row=0; Row < SENSOR_TBL_CHAN_CNT; Row++)
+   {
+      Sum = Fused->Offset[Row];
+      for (Col=0; Col < SENSOR_TBL_CHAN_CNT; Col++)
+      {
+         Sum += Fused->Gain[Row][Col] * Raw[Col];
+      }
+      Cal[Row] = Sum;
+   }
+
+} /* End SENSOR_TBL_Calibrate() */
+
+
+/******************************************************************************
+** Function: SENSOR_TBL_Dump
+**
+** Notes:
+**  1. Called by the owner's TBLMGR_DumpTblFuncPtr_t callback.
+**  2. Can assume valid table filename because this is a callback from
+**     the app framework table manager that has verified the file.
+**  3. File is formatted so it can be used as a load file. It does not follow
+**     the cFE table file format.
+**  4. Only the table parameters are dumped, the fused calibration is
+**     recomputed when the file is loaded.
+*/
+bool SENSOR_TBL_Dump(SENSOR_TBL_Class_t *SensorTbl, osal_id_t FileHandle)
+{
+
+   const SENSOR_TBL_Data_t *Data = __atomic_load_n(&SensorTbl->ActivatePending, __ATOMIC_ACQUIRE) ?
+                                   &SensorTbl->LoadData : &SensorTbl->Data;
+   const SENSOR_TBL_Gyro_t *Gyro = &Data->Gyro;
+   const GYRO_BIAS_Param_t *BiasEst = &Data->BiasEst;
+   char  DumpRecord[256];
+   uint8 Axis, Row;
+
+   sprintf(DumpRecord,"   \"gyro\": {\n");
+   OS_write(FileHandle, DumpRecord, strlen(DumpRecord));
+
+   for (Axis=0; Axis < SENSOR_TBL_GYRO_AXIS_CNT; Axis++)
+   {
+      sprintf(DumpRecord,"      \"bias-%c\": %0.6f,\n", AxisKey[Axis], Gyro->Bias[Axis]);
+      OS_write(FileHandle, DumpRecord, strlen(DumpRecord));
+   }
+
+   for (Axis=0; Axis < SENSOR_TBL_GYRO_AXIS_CNT; Axis++)
+   {
+      sprintf(DumpRecord,"      \"scale-%c\": %0.6f,\n", AxisKey[Axis], Gyro->Scale[Axis]);
+      OS_write(FileHandle, DumpRecord, strlen(DumpRecord));
+   }
+
+   sprintf(DumpRecord,"      \"misalign\": [\n");
+   OS_write(FileHandle, DumpRecord, strlen(DumpRecord));
+
+   for (Row=0; Row < SENSOR_TBL_GYRO_AXIS_CNT; Row++)
+   {
+      sprintf(DumpRecord,"         {\"x\": %0.6f, \"y\": %0.6f, \"z\": %0.6f}%s\n",
+              Gyro->Misalign[Row][0], Gyro->Misalign[Row][1], Gyro->Misalign[Row][2],
+              (Row < (SENSOR_TBL_GYRO_AXIS_CNT-1)) ? "," : "");
+      OS_write(FileHandle, DumpRecord, strlen(DumpRecord));
+   }
+
+   sprintf(DumpRecord,"      ]\n   },\n");
+   OS_write(FileHandle, DumpRecord, strlen(DumpRecord));
+
+   sprintf(DumpRecord,"   \"light-a\": {\"gain\": %0.6f, \"offset\": %0.6f},\n",
+           Data->Light[0].Gain, Data->Light[0].Offset);
+   OS_write(FileHandle, DumpRecord, strlen(DumpRecord));
+
+   sprintf(DumpRecord,"   \"light-b\": {\"gain\": %0.6f, \"offset\": %0.6f},\n",
+           Data->Light[1].Gain, Data->Light[1].Offset);
+   OS_write(FileHandle, DumpRecord, strlen(DumpRecord));
+
+   sprintf(DumpRecord,"   \"gyro-bias-est\": {\"enabled\": %d, \"window-len\": %d, \"still-std\": %0.6f,\n",
+           BiasEst->Enabled, BiasEst->WindowLen, BiasEst->StillStd);
+   OS_write(FileHandle, DumpRecord, strlen(DumpRecord));
+
+   sprintf(DumpRecord,"                     \"max-bias\": %0.6f, \"memory\": %0.2f, \"min-temp-std\": %0.3f}\n}\n",
+           BiasEst->MaxBias, BiasEst->Memory, BiasEst->MinTempStd);
+   OS_write(FileHandle, DumpRecord, strlen(DumpRecord));
+
+   return true;
+
+} /* End of SENSOR_TBL_Dump() */
+
+
+/******************************************************************************
+** Function: SENSOR_TBL_Load
+**
+** Notes:
+**  1. Must only be called from the app's main task because TblData, JsonBuf
+**     and LoadTbl are shared by all instances.
+**  2. The staging buffer belongs to the worker until the previous load has
+**     been activated so a new load is rejected in the meantime.
+*/
+bool SENSOR_TBL_Load(SENSOR_TBL_Class_t *SensorTbl, APP_C_FW_TblLoadOptions_Enum_t LoadType,
+                     const char *Filename)
+{
+
+   bool  RetStatus = false;
+
+   if (__atomic_load_n(&SensorTbl->ActivatePending, __ATOMIC_ACQUIRE))
+   {
+      CFE_EVS_SendEvent(SENSOR_TBL_LOAD_EID, CFE_EVS_EventType_ERROR,
+                        "Sensor table load rejected, the previous load hasn't been activated");
+      return false;
+   }
+
+   LoadTbl = SensorTbl;
+
+   if (CJSON_ProcessFile(Filename, JsonBuf, SENSOR_TBL_JSON_FILE_MAX_CHAR, LoadJsonData))
+   {
+      SensorTbl->Loaded = true;
+      RetStatus = true;
+   }
+
+   LoadTbl = NULL;
+
+   return RetStatus;
+
+} /* End SENSOR_TBL_Load() */
+
+
+/******************************************************************************
+** Function: SENSOR_TBL_ResetStatus
+**
+*/
+void SENSOR_TBL_ResetStatus(SENSOR_TBL_Class_t *SensorTbl)
+{
+
+   SensorTbl->LastLoadCnt = 0;
+
+} /* End SENSOR_TBL_ResetStatus() */
+
+
+/******************************************************************************
+** Function: FuseCal
+**
+** Fold the table terms into one affine transform, see sensor_tbl.h. The
+** gyro's block is Misalign*Scale with an offset of -Misalign*Scale*Bias and
+** each light sensor is a diagonal term.
+*/
+static void FuseCal(SENSOR_TBL_Cal_t *Cal, const SENSOR_TBL_Data_t *Data)
+{
+
+   uint8 Row, Col, Light;
+   float Gain;
+
+   memset(Cal, 0, sizeof(SENSOR_TBL_Cal_t));
+
+   for (Row=0; Row < SENSOR_TBL_GYRO_AXIS_CNT; Row++)
+   {
+      for (Col=0; Col < SENSOR_TBL_GYRO_AXIS_CNT; Col++)
+      {
+         Gain = Data->Gyro.Misalign[Row][Col] * Data->Gyro.Scale[Col];
+         Cal->Gain[SENSOR_TBL_CHAN_RATE_X + Row][SENSOR_TBL_CHAN_RATE_X + Col] = Gain;
+         Cal->Offset[SENSOR_TBL_CHAN_RATE_X + Row] -= Gain * Data->Gyro.Bias[Col];
+      }
+   }
+
+   for (Light=0; Light < SENSOR_TBL_LIGHT_CNT; Light++)
+   {
+      Cal->Gain[SENSOR_TBL_CHAN_LUX_A + Light][SENSOR_TBL_CHAN_LUX_A + Light] = Data->Light[Light].Gain;
+      Cal->Offset[SENSOR_TBL_CHAN_LUX_A + Light] = Data->Light[Light].Offset;
+   }
+
+} /* End FuseCal() */
+
+
+/******************************************************************************
+** Function: LoadJsonData
+**
+** Notes:
+**  1. An initial load must define every object. After that any subset of the
+**     table can be updated.
+**  2. The fused calibration is computed in a local buffer and staged with
+**     the table data so a rejected load leaves both unchanged.
+**  3. Partial loads are applied on top of the active data. The release
+**     store publishes the staged load to SENSOR_TBL_Activate().
+*/
+static bool LoadJsonData(size_t JsonFileLen)
+{
+
+   bool      RetStatus = false;
+   size_t    ObjLoadCnt;
+   size_t    Obj;
+   uint8     i;
+   bool      ZeroGain = false;
+   SENSOR_TBL_Cal_t Cal;
+
+   LoadTbl->JsonFileLen = JsonFileLen;
+
+   /*
+   ** 1. Copy table owner data into local table buffer
+   ** 2. Process JSON file which updates local table buffer with JSON supplied values
+   ** 3. If valid, stage local buffer for activation
+   */
+
+   memcpy(&TblData, &LoadTbl->Data, sizeof(SENSOR_TBL_Data_t));
+
+   for (Obj=0; Obj < LoadTbl->JsonObjCnt; Obj++)
+   {
+      JsonTblObjs[Obj].Updated = false;
+   }
+
+   ObjLoadCnt = CJSON_LoadObjArray(JsonTblObjs, LoadTbl->JsonObjCnt, JsonBuf, LoadTbl->JsonFileLen);
+
+   for (i=0; i < SENSOR_TBL_GYRO_AXIS_CNT; i++)
+   {
+      ZeroGain |= (TblData.Gyro.Scale[i] == 0.0);
+   }
+   for (i=0; i < SENSOR_TBL_LIGHT_CNT; i++)
+   {
+      ZeroGain |= (TblData.Light[i].Gain == 0.0);
+   }
+
+   if (!LoadTbl->Loaded && (ObjLoadCnt != LoadTbl->JsonObjCnt))
+   {
+
+      CFE_EVS_SendEvent(SENSOR_TBL_LOAD_EID, CFE_EVS_EventType_ERROR,
+                        "Table has never been loaded and new table only contains %d of %d JSON objects",
+                        (unsigned int)ObjLoadCnt, (unsigned int)LoadTbl->JsonObjCnt);
+
+   }
+   else if (ZeroGain)
+   {
+
+      CFE_EVS_SendEvent(SENSOR_TBL_LOAD_EID, CFE_EVS_EventType_ERROR,
+                        "Invalid sensor calibration, the gyro scale factors and light gains must be non-zero");
+
+   }
+   else if (GYRO_BIAS_ValidParam(&TblData.BiasEst))
+   {
+
+      FuseCal(&Cal, &TblData);
+      memcpy(&LoadTbl->LoadData, &TblData, sizeof(SENSOR_TBL_Data_t));
+      memcpy(&LoadTbl->LoadCal, &Cal, sizeof(SENSOR_TBL_Cal_t));
+      __atomic_store_n(&LoadTbl->ActivatePending, true, __ATOMIC_RELEASE);
+      LoadTbl->LastLoadCnt = ObjLoadCnt;
+      CFE_EVS_SendEvent(SENSOR_TBL_LOAD_EID, CFE_EVS_EventType_DEBUG,
+                        "Successfully loaded %d JSON objects",
+                        (unsigned int)ObjLoadCnt);
+      RetStatus = true;
+
+   }
+
+   return RetStatus;
+
+} /* End LoadJsonData() */
@@ -0,0 +1,254 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Manage the sensor calibration table
+**
+**  Notes:
+**    1. Each rig's SAT_CTRL object owns a table object and passes it to
+**       every function. Table loads are only performed by the app's main
+**       task so the JSON file buffer and the load working buffer are shared
+**       by all instances.
+**    2. The gyro is calibrated with
+**         Cal = Misalign * Scale * (Raw - Bias)
+**       where Scale is a diagonal matrix of the per-axis scale factors and
+**       Misalign maps the sensor axes to the rig's axes. Each light sensor
+**       is calibrated with Cal = Gain * Raw + Offset.
+**    3. At load time every term is folded into one affine transform over
+**       the sensor channel vector so SENSOR_TBL_Calibrate() only performs a
+**       single small matrix-vector multiply and add per message.
+**    4. The table also holds the online gyro bias estimator's parameters,
+**       see gyro_bias.h. GyroVersion is incremented when a load changes the
+**       gyro calibration so the owner can forget the bias it learned
+**       relative to the old calibration.
+**    5. The rig worker calibrates with Data and Cal while the main task
+**       loads. A load is written to LoadData/LoadCal and the worker copies it
+**       in with SENSOR_TBL_Activate() between control cycles. GyroVersion
+**       is incremented after the copy so the owner never sees a new version
+**       with the old calibration. A new load is rejected until the previous
+**       one has been activated.
+**
+*/
+
+#ifndef _sensor_tbl_
+#define _sensor_tbl_
+
+/*
+** Includes
+*/
+
+#include "app_cfg.h"
+#include "gyro_bias.h"
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define SENSOR_TBL_GYRO_AXIS_CNT   3
+#define SENSOR_TBL_LIGHT_CNT       2
+
+/*
+** Event Message IDs
+*/
+
+#define SENSOR_TBL_DUMP_EID  (SENSOR_TBL_BASE_EID + 0)
+#define SENSOR_TBL_LOAD_EID  (SENSOR_TBL_BASE_EID + 1)
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+/*
+** Sensor channel vector
+*/
+typedef enum
+{
+
+   SENSOR_TBL_CHAN_RATE_X = 0,   /* Radians/sec */
+   SENSOR_TBL_CHAN_RATE_Y = 1,
+   SENSOR_TBL_CHAN_RATE_Z = 2,
+   SENSOR_TBL_CHAN_LUX_A  = 3,
+   SENSOR_TBL_CHAN_LUX_B  = 4,
+   SENSOR_TBL_CHAN_CNT    = 5
+
+} SENSOR_TBL_Chan_t;
+
+
+/******************************************************************************
+** Table - Local table copy used for table loads
+**
+*/
+
+typedef struct
+{
+
+   float  Bias[SENSOR_TBL_GYRO_AXIS_CNT];
+   float  Scale[SENSOR_TBL_GYRO_AXIS_CNT];
+   float  Misalign[SENSOR_TBL_GYRO_AXIS_CNT][SENSOR_TBL_GYRO_AXIS_CNT];  /* [Rig axis][Sensor axis] */
+
+} SENSOR_TBL_Gyro_t;
+
+
+typedef struct
+{
+
+   float  Gain;
+   float  Offset;
+
+} SENSOR_TBL_Light_t;
+
+
+typedef struct
+{
+
+   SENSOR_TBL_Gyro_t   Gyro;
+   SENSOR_TBL_Light_t  Light[SENSOR_TBL_LIGHT_CNT];
+   GYRO_BIAS_Param_t   BiasEst;
+
+} SENSOR_TBL_Data_t;
+
+
+/******************************************************************************
+** Fused calibration, Cal = Gain * Raw + Offset
+*/
+
+typedef struct
+{
+
+   float  Gain[SENSOR_TBL_CHAN_CNT][SENSOR_TBL_CHAN_CNT];
+   float  Offset[SENSOR_TBL_CHAN_CNT];
+
+} SENSOR_TBL_Cal_t;
+
+
+/******************************************************************************
+** Class
+*/
+
+typedef struct
+{
+
+   /*
+   ** Table Data
+   */
+
+   SENSOR_TBL_Data_t  Data;
+   SENSOR_TBL_Cal_t   Cal;
+   uint16             GyroVersion;
+
+   /*
+   ** Staged load, owned by the main task until ActivatePending is set
+   */
+
+   SENSOR_TBL_Data_t  LoadData;
+   SENSOR_TBL_Cal_t   LoadCal;
+   bool               ActivatePending;  /* Atomic */
+
+   /*
+   ** Standard CJSON table data
+   */
+
+   bool    Loaded;       /* Has entire table been loaded? */
+   uint16  LastLoadCnt;
+
+   size_t  JsonObjCnt;
+   size_t  JsonFileLen;
+
+} SENSOR_TBL_Class_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: SENSOR_TBL_Constructor
+**
+** Initialize the sensor calibration table object.
+**
+** Notes:
+**   1. The fused calibration is initialized to identity so raw values pass
+**      through until a table is loaded.
+**
+*/
+void SENSOR_TBL_Constructor(SENSOR_TBL_Class_t *SensorTbl);
+
+
+/******************************************************************************
+** Function: SENSOR_TBL_Activate
+**
+** Copy a staged table load into the active table data and calibration.
+** Returns true if a load was activated.
+**
+** Notes:
+**  1. Must be called by the rig worker between control cycles and by the
+**     owner's constructor after loading its default table.
+**
+*/
+bool SENSOR_TBL_Activate(SENSOR_TBL_Class_t *SensorTbl);
+
+
+/******************************************************************************
+** Function: SENSOR_TBL_Calibrate
+**
+** Apply the fused calibration to a raw sensor channel vector.
+**
+*/
+void SENSOR_TBL_Calibrate(const SENSOR_TBL_Class_t *SensorTbl,
+                          const float Raw[SENSOR_TBL_CHAN_CNT], float Cal[SENSOR_TBL_CHAN_CNT]);
+
+
+/******************************************************************************
+** Function: SENSOR_TBL_Dump
+**
+** Write the table data from memory to a JSON file.
+**
+** Notes:
+**  1. Called by the owner's TBLMGR_DumpTblFuncPtr_t callback.
+**
+*/
+bool SENSOR_TBL_Dump(SENSOR_TBL_Class_t *SensorTbl, osal_id_t FileHandle);
+
+
+/******************************************************************************
+** Function: SENSOR_TBL_Load
+**
+** Copy the table data from a JSON file to the staging buffer and compute
+** the fused calibration. SENSOR_TBL_Activate() makes the load active.
+**
+** Notes:
+**  1. Called by the owner's TBLMGR_LoadTblFuncPtr_t callback and by the
+**     owner's constructor to load its default table.
+**  2. Must only be called from the app's main task because the JSON file
+**     buffer and the load working buffer are shared by all instances.
+**
+*/
+bool SENSOR_TBL_Load(SENSOR_TBL_Class_t *SensorTbl, APP_C_FW_TblLoadOptions_Enum_t LoadType,
+                     const char *Filename);
+
+
+/******************************************************************************
+** Function: SENSOR_TBL_ResetStatus
+**
+** Reset counters and status flags to a known reset state.  The behavior of
+** the table manager should not be impacted. The intent is to clear counters
+** and flags to a known default state for telemetry.
+**
+*/
+void SENSOR_TBL_ResetStatus(SENSOR_TBL_Class_t *SensorTbl);
+
+
+#endif /* _sensor_tbl_ */
@@ -0,0 +1,309 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Implement the command sequencer class
+**
+**  Notes:
+**    1. See seq.h for details. Request and State are the only fields shared
+**       by the main task and the worker so they're accessed atomically. The
+**       progress counters are only reported in telemetry.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+#include "seq.h"
+
+
+/************************************/
+/** Local File Function Prototypes **/
+/************************************/
+
+static void PostRequest(SEQ_Class_t *Seq, SEQ_Request_Enum_t Request);
+static void SetState(SEQ_Class_t *Seq, TBL_SAT_SeqState_Enum_t State);
+
+
+/******************************************************************************
+** Function: SEQ_Constructor
+**
+*/
+void SEQ_Constructor(SEQ_Class_t *Seq, uint8 RigIdx)
+{
+
+   memset(Seq, 0, sizeof(SEQ_Class_t));
+
+   Seq->RigIdx = RigIdx;
+   Seq->State  = TBL_SAT_SeqState_IDLE;
+
+   SEQ_TBL_Constructor(&Seq->Tbl);
+
+} /* End SEQ_Constructor() */
+
+
+/******************************************************************************
+** Function: SEQ_Abort
+**
+*/
+bool SEQ_Abort(SEQ_Class_t *Seq)
+{
+
+   if (!SEQ_Active(Seq))
+   {
+      CFE_EVS_SendEvent(SEQ_CMD_EID, CFE_EVS_EventType_ERROR,
+                        "Rig %d abort sequence rejected, no sequence is active", Seq->RigIdx);
+      return false;
+   }
+
+   PostRequest(Seq, SEQ_REQ_ABORT);
+
+   return true;
+
+} /* End SEQ_Abort() */
+
+
+/******************************************************************************
+** Function: SEQ_Active
+**
+*/
+bool SEQ_Active(const SEQ_Class_t *Seq)
+{
+
+   return (SEQ_GetState(Seq) != TBL_SAT_SeqState_IDLE ||
+           __atomic_load_n(&Seq->Request, __ATOMIC_ACQUIRE) == SEQ_REQ_START);
+
+} /* End SEQ_Active() */
+
+
+/******************************************************************************
+** Function: SEQ_GetState
+**
+*/
+TBL_SAT_SeqState_Enum_t SEQ_GetState(const SEQ_Class_t *Seq)
+{
+
+   return (TBL_SAT_SeqState_Enum_t)__atomic_load_n(&Seq->State, __ATOMIC_ACQUIRE);
+
+} /* End SEQ_GetState() */
+
+
+/******************************************************************************
+** Function: SEQ_NextDueCmd
+**
+*/
+const SEQ_TBL_Entry_t *SEQ_NextDueCmd(SEQ_Class_t *Seq)
+{
+
+   const SEQ_TBL_Entry_t *Entry;
+
+   if (Seq->State != TBL_SAT_SeqState_RUNNING)
+   {
+      return NULL;
+   }
+
+   if (Seq->Entry >= Seq->Tbl.Data.EntryCnt)
+   {
+      SetState(Seq, TBL_SAT_SeqState_IDLE);
+      CFE_EVS_SendEvent(SEQ_STATE_EID, CFE_EVS_EventType_INFORMATION,
+                        "Rig %d sequence completed %d commands at cycle %u, %u ms",
+                        Seq->RigIdx, Seq->CmdCnt, (unsigned int)Seq->Cycle, (unsigned int)Seq->TimeMs);
+      return NULL;
+   }
+
+   Entry = &Seq->Tbl.Data.Entry[Seq->Entry];
+
+   if ((Entry->AtCycle ? Seq->Cycle : Seq->TimeMs) < Entry->At)
+   {
+      return NULL;
+   }
+
+   Seq->Entry++;
+   Seq->CmdCnt++;
+
+   return Entry;
+
+} /* End SEQ_NextDueCmd() */
+
+
+/******************************************************************************
+** Function: SEQ_Pause
+**
+*/
+bool SEQ_Pause(SEQ_Class_t *Seq)
+{
+
+   if (SEQ_GetState(Seq) != TBL_SAT_SeqState_RUNNING)
+   {
+      CFE_EVS_SendEvent(SEQ_CMD_EID, CFE_EVS_EventType_ERROR,
+                        "Rig %d pause sequence rejected, no sequence is running", Seq->RigIdx);
+      return false;
+   }
+
+   PostRequest(Seq, SEQ_REQ_PAUSE);
+
+   return true;
+
+} /* End SEQ_Pause() */
+
+
+/******************************************************************************
+** Function: SEQ_ResetStatus
+**
+*/
+void SEQ_ResetStatus(SEQ_Class_t *Seq)
+{
+
+   SEQ_TBL_ResetStatus(&Seq->Tbl);
+
+} /* End SEQ_ResetStatus() */
+
+
+/******************************************************************************
+** Function: SEQ_Start
+**
+*/
+bool SEQ_Start(SEQ_Class_t *Seq)
+{
+
+   TBL_SAT_SeqState_Enum_t State = SEQ_GetState(Seq);
+
+   if (State == TBL_SAT_SeqState_RUNNING)
+   {
+      CFE_EVS_SendEvent(SEQ_CMD_EID, CFE_EVS_EventType_ERROR,
+                        "Rig %d start sequence rejected, a sequence is already running", Seq->RigIdx);
+      return false;
+   }
+
+   if (State == TBL_SAT_SeqState_IDLE && Seq->Tbl.Data.EntryCnt == 0)
+   {
+      CFE_EVS_SendEvent(SEQ_CMD_EID, CFE_EVS_EventType_ERROR,
+                        "Rig %d start sequence rejected, no sequence is loaded", Seq->RigIdx);
+      return false;
+   }
+
+   PostRequest(Seq, SEQ_REQ_START);
+
+   return true;
+
+} /* End SEQ_Start() */
+
+
+/******************************************************************************
+** Function: SEQ_Step
+**
+** Notes:
+**   1. A resumed sequence counts the resume pass as its next cycle if it's
+**      a control step but none of the paused time.
+**
+*/
+void SEQ_Step(SEQ_Class_t *Seq, uint64 NowMs, bool CtrlStep)
+{
+
+   uint8 Request = __atomic_exchange_n(&Seq->Request, SEQ_REQ_NONE, __ATOMIC_ACQ_REL);
+
+   switch (Request)
+   {
+      case SEQ_REQ_START:
+         if (Seq->State == TBL_SAT_SeqState_IDLE)
+         {
+            Seq->Entry     = 0;
+            Seq->CmdCnt    = 0;
+            Seq->Cycle     = 0;
+            Seq->TimeMs    = 0;
+            Seq->FirstStep = true;
+            CFE_EVS_SendEvent(SEQ_STATE_EID, CFE_EVS_EventType_INFORMATION,
+                              "Rig %d sequence started with %d entries",
+                              Seq->RigIdx, Seq->Tbl.Data.EntryCnt);
+         }
+         else if (Seq->State == TBL_SAT_SeqState_PAUSED)
+         {
+            CFE_EVS_SendEvent(SEQ_STATE_EID, CFE_EVS_EventType_INFORMATION,
+                              "Rig %d sequence resumed at entry %d, cycle %u",
+                              Seq->RigIdx, Seq->Entry, (unsigned int)Seq->Cycle);
+         }
+         Seq->LastStepMs = NowMs;
+         SetState(Seq, TBL_SAT_SeqState_RUNNING);
+         break;
+
+      case SEQ_REQ_ABORT:
+         if (Seq->State != TBL_SAT_SeqState_IDLE)
+         {
+            SetState(Seq, TBL_SAT_SeqState_IDLE);
+            CFE_EVS_SendEvent(SEQ_STATE_EID, CFE_EVS_EventType_INFORMATION,
+                              "Rig %d sequence aborted at entry %d, cycle %u",
+                              Seq->RigIdx, Seq->Entry, (unsigned int)Seq->Cycle);
+         }
+         break;
+
+      case SEQ_REQ_PAUSE:
+         if (Seq->State == TBL_SAT_SeqState_RUNNING)
+         {
+            SetState(Seq, TBL_SAT_SeqState_PAUSED);
+            CFE_EVS_SendEvent(SEQ_STATE_EID, CFE_EVS_EventType_INFORMATION,
+                              "Rig %d sequence paused at entry %d, cycle %u",
+                              Seq->RigIdx, Seq->Entry, (unsigned int)Seq->Cycle);
+         }
+         break;
+
+      default:
+         break;
+
+   } /* End request switch */
+
+   if (Seq->State == TBL_SAT_SeqState_RUNNING)
+   {
+      if (Seq->FirstStep)
+      {
+         Seq->FirstStep = false;
+      }
+      else
+      {
+         if (CtrlStep)
+         {
+            Seq->Cycle++;
+         }
+         Seq->TimeMs += (uint32)(NowMs - Seq->LastStepMs);
+      }
+      Seq->LastStepMs = NowMs;
+   }
+
+} /* End SEQ_Step() */
+
+
+/******************************************************************************
+** Function: PostRequest
+**
+** A request replaces a request that the worker hasn't applied yet.
+*/
+static void PostRequest(SEQ_Class_t *Seq, SEQ_Request_Enum_t Request)
+{
+
+   __atomic_store_n(&Seq->Request, (uint8)Request, __ATOMIC_RELEASE);
+
+} /* End PostRequest() */
+
+
+/******************************************************************************
+** Function: SetState
+**
+*/
+static void SetState(SEQ_Class_t *Seq, TBL_SAT_SeqState_Enum_t State)
+{
+
+   __atomic_store_n(&Seq->State, (uint8)State, __ATOMIC_RELEASE);
+
+} /* End SetState() */
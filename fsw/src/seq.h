@@ -0,0 +1,199 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Define the command sequencer class
+**
+**  Notes:
+**    1. Each rig owns one SEQ object that executes the rig's command
+**       sequence table, see seq_tbl.h. The sequencer runs in the rig's
+**       worker task on every worker pass, before the control mode decides
+**       whether the pass is a control step, so sequence commands take
+**       effect without ground round-trip jitter and time based entries
+**       don't wait for the next control step.
+**    2. The start, abort and pause commands are received by the app's main
+**       task. They post a request and wake the rig's worker, which applies
+**       the request on its next pass. The state is only changed by the
+**       worker.
+**    3. Sequence time is measured from the worker pass that applies the
+**       start request and cycles count the control steps after that pass.
+**       Both stop while the sequence is paused so a resumed sequence keeps
+**       its relative timing.
+**    4. Entries execute in table order and an entry isn't checked until
+**       every preceding entry has executed. All entries that are due
+**       execute in the same control step.
+**
+*/
+
+#ifndef _seq_
+#define _seq_
+
+/*
+** Includes
+*/
+
+#include "app_cfg.h"
+#include "seq_tbl.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+/*
+** Event Message IDs
+*/
+
+#define SEQ_CMD_EID    (SEQ_BASE_EID + 0)
+#define SEQ_STATE_EID  (SEQ_BASE_EID + 1)
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+
+typedef enum
+{
+
+   SEQ_REQ_NONE  = 0,
+   SEQ_REQ_START = 1,
+   SEQ_REQ_ABORT = 2,
+   SEQ_REQ_PAUSE = 3
+
+} SEQ_Request_Enum_t;
+
+
+/******************************************************************************
+** SEQ_Class
+*/
+
+typedef struct
+{
+
+   /*
+   ** Class State Data
+   */
+
+   uint8   RigIdx;
+   uint8   Request;      /* SEQ_Request_Enum_t posted by the main task */
+   uint8   State;        /* TBL_SAT_SeqState_Enum_t, only written by the worker */
+   bool    FirstStep;
+
+   uint16  Entry;        /* Next entry to execute */
+   uint16  CmdCnt;
+   uint32  Cycle;
+   uint32  TimeMs;
+   uint64  LastStepMs;
+
+   SEQ_TBL_Class_t  Tbl;
+
+} SEQ_Class_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: SEQ_Constructor
+**
+** Initialize a rig's sequencer object to a known state
+**
+** Notes:
+**   1. This must be called prior to any other function.
+**   2. No sequence is loaded by default.
+**
+*/
+void SEQ_Constructor(SEQ_Class_t *Seq, uint8 RigIdx);
+
+
+/******************************************************************************
+** Function: SEQ_Abort
+**
+** Request the worker to abort a running or paused sequence.
+*/
+bool SEQ_Abort(SEQ_Class_t *Seq);
+
+
+/******************************************************************************
+** Function: SEQ_Active
+**
+** Return true if a sequence is running, paused or has a start request
+** pending. The sequence table can't be loaded while it's active.
+*/
+bool SEQ_Active(const SEQ_Class_t *Seq);
+
+
+/******************************************************************************
+** Function: SEQ_GetState
+**
+*/
+TBL_SAT_SeqState_Enum_t SEQ_GetState(const SEQ_Class_t *Seq);
+
+
+/******************************************************************************
+** Function: SEQ_NextDueCmd
+**
+** Return the next entry that is due in the current control step or NULL if
+** no entry is due. Call after SEQ_Step() until NULL is returned.
+**
+** Notes:
+**   1. The sequence completes when its last entry is returned.
+**
+*/
+const SEQ_TBL_Entry_t *SEQ_NextDueCmd(SEQ_Class_t *Seq);
+
+
+/******************************************************************************
+** Function: SEQ_Pause
+**
+** Request the worker to pause a running sequence.
+*/
+bool SEQ_Pause(SEQ_Class_t *Seq);
+
+
+/******************************************************************************
+** Function: SEQ_ResetStatus
+**
+** Reset counters and status flags to a known reset state.
+**
+** Notes:
+**   1. Any counter or variable that is reported in HK telemetry that doesn't
+**      change the functional behavior should be reset.
+**
+*/
+void SEQ_ResetStatus(SEQ_Class_t *Seq);
+
+
+/******************************************************************************
+** Function: SEQ_Start
+**
+** Request the worker to start the loaded sequence or resume a paused one.
+*/
+bool SEQ_Start(SEQ_Class_t *Seq);
+
+
+/******************************************************************************
+** Function: SEQ_Step
+**
+** Apply a pending request and advance the sequence time, and the cycle if
+** CtrlStep is true. Called by the rig's worker at the start of every pass.
+** NowMs is CLOCK_MONOTONIC in milliseconds.
+*/
+void SEQ_Step(SEQ_Class_t *Seq, uint64 NowMs, bool CtrlStep);
+
+
+#endif /* _seq_ */
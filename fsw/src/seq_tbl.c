@@ -0,0 +1,395 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Implement the command sequence table
+**
+**  Notes:
+**    1. The static "JsonEntry" array serves as the JSON load buffer. It's
+**       validated and converted to the owner's table storage. Table dump
+**       data is read directly from table owner's table storage.
+**    2. LoadTbl identifies the instance being loaded while CJSON calls
+**       LoadJsonData(). It's only valid during SEQ_TBL_Load().
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+#include "seq_tbl.h"
+#include "fan.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define SEQ_JSON_OBJ(Entry, Field, Float, Type, Key) \
+   { &JsonEntry[Entry].Field, sizeof(JsonEntry[Entry].Field), false, Type, Float, \
+     { "cmd[" #Entry "]." Key, (sizeof("cmd[" #Entry "]." Key)-1)} }
+
+/* Must be kept in sync with JsonObj_t */
+#define SEQ_JSON_OBJS(Entry) \
+   SEQ_JSON_OBJ(Entry, Id,       false, JSONString, "id"),        \
+   SEQ_JSON_OBJ(Entry, Cycle,    false, JSONNumber, "cycle"),     \
+   SEQ_JSON_OBJ(Entry, TimeMs,   false, JSONNumber, "time-ms"),   \
+   SEQ_JSON_OBJ(Entry, Mode,     false, JSONNumber, "mode"),      \
+   SEQ_JSON_OBJ(Entry, PosGain,  true,  JSONNumber, "pos-gain"),  \
+   SEQ_JSON_OBJ(Entry, RateGain, true,  JSONNumber, "rate-gain"), \
+   SEQ_JSON_OBJ(Entry, Duration, false, JSONNumber, "duration"),  \
+   SEQ_JSON_OBJ(Entry, FanAPwm,  false, JSONNumber, "fan-a-pwm"), \
+   SEQ_JSON_OBJ(Entry, FanBPwm,  false, JSONNumber, "fan-b-pwm")
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+typedef enum
+{
+
+   JSON_OBJ_ID        = 0,
+   JSON_OBJ_CYCLE     = 1,
+   JSON_OBJ_TIME_MS   = 2,
+   JSON_OBJ_MODE      = 3,
+   JSON_OBJ_POS_GAIN  = 4,
+   JSON_OBJ_RATE_GAIN = 5,
+   JSON_OBJ_DURATION  = 6,
+   JSON_OBJ_FAN_A_PWM = 7,
+   JSON_OBJ_FAN_B_PWM = 8,
+   JSON_OBJ_CNT       = 9
+
+} JsonObj_t;
+
+typedef struct
+{
+
+   char    Id[SEQ_TBL_ID_LEN];
+   uint32  Cycle;
+   uint32  TimeMs;
+   uint32  Mode;
+   float   PosGain;
+   float   RateGain;
+   uint32  Duration;
+   uint32  FanAPwm;
+   uint32  FanBPwm;
+
+} JsonEntry_t;
+
+typedef struct
+{
+
+   const char         *Id;
+   SEQ_TBL_Cmd_Enum_t  Cmd;
+   JsonObj_t           Param[3];
+   uint8               ParamCnt;
+
+} CmdDef_t;
+
+
+/************************************/
+/** Local File Function Prototypes **/
+/************************************/
+
+static bool LoadJsonData(size_t JsonFileLen);
+static bool ObjUpdated(uint16 Entry, JsonObj_t Obj);
+
+
+/**********************/
+/** Global File Data **/
+/**********************/
+
+static SEQ_TBL_Class_t *LoadTbl = NULL;
+
+static JsonEntry_t     JsonEntry[SEQ_TBL_MAX_ENTRY];  /* Working buffer for loads */
+static SEQ_TBL_Data_t  TblData;
+static char JsonBuf[SEQ_TBL_JSON_FILE_MAX_CHAR];
+
+static CJSON_Obj_t JsonTblObjs[] = {
+
+   /* One entry per sequence entry, must be kept in sync with SEQ_TBL_MAX_ENTRY */
+   SEQ_JSON_OBJS(0),
+   SEQ_JSON_OBJS(1),
+   SEQ_JSON_OBJS(2),
+   SEQ_JSON_OBJS(3),
+   SEQ_JSON_OBJS(4),
+   SEQ_JSON_OBJS(5),
+   SEQ_JSON_OBJS(6),
+   SEQ_JSON_OBJS(7),
+   SEQ_JSON_OBJS(8),
+   SEQ_JSON_OBJS(9),
+   SEQ_JSON_OBJS(10),
+   SEQ_JSON_OBJS(11),
+   SEQ_JSON_OBJS(12),
+   SEQ_JSON_OBJS(13),
+   SEQ_JSON_OBJS(14),
+   SEQ_JSON_OBJS(15)
+
+};
+
+static const CmdDef_t CmdDef[] = {
+
+   { "set-ctrl-mode",    SEQ_TBL_CMD_SET_CTRL_MODE,    { JSON_OBJ_MODE },                                           1 },
+   { "set-ctrl-gains",   SEQ_TBL_CMD_SET_CTRL_GAINS,   { JSON_OBJ_POS_GAIN, JSON_OBJ_RATE_GAIN },                   2 },
+   { "override-fan-pwm", SEQ_TBL_CMD_OVERRIDE_FAN_PWM, { JSON_OBJ_DURATION, JSON_OBJ_FAN_A_PWM, JSON_OBJ_FAN_B_PWM }, 3 }
+
+};
+
+#define CMD_DEF_CNT  (sizeof(CmdDef)/sizeof(CmdDef_t))
+
+
+/******************************************************************************
+** Function: SEQ_TBL_Constructor
+**
+** Notes:
+**    1. This must be called prior to any other functions
+**
+*/
+void SEQ_TBL_Constructor(SEQ_TBL_Class_t *SeqTbl)
+{
+
+   CFE_PSP_MemSet(SeqTbl, 0, sizeof(SEQ_TBL_Class_t));
+
+   SeqTbl->JsonObjCnt = (sizeof(JsonTblObjs)/sizeof(CJSON_Obj_t));
+
+} /* End SEQ_TBL_Constructor() */
+
+
+/******************************************************************************
+** Function: SEQ_TBL_Dump
+**
+** Notes:
+**  1. Called by the owner's TBLMGR_DumpTblFuncPtr_t callback.
+**  2. Can assume valid table filename because this is a callback from
+**     the app framework table manager that has verified the file.
+**  3. File is formatted so it can be used as a load file. It does not follow
+**     the cFE table file format.
+*/
+bool SEQ_TBL_Dump(SEQ_TBL_Class_t *SeqTbl, osal_id_t FileHandle)
+{
+
+   char  DumpRecord[256];
+   char  AtRecord[32];
+   const SEQ_TBL_Entry_t *Entry;
+   uint16 i;
+   uint8  Def;
+
+   sprintf(DumpRecord,"   \"cmd\": [\n");
+   OS_write(FileHandle, DumpRecord, strlen(DumpRecord));
+
+   for (i=0; i < SeqTbl->Data.EntryCnt; i++)
+   {
+
+      Entry = &SeqTbl->Data.Entry[i];
+
+      sprintf(AtRecord, "\"%s\": %u", Entry->AtCycle ? "cycle" : "time-ms", (unsigned int)Entry->At);
+
+      for (Def=0; Def < CMD_DEF_CNT && CmdDef[Def].Cmd != Entry->Cmd; Def++);
+
+      switch (Entry->Cmd)
+      {
+         case SEQ_TBL_CMD_SET_CTRL_MODE:
+            sprintf(DumpRecord,"      {%s, \"id\": \"%s\", \"mode\": %d}", AtRecord, CmdDef[Def].Id, Entry->Mode);
+            break;
+         case SEQ_TBL_CMD_SET_CTRL_GAINS:
+            sprintf(DumpRecord,"      {%s, \"id\": \"%s\", \"pos-gain\": %0.6f, \"rate-gain\": %0.6f}",
+                    AtRecord, CmdDef[Def].Id, Entry->PosGain, Entry->RateGain);
+            break;
+         case SEQ_TBL_CMD_OVERRIDE_FAN_PWM:
+            sprintf(DumpRecord,"      {%s, \"id\": \"%s\", \"duration\": %u, \"fan-a-pwm\": %d, \"fan-b-pwm\": %d}",
+                    AtRecord, CmdDef[Def].Id, (unsigned int)Entry->Duration, Entry->FanAPwm, Entry->FanBPwm);
+            break;
+         default:
+            sprintf(DumpRecord,"      {%s, \"id\": \"undefined\"}", AtRecord);
+            break;
+      }
+      OS_write(FileHandle, DumpRecord, strlen(DumpRecord));
+
+      sprintf(DumpRecord,"%s\n", (i < (SeqTbl->Data.EntryCnt-1)) ? "," : "");
+      OS_write(FileHandle, DumpRecord, strlen(DumpRecord));
+
+   }
+
+   sprintf(DumpRecord,"   ]\n}\n");
+   OS_write(FileHandle, DumpRecord, strlen(DumpRecord));
+
+   return true;
+
+} /* End of SEQ_TBL_Dump() */
+
+
+/******************************************************************************
+** Function: SEQ_TBL_Load
+**
+** Notes:
+**  1. Must only be called from the app's main task, see seq_tbl.h note 1.
+*/
+bool SEQ_TBL_Load(SEQ_TBL_Class_t *SeqTbl, APP_C_FW_TblLoadOptions_Enum_t LoadType,
+                  const char *Filename)
+{
+
+   bool  RetStatus = false;
+
+   LoadTbl = SeqTbl;
+
+   if (CJSON_ProcessFile(Filename, JsonBuf, SEQ_TBL_JSON_FILE_MAX_CHAR, LoadJsonData))
+   {
+      SeqTbl->Loaded = true;
+      RetStatus = true;
+   }
+
+   LoadTbl = NULL;
+
+   return RetStatus;
+
+} /* End SEQ_TBL_Load() */
+
+
+/******************************************************************************
+** Function: SEQ_TBL_ResetStatus
+**
+*/
+void SEQ_TBL_ResetStatus(SEQ_TBL_Class_t *SeqTbl)
+{
+
+   SeqTbl->LastLoadCnt = 0;
+
+} /* End SEQ_TBL_ResetStatus() */
+
+
+/******************************************************************************
+** Function: LoadJsonData
+**
+** Notes:
+**  1. Entries must be defined in order starting with cmd[0]. The first
+**     entry without an "id" ends the sequence.
+**  2. Any invalid entry rejects the entire load. Modes must be a defined
+**     control mode and fan PWMs must be <= FAN_MAX_PWM.
+*/
+static bool LoadJsonData(size_t JsonFileLen)
+{
+
+   size_t  ObjLoadCnt;
+   size_t  Obj;
+   uint16  i;
+   uint8   Def, Param;
+   const JsonEntry_t *Json;
+   SEQ_TBL_Entry_t   *Entry;
+
+   LoadTbl->JsonFileLen = JsonFileLen;
+
+   memset(JsonEntry, 0, sizeof(JsonEntry));
+   memset(&TblData, 0, sizeof(SEQ_TBL_Data_t));
+
+   for (Obj=0; Obj < LoadTbl->JsonObjCnt; Obj++)
+   {
+      JsonTblObjs[Obj].Updated = false;
+   }
+
+   ObjLoadCnt = CJSON_LoadObjArray(JsonTblObjs, LoadTbl->JsonObjCnt, JsonBuf, LoadTbl->JsonFileLen);
+
+   for (i=0; i < SEQ_TBL_MAX_ENTRY && ObjUpdated(i, JSON_OBJ_ID); i++)
+   {
+
+      Json  = &JsonEntry[i];
+      Entry = &TblData.Entry[i];
+
+      for (Def=0; Def < CMD_DEF_CNT && strcmp(CmdDef[Def].Id, Json->Id) != 0; Def++);
+
+      if (Def == CMD_DEF_CNT)
+      {
+         CFE_EVS_SendEvent(SEQ_TBL_LOAD_EID, CFE_EVS_EventType_ERROR,
+                           "Sequence load rejected, cmd[%d] has an undefined id \"%s\"", i, Json->Id);
+         return false;
+      }
+
+      if (ObjUpdated(i, JSON_OBJ_CYCLE) == ObjUpdated(i, JSON_OBJ_TIME_MS))
+      {
+         CFE_EVS_SendEvent(SEQ_TBL_LOAD_EID, CFE_EVS_EventType_ERROR,
+                           "Sequence load rejected, cmd[%d] must define exactly one of cycle or time-ms", i);
+         return false;
+      }
+
+      for (Param=0; Param < CmdDef[Def].ParamCnt; Param++)
+      {
+         if (!ObjUpdated(i, CmdDef[Def].Param[Param]))
+         {
+            CFE_EVS_SendEvent(SEQ_TBL_LOAD_EID, CFE_EVS_EventType_ERROR,
+                              "Sequence load rejected, cmd[%d] %s is missing a parameter", i, Json->Id);
+            return false;
+         }
+      }
+
+      if (CmdDef[Def].Cmd == SEQ_TBL_CMD_SET_CTRL_MODE &&
+          (Json->Mode < TBL_SAT_CtrlMode_IDLE || Json->Mode > TBL_SAT_CtrlMode_SUN_ACQ))
+      {
+         CFE_EVS_SendEvent(SEQ_TBL_LOAD_EID, CFE_EVS_EventType_ERROR,
+                           "Sequence load rejected, cmd[%d] mode %d must be in [%d,%d]",
+                           i, (unsigned int)Json->Mode, TBL_SAT_CtrlMode_IDLE, TBL_SAT_CtrlMode_SUN_ACQ);
+         return false;
+      }
+
+      if (CmdDef[Def].Cmd == SEQ_TBL_CMD_OVERRIDE_FAN_PWM &&
+          (Json->FanAPwm > FAN_MAX_PWM || Json->FanBPwm > FAN_MAX_PWM))
+      {
+         CFE_EVS_SendEvent(SEQ_TBL_LOAD_EID, CFE_EVS_EventType_ERROR,
+                           "Sequence load rejected, cmd[%d] fan PWMs (%d,%d) must be <= %d",
+                           i, (unsigned int)Json->FanAPwm, (unsigned int)Json->FanBPwm, FAN_MAX_PWM);
+         return false;
+      }
+
+      Entry->Cmd      = CmdDef[Def].Cmd;
+      Entry->AtCycle  = ObjUpdated(i, JSON_OBJ_CYCLE);
+      Entry->At       = Entry->AtCycle ? Json->Cycle : Json->TimeMs;
+      Entry->Mode     = (TBL_SAT_CtrlMode_Enum_t)Json->Mode;
+      Entry->PosGain  = Json->PosGain;
+      Entry->RateGain = Json->RateGain;
+      Entry->Duration = Json->Duration;
+      Entry->FanAPwm  = (uint16)Json->FanAPwm;
+      Entry->FanBPwm  = (uint16)Json->FanBPwm;
+
+   } /* End entry loop */
+
+   TblData.EntryCnt = i;
+
+   if (TblData.EntryCnt == 0)
+   {
+      CFE_EVS_SendEvent(SEQ_TBL_LOAD_EID, CFE_EVS_EventType_ERROR,
+                        "Sequence load rejected, cmd[0] isn't defined");
+      return false;
+   }
+
+   memcpy(&LoadTbl->Data, &TblData, sizeof(SEQ_TBL_Data_t));
+   LoadTbl->LastLoadCnt = ObjLoadCnt;
+   CFE_EVS_SendEvent(SEQ_TBL_LOAD_EID, CFE_EVS_EventType_DEBUG,
+                     "Successfully loaded a %d command sequence from %d JSON objects",
+                     TblData.EntryCnt, (unsigned int)ObjLoadCnt);
+
+   return true;
+
+} /* End LoadJsonData() */
+
+
+/******************************************************************************
+** Function: ObjUpdated
+**
+*/
+static bool ObjUpdated(uint16 Entry, JsonObj_t Obj)
+{
+
+   return JsonTblObjs[Entry*JSON_OBJ_CNT + Obj].Updated;
+
+} /* End ObjUpdated() */
@@ -0,0 +1,191 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Manage the Table Sat command sequence table
+**
+**  Notes:
+**    1. Each rig owns a table object and passes it to every function. Table
+**       loads are only performed by the app's main task so the JSON file
+**       buffer and the load working buffer are shared by all instances.
+**    2. A sequence is a "cmd" array of up to SEQ_TBL_MAX_ENTRY entries that
+**       execute in table order. Each entry defines exactly one of "cycle"
+**       (control cycles) or "time-ms" (milliseconds), measured from the
+**       start of the sequence, and an "id" with the id's parameters:
+**         set-ctrl-mode     mode
+**         set-ctrl-gains    pos-gain, rate-gain
+**         override-fan-pwm  duration, fan-a-pwm, fan-b-pwm
+**    3. A load always replaces the entire sequence.
+**    4. The start and stop PWM playback commands share the entry format so
+**       they can be posted to a rig's command mailbox, see cmd_mbox.h. They
+**       don't have sequence ids so a sequence can't contain them.
+**
+*/
+
+#ifndef _seq_tbl_
+#define _seq_tbl_
+
+/*
+** Includes
+*/
+
+#include "app_cfg.h"
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define SEQ_TBL_MAX_ENTRY   16
+#define SEQ_TBL_ID_LEN      24
+
+/*
+** Event Message IDs
+*/
+
+#define SEQ_TBL_DUMP_EID  (SEQ_TBL_BASE_EID + 0)
+#define SEQ_TBL_LOAD_EID  (SEQ_TBL_BASE_EID + 1)
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+
+typedef enum
+{
+
+   SEQ_TBL_CMD_UNDEF            = 0,
+   SEQ_TBL_CMD_SET_CTRL_MODE    = 1,
+   SEQ_TBL_CMD_SET_CTRL_GAINS   = 2,
+   SEQ_TBL_CMD_OVERRIDE_FAN_PWM = 3,
+   SEQ_TBL_CMD_START_PWM_PLAYBACK = 4,
+   SEQ_TBL_CMD_STOP_PWM_PLAYBACK  = 5
+
+} SEQ_TBL_Cmd_Enum_t;
+
+
+/******************************************************************************
+** Table - Local table copy used for table loads
+**
+*/
+
+typedef struct
+{
+
+   SEQ_TBL_Cmd_Enum_t  Cmd;
+   bool    AtCycle;   /* At is in control cycles when true, milliseconds when false */
+   uint32  At;
+
+   TBL_SAT_CtrlMode_Enum_t  Mode;
+   float   PosGain;
+   float   RateGain;
+   uint32  Duration;
+   uint16  FanAPwm;
+   uint16  FanBPwm;
+   uint16  RepeatCnt;
+   char    Filename[OS_MAX_PATH_LEN];
+
+} SEQ_TBL_Entry_t;
+
+
+typedef struct
+{
+
+   uint16           EntryCnt;
+   SEQ_TBL_Entry_t  Entry[SEQ_TBL_MAX_ENTRY];
+
+} SEQ_TBL_Data_t;
+
+
+/******************************************************************************
+** Class
+*/
+
+typedef struct
+{
+
+   /*
+   ** Table Data
+   */
+
+   SEQ_TBL_Data_t Data;
+
+   /*
+   ** Standard CJSON table data
+   */
+
+   bool    Loaded;       /* Has entire table been loaded? */
+   uint16  LastLoadCnt;
+
+   size_t  JsonObjCnt;
+   size_t  JsonFileLen;
+
+} SEQ_TBL_Class_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: SEQ_TBL_Constructor
+**
+** Initialize the sequence table object.
+**
+** Notes:
+**   1. The table starts empty, a sequence must be loaded by command.
+**
+*/
+void SEQ_TBL_Constructor(SEQ_TBL_Class_t *SeqTbl);
+
+
+/******************************************************************************
+** Function: SEQ_TBL_Dump
+**
+** Write the table data from memory to a JSON file.
+**
+** Notes:
+**  1. Called by the owner's TBLMGR_DumpTblFuncPtr_t callback.
+**
+*/
+bool SEQ_TBL_Dump(SEQ_TBL_Class_t *SeqTbl, osal_id_t FileHandle);
+
+
+/******************************************************************************
+** Function: SEQ_TBL_Load
+**
+** Copy the table data from a JSON file to memory.
+**
+** Notes:
+**  1. Called by the owner's TBLMGR_LoadTblFuncPtr_t callback. LoadType is
+**     ignored because a load always replaces the entire sequence.
+**
+*/
+bool SEQ_TBL_Load(SEQ_TBL_Class_t *SeqTbl, APP_C_FW_TblLoadOptions_Enum_t LoadType,
+                  const char *Filename);
+
+
+/******************************************************************************
+** Function: SEQ_TBL_ResetStatus
+**
+** Reset counters and status flags to a known reset state.  The behavior of
+** the table manager should not be impacted. The intent is to clear counters
+** and flags to a known default state for telemetry.
+**
+*/
+void SEQ_TBL_ResetStatus(SEQ_TBL_Class_t *SeqTbl);
+
+
+#endif /* _seq_tbl_ */
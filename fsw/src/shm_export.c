@@ -0,0 +1,222 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Implement the shared memory telemetry export class
+**
+**  Notes:
+**    1. See shm_export.h and tbl_sat_shm.h for details. The release fence
+**       after Seq is made odd keeps the slot writes from being seen before
+**       it and the release store that makes Seq even keeps them from being
+**       seen after it.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "shm_export.h"
+#include "rig_mgr.h"
+
+
+/*
+** tbl_sat_shm.h can't include the app's headers because external readers
+** use it, so its array sizes are checked here
+*/
+
+_Static_assert(TBL_SAT_SHM_MAX_RIG == RIG_MGR_MAX_RIG, "TBL_SAT_SHM_MAX_RIG must match RIG_MGR_MAX_RIG");
+_Static_assert(TBL_SAT_SHM_MAX_FAN == FAN_TBL_MAX_FAN, "TBL_SAT_SHM_MAX_FAN must match FAN_TBL_MAX_FAN");
+_Static_assert((TBL_SAT_SHM_HISTORY_LEN & (TBL_SAT_SHM_HISTORY_LEN-1)) == 0, "TBL_SAT_SHM_HISTORY_LEN must be a power of 2");
+
+
+/************************************/
+/** Local File Function Prototypes **/
+/************************************/
+
+static void Snapshot(TBL_SAT_SHM_Snapshot_t *Snap, const SAT_CTRL_Class_t *SatCtrl, uint64 NowMs);
+
+
+/******************************************************************************
+** Function: SHM_EXPORT_Constructor
+**
+*/
+void SHM_EXPORT_Constructor(SHM_EXPORT_Class_t *ShmExport, const char *Name, uint8 RigCnt)
+{
+
+   TBL_SAT_SHM_Segment_t *Segment;
+   int   Fd;
+   void *Addr;
+
+   memset(ShmExport, 0, sizeof(SHM_EXPORT_Class_t));
+
+   if (Name == NULL || Name[0] == '\0')
+   {
+      CFE_EVS_SendEvent(SHM_EXPORT_CONSTRUCTOR_EID, CFE_EVS_EventType_INFORMATION,
+                        "Shared memory telemetry export disabled");
+      return;
+   }
+
+   strncpy(ShmExport->Name, Name, OS_MAX_API_NAME-1);
+
+   Fd = shm_open(ShmExport->Name, O_CREAT | O_RDWR, 0644);
+   if (Fd < 0)
+   {
+      CFE_EVS_SendEvent(SHM_EXPORT_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                        "Shared memory segment %s open failed, errno %d",
+                        ShmExport->Name, errno);
+      return;
+   }
+
+   if (ftruncate(Fd, sizeof(TBL_SAT_SHM_Segment_t)) != 0)
+   {
+      CFE_EVS_SendEvent(SHM_EXPORT_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                        "Shared memory segment %s resize to %d bytes failed, errno %d",
+                        ShmExport->Name, (int)sizeof(TBL_SAT_SHM_Segment_t), errno);
+      close(Fd);
+      return;
+   }
+
+   Addr = mmap(NULL, sizeof(TBL_SAT_SHM_Segment_t), PROT_READ | PROT_WRITE, MAP_SHARED, Fd, 0);
+   close(Fd);
+
+   if (Addr == MAP_FAILED)
+   {
+      CFE_EVS_SendEvent(SHM_EXPORT_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                        "Shared memory segment %s map failed, errno %d",
+                        ShmExport->Name, errno);
+      return;
+   }
+
+   Segment = (TBL_SAT_SHM_Segment_t *)Addr;
+
+   __atomic_store_n(&Segment->Magic, 0, __ATOMIC_RELEASE);
+   memset(&Segment->Version, 0, sizeof(TBL_SAT_SHM_Segment_t) - sizeof(Segment->Magic));
+
+   Segment->Version    = TBL_SAT_SHM_VERSION;
+   Segment->RigCnt     = RigCnt;
+   Segment->Size       = sizeof(TBL_SAT_SHM_Segment_t);
+   Segment->HistoryLen = TBL_SAT_SHM_HISTORY_LEN;
+
+   __atomic_store_n(&Segment->Magic, TBL_SAT_SHM_MAGIC, __ATOMIC_RELEASE);
+
+   ShmExport->Segment = Segment;
+   ShmExport->Enabled = true;
+
+   CFE_EVS_SendEvent(SHM_EXPORT_CONSTRUCTOR_EID, CFE_EVS_EventType_INFORMATION,
+                     "Shared memory telemetry exported to %s, %d bytes for %d rigs",
+                     ShmExport->Name, (int)sizeof(TBL_SAT_SHM_Segment_t), RigCnt);
+
+} /* End SHM_EXPORT_Constructor() */
+
+
+/******************************************************************************
+** Function: SHM_EXPORT_Publish
+**
+*/
+void SHM_EXPORT_Publish(SHM_EXPORT_Class_t *ShmExport, uint8 Rig,
+                        const SAT_CTRL_Class_t *SatCtrl, uint64 NowMs)
+{
+
+   TBL_SAT_SHM_Rig_t   *Slot;
+   TBL_SAT_SHM_Cycle_t *Cycle;
+   uint32 Seq;
+
+   if (!ShmExport->Enabled || Rig >= TBL_SAT_SHM_MAX_RIG)
+   {
+      return;
+   }
+
+   Slot = &ShmExport->Segment->Rig[Rig];
+   Seq  = __atomic_load_n(&Slot->Seq, __ATOMIC_RELAXED);
+
+   __atomic_store_n(&Slot->Seq, Seq + 1, __ATOMIC_RELAXED);
+   __atomic_thread_fence(__ATOMIC_RELEASE);
+
+   Snapshot(&Slot->Snapshot, SatCtrl, NowMs);
+
+   Cycle = &Slot->History[Slot->HistoryCnt & (TBL_SAT_SHM_HISTORY_LEN-1)];
+   Cycle->TimeMs       = Slot->Snapshot.TimeMs;
+   Cycle->Cycle        = Slot->Snapshot.Cycle;
+   Cycle->CtrlMode     = Slot->Snapshot.CtrlMode;
+   Cycle->SunAcqState  = Slot->Snapshot.SunAcqState;
+   Cycle->TotalLight   = Slot->Snapshot.TotalLight;
+   Cycle->SpinRate     = Slot->Snapshot.SpinRate;
+   Cycle->PosErr       = Slot->Snapshot.PosErr;
+   Cycle->RateErr      = Slot->Snapshot.RateErr;
+   Cycle->FanPwmCmd[0] = Slot->Snapshot.FanPwmCmd[0];
+   Cycle->FanPwmCmd[1] = Slot->Snapshot.FanPwmCmd[1];
+   Slot->HistoryCnt++;
+
+   __atomic_store_n(&Slot->Seq, Seq + 2, __ATOMIC_RELEASE);
+
+} /* End SHM_EXPORT_Publish() */
+
+
+/******************************************************************************
+** Function: Snapshot
+**
+*/
+static void Snapshot(TBL_SAT_SHM_Snapshot_t *Snap, const SAT_CTRL_Class_t *SatCtrl, uint64 NowMs)
+{
+
+   uint8 i;
+
+   Snap->TimeMs      = NowMs;
+   Snap->Cycle       = SatCtrl->ExecCntr;
+   Snap->CtrlMode    = SatCtrl->Mode;
+   Snap->SunAcqState = SatCtrl->SunAcqMode.State;
+   Snap->SeqState    = SEQ_GetState(&SatCtrl->Seq);
+   Snap->FanOverride = SatCtrl->Fan.OverridePwmCmdEnabled;
+
+   Snap->LuxA       = SatCtrl->Sensor.LuxA;
+   Snap->LuxB       = SatCtrl->Sensor.LuxB;
+   Snap->RawRate[0] = SatCtrl->Sensor.RateX;
+   Snap->RawRate[1] = SatCtrl->Sensor.RateY;
+   Snap->RawRate[2] = SatCtrl->Sensor.RateZ;
+   Snap->CalRate[0] = SatCtrl->SensorCal[SENSOR_TBL_CHAN_RATE_X];
+   Snap->CalRate[1] = SatCtrl->SensorCal[SENSOR_TBL_CHAN_RATE_Y];
+   Snap->CalRate[2] = SatCtrl->SensorCal[SENSOR_TBL_CHAN_RATE_Z];
+   Snap->DeltaTime  = SatCtrl->Sensor.DeltaTime;
+   Snap->SensorFreshMask = SatCtrl->Mqtt.FreshMask;
+
+   Snap->TotalLight = SatCtrl->Sensor.TotalLight;
+   Snap->SpinRate   = SatCtrl->Sensor.SpinRate;
+   Snap->PosErr     = SatCtrl->SunAcqMode.PosErr;
+   Snap->RateErr    = SatCtrl->SunAcqMode.RateErr;
+   Snap->PosGain    = SatCtrl->Tbl.Data.PosGain;
+   Snap->RateGain   = SatCtrl->Tbl.Data.RateGain;
+
+   /* Unconfigured fans read as zero so History's FAN_B entry is zero too */
+   Snap->FanCnt = SatCtrl->Fan.FanCnt;
+   for (i=0; i < TBL_SAT_SHM_MAX_FAN; i++)
+   {
+      if (i < SatCtrl->Fan.FanCnt)
+      {
+         Snap->FanPwmCmd[i] = SatCtrl->Fan.Actuator[i].PwmCmd;
+         Snap->FanRpm[i]    = SatCtrl->Fan.Actuator[i].Rpm;
+      }
+      else
+      {
+         Snap->FanPwmCmd[i] = 0;
+         Snap->FanRpm[i]    = 0;
+      }
+   }
+
+} /* End Snapshot() */
@@ -0,0 +1,106 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Define the shared memory telemetry export class
+**
+**  Notes:
+**    1. The rig manager owns one SHM_EXPORT object that publishes each
+**       rig's controller snapshot and recent cycle history in a POSIX
+**       shared memory segment. Local dashboards map the segment read-only
+**       and poll it without going through SB and the telemetry output app.
+**       The segment layout is defined in tbl_sat_shm.h.
+**    2. The segment is created by the main task during initialization and
+**       each rig's slot is only written by the rig's worker, so every slot
+**       has a single writer and the sequence lock needs no mutex.
+**    3. An empty SHM_EXPORT_NAME disables the export. A segment that can't
+**       be created is reported and the app runs without it.
+**
+*/
+
+#ifndef _shm_export_
+#define _shm_export_
+
+/*
+** Includes
+*/
+
+#include "app_cfg.h"
+#include "sat_ctrl.h"
+#include "tbl_sat_shm.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+/*
+** Event Message IDs
+*/
+
+#define SHM_EXPORT_CONSTRUCTOR_EID  (SHM_EXPORT_BASE_EID + 0)
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+
+/******************************************************************************
+** SHM_EXPORT_Class
+*/
+
+typedef struct
+{
+
+   bool    Enabled;
+   char    Name[OS_MAX_API_NAME];
+
+   TBL_SAT_SHM_Segment_t *Segment;
+
+} SHM_EXPORT_Class_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: SHM_EXPORT_Constructor
+**
+** Create and initialize the shared memory segment.
+**
+** Notes:
+**   1. This must be called prior to any other function and before the
+**      worker tasks are created.
+**   2. An existing segment with the same name is reused and cleared so
+**      readers that mapped it before an app restart keep a valid mapping.
+**
+*/
+void SHM_EXPORT_Constructor(SHM_EXPORT_Class_t *ShmExport, const char *Name, uint8 RigCnt);
+
+
+/******************************************************************************
+** Function: SHM_EXPORT_Publish
+**
+** Update a rig's snapshot and append a history entry. Called by the rig's
+** worker after each control cycle.
+**
+*/
+void SHM_EXPORT_Publish(SHM_EXPORT_Class_t *ShmExport, uint8 Rig,
+                        const SAT_CTRL_Class_t *SatCtrl, uint64 NowMs);
+
+
+#endif /* _shm_export_ */
@@ -0,0 +1,235 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Implement the software-in-the-loop hardware simulation
+**
+**  Notes:
+**    1. See sim_hw.h for details.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+#include "io_reg.h"
+#include "sim_hw.h"
+
+
+/************************************/
+/** Local File Function Prototypes **/
+/************************************/
+
+static uint16 FanOutput(const FAN_Class_t *Fan, uint8 FanIdx);
+static void   SendSensorTlm(SIM_HW_Class_t *SimHw, CFE_SB_MsgId_t SensorMid);
+
+
+/******************************************************************************
+** Function: SIM_HW_Constructor
+**
+*/
+void SIM_HW_Constructor(SIM_HW_Class_t *SimHw, INITBL_Class_t *IniTbl, uint8 RigCnt)
+{
+
+#ifdef TBL_SAT_SIM_HW
+   SIM_PLANT_Param_t PlantParam;
+   uint32 Rig;
+#endif
+
+   memset(SimHw, 0, sizeof(SIM_HW_Class_t));
+
+#ifdef TBL_SAT_SIM_HW
+
+   Rig = INITBL_GetIntConfig(IniTbl, CFG_SIM_RIG);
+   SimHw->StepMs         = INITBL_GetIntConfig(IniTbl, CFG_SIM_STEP);
+   SimHw->SensorPeriodMs = INITBL_GetIntConfig(IniTbl, CFG_SIM_SENSOR_PERIOD);
+   SimHw->RealDelayMs    = INITBL_GetIntConfig(IniTbl, CFG_SIM_REAL_DELAY);
+
+   if (Rig >= RigCnt || SimHw->StepMs == 0 || SimHw->SensorPeriodMs == 0 ||
+       (SimHw->SensorPeriodMs % 1000) != 0)
+   {
+      CFE_EVS_SendEvent (SIM_HW_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                         "Simulation disabled, invalid configuration. Rig %d must be less than %d, step %d ms must be non-zero and sensor period %d ms must be a non-zero multiple of 1000",
+                         (int)Rig, RigCnt, (int)SimHw->StepMs, (int)SimHw->SensorPeriodMs);
+      return;
+   }
+
+   SimHw->Rig          = (uint8)Rig;
+   SimHw->NextSensorMs = SimHw->SensorPeriodMs;
+
+   SIM_PLANT_DefaultParam(&PlantParam);
+   SIM_PLANT_Constructor(&SimHw->Plant, &PlantParam, 0.0, 0.0, INITBL_GetIntConfig(IniTbl, CFG_SIM_SEED));
+
+   SimHw->Enabled = true;
+
+   CFE_EVS_SendEvent (SIM_HW_CONSTRUCTOR_EID, CFE_EVS_EventType_INFORMATION,
+                      "Simulating rig %d: %d ms steps, %d ms sensor period, %d ms real delay per step",
+                      SimHw->Rig, (int)SimHw->StepMs, (int)SimHw->SensorPeriodMs, (int)SimHw->RealDelayMs);
+
+#endif
+
+} /* End SIM_HW_Constructor() */
+
+
+/******************************************************************************
+** Function: SIM_HW_NowMs
+**
+*/
+uint64 SIM_HW_NowMs(const SIM_HW_Class_t *SimHw)
+{
+
+   return __atomic_load_n(&SimHw->NowMs, __ATOMIC_ACQUIRE);
+
+} /* End SIM_HW_NowMs() */
+
+
+/******************************************************************************
+** Function: SIM_HW_Step
+**
+** Notes:
+**   1. The fan outputs are held for the whole step, matching the rig's
+**      outputs only changing when its worker executes it.
+**
+*/
+void SIM_HW_Step(SIM_HW_Class_t *SimHw, const FAN_Class_t *Fan, CFE_SB_MsgId_t SensorMid)
+{
+
+   uint64 NowMs = SimHw->NowMs;
+   uint32 Ms;
+   uint8  i;
+
+   if (!SimHw->Enabled) return;
+
+   memset(SimHw->FanPwm, 0, sizeof(SimHw->FanPwm));
+   SimHw->Plant.Param.FanCnt = (Fan->FanCnt < SIM_PLANT_MAX_FAN) ? Fan->FanCnt : SIM_PLANT_MAX_FAN;
+   for (i=0; i < SimHw->Plant.Param.FanCnt; i++)
+   {
+      SimHw->FanPwm[i] = FanOutput(Fan, i);
+   }
+
+   for (Ms=0; Ms < SimHw->StepMs; Ms += SIM_HW_PLANT_STEP_MS)
+   {
+      SIM_PLANT_Step(&SimHw->Plant, SimHw->FanPwm, SIM_HW_PLANT_STEP_MS / 1000.0);
+   }
+
+   NowMs += SimHw->StepMs;
+   __atomic_store_n(&SimHw->NowMs, NowMs, __ATOMIC_RELEASE);
+
+   if (NowMs >= SimHw->NextSensorMs)
+   {
+      SendSensorTlm(SimHw, SensorMid);
+      SimHw->NextSensorMs += SimHw->SensorPeriodMs;
+   }
+
+} /* End SIM_HW_Step() */
+
+
+/******************************************************************************
+** Function: FanOutput
+**
+** Return a fan's output duty cycle in FAN_MAX_PWM units.
+**
+** Notes:
+**   1. Hardware PWM fans read the registers the app wrote so the simulation
+**      sees exactly what the PWM peripheral would output.
+**
+*/
+static uint16 FanOutput(const FAN_Class_t *Fan, uint8 FanIdx)
+{
+
+   const FAN_Struct_t *Actuator = &Fan->Actuator[FanIdx];
+   volatile uint32 *PwmBank;
+   uint32 Data, Range;
+
+   if (Fan->PwmMapped && Actuator->PwmChannel != FAN_SOFT_PWM_CHANNEL)
+   {
+      PwmBank = IO_REG_PwmBank();
+      if (Actuator->PwmChannel == PWM_CHANNEL0)
+      {
+         Data  = PwmBank[IO_REG_PWM_DAT1];
+         Range = PwmBank[IO_REG_PWM_RNG1];
+      }
+      else
+      {
+         Data  = PwmBank[IO_REG_PWM_DAT2];
+         Range = PwmBank[IO_REG_PWM_RNG2];
+      }
+   }
+   else
+   {
+      Data  = Actuator->PwmOutput;
+      Range = Fan->PwmRange;
+   }
+
+   if (Range == 0)
+   {
+      return 0;
+   }
+   if (Data > Range)
+   {
+      Data = Range;
+   }
+
+   return (uint16)((Data * FAN_MAX_PWM + Range/2) / Range);
+
+} /* End FanOutput() */
+
+
+/******************************************************************************
+** Function: SendSensorTlm
+**
+** Notes:
+**   1. Every field is sampled so the message is marked fully fresh, the
+**      same as a schema 1 MQTT message.
+**   2. Only the first transmit error is reported with an event.
+**
+*/
+static void SendSensorTlm(SIM_HW_Class_t *SimHw, CFE_SB_MsgId_t SensorMid)
+{
+
+   MQTT_GW_TblSatSensorTlm_Payload_t *Payload = &SimHw->SensorTlm.Payload;
+   SIM_PLANT_Sensor_t Sensor;
+   int32 Status;
+
+   SIM_PLANT_ReadSensors(&SimHw->Plant, &Sensor);
+
+   CFE_MSG_Init(CFE_MSG_PTR(SimHw->SensorTlm.TelemetryHeader), SensorMid, sizeof(MQTT_GW_TblSatSensorTlm_t));
+
+   Payload->DeltaTime = SimHw->SensorPeriodMs / 1000;
+   Payload->RateX     = Sensor.Rate[0];
+   Payload->RateY     = Sensor.Rate[1];
+   Payload->RateZ     = Sensor.Rate[2];
+   Payload->LuxA      = Sensor.Lux[0];
+   Payload->LuxB      = Sensor.Lux[1];
+   Payload->FreshMask = (MQTT_GW_TblSatSensorFresh_DELTA_TIME | MQTT_GW_TblSatSensorFresh_RATE_X |
+                         MQTT_GW_TblSatSensorFresh_RATE_Y | MQTT_GW_TblSatSensorFresh_RATE_Z |
+                         MQTT_GW_TblSatSensorFresh_LUX_A | MQTT_GW_TblSatSensorFresh_LUX_B);
+
+   CFE_SB_TimeStampMsg(CFE_MSG_PTR(SimHw->SensorTlm.TelemetryHeader));
+   Status = CFE_SB_TransmitMsg(CFE_MSG_PTR(SimHw->SensorTlm.TelemetryHeader), true);
+
+   if (Status == CFE_SUCCESS)
+   {
+      SimHw->SensorTlmCnt++;
+   }
+   else if (++SimHw->SensorTlmErrCnt == 1)
+   {
+      CFE_EVS_SendEvent (SIM_HW_SENSOR_TLM_EID, CFE_EVS_EventType_ERROR,
+                         "Simulated sensor message transmit failed. Status = 0x%08X",
+                         (unsigned int)Status);
+   }
+
+} /* End SendSensorTlm() */
@@ -0,0 +1,140 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Define the software-in-the-loop hardware simulation
+**
+**  Notes:
+**    1. The simulation is only enabled when the app is built with
+**       TBL_SAT_SIM_HW, see io_reg.h. It replaces a Raspberry Pi, its PWM
+**       hardware and the Python sensor stack so the app can run end to end
+**       on a development host.
+**    2. One rig, selected by the ini file's SIM_RIG, drives a SIM_PLANT
+**       model. Fans on a hardware PWM channel are read from the simulated
+**       register bank's DAT and RNG registers. Software PWM fans use the
+**       duty the software PWM task would output.
+**    3. The simulation runs in lockstep on a virtual clock. Each step of the
+**       simulated rig's worker advances the plant SIM_STEP milliseconds,
+**       publishes an MQTT_GW_TblSatSensorTlm_t message on the rig's sensor
+**       topic every SIM_SENSOR_PERIOD milliseconds, executes the worker's
+**       rigs at the new virtual time and then sleeps SIM_REAL_DELAY real
+**       milliseconds. Only the simulated rig's worker uses the virtual
+**       clock, workers without the simulated rig keep real time.
+**    4. The sensor message DeltaTime field is whole seconds so
+**       SIM_SENSOR_PERIOD must be a multiple of 1000.
+**    5. PWM FIFO playback and tach feedback aren't simulated.
+**
+*/
+
+#ifndef _sim_hw_
+#define _sim_hw_
+
+/*
+** Includes
+*/
+
+#include "app_cfg.h"
+#include "mqtt_gw_eds_typedefs.h"
+#include "fan.h"
+#include "sim_plant.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define SIM_HW_PLANT_STEP_MS  1
+
+/*
+** Event Message IDs
+*/
+
+#define SIM_HW_CONSTRUCTOR_EID  (SIM_HW_BASE_EID + 0)
+#define SIM_HW_SENSOR_TLM_EID   (SIM_HW_BASE_EID + 1)
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+
+/******************************************************************************
+** SIM_HW_Class
+*/
+
+typedef struct
+{
+
+   bool    Enabled;
+   uint8   Rig;
+   uint32  StepMs;
+   uint32  SensorPeriodMs;
+   uint32  RealDelayMs;
+
+   uint64  NowMs;            /* Atomic, virtual clock */
+   uint64  NextSensorMs;
+   uint32  SensorTlmCnt;
+   uint32  SensorTlmErrCnt;
+   uint16  FanPwm[SIM_PLANT_MAX_FAN];  /* Last plant inputs in FAN_MAX_PWM units */
+
+   SIM_PLANT_Class_t  Plant;
+
+   MQTT_GW_TblSatSensorTlm_t  SensorTlm;
+
+} SIM_HW_Class_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: SIM_HW_Constructor
+**
+** Configure the simulation from the ini file. RigCnt is the number of rigs
+** defined so SIM_RIG can be validated.
+**
+** Notes:
+**   1. This must be called prior to any other function.
+**   2. The simulation stays disabled unless the app is built with
+**      TBL_SAT_SIM_HW.
+**
+*/
+void SIM_HW_Constructor(SIM_HW_Class_t *SimHw, INITBL_Class_t *IniTbl, uint8 RigCnt);
+
+
+/******************************************************************************
+** Function: SIM_HW_NowMs
+**
+** Return the virtual clock in milliseconds.
+*/
+uint64 SIM_HW_NowMs(const SIM_HW_Class_t *SimHw);
+
+
+/******************************************************************************
+** Function: SIM_HW_Step
+**
+** Advance the plant one simulation step using the simulated rig's current
+** fan outputs and publish a sensor message on SensorMid when one is due.
+**
+** Notes:
+**   1. Must be called by the simulated rig's worker before it reads its
+**      pipe so the sensor message is processed in the same step.
+**
+*/
+void SIM_HW_Step(SIM_HW_Class_t *SimHw, const FAN_Class_t *Fan, CFE_SB_MsgId_t SensorMid);
+
+
+#endif /* _sim_hw_ */
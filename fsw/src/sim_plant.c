@@ -0,0 +1,261 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Implement the Table Sat plant model
+**
+**  Notes:
+**    1. See sim_plant.h for details.
+**    2. Fan thrust uses the exact first order lag solution and the table
+**       uses semi-implicit Euler so a few millisecond step is stable.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+#include <math.h>
+#include "sim_plant.h"
+
+#define DEG_2_RAD  0.017453292519943295
+#define RAD_2_DEG  57.29577951326093
+
+
+/************************************/
+/** Local File Function Prototypes **/
+/************************************/
+
+static double WrapAngle(double Angle);
+
+
+/******************************************************************************
+** Function: SIM_PLANT_Constructor
+**
+** Notes:
+**   1. The seed is scrambled with splitmix64 so consecutive seeds give
+**      independent streams and a zero seed is valid.
+**
+*/
+void SIM_PLANT_Constructor(SIM_PLANT_Class_t *Plant, const SIM_PLANT_Param_t *Param,
+                           double Angle, double Rate, uint64 Seed)
+{
+
+   uint64 Z = Seed + 0x9E3779B97F4A7C15ULL;
+
+   memset(Plant, 0, sizeof(SIM_PLANT_Class_t));
+
+   Plant->Param = *Param;
+   Plant->Angle = fmod(fmod(Angle, 360.0) + 360.0, 360.0);
+   Plant->Rate  = Rate;
+
+   Z = (Z ^ (Z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+   Z = (Z ^ (Z >> 27)) * 0x94D049BB133111EBULL;
+   Plant->Rng = (Z ^ (Z >> 31)) | 1;
+
+} /* End SIM_PLANT_Constructor() */
+
+
+/******************************************************************************
+** Function: SIM_PLANT_DefaultParam
+**
+** Notes:
+**   1. The fan arm signs match the flight survey: a negative torque-Z effort
+**      turns fan B on and the gyro reads a positive rate.
+**
+*/
+void SIM_PLANT_DefaultParam(SIM_PLANT_Param_t *Param)
+{
+
+   memset(Param, 0, sizeof(SIM_PLANT_Param_t));
+
+   Param->Inertia         = 0.05;
+   Param->ViscousFriction = 0.01;
+   Param->CoulombFriction = 0.0005;
+
+   Param->FanCnt       = 2;
+   Param->FanMaxThrust = 0.5;
+   Param->FanTimeConst = 0.3;
+   Param->FanArm[0]    = -0.15;
+   Param->FanArm[1]    =  0.15;
+
+   Param->SunAngle      = 180.0;
+   Param->LuxExponent   = 2.0;
+   Param->LuxPeak[0]    = 800.0;
+   Param->LuxPeak[1]    = 400.0;
+   Param->LuxAmbient[0] = 40.0;
+   Param->LuxAmbient[1] = 20.0;
+
+   Param->GyroNoise = 0.002;
+   Param->GyroBias  = 0.0;
+   Param->LuxNoise  = 0.02;
+
+} /* End SIM_PLANT_DefaultParam() */
+
+
+/******************************************************************************
+** Function: SIM_PLANT_Gauss
+**
+** Notes:
+**   1. Box-Muller, one of the pair is discarded to keep the state small.
+**
+*/
+double SIM_PLANT_Gauss(SIM_PLANT_Class_t *Plant)
+{
+
+   double U1 = SIM_PLANT_Uniform(Plant);
+   double U2 = SIM_PLANT_Uniform(Plant);
+
+   return sqrt(-2.0 * log(1.0 - U1)) * cos(2.0 * M_PI * U2);
+
+} /* End SIM_PLANT_Gauss() */
+
+
+/******************************************************************************
+** Function: SIM_PLANT_PointingErr
+**
+*/
+double SIM_PLANT_PointingErr(const SIM_PLANT_Class_t *Plant)
+{
+
+   return WrapAngle(Plant->Param.SunAngle - Plant->Angle);
+
+} /* End SIM_PLANT_PointingErr() */
+
+
+/******************************************************************************
+** Function: SIM_PLANT_ReadSensors
+**
+*/
+void SIM_PLANT_ReadSensors(SIM_PLANT_Class_t *Plant, SIM_PLANT_Sensor_t *Sensor)
+{
+
+   const SIM_PLANT_Param_t *Param = &Plant->Param;
+   double CosErr = cos(SIM_PLANT_PointingErr(Plant) * DEG_2_RAD);
+   double Lux;
+   uint8  i;
+
+   Sensor->Rate[0] = (float)(Param->GyroNoise * SIM_PLANT_Gauss(Plant));
+   Sensor->Rate[1] = (float)(Param->GyroNoise * SIM_PLANT_Gauss(Plant));
+   Sensor->Rate[2] = (float)(Plant->Rate + Param->GyroBias + Param->GyroNoise * SIM_PLANT_Gauss(Plant));
+
+   for (i=0; i < SIM_PLANT_LUX_CNT; i++)
+   {
+      Lux = Param->LuxAmbient[i];
+      if (CosErr > 0.0)
+      {
+         Lux += Param->LuxPeak[i] * pow(CosErr, Param->LuxExponent);
+      }
+      Lux *= 1.0 + Param->LuxNoise * SIM_PLANT_Gauss(Plant);
+      Sensor->Lux[i] = (Lux > 0.0) ? (uint32)lround(Lux) : 0;
+   }
+
+} /* End SIM_PLANT_ReadSensors() */
+
+
+/******************************************************************************
+** Function: SIM_PLANT_Step
+**
+** Notes:
+**   1. Coulomb friction holds a stopped table until the fan torque exceeds
+**      it and can't reverse the table within a step.
+**
+*/
+void SIM_PLANT_Step(SIM_PLANT_Class_t *Plant, const uint16 *FanPwm, double Dt)
+{
+
+   const SIM_PLANT_Param_t *Param = &Plant->Param;
+   double Lag = exp(-Dt / Param->FanTimeConst);
+   double FanTorque = 0.0;
+   double Torque, NewRate;
+   uint8  i;
+
+   for (i=0; i < Param->FanCnt && i < SIM_PLANT_MAX_FAN; i++)
+   {
+      Plant->Thrust[i] = Param->FanMaxThrust * ((double)FanPwm[i] / SIM_PLANT_PWM_MAX) +
+                         (Plant->Thrust[i] - Param->FanMaxThrust * ((double)FanPwm[i] / SIM_PLANT_PWM_MAX)) * Lag;
+      FanTorque += Param->FanArm[i] * Plant->Thrust[i];
+   }
+
+   if (Plant->Rate == 0.0 && fabs(FanTorque) <= Param->CoulombFriction)
+   {
+      NewRate = 0.0;
+   }
+   else
+   {
+      Torque = FanTorque - Param->ViscousFriction * Plant->Rate;
+      if (Plant->Rate != 0.0)
+      {
+         Torque -= copysign(Param->CoulombFriction, Plant->Rate);
+      }
+      else
+      {
+         Torque -= copysign(Param->CoulombFriction, FanTorque);
+      }
+      NewRate = Plant->Rate + Torque / Param->Inertia * Dt;
+      if (Plant->Rate != 0.0 && (NewRate * Plant->Rate) < 0.0 &&
+          fabs(FanTorque) <= Param->CoulombFriction)
+      {
+         NewRate = 0.0;
+      }
+   }
+
+   Plant->Rate   = NewRate;
+   Plant->Angle  = fmod(Plant->Angle + Plant->Rate * RAD_2_DEG * Dt + 360.0, 360.0);
+   Plant->Time  += Dt;
+
+} /* End SIM_PLANT_Step() */
+
+
+/******************************************************************************
+** Function: SIM_PLANT_Uniform
+**
+** Notes:
+**   1. xorshift64* using the top 53 bits.
+**
+*/
+double SIM_PLANT_Uniform(SIM_PLANT_Class_t *Plant)
+{
+
+   Plant->Rng ^= Plant->Rng >> 12;
+   Plant->Rng ^= Plant->Rng << 25;
+   Plant->Rng ^= Plant->Rng >> 27;
+
+   return (double)((Plant->Rng * 0x2545F4914F6CDD1DULL) >> 11) * (1.0 / 9007199254740992.0);
+
+} /* End SIM_PLANT_Uniform() */
+
+
+/******************************************************************************
+** Function: WrapAngle
+**
+** Wrap an angle in degrees to (-180,180].
+*/
+static double WrapAngle(double Angle)
+{
+
+   Angle = fmod(Angle, 360.0);
+   if (Angle > 180.0)
+   {
+      Angle -= 360.0;
+   }
+   else if (Angle <= -180.0)
+   {
+      Angle += 360.0;
+   }
+
+   return Angle;
+
+} /* End WrapAngle() */
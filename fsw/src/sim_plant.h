@@ -0,0 +1,181 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Define the Table Sat plant model
+**
+**  Notes:
+**    1. This module doesn't use cFE or app_c_fw services so it can be built
+**       into host tools, see tools/sim.
+**    2. The table rotates about Z. Each fan produces a thrust proportional
+**       to its PWM command through a first order spin up lag and applies a
+**       torque with its own sign and moment arm. Bearing friction has a
+**       viscous and a Coulomb term.
+**    3. The light source is at SunAngle in the table's rotation frame. Each
+**       lux sensor sees Peak*cos(err)^Exponent plus Ambient, where err is
+**       the table's pointing error, and nothing beyond 90 degrees.
+**    4. Sensor noise is Gaussian from a per-object random number generator
+**       so results only depend on the seed.
+**
+*/
+
+#ifndef _sim_plant_
+#define _sim_plant_
+
+/*
+** Includes
+*/
+
+#include "common_types.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define SIM_PLANT_MAX_FAN   8   /* Must match FAN_TBL_MAX_FAN */
+#define SIM_PLANT_PWM_MAX   2047.0  /* Must match FAN_MAX_PWM */
+#define SIM_PLANT_LUX_CNT   2
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+
+/******************************************************************************
+** Model parameters
+*/
+
+typedef struct
+{
+
+   double  Inertia;          /* kg*m^2 about Z */
+   double  ViscousFriction;  /* N*m*s/rad */
+   double  CoulombFriction;  /* N*m */
+
+   uint8   FanCnt;
+   double  FanMaxThrust;     /* Newtons at SIM_PLANT_PWM_MAX */
+   double  FanTimeConst;     /* Seconds */
+   double  FanArm[SIM_PLANT_MAX_FAN];  /* Signed moment arm in meters */
+
+   double  SunAngle;         /* Degrees */
+   double  LuxExponent;
+   double  LuxPeak[SIM_PLANT_LUX_CNT];
+   double  LuxAmbient[SIM_PLANT_LUX_CNT];
+
+   double  GyroNoise;        /* 1 sigma, rad/s */
+   double  GyroBias;         /* rad/s */
+   double  LuxNoise;         /* 1 sigma, fraction of the reading */
+
+} SIM_PLANT_Param_t;
+
+
+/******************************************************************************
+** Sensor readings in the units of the tablesat/sensors MQTT payload
+*/
+
+typedef struct
+{
+
+   float   Rate[3];          /* rad/s */
+   uint32  Lux[SIM_PLANT_LUX_CNT];
+
+} SIM_PLANT_Sensor_t;
+
+
+/******************************************************************************
+** SIM_PLANT_Class
+*/
+
+typedef struct
+{
+
+   SIM_PLANT_Param_t  Param;
+
+   double  Time;             /* Seconds */
+   double  Angle;            /* Degrees in [0,360) */
+   double  Rate;             /* rad/s */
+   double  Thrust[SIM_PLANT_MAX_FAN];
+
+   uint64  Rng;
+
+} SIM_PLANT_Class_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: SIM_PLANT_Constructor
+**
+** Initialize a plant at rest with the fans off. Angle is in degrees and
+** Rate in rad/s.
+*/
+void SIM_PLANT_Constructor(SIM_PLANT_Class_t *Plant, const SIM_PLANT_Param_t *Param,
+                           double Angle, double Rate, uint64 Seed);
+
+
+/******************************************************************************
+** Function: SIM_PLANT_DefaultParam
+**
+** Load parameters that approximate the Table Sat kit with two opposed fans.
+*/
+void SIM_PLANT_DefaultParam(SIM_PLANT_Param_t *Param);
+
+
+/******************************************************************************
+** Function: SIM_PLANT_Gauss
+**
+** Return a zero mean, unit variance sample from the plant's generator.
+*/
+double SIM_PLANT_Gauss(SIM_PLANT_Class_t *Plant);
+
+
+/******************************************************************************
+** Function: SIM_PLANT_PointingErr
+**
+** Return the angle from the table to the light source in (-180,180] degrees.
+*/
+double SIM_PLANT_PointingErr(const SIM_PLANT_Class_t *Plant);
+
+
+/******************************************************************************
+** Function: SIM_PLANT_ReadSensors
+**
+** Sample the gyro and lux sensors including noise.
+*/
+void SIM_PLANT_ReadSensors(SIM_PLANT_Class_t *Plant, SIM_PLANT_Sensor_t *Sensor);
+
+
+/******************************************************************************
+** Function: SIM_PLANT_Step
+**
+** Advance the plant Dt seconds holding each fan's PWM command, in
+** 0..SIM_PLANT_PWM_MAX, constant.
+*/
+void SIM_PLANT_Step(SIM_PLANT_Class_t *Plant, const uint16 *FanPwm, double Dt);
+
+
+/******************************************************************************
+** Function: SIM_PLANT_Uniform
+**
+** Return a sample in [0,1) from the plant's generator.
+*/
+double SIM_PLANT_Uniform(SIM_PLANT_Class_t *Plant);
+
+
+#endif /* _sim_plant_ */
@@ -0,0 +1,184 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Implement the time optimal Z axis slew generator
+**
+**  Notes:
+**    1. See slew.h for details.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+#include <math.h>
+#include "slew.h"
+
+
+/******************************************************************************
+** Function: SLEW_Init
+**
+*/
+void SLEW_Init(SLEW_Class_t *Slew)
+{
+
+   memset(Slew, 0, sizeof(SLEW_Class_t));
+
+   Slew->Phase = SLEW_PHASE_IDLE;
+
+} /* End SLEW_Init() */
+
+
+/******************************************************************************
+** Function: SLEW_AddSample
+**
+*/
+void SLEW_AddSample(SLEW_Class_t *Slew, double Rate, double DeltaTime)
+{
+
+   SLEW_Fit_t *Fit = &Slew->Fit;
+   double X, Y;
+
+   if (Fit->PrevValid && DeltaTime > 0.0)
+   {
+      X = 0.5*(Rate + Fit->PrevRate);
+      Y = (Rate - Fit->PrevRate)/DeltaTime;
+      Fit->Cnt++;
+      Fit->X  += X;
+      Fit->Y  += Y;
+      Fit->XX += X*X;
+      Fit->XY += X*Y;
+   }
+
+   Fit->PrevRate  = Rate;
+   Fit->PrevValid = true;
+
+} /* End SLEW_AddSample() */
+
+
+/******************************************************************************
+** Function: SLEW_FitModel
+**
+** Notes:
+**   1. A friction that fits negative is noise on a survey that barely
+**      left its steady rate and is taken as zero.
+**
+*/
+bool SLEW_FitModel(SLEW_Class_t *Slew, float SurveyPwm)
+{
+
+   const SLEW_Fit_t *Fit = &Slew->Fit;
+   double MeanX, MeanY, VarX, Friction;
+
+   Slew->ModelValid = false;
+
+   if (Fit->Cnt < SLEW_MIN_FIT_CNT || !(SurveyPwm > 0.0))
+   {
+      return false;
+   }
+
+   MeanX = Fit->X/Fit->Cnt;
+   MeanY = Fit->Y/Fit->Cnt;
+   VarX  = Fit->XX/Fit->Cnt - MeanX*MeanX;
+
+   if (VarX < SLEW_MIN_RATE_STD*SLEW_MIN_RATE_STD)
+   {
+      return false;
+   }
+
+   Friction = -(Fit->XY/Fit->Cnt - MeanX*MeanY)/VarX;
+   if (Friction < 0.0)
+   {
+      Friction = 0.0;
+   }
+
+   Slew->Friction = Friction;
+   Slew->Accel    = (MeanY + Friction*MeanX)/SurveyPwm;
+   Slew->ModelValid = (Slew->Accel > 0.0);
+
+   return Slew->ModelValid;
+
+} /* End SLEW_FitModel() */
+
+
+/******************************************************************************
+** Function: SLEW_Step
+**
+** Notes:
+**   1. Speed and Target are towards the target. Target is the rate that
+**      travels one step and then brakes to a stop at the target.
+**
+*/
+float SLEW_Step(SLEW_Class_t *Slew, const SLEW_Param_t *Param,
+                double PosErr, double Rate, double DeltaTime)
+{
+
+   double Dir   = (PosErr > 0.0) ? -1.0 : 1.0;
+   double Dist  = fabs(PosErr);
+   double Speed = Dir*Rate;
+   double Brake = Slew->Accel*Param->FanPwm;
+   double Lead  = Brake*DeltaTime;
+   double Target, Pwm;
+   bool   Coast = false;
+
+   Target = sqrt(Lead*Lead + 2.0*Brake*Dist) - Lead;
+   if (Target >= Param->MaxRate)
+   {
+      Target = Param->MaxRate;
+      Coast  = true;
+   }
+
+   if (DeltaTime > 0.0)
+   {
+      Pwm = (Slew->Friction*Target + (Target - Speed)/DeltaTime)/Slew->Accel;
+   }
+   else
+   {
+      Pwm = (Target > Speed) ? Param->FanPwm : -Param->FanPwm;
+   }
+   Pwm = fmax(fmin(Pwm, Param->FanPwm), -Param->FanPwm);
+
+   if (Pwm < 0.0 || (!Coast && Speed > Target))
+   {
+      Slew->Phase = SLEW_PHASE_BRAKE;
+   }
+   else if (Coast && Pwm < Param->FanPwm)
+   {
+      Slew->Phase = SLEW_PHASE_COAST;
+   }
+   else
+   {
+      Slew->Phase = SLEW_PHASE_ACCEL;
+   }
+   Slew->TargetRate = Dir*Target;
+
+   return (float)(Dir*Pwm);
+
+} /* End SLEW_Step() */
+
+
+/******************************************************************************
+** Function: SLEW_ValidParam
+**
+*/
+bool SLEW_ValidParam(const SLEW_Param_t *Param)
+{
+
+   return (Param->FanPwm > 0 && Param->MaxRate > 0.0 &&
+           Param->PosTol > 0.0 && Param->RateTol > 0.0);
+
+} /* End SLEW_ValidParam() */
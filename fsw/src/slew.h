@@ -0,0 +1,176 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Define the time optimal Z axis slew generator
+**
+**  Notes:
+**    1. The survey's constant fan effort measures the table's response.
+**       Each survey step's rate change is fitted to dRate/dt = A - K*Rate
+**       where A is the acceleration the survey PWM produces from rest and
+**       K is the viscous friction. A divided by the survey PWM is the
+**       acceleration per PWM count, the fans are assumed to be matched
+**       so it's also the braking acceleration of the opposite fan. The
+**       fit is rejected if the survey's rates don't spread at least
+**       SLEW_MIN_RATE_STD.
+**    2. A slew is bang-coast-bang. The fans accelerate at FanPwm towards
+**       the target, coast at MaxRate with the PWM that balances the
+**       friction and brake at FanPwm. The braking starts when the rate
+**       reaches the largest rate that can still stop at the target, which
+**       includes one step of travel for the command's delay. Each step
+**       commands the PWM that moves the rate to that profile and limits
+**       it to FanPwm, so far from the target the command saturates.
+**    3. Braking ignores friction's help so a slew stops at or short of
+**       the target. SUN_ACQ doesn't run the slew to the target, it takes
+**       over the end game once the remaining distance can be closed at
+**       the survey PWM, see sun_acq.c.
+**    4. Like SUN_ACQ this module doesn't use cFE or app_c_fw services so
+**       it can be built into host tools. Rates are in degrees/sec.
+**
+*/
+
+#ifndef _slew_
+#define _slew_
+
+/*
+** Includes
+*/
+
+#include "common_types.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+/* Phases, must match the EDS SlewPhase definition */
+#define SLEW_PHASE_IDLE   1
+#define SLEW_PHASE_ACCEL  2
+#define SLEW_PHASE_COAST  3
+#define SLEW_PHASE_BRAKE  4
+
+#define SLEW_MIN_FIT_CNT   10     /* Survey steps needed to fit the response */
+#define SLEW_MIN_RATE_STD  0.5    /* Degrees/sec */
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+
+/******************************************************************************
+** Table parameters, see sat_ctrl_tbl.h
+*/
+
+typedef struct
+{
+
+   uint16  FanPwm;     /* Largest accelerate and brake PWM */
+   float   MaxRate;    /* Coast rate, degrees/sec */
+   float   PosTol;     /* Hold hand over position error, degrees */
+   float   RateTol;    /* Hold hand over rate, degrees/sec */
+
+} SLEW_Param_t;
+
+
+/******************************************************************************
+** Survey response least squares sums. X is a step's mean rate and Y its
+** rate change per second.
+*/
+
+typedef struct
+{
+
+   uint32  Cnt;
+   bool    PrevValid;
+   double  PrevRate;
+   double  X;
+   double  Y;
+   double  XX;
+   double  XY;
+
+} SLEW_Fit_t;
+
+
+/******************************************************************************
+** SLEW_Class
+*/
+
+typedef struct
+{
+
+   SLEW_Fit_t  Fit;
+
+   bool    ModelValid;
+   double  Accel;       /* Degrees/sec^2 per PWM count */
+   double  Friction;    /* 1/sec */
+
+   uint8   Phase;
+   double  TargetRate;  /* Profile rate towards the target, degrees/sec */
+
+} SLEW_Class_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: SLEW_Init
+**
+** Start a new response fit with no model.
+*/
+void SLEW_Init(SLEW_Class_t *Slew);
+
+
+/******************************************************************************
+** Function: SLEW_AddSample
+**
+** Add a survey step's rate and the seconds since the previous step to the
+** response fit.
+*/
+void SLEW_AddSample(SLEW_Class_t *Slew, double Rate, double DeltaTime);
+
+
+/******************************************************************************
+** Function: SLEW_FitModel
+**
+** Fit the response to the samples added with the survey's SurveyPwm.
+** Returns true if the model is valid.
+*/
+bool SLEW_FitModel(SLEW_Class_t *Slew, float SurveyPwm);
+
+
+/******************************************************************************
+** Function: SLEW_Step
+**
+** Return the signed PWM that turns the table towards the target, positive
+** increases the rotation. PosErr is the rotation minus the target in
+** degrees, Rate is the current rate and DeltaTime the seconds between
+** steps. Requires a valid model.
+*/
+float SLEW_Step(SLEW_Class_t *Slew, const SLEW_Param_t *Param,
+                double PosErr, double Rate, double DeltaTime);
+
+
+/******************************************************************************
+** Function: SLEW_ValidParam
+**
+** Return true if the PWM, rate and tolerances are greater than 0.
+*/
+bool SLEW_ValidParam(const SLEW_Param_t *Param);
+
+
+#endif /* _slew_ */
@@ -0,0 +1,156 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Implement the statistical summary telemetry class
+**
+**  Notes:
+**    1. See stat_sum.h for details.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <math.h>
+#include <string.h>
+#include "stat_sum.h"
+
+
+/************************************/
+/** Local File Function Prototypes **/
+/************************************/
+
+static void Report(TBL_SAT_StatSummary_t *Summary, const STAT_SUM_Accum_t *Accum);
+
+
+/******************************************************************************
+** Function: STAT_SUM_Constructor
+**
+*/
+void STAT_SUM_Constructor(STAT_SUM_Class_t *StatSum, uint8 RigIdx, uint32 PeriodMs,
+                          CFE_SB_MsgId_t StatsTlmMid)
+{
+
+   memset(StatSum, 0, sizeof(STAT_SUM_Class_t));
+
+   StatSum->PeriodMs = PeriodMs;
+
+   CFE_MSG_Init(CFE_MSG_PTR(StatSum->StatsTlm.TelemetryHeader), StatsTlmMid, sizeof(TBL_SAT_StatsTlm_t));
+   StatSum->StatsTlm.Payload.RigIdx = RigIdx;
+
+} /* End STAT_SUM_Constructor() */
+
+
+/******************************************************************************
+** Function: STAT_SUM_Send
+**
+** Notes:
+**   1. The next interval starts where the last one should have ended so the
+**      summaries don't drift with the worker's wakeup jitter. If the worker
+**      fell more than one interval behind the next interval starts now.
+**
+*/
+bool STAT_SUM_Send(STAT_SUM_Class_t *StatSum, uint64 NowMs)
+{
+
+   TBL_SAT_StatsTlm_Payload_t *Payload = &StatSum->StatsTlm.Payload;
+
+   if (StatSum->IntervalStartMs == 0)
+   {
+      StatSum->IntervalStartMs = NowMs;
+      return false;
+   }
+
+   if ((NowMs - StatSum->IntervalStartMs) < StatSum->PeriodMs)
+   {
+      return false;
+   }
+
+   Payload->IntervalMs = (uint32)(NowMs - StatSum->IntervalStartMs);
+   Report(&Payload->RawRateX,   &StatSum->Accum[STAT_SUM_CHAN_RATE_X]);
+   Report(&Payload->RawRateY,   &StatSum->Accum[STAT_SUM_CHAN_RATE_Y]);
+   Report(&Payload->RawRateZ,   &StatSum->Accum[STAT_SUM_CHAN_RATE_Z]);
+   Report(&Payload->TotalLight, &StatSum->Accum[STAT_SUM_CHAN_TOTAL_LIGHT]);
+   Report(&Payload->FanAPwmCmd, &StatSum->Accum[STAT_SUM_CHAN_FAN_A_PWM]);
+   Report(&Payload->FanBPwmCmd, &StatSum->Accum[STAT_SUM_CHAN_FAN_B_PWM]);
+
+   CFE_SB_TimeStampMsg(CFE_MSG_PTR(StatSum->StatsTlm.TelemetryHeader));
+   CFE_SB_TransmitMsg(CFE_MSG_PTR(StatSum->StatsTlm.TelemetryHeader), true);
+
+   memset(StatSum->Accum, 0, sizeof(StatSum->Accum));
+   StatSum->IntervalStartMs += StatSum->PeriodMs;
+   if ((NowMs - StatSum->IntervalStartMs) >= StatSum->PeriodMs)
+   {
+      StatSum->IntervalStartMs = NowMs;
+   }
+
+   return true;
+
+} /* End STAT_SUM_Send() */
+
+
+/******************************************************************************
+** Function: STAT_SUM_Update
+**
+*/
+void STAT_SUM_Update(STAT_SUM_Class_t *StatSum, STAT_SUM_Chan_t Chan, float X)
+{
+
+   STAT_SUM_Accum_t *Accum = &StatSum->Accum[Chan];
+   double Delta;
+
+   if (Accum->Count == 0)
+   {
+      Accum->Min = X;
+      Accum->Max = X;
+   }
+   else if (X < Accum->Min)
+   {
+      Accum->Min = X;
+   }
+   else if (X > Accum->Max)
+   {
+      Accum->Max = X;
+   }
+
+   Accum->Count++;
+   Delta        = X - Accum->Mean;
+   Accum->Mean += Delta / Accum->Count;
+   Accum->M2   += Delta * (X - Accum->Mean);
+
+} /* End STAT_SUM_Update() */
+
+
+/******************************************************************************
+** Function: Report
+**
+** Copy an accumulator to its telemetry summary. The variance is the sample
+** variance and is zero for an interval with less than two samples.
+*/
+static void Report(TBL_SAT_StatSummary_t *Summary, const STAT_SUM_Accum_t *Accum)
+{
+
+   double Variance = (Accum->Count > 1) ? Accum->M2 / (Accum->Count - 1) : 0.0;
+
+   Summary->Count      = Accum->Count;
+   Summary->Min        = Accum->Min;
+   Summary->Max        = Accum->Max;
+   Summary->Mean       = (float)Accum->Mean;
+   Summary->Variance   = (float)Variance;
+   Summary->StdDev     = (float)sqrt(Variance);
+   Summary->PeakToPeak = Accum->Max - Accum->Min;
+
+} /* End Report() */
@@ -0,0 +1,146 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Define the statistical summary telemetry class
+**
+**  Notes:
+**    1. Each rig owns one STAT_SUM object that accumulates the count, min,
+**       max, mean and variance of the rig's raw rates, total light and fan
+**       commands over a summary interval. Every sample is included so the
+**       summary isn't aliased like StatusTlm's instantaneous values.
+**    2. The mean and variance are accumulated with Welford's update which
+**       is numerically stable and only needs the running mean and sum of
+**       squared deviations, so an interval of any length costs a fixed
+**       amount of memory.
+**    3. The object is only accessed by the rig's worker. The worker sends
+**       the rig's StatsTlm packet and resets the accumulators at the end of
+**       each interval so no data is shared with the main task.
+**
+*/
+
+#ifndef _stat_sum_
+#define _stat_sum_
+
+/*
+** Includes
+*/
+
+#include "app_cfg.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+/*
+** Summarized signals
+*/
+typedef enum
+{
+
+   STAT_SUM_CHAN_RATE_X      = 0,
+   STAT_SUM_CHAN_RATE_Y      = 1,
+   STAT_SUM_CHAN_RATE_Z      = 2,
+   STAT_SUM_CHAN_TOTAL_LIGHT = 3,
+   STAT_SUM_CHAN_FAN_A_PWM   = 4,
+   STAT_SUM_CHAN_FAN_B_PWM   = 5,
+   STAT_SUM_CHAN_CNT         = 6
+
+} STAT_SUM_Chan_t;
+
+
+/******************************************************************************
+** Welford accumulator
+*/
+
+typedef struct
+{
+
+   uint32  Count;
+   float   Min;
+   float   Max;
+   double  Mean;
+   double  M2;     /* Sum of squared deviations from the mean */
+
+} STAT_SUM_Accum_t;
+
+
+/******************************************************************************
+** STAT_SUM_Class
+*/
+
+typedef struct
+{
+
+   /*
+   ** Class State Data
+   */
+
+   uint32  PeriodMs;
+   uint64  IntervalStartMs;   /* Zero until the first interval starts */
+
+   STAT_SUM_Accum_t  Accum[STAT_SUM_CHAN_CNT];
+
+   /*
+   ** Telemetry Packets
+   */
+
+   TBL_SAT_StatsTlm_t  StatsTlm;
+
+} STAT_SUM_Class_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: STAT_SUM_Constructor
+**
+** Initialize a rig's statistical summary to an empty interval.
+**
+** Notes:
+**   1. This must be called prior to any other function.
+**
+*/
+void STAT_SUM_Constructor(STAT_SUM_Class_t *StatSum, uint8 RigIdx, uint32 PeriodMs,
+                          CFE_SB_MsgId_t StatsTlmMid);
+
+
+/******************************************************************************
+** Function: STAT_SUM_Send
+**
+** Send the StatsTlm packet and start a new interval when PeriodMs has
+** elapsed since the current interval started. Returns true if a packet was
+** sent.
+*/
+bool STAT_SUM_Send(STAT_SUM_Class_t *StatSum, uint64 NowMs);
+
+
+/******************************************************************************
+** Function: STAT_SUM_Update
+**
+** Add a sample to a channel's accumulator for the current interval.
+*/
+void STAT_SUM_Update(STAT_SUM_Class_t *StatSum, STAT_SUM_Chan_t Chan, float X);
+
+
+#endif /* _stat_sum_ */
@@ -0,0 +1,247 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Implement the sun acquisition control law
+**
+**  Notes:
+**    1. See sun_acq.h for details.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+#include <math.h>
+#include "sun_acq.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define PROFILE_BIN_WIDTH  (SUN_ACQ_SURVEY_ROTATION / SUN_ACQ_PROFILE_BINS)
+
+
+/************************************/
+/** Local File Function Prototypes **/
+/************************************/
+
+static double LocateSource(const SUN_ACQ_Class_t *SunAcq);
+static void   PosCtrl(SUN_ACQ_Class_t *SunAcq, const SUN_ACQ_Param_t *Param, double SpinRate);
+
+
+/******************************************************************************
+** Function: SUN_ACQ_Init
+**
+*/
+void SUN_ACQ_Init(SUN_ACQ_Class_t *SunAcq)
+{
+
+   memset(SunAcq, 0, sizeof(SUN_ACQ_Class_t));
+
+   SunAcq->State          = SUN_ACQ_STATE_SURVEY;
+   SunAcq->LightIntensity = SUN_ACQ_LIGHT_UNDEF;
+
+   SLEW_Init(&SunAcq->Slew);
+
+} /* End SUN_ACQ_Init() */
+
+
+/******************************************************************************
+** Function: SUN_ACQ_ProfileValid
+**
+*/
+bool SUN_ACQ_ProfileValid(const SUN_ACQ_Class_t *SunAcq)
+{
+
+   uint16 Bin;
+
+   if (SunAcq->State != SUN_ACQ_STATE_ACQUIRE && SunAcq->State != SUN_ACQ_STATE_HOLD)
+   {
+      return false;
+   }
+
+   for (Bin=0; Bin < SUN_ACQ_PROFILE_BINS; Bin++)
+   {
+      if (SunAcq->ProfileCnt[Bin] == 0)
+      {
+         return false;
+      }
+   }
+
+   return true;
+
+} /* End SUN_ACQ_ProfileValid() */
+
+
+/******************************************************************************
+** Function: SUN_ACQ_Step
+**
+** Notes:
+**   1. A survey that turns backwards doesn't add to the profile.
+**   2. The survey effort turns the table in the direction of increasing
+**      rotation so a negative effort increases the rotation.
+**   3. The end game switches the survey's PWM on the sign of the rate
+**      error rather than scaling the effort, a proportional effort stalls
+**      in the fans' friction short of the source. The target rate slope is
+**      RateTol/PosTol so the table arrives inside both hold tolerances.
+**      EndGameDist is where the target rate reaches MaxRate. The slew's
+**      full PWM braking isn't used that close to the source because the
+**      fans' lag and the command latency keep braking the table after
+**      hold stops the effort.
+**
+*/
+bool SUN_ACQ_Step(SUN_ACQ_Class_t *SunAcq, const SUN_ACQ_Param_t *Param,
+                  uint32 TotalLight, double SpinRate, double AngleDelta,
+                  double DeltaTime)
+{
+
+   bool   RetStatus = true;
+   bool   InTol;
+   double TargetRate;
+   double EndGameDist = Param->Slew.MaxRate * Param->Slew.PosTol / Param->Slew.RateTol;
+   uint16 Bin;
+
+   SunAcq->Rotation += AngleDelta;
+
+   switch (SunAcq->State)
+   {
+      case SUN_ACQ_STATE_SURVEY:
+          SunAcq->Effort[SUN_ACQ_AXIS_TORQUE_Z] = -Param->SurveyFanPwm;
+          SunAcq->SurveyRotation += AngleDelta;
+          if (SunAcq->SurveyRotation < SUN_ACQ_SURVEY_ROTATION)
+          {
+             SLEW_AddSample(&SunAcq->Slew, SpinRate, DeltaTime);
+             if (TotalLight > SunAcq->SurveyMaxLight)
+             {
+                SunAcq->SurveyMaxLight = TotalLight;
+                SunAcq->SurveyMaxLightAngle = SunAcq->SurveyRotation;
+             }
+             if (SunAcq->SurveyRotation >= 0.0)
+             {
+                Bin = (uint16)(SunAcq->SurveyRotation / PROFILE_BIN_WIDTH);
+                if (SunAcq->ProfileCnt[Bin] < 0xFFFF)
+                {
+                   SunAcq->ProfileCnt[Bin]++;
+                }
+                SunAcq->ProfileLight[Bin] += ((float)TotalLight - SunAcq->ProfileLight[Bin]) / SunAcq->ProfileCnt[Bin];
+             }
+          }
+          else
+          {
+             SunAcq->State = SUN_ACQ_STATE_ACQUIRE;
+             SunAcq->SourceAngle = LocateSource(SunAcq);
+             SLEW_FitModel(&SunAcq->Slew, Param->SurveyFanPwm);
+          }
+          break;
+      case SUN_ACQ_STATE_ACQUIRE:
+          PosCtrl(SunAcq, Param, SpinRate);
+          InTol = (fabs(SunAcq->PosErr) < Param->Slew.PosTol) && (fabs(SpinRate) < Param->Slew.RateTol);
+          if (InTol)
+          {
+             SunAcq->State = SUN_ACQ_STATE_HOLD;
+             SunAcq->Slew.Phase = SLEW_PHASE_IDLE;
+             SunAcq->Effort[SUN_ACQ_AXIS_TORQUE_Z] = 0.0;
+          }
+          else if (SunAcq->Slew.ModelValid && fabs(SunAcq->PosErr) > EndGameDist)
+          {
+             SunAcq->Effort[SUN_ACQ_AXIS_TORQUE_Z] = -SLEW_Step(&SunAcq->Slew, &Param->Slew, SunAcq->PosErr,
+                                                                SpinRate, DeltaTime);
+          }
+          else
+          {
+             if (SunAcq->Slew.ModelValid)
+             {
+                SunAcq->Slew.Phase = SLEW_PHASE_BRAKE;
+             }
+             TargetRate = fmax(fmin(-SunAcq->PosErr * Param->Slew.RateTol / Param->Slew.PosTol,
+                                    Param->Slew.MaxRate), -Param->Slew.MaxRate);
+             SunAcq->Effort[SUN_ACQ_AXIS_TORQUE_Z] = (float)copysign(Param->SurveyFanPwm, SpinRate - TargetRate);
+          }
+          break;
+      case SUN_ACQ_STATE_HOLD:
+          PosCtrl(SunAcq, Param, SpinRate);
+          SunAcq->Effort[SUN_ACQ_AXIS_TORQUE_Z] = 0.0;
+          break;
+      default:
+          RetStatus = false;
+   }
+
+   return RetStatus;
+
+} /* End SUN_ACQ_Step() */
+
+
+/******************************************************************************
+** Function: LocateSource
+**
+** Return the source angle in survey rotation degrees.
+**
+** Notes:
+**   1. The peak of the parabola through the brightest bin's center and its
+**      neighbors' centers is limited to the brightest bin. The neighbors
+**      wrap around the revolution.
+**
+*/
+static double LocateSource(const SUN_ACQ_Class_t *SunAcq)
+{
+
+   double Prev, Peak, Next, Curve;
+   double Offset = 0.0;
+   uint16 Bin, Max = 0;
+
+   for (Bin=0; Bin < SUN_ACQ_PROFILE_BINS; Bin++)
+   {
+      if (SunAcq->ProfileCnt[Bin] == 0)
+      {
+         return SunAcq->SurveyMaxLightAngle;
+      }
+      if (SunAcq->ProfileLight[Bin] > SunAcq->ProfileLight[Max])
+      {
+         Max = Bin;
+      }
+   }
+
+   Prev  = SunAcq->ProfileLight[(Max + SUN_ACQ_PROFILE_BINS - 1) % SUN_ACQ_PROFILE_BINS];
+   Peak  = SunAcq->ProfileLight[Max];
+   Next  = SunAcq->ProfileLight[(Max + 1) % SUN_ACQ_PROFILE_BINS];
+   Curve = Prev - 2.0*Peak + Next;
+
+   if (Curve < 0.0)
+   {
+      Offset = fmax(fmin(0.5*(Prev - Next)/Curve, 0.5), -0.5);
+   }
+
+   return (Max + 0.5 + Offset) * PROFILE_BIN_WIDTH;
+
+} /* End LocateSource() */
+
+
+/******************************************************************************
+** Function: PosCtrl
+**
+** Compute the position and rate errors and the control output.
+**
+*/
+static void PosCtrl(SUN_ACQ_Class_t *SunAcq, const SUN_ACQ_Param_t *Param, double SpinRate)
+{
+
+   SunAcq->PosErr  = remainder(SunAcq->Rotation - SunAcq->SourceAngle, SUN_ACQ_SURVEY_ROTATION);
+   SunAcq->RateErr = SpinRate;
+   SunAcq->Ctrl    = SunAcq->RateErr * Param->RateGain + SunAcq->PosErr * Param->PosGain;
+
+} /* End PosCtrl() */
@@ -0,0 +1,170 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Define the sun acquisition control law
+**
+**  Notes:
+**    1. This module doesn't use cFE or app_c_fw services so the flight
+**       control law can be built into host tools, see tools/sim. SAT_CTRL
+**       owns one object per rig and handles events, sensor messages and
+**       fan commands.
+**    2. The survey rotates the table one revolution while recording a
+**       light profile, the mean light in each of SUN_ACQ_PROFILE_BINS equal
+**       angle bins. When the survey completes the source angle is located
+**       by fitting a parabola through the brightest bin and its two
+**       neighbors. Acquire slews the shortest way to the source angle and
+**       hold starts once the position error and rate are within the slew
+**       tolerances. Hold stops the fan effort.
+**    3. Once the survey completes the profile is also the attitude
+**       estimator's light measurement model, see att_est.h.
+**    4. Rotation accumulates every step's AngleDelta since the acquisition
+**       started. The position error is Rotation's distance from the source
+**       angle, wrapped to +/-180 degrees. SAT_CTRL passes the estimator's
+**       angle change as AngleDelta so the error follows the filtered angle
+**       rather than single rate samples.
+**    5. A survey that leaves a profile bin empty falls back to the angle
+**       of the single brightest sample.
+**    6. The survey also measures the table's response to the fans for the
+**       acquire slew, see slew.h. The slew ends where the table can
+**       follow a target rate that falls linearly from the slew's maximum
+**       rate to the hold rate tolerance at the position tolerance, and
+**       the acquire switches the survey PWM to follow it. If the response
+**       can't be fitted the whole acquire follows that target rate.
+**
+*/
+
+#ifndef _sun_acq_
+#define _sun_acq_
+
+/*
+** Includes
+*/
+
+#include "common_types.h"
+#include "slew.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+/* States, must match the EDS SunAcqState definition */
+#define SUN_ACQ_STATE_UNDEF    1
+#define SUN_ACQ_STATE_SURVEY   2
+#define SUN_ACQ_STATE_ACQUIRE  3
+#define SUN_ACQ_STATE_HOLD     4
+
+/* Effort axes, must match FAN_TBL_AXIS_* */
+#define SUN_ACQ_AXIS_TORQUE_Z  0
+#define SUN_ACQ_AXIS_CNT       3
+
+#define SUN_ACQ_SURVEY_ROTATION  360.0  /* Degrees */
+#define SUN_ACQ_PROFILE_BINS     36     /* Light profile bins per revolution */
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+
+typedef enum
+{
+   SUN_ACQ_LIGHT_UNDEF      = 1,
+   SUN_ACQ_LIGHT_INCREASING = 2,
+   SUN_ACQ_LIGHT_DECREASING = 3
+
+} SUN_ACQ_LightIntensity_t;
+
+
+/******************************************************************************
+** Control parameters, see sat_ctrl_tbl.h
+*/
+
+typedef struct
+{
+
+   float  SurveyFanPwm;
+   float  PosGain;
+   float  RateGain;
+   SLEW_Param_t  Slew;
+
+} SUN_ACQ_Param_t;
+
+
+/******************************************************************************
+** SUN_ACQ_Class
+*/
+
+typedef struct
+{
+
+   uint8   State;
+   double  PosErr;
+   double  RateErr;
+   double  Ctrl;
+   float   Effort[SUN_ACQ_AXIS_CNT];
+   uint32  SurveyMaxLight;
+   double  SurveyMaxLightAngle;  /* SurveyRotation when SurveyMaxLight was measured */
+   double  SurveyRotation;
+   double  Rotation;             /* Since SUN_ACQ_Init() */
+   double  SourceAngle;          /* Interpolated profile peak in survey rotation degrees */
+   SUN_ACQ_LightIntensity_t  LightIntensity;
+   float   ProfileLight[SUN_ACQ_PROFILE_BINS];   /* Mean light at each bin's center */
+   uint16  ProfileCnt[SUN_ACQ_PROFILE_BINS];     /* Samples averaged in each bin */
+   SLEW_Class_t  Slew;
+
+} SUN_ACQ_Class_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: SUN_ACQ_Init
+**
+** Start a new sun acquisition with a survey.
+*/
+void SUN_ACQ_Init(SUN_ACQ_Class_t *SunAcq);
+
+
+/******************************************************************************
+** Function: SUN_ACQ_ProfileValid
+**
+** Return true if the survey is complete and every profile bin has a
+** sample.
+*/
+bool SUN_ACQ_ProfileValid(const SUN_ACQ_Class_t *SunAcq);
+
+
+/******************************************************************************
+** Function: SUN_ACQ_Step
+**
+** Run one control step using new sensor data. SpinRate is in degrees/sec,
+** AngleDelta is the rotation in degrees and DeltaTime the seconds since
+** the previous step. The step's fan effort is in SunAcq->Effort.
+**
+** Notes:
+**   1. Returns false if the state is invalid. The caller should reinitialize
+**      the acquisition.
+**
+*/
+bool SUN_ACQ_Step(SUN_ACQ_Class_t *SunAcq, const SUN_ACQ_Param_t *Param,
+                  uint32 TotalLight, double SpinRate, double AngleDelta,
+                  double DeltaTime);
+
+
+#endif /* _sun_acq_ */
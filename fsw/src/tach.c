@@ -0,0 +1,629 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Implement the fan tachometer capture class
+**
+**  Notes:
+**    1. See tach.h for details.
+**    2. The GPIO character device source requires the Linux GPIO v2 uAPI
+**       (kernel 5.10 or later).
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+#include "tach.h"
+#include "mem_mon.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define TACH_TASK_NAME    "TBL_SAT_TACH"
+#define TACH_STACK_SIZE   8192
+
+#define READ_EDGE_MAX       32
+#define READ_TIMEOUT_MS    100
+#define READ_ERR_DELAY_MS  1000
+
+#define GPIO_CONSUMER_NAME  "tbl_sat_tach"
+
+
+/************************************/
+/** Local File Function Prototypes **/
+/************************************/
+
+static uint64 NowNs(void);
+static void   TachTask(void);
+
+static bool   GpioCdevOpen(const char *Device, const uint8 *BcmId, uint8 LineCnt);
+static int32  GpioCdevRead(TACH_Edge_t *Edge, uint32 MaxEdges, uint32 TimeoutMs);
+static void   GpioCdevClose(void);
+
+static bool   SyntheticOpen(const char *Device, const uint8 *BcmId, uint8 LineCnt);
+static int32  SyntheticRead(TACH_Edge_t *Edge, uint32 MaxEdges, uint32 TimeoutMs);
+static void   SyntheticClose(void);
+
+
+/**********************/
+/** Global File Data **/
+/**********************/
+
+static TACH_Class_t *Tach = NULL;
+
+static const TACH_EdgeSource_t GpioCdevSource =
+{
+   TACH_SOURCE_GPIO_CDEV, GpioCdevOpen, GpioCdevRead, GpioCdevClose
+};
+
+static const TACH_EdgeSource_t SyntheticSource =
+{
+   TACH_SOURCE_SYNTHETIC, SyntheticOpen, SyntheticRead, SyntheticClose
+};
+
+/*
+** GPIO character device source state
+*/
+
+static int    GpioLineFd = -1;
+static uint8  GpioLineCnt;
+static uint32 GpioOffset[TACH_MAX_LINE];
+
+/*
+** Synthetic source state
+*/
+
+static uint8  SynthLineCnt;
+static uint64 SynthNextEdgeNs[TACH_MAX_LINE];
+static uint64 SynthPeriodNs[TACH_MAX_LINE];
+static uint32 SynthSeqNo[TACH_MAX_LINE];
+
+
+/******************************************************************************
+** Function: TACH_Constructor
+**
+*/
+void TACH_Constructor(TACH_Class_t *TachPtr, INITBL_Class_t *IniTbl)
+{
+
+   const char *SourceName = INITBL_GetStrConfig(IniTbl, CFG_FAN_TACH_SOURCE);
+
+   Tach = TachPtr;
+
+   memset(Tach, 0, sizeof(TACH_Class_t));
+
+   Tach->PulsePerRev = INITBL_GetIntConfig(IniTbl, CFG_FAN_TACH_PULSE_PER_REV);
+
+   if (Tach->PulsePerRev == 0)
+   {
+      CFE_EVS_SendEvent (TACH_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                         "Invalid tach pulses per revolution of 0, using 2");
+      Tach->PulsePerRev = 2;
+   }
+
+   if (strcmp(SourceName, TACH_SOURCE_GPIO_CDEV) == 0)
+   {
+      Tach->Source = &GpioCdevSource;
+   }
+   else if (strcmp(SourceName, TACH_SOURCE_SYNTHETIC) == 0)
+   {
+      Tach->Source = &SyntheticSource;
+   }
+   else
+   {
+      CFE_EVS_SendEvent (TACH_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                         "Invalid tach source '%s'. Must be '%s' or '%s'",
+                         SourceName, TACH_SOURCE_GPIO_CDEV, TACH_SOURCE_SYNTHETIC);
+   }
+
+} /* End TACH_Constructor() */
+
+
+/******************************************************************************
+** Function: TACH_AddLines
+**
+*/
+uint8 TACH_AddLines(const uint8 *BcmId, uint8 LineCnt)
+{
+
+   uint8 FirstLine = Tach->LineCnt;
+   uint8 i;
+
+   if (Tach->TaskCreated || (FirstLine + LineCnt) > TACH_MAX_LINE)
+   {
+      CFE_EVS_SendEvent (TACH_ADD_LINES_EID, CFE_EVS_EventType_ERROR,
+                         "Can't add %d tach lines to the %d existing lines. Lines must be added before capture starts and the total must be <= %d",
+                         LineCnt, FirstLine, TACH_MAX_LINE);
+      return TACH_MAX_LINE;
+   }
+
+   for (i=0; i < LineCnt; i++)
+   {
+      Tach->BcmId[FirstLine + i] = BcmId[i];
+   }
+   Tach->LineCnt += LineCnt;
+
+   return FirstLine;
+
+} /* End TACH_AddLines() */
+
+
+/******************************************************************************
+** Function: TACH_GetLine
+**
+*/
+const TACH_Line_t *TACH_GetLine(uint8 Line)
+{
+
+   return &Tach->Line[Line];
+
+} /* End TACH_GetLine() */
+
+
+/******************************************************************************
+** Function: TACH_ResetStatus
+**
+*/
+void TACH_ResetStatus(void)
+{
+
+   __atomic_store_n(&Tach->DroppedEdgeCnt, 0, __ATOMIC_RELAXED);
+   __atomic_store_n(&Tach->SourceErrCnt,   0, __ATOMIC_RELAXED);
+
+} /* End TACH_ResetStatus() */
+
+
+/******************************************************************************
+** Function: TACH_SetSyntheticRpm
+**
+*/
+void TACH_SetSyntheticRpm(uint8 Line, float Rpm)
+{
+
+   if (Line < TACH_MAX_LINE)
+   {
+      __atomic_store(&Tach->Line[Line].SyntheticRpm, &Rpm, __ATOMIC_RELAXED);
+   }
+
+} /* End TACH_SetSyntheticRpm() */
+
+
+/******************************************************************************
+** Function: TACH_Start
+**
+** Notes:
+**   1. The capture task isn't created if the source can't be opened. The
+**      fans still run and report zero RPM.
+**
+*/
+void TACH_Start(INITBL_Class_t *IniTbl)
+{
+
+   const char *Device = INITBL_GetStrConfig(IniTbl, CFG_FAN_TACH_DEVICE);
+   int32 CfeStatus;
+
+   if (Tach->Source == NULL || Tach->LineCnt == 0)
+   {
+      return;
+   }
+
+   if (Tach->Source->Open(Device, Tach->BcmId, Tach->LineCnt))
+   {
+
+      CfeStatus = CFE_ES_CreateChildTask(&Tach->TaskId, TACH_TASK_NAME, TachTask,
+                                         CFE_ES_TASK_STACK_ALLOCATE, TACH_STACK_SIZE,
+                                         INITBL_GetIntConfig(IniTbl, CFG_FAN_TACH_PRIORITY), 0);
+
+      Tach->TaskCreated = (CfeStatus == CFE_SUCCESS);
+
+      if (Tach->TaskCreated)
+      {
+         CFE_EVS_SendEvent (TACH_CONSTRUCTOR_EID, CFE_EVS_EventType_INFORMATION,
+                            "Tach capture started for %d fans using the %s source with %d pulses per revolution",
+                            Tach->LineCnt, Tach->Source->Name, Tach->PulsePerRev);
+      }
+      else
+      {
+         Tach->Source->Close();
+         CFE_EVS_SendEvent (TACH_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                            "Tach child task creation failed. Status = 0x%08X",
+                            (unsigned int)CfeStatus);
+      }
+
+   }
+   else
+   {
+      CFE_EVS_SendEvent (TACH_CONSTRUCTOR_EID, CFE_EVS_EventType_ERROR,
+                         "Tach %s source open failed for device %s: %s",
+                         Tach->Source->Name, Device, strerror(errno));
+   }
+
+} /* End TACH_Start() */
+
+
+/******************************************************************************
+** Function: TACH_Update
+**
+** Notes:
+**   1. The edge count is loaded with acquire semantics to pair with the
+**      capture task's release so the period and edge time are at least as
+**      recent as the count.
+**
+*/
+void TACH_Update(uint8 FirstLine, uint8 LineCnt)
+{
+
+   uint8   i;
+   uint64  Now = NowNs();
+   uint64  DeltaNs;
+   uint32  EdgeCnt, PeriodNs;
+   uint64  LastEdgeNs;
+   TACH_Line_t *Line;
+
+   for (i=FirstLine; i < (FirstLine + LineCnt) && i < Tach->LineCnt; i++)
+   {
+
+      Line = &Tach->Line[i];
+
+      EdgeCnt    = __atomic_load_n(&Line->EdgeCnt,    __ATOMIC_ACQUIRE);
+      PeriodNs   = __atomic_load_n(&Line->PeriodNs,   __ATOMIC_RELAXED);
+      LastEdgeNs = __atomic_load_n(&Line->LastEdgeNs, __ATOMIC_RELAXED);
+
+      DeltaNs = Now - Line->PrevUpdateNs;
+      if (Line->PrevUpdateNs != 0 && DeltaNs > 0)
+      {
+         Line->PulsePerSec = (float)(EdgeCnt - Line->PrevEdgeCnt) * 1.0e9f / (float)DeltaNs;
+      }
+      Line->PrevEdgeCnt  = EdgeCnt;
+      Line->PrevUpdateNs = Now;
+
+      if (PeriodNs != 0 && (LastEdgeNs + TACH_STALE_TIME_NS) > Now)
+      {
+         Line->PeriodUsec = (float)PeriodNs / 1000.0f;
+         Line->Rpm        = 60.0e9f / ((float)PeriodNs * (float)Tach->PulsePerRev);
+      }
+      else
+      {
+         Line->PeriodUsec = 0.0;
+         Line->Rpm        = 0.0;
+      }
+
+   } /* End line loop */
+
+} /* End TACH_Update() */
+
+
+/******************************************************************************
+** Function: NowNs
+**
+** Return CLOCK_MONOTONIC in nanoseconds, the same clock used for the GPIO
+** line event timestamps.
+*/
+static uint64 NowNs(void)
+{
+
+   struct timespec Now;
+
+   clock_gettime(CLOCK_MONOTONIC, &Now);
+
+   return ((uint64)Now.tv_sec * 1000000000ULL + (uint64)Now.tv_nsec);
+
+} /* End NowNs() */
+
+
+/******************************************************************************
+** Function: TachTask
+**
+** Read edges from the source and update the line counters.
+**
+** Notes:
+**   1. A gap in a line's sequence numbers means the source dropped edges.
+**      The dropped edges are still added to the edge count because they
+**      occurred, but the period isn't updated since it would span more
+**      than one pulse.
+**   2. Only the first source error is reported with an event to prevent
+**      flooding. The error counter captures the rest.
+**
+*/
+static void TachTask(void)
+{
+
+   TACH_Edge_t  Edge[READ_EDGE_MAX];
+   TACH_Line_t  *Line;
+   int32   EdgeCnt, i;
+   uint32  Gap;
+   uint64  PeriodNs;
+
+   MEM_MON_PaintStack(TBL_SAT_MemTask_TACH, 0);
+
+   while (true)
+   {
+
+      EdgeCnt = Tach->Source->Read(Edge, READ_EDGE_MAX, READ_TIMEOUT_MS);
+
+      if (EdgeCnt < 0)
+      {
+         if (__atomic_add_fetch(&Tach->SourceErrCnt, 1, __ATOMIC_RELAXED) == 1)
+         {
+            CFE_EVS_SendEvent (TACH_SOURCE_EID, CFE_EVS_EventType_ERROR,
+                               "Tach %s source read failed: %s", Tach->Source->Name, strerror(errno));
+         }
+         OS_TaskDelay(READ_ERR_DELAY_MS);
+         continue;
+      }
+
+      for (i=0; i < EdgeCnt; i++)
+      {
+
+         Line = &Tach->Line[Edge[i].Line];
+
+         Gap = (Line->LastSeqNo == 0) ? 1 : (Edge[i].SeqNo - Line->LastSeqNo);
+         Line->LastSeqNo = Edge[i].SeqNo;
+
+         if (Gap > 1)
+         {
+            __atomic_add_fetch(&Tach->DroppedEdgeCnt, Gap - 1, __ATOMIC_RELAXED);
+         }
+         else if (Line->LastEdgeNs != 0)
+         {
+            PeriodNs = Edge[i].TimeNs - Line->LastEdgeNs;
+            __atomic_store_n(&Line->PeriodNs, (PeriodNs > 0xFFFFFFFFULL) ? 0xFFFFFFFF : (uint32)PeriodNs,
+                             __ATOMIC_RELAXED);
+         }
+
+         __atomic_store_n(&Line->LastEdgeNs, Edge[i].TimeNs, __ATOMIC_RELAXED);
+         __atomic_add_fetch(&Line->EdgeCnt, Gap, __ATOMIC_RELEASE);
+
+      } /* End edge loop */
+
+   } /* End task loop */
+
+} /* End TachTask() */
+
+
+/******************************************************************************
+** Function: GpioCdevOpen
+**
+** Request falling edge events for all tach lines with one GPIO v2 line
+** request.
+*/
+static bool GpioCdevOpen(const char *Device, const uint8 *BcmId, uint8 LineCnt)
+{
+
+   bool  RetStatus = false;
+   int   ChipFd;
+   uint8 i;
+   struct gpio_v2_line_request Request;
+
+   ChipFd = open(Device, O_RDONLY | O_CLOEXEC);
+
+   if (ChipFd >= 0)
+   {
+
+      memset(&Request, 0, sizeof(Request));
+
+      for (i=0; i < LineCnt; i++)
+      {
+         Request.offsets[i] = BcmId[i];
+         GpioOffset[i]      = BcmId[i];
+      }
+      GpioLineCnt = LineCnt;
+
+      Request.num_lines    = LineCnt;
+      Request.config.flags = GPIO_V2_LINE_FLAG_INPUT | GPIO_V2_LINE_FLAG_EDGE_FALLING |
+                             GPIO_V2_LINE_FLAG_BIAS_PULL_UP;
+      strncpy(Request.consumer, GPIO_CONSUMER_NAME, GPIO_MAX_NAME_SIZE-1);
+
+      if (ioctl(ChipFd, GPIO_V2_GET_LINE_IOCTL, &Request) >= 0)
+      {
+         GpioLineFd = Request.fd;
+         RetStatus  = true;
+      }
+
+      close(ChipFd);
+
+   }
+
+   return RetStatus;
+
+} /* End GpioCdevOpen() */
+
+
+/******************************************************************************
+** Function: GpioCdevRead
+**
+** Notes:
+**   1. All pending events are read with one read() call. The kernel
+**      buffers events between reads so none are lost unless its buffer
+**      overflows, which shows up as a sequence number gap.
+**
+*/
+static int32 GpioCdevRead(TACH_Edge_t *Edge, uint32 MaxEdges, uint32 TimeoutMs)
+{
+
+   struct gpio_v2_line_event Event[READ_EDGE_MAX];
+   struct pollfd PollFd;
+   int     PollStatus;
+   ssize_t ReadLen;
+   int32   EdgeCnt = 0;
+   uint32  i;
+   uint8   Line;
+
+   PollFd.fd      = GpioLineFd;
+   PollFd.events  = POLLIN;
+   PollFd.revents = 0;
+
+   PollStatus = poll(&PollFd, 1, (int)TimeoutMs);
+
+   if (PollStatus <= 0)
+   {
+      return (PollStatus == 0 || errno == EINTR) ? 0 : -1;
+   }
+
+   if (MaxEdges > READ_EDGE_MAX)
+   {
+      MaxEdges = READ_EDGE_MAX;
+   }
+
+   ReadLen = read(GpioLineFd, Event, MaxEdges * sizeof(Event[0]));
+
+   if (ReadLen < 0)
+   {
+      return (errno == EINTR || errno == EAGAIN) ? 0 : -1;
+   }
+
+   for (i=0; i < (uint32)ReadLen / sizeof(Event[0]); i++)
+   {
+      for (Line=0; Line < GpioLineCnt; Line++)
+      {
+         if (GpioOffset[Line] == Event[i].offset)
+         {
+            Edge[EdgeCnt].Line   = Line;
+            Edge[EdgeCnt].SeqNo  = Event[i].line_seqno;
+            Edge[EdgeCnt].TimeNs = Event[i].timestamp_ns;
+            EdgeCnt++;
+            break;
+         }
+      }
+   }
+
+   return EdgeCnt;
+
+} /* End GpioCdevRead() */
+
+
+/******************************************************************************
+** Function: GpioCdevClose
+**
+*/
+static void GpioCdevClose(void)
+{
+
+   if (GpioLineFd >= 0)
+   {
+      close(GpioLineFd);
+      GpioLineFd = -1;
+   }
+
+} /* End GpioCdevClose() */
+
+
+/******************************************************************************
+** Function: SyntheticOpen
+**
+*/
+static bool SyntheticOpen(const char *Device, const uint8 *BcmId, uint8 LineCnt)
+{
+
+   SynthLineCnt = LineCnt;
+
+   memset(SynthNextEdgeNs, 0, sizeof(SynthNextEdgeNs));
+   memset(SynthPeriodNs, 0, sizeof(SynthPeriodNs));
+   memset(SynthSeqNo, 0, sizeof(SynthSeqNo));
+
+   return true;
+
+} /* End SyntheticOpen() */
+
+
+/******************************************************************************
+** Function: SyntheticRead
+**
+** Sleep until the next synthetic edge, or the timeout, and return every edge
+** that is due.
+**
+** Notes:
+**   1. When a line's rate increases its next edge is pulled in so a change
+**      from a very low rate takes effect immediately.
+**
+*/
+static int32 SyntheticRead(TACH_Edge_t *Edge, uint32 MaxEdges, uint32 TimeoutMs)
+{
+
+   struct timespec WakeTime;
+   uint64 Now  = NowNs();
+   uint64 Wake = Now + (uint64)TimeoutMs * 1000000ULL;
+   int32  EdgeCnt = 0;
+   float  Rpm;
+   uint8  i;
+
+   for (i=0; i < SynthLineCnt; i++)
+   {
+
+      __atomic_load(&Tach->Line[i].SyntheticRpm, &Rpm, __ATOMIC_RELAXED);
+
+      if (Rpm > 0.0)
+      {
+         SynthPeriodNs[i] = (uint64)(60.0e9 / ((double)Rpm * Tach->PulsePerRev));
+         if (SynthNextEdgeNs[i] == 0 || SynthNextEdgeNs[i] > (Now + SynthPeriodNs[i]))
+         {
+            SynthNextEdgeNs[i] = Now + SynthPeriodNs[i];
+         }
+         if (SynthNextEdgeNs[i] < Wake)
+         {
+            Wake = SynthNextEdgeNs[i];
+         }
+      }
+      else
+      {
+         SynthNextEdgeNs[i] = 0;
+      }
+
+   } /* End line loop */
+
+   WakeTime.tv_sec  = Wake / 1000000000ULL;
+   WakeTime.tv_nsec = Wake % 1000000000ULL;
+   clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &WakeTime, NULL);
+
+   Now = NowNs();
+
+   for (i=0; i < SynthLineCnt; i++)
+   {
+      while (SynthNextEdgeNs[i] != 0 && SynthNextEdgeNs[i] <= Now && (uint32)EdgeCnt < MaxEdges)
+      {
+         Edge[EdgeCnt].Line   = i;
+         Edge[EdgeCnt].SeqNo  = ++SynthSeqNo[i];
+         Edge[EdgeCnt].TimeNs = SynthNextEdgeNs[i];
+         SynthNextEdgeNs[i]  += SynthPeriodNs[i];
+         EdgeCnt++;
+      }
+   }
+
+   return EdgeCnt;
+
+} /* End SyntheticRead() */
+
+
+/******************************************************************************
+** Function: SyntheticClose
+**
+*/
+static void SyntheticClose(void)
+{
+
+   SynthLineCnt = 0;
+
+} /* End SyntheticClose() */
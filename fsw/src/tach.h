@@ -0,0 +1,243 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Define the fan tachometer capture class
+**
+**  Notes:
+**    1. Use the Singleton design pattern. One capture task and one GPIO
+**       line request serve every rig. The object is owned by RIG_MGR and
+**       each FAN object adds its tach lines with TACH_AddLines() before
+**       TACH_Start() is called. A FAN object's lines are contiguous starting
+**       at the index returned by TACH_AddLines().
+**    2. A dedicated child task waits for tach edges from an edge source and
+**       updates each line's edge count, last edge time and last period
+**       using atomic stores. Control tasks read them with atomic loads in
+**       TACH_Update() so no task ever blocks on another. Each line is only
+**       updated by the control task that runs the line's rig.
+**    3. Edge sources are pluggable. The GPIO character device source
+**       requests falling edge events with kernel timestamps for all tach
+**       lines using one Linux GPIO v2 line request. The synthetic source
+**       generates edges from rates set by TACH_SetSyntheticRpm() so the
+**       measurement path can be exercised on a host without fans.
+**    4. The fan tach output is open collector so the GPIO source enables
+**       the internal pull-up. The Noctua NF-A4x10 produces two pulses per
+**       revolution.
+**    5. RPM is computed from the most recent edge-to-edge period so it
+**       responds within one pulse. PulsePerSec is the average over the
+**       line's last TACH_Update() interval. A line with no edge for
+**       TACH_STALE_TIME_NS reports zero RPM.
+**
+*/
+
+#ifndef _tach_
+#define _tach_
+
+/*
+** Includes
+*/
+
+#include "app_cfg.h"
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define TACH_MAX_LINE      16
+#define TACH_STALE_TIME_NS  1000000000ULL
+
+#define TACH_SOURCE_GPIO_CDEV  "gpio-cdev"
+#define TACH_SOURCE_SYNTHETIC  "synthetic"
+
+/*
+** Event Message IDs
+*/
+
+#define TACH_CONSTRUCTOR_EID  (TACH_BASE_EID + 0)
+#define TACH_SOURCE_EID       (TACH_BASE_EID + 1)
+#define TACH_ADD_LINES_EID    (TACH_BASE_EID + 2)
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+
+typedef struct
+{
+
+   uint8   Line;       /* Tach line index, not the BCM ID */
+   uint32  SeqNo;      /* Per line sequence number used to detect dropped edges */
+   uint64  TimeNs;     /* CLOCK_MONOTONIC */
+
+} TACH_Edge_t;
+
+
+/******************************************************************************
+** Edge source interface
+**
+** Read() waits up to TimeoutMs for edges and returns the number of edges
+** copied to Edge, zero on a timeout or a negative value on an error.
+*/
+
+typedef struct
+{
+
+   const char *Name;
+   bool   (*Open)(const char *Device, const uint8 *BcmId, uint8 LineCnt);
+   int32  (*Read)(TACH_Edge_t *Edge, uint32 MaxEdges, uint32 TimeoutMs);
+   void   (*Close)(void);
+
+} TACH_EdgeSource_t;
+
+
+typedef struct
+{
+
+   /*
+   ** Written by the tach task, read by the control task with atomics
+   */
+
+   uint32  EdgeCnt;
+   uint32  PeriodNs;
+   uint64  LastEdgeNs;
+
+   /*
+   ** Tach task only
+   */
+
+   uint32  LastSeqNo;
+
+   /*
+   ** Owning control task only
+   */
+
+   uint64  PrevUpdateNs;
+   uint32  PrevEdgeCnt;
+   float   Rpm;
+   float   PulsePerSec;
+   float   PeriodUsec;
+
+   /*
+   ** Synthetic source rate, written by any task
+   */
+
+   float   SyntheticRpm;
+
+} TACH_Line_t;
+
+
+/******************************************************************************
+** TACH_Class
+*/
+
+typedef struct
+{
+
+   /*
+   ** Class State Data
+   */
+
+   uint8   LineCnt;
+   uint16  PulsePerRev;
+   uint8   BcmId[TACH_MAX_LINE];
+   const TACH_EdgeSource_t *Source;
+
+   bool             TaskCreated;
+   CFE_ES_TaskId_t  TaskId;
+
+   uint32  DroppedEdgeCnt;    /* Atomic, edges the source reported as lost */
+   uint32  SourceErrCnt;      /* Atomic */
+
+   TACH_Line_t  Line[TACH_MAX_LINE];
+
+} TACH_Class_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: TACH_Constructor
+**
+** Initialize the tach object and select the edge source defined in the JSON
+** ini file.
+**
+** Notes:
+**   1. This must be called prior to any other function.
+**
+*/
+void TACH_Constructor(TACH_Class_t *TachPtr, INITBL_Class_t *IniTbl);
+
+
+/******************************************************************************
+** Function: TACH_AddLines
+**
+** Add LineCnt tach lines using the BcmId pins in fan order. Returns the index
+** of the first line or TACH_MAX_LINE if there isn't room for all of them.
+**
+** Notes:
+**   1. Must be called before TACH_Start().
+**
+*/
+uint8 TACH_AddLines(const uint8 *BcmId, uint8 LineCnt);
+
+
+/******************************************************************************
+** Function: TACH_GetLine
+**
+** Return a tach line. Line must be less than TACH_MAX_LINE.
+*/
+const TACH_Line_t *TACH_GetLine(uint8 Line);
+
+
+/******************************************************************************
+** Function: TACH_ResetStatus
+**
+** Reset counters and status flags to a known reset state.
+*/
+void TACH_ResetStatus(void);
+
+
+/******************************************************************************
+** Function: TACH_SetSyntheticRpm
+**
+** Set the rate of a line's synthetic tach edges. Has no effect on the GPIO
+** character device source.
+*/
+void TACH_SetSyntheticRpm(uint8 Line, float Rpm);
+
+
+/******************************************************************************
+** Function: TACH_Start
+**
+** Open the edge source for all of the added lines and create the capture
+** child task.
+*/
+void TACH_Start(INITBL_Class_t *IniTbl);
+
+
+/******************************************************************************
+** Function: TACH_Update
+**
+** Compute the RPM, pulse rate and period of LineCnt lines starting at
+** FirstLine from the counters written by the capture task. Call once per
+** control cycle from the task that owns the lines.
+*/
+void TACH_Update(uint8 FirstLine, uint8 LineCnt);
+
+
+#endif /* _tach_ */
@@ -36,8 +36,9 @@
 #define  INITBL_OBJ    (&(TblSat.IniTbl))
 #define  CMDMGR_OBJ    (&(TblSat.CmdMgr))
 #define  TBLMGR_OBJ    (&(TblSat.TblMgr))
-#define  CHILDMGR_OBJ  (&(TblSat.ChildMgr))
-#define  SAT_CTRL_OBJ  (&(TblSat.SatCtrl))
+#define  RT_PROFILE_OBJ (&(TblSat.RtProfile))
+#define  MEM_MON_OBJ   (&(TblSat.MemMon))
+#define  RIG_MGR_OBJ   (&(TblSat.RigMgr))
 
 
 /*******************************/
@@ -46,6 +47,7 @@
 
 static int32 InitApp(void);
 static int32 ProcessCommands(void);
+static void SendMemTlm(void);
 static void SendStatusTlm(void);
 
 
@@ -136,9 +138,8 @@ bool TBL_SAT_ResetAppCmd(void* ObjDataPtr, const CFE_MSG_Message_t *MsgPtr)
 {
 
    CMDMGR_ResetStatus(CMDMGR_OBJ);
-   CHILDMGR_ResetStatus(CHILDMGR_OBJ);
    
-   SAT_CTRL_ResetStatus();
+   RIG_MGR_ResetStatus();
 	  
    return true;
 
@@ -154,8 +155,6 @@ static int32 InitApp(void)
 
    int32 Status = APP_C_FW_CFS_ERROR;
    
-   CHILDMGR_TaskInit_t ChildTaskInit;
-   
    /*
    ** Initialize objects 
    */
@@ -166,9 +165,14 @@ static int32 InitApp(void)
       TblSat.PerfId        = INITBL_GetIntConfig(INITBL_OBJ, CFG_APP_PERF_ID);
       TblSat.CmdMid        = CFE_SB_ValueToMsgId(INITBL_GetIntConfig(INITBL_OBJ, CFG_TBL_SAT_CMD_TOPICID));
       TblSat.SendStatusMid = CFE_SB_ValueToMsgId(INITBL_GetIntConfig(INITBL_OBJ, CFG_BC_SCH_1_HZ_TOPICID));
+      TblSat.CmdPipeDepth  = INITBL_GetIntConfig(INITBL_OBJ, CFG_CMD_PIPE_DEPTH);
       
       CFE_ES_PerfLogEntry(TblSat.PerfId);
 
+      /* Lock memory and paint the main task's stack before any child tasks are created */
+      RT_PROFILE_Constructor(RT_PROFILE_OBJ, INITBL_OBJ);
+      MEM_MON_Constructor(MEM_MON_OBJ, INITBL_OBJ);
+
       Status = CFE_SUCCESS;
   
    } /* End if INITBL Constructed */
@@ -179,13 +183,14 @@ static int32 InitApp(void)
       /* Must constructor table manager prior to any app objects that contain tables */
       TBLMGR_Constructor(TBLMGR_OBJ, INITBL_GetStrConfig(INITBL_OBJ, CFG_APP_CFE_NAME));
 
-      SAT_CTRL_Constructor(SAT_CTRL_OBJ, INITBL_OBJ, TBLMGR_OBJ);
+      /* Constructor sends error events */    
+      Status = RIG_MGR_Constructor(RIG_MGR_OBJ, INITBL_OBJ, TBLMGR_OBJ);
 
       /*
       ** Initialize app level interfaces
       */
       
-      CFE_SB_CreatePipe(&TblSat.CmdPipe, INITBL_GetIntConfig(INITBL_OBJ, CFG_CMD_PIPE_DEPTH), INITBL_GetStrConfig(INITBL_OBJ, CFG_CMD_PIPE_NAME));  
+      CFE_SB_CreatePipe(&TblSat.CmdPipe, TblSat.CmdPipeDepth, INITBL_GetStrConfig(INITBL_OBJ, CFG_CMD_PIPE_NAME));  
       CFE_SB_Subscribe(TblSat.CmdMid,        TblSat.CmdPipe);
       CFE_SB_Subscribe(TblSat.SendStatusMid, TblSat.CmdPipe);
 
@@ -195,22 +200,19 @@ static int32 InitApp(void)
       CMDMGR_RegisterFunc(CMDMGR_OBJ, TBL_SAT_LOAD_TBL_CC, TBLMGR_OBJ, TBLMGR_LoadTblCmd, sizeof(TBL_SAT_LoadTbl_CmdPayload_t));
       CMDMGR_RegisterFunc(CMDMGR_OBJ, TBL_SAT_DUMP_TBL_CC, TBLMGR_OBJ, TBLMGR_DumpTblCmd, sizeof(TBL_SAT_DumpTbl_CmdPayload_t));
 
-OS_printf("*****sizeof(TBL_SAT_SetCtrlMode_Payload_t)=%d\n", (uint32)sizeof(TBL_SAT_SetCtrlMode_Payload_t));
-      CMDMGR_RegisterFunc(CMDMGR_OBJ, TBL_SAT_SET_CTRL_MODE_CC,    SAT_CTRL_OBJ, SAT_CTRL_SetModeCmd,      2); //sizeof(TBL_SAT_SetCtrlMode_Payload_t));
-      CMDMGR_RegisterFunc(CMDMGR_OBJ, TBL_SAT_SET_CTRL_GAINS_CC,   SAT_CTRL_OBJ, SAT_CTRL_SetCtrlGainsCmd, sizeof(TBL_SAT_SetCtrlGains_Payload_t)); //sizeof(TBL_SAT_SetCtrlMode_Payload_t));
-      CMDMGR_RegisterFunc(CMDMGR_OBJ, TBL_SAT_OVERRIDE_FAN_PWM_CC, SAT_CTRL_OBJ, FAN_OverridePwmCmd,       sizeof(TBL_SAT_OverrideFanPwm_Payload_t)); //sizeof(TBL_SAT_SetCtrlMode_Payload_t));
+      CMDMGR_RegisterFunc(CMDMGR_OBJ, TBL_SAT_SET_CTRL_MODE_CC,      RIG_MGR_OBJ, RIG_MGR_SetCtrlModeCmd,      sizeof(TBL_SAT_SetCtrlMode_CmdPayload_t));
+      CMDMGR_RegisterFunc(CMDMGR_OBJ, TBL_SAT_SET_CTRL_GAINS_CC,     RIG_MGR_OBJ, RIG_MGR_SetCtrlGainsCmd,     sizeof(TBL_SAT_SetCtrlGains_CmdPayload_t));
+      CMDMGR_RegisterFunc(CMDMGR_OBJ, TBL_SAT_OVERRIDE_FAN_PWM_CC,   RIG_MGR_OBJ, RIG_MGR_OverrideFanPwmCmd,   sizeof(TBL_SAT_OverrideFanPwm_CmdPayload_t));
+      CMDMGR_RegisterFunc(CMDMGR_OBJ, TBL_SAT_START_PWM_PLAYBACK_CC, RIG_MGR_OBJ, RIG_MGR_StartPwmPlaybackCmd, sizeof(TBL_SAT_StartPwmPlayback_CmdPayload_t));
+      CMDMGR_RegisterFunc(CMDMGR_OBJ, TBL_SAT_STOP_PWM_PLAYBACK_CC,  RIG_MGR_OBJ, RIG_MGR_StopPwmPlaybackCmd,  sizeof(TBL_SAT_StopPwmPlayback_CmdPayload_t));
+      CMDMGR_RegisterFunc(CMDMGR_OBJ, TBL_SAT_SET_TBL_RIG_CC,        RIG_MGR_OBJ, RIG_MGR_SetTblRigCmd,        sizeof(TBL_SAT_SetTblRig_CmdPayload_t));
+      CMDMGR_RegisterFunc(CMDMGR_OBJ, TBL_SAT_START_SEQ_CC,          RIG_MGR_OBJ, RIG_MGR_StartSeqCmd,         sizeof(TBL_SAT_StartSeq_CmdPayload_t));
+      CMDMGR_RegisterFunc(CMDMGR_OBJ, TBL_SAT_ABORT_SEQ_CC,          RIG_MGR_OBJ, RIG_MGR_AbortSeqCmd,         sizeof(TBL_SAT_AbortSeq_CmdPayload_t));
+      CMDMGR_RegisterFunc(CMDMGR_OBJ, TBL_SAT_PAUSE_SEQ_CC,          RIG_MGR_OBJ, RIG_MGR_PauseSeqCmd,         sizeof(TBL_SAT_PauseSeq_CmdPayload_t));
+      CMDMGR_RegisterFunc(CMDMGR_OBJ, TBL_SAT_SET_SENSOR_FAULT_CC,   RIG_MGR_OBJ, RIG_MGR_SetSensorFaultCmd,   sizeof(TBL_SAT_SetSensorFault_CmdPayload_t));
       
       CFE_MSG_Init(CFE_MSG_PTR(TblSat.StatusTlm.TelemetryHeader), CFE_SB_ValueToMsgId(INITBL_GetIntConfig(INITBL_OBJ, CFG_TBL_SAT_STATUS_TLM_TOPICID)), sizeof(TBL_SAT_StatusTlm_t));
-
-      /* Constructor sends error events */    
-      ChildTaskInit.TaskName  = INITBL_GetStrConfig(INITBL_OBJ, CFG_CHILD_NAME);
-      ChildTaskInit.PerfId    = INITBL_GetIntConfig(INITBL_OBJ, CFG_CHILD_PERF_ID);
-      ChildTaskInit.StackSize = INITBL_GetIntConfig(INITBL_OBJ, CFG_CHILD_STACK_SIZE);
-      ChildTaskInit.Priority  = INITBL_GetIntConfig(INITBL_OBJ, CFG_CHILD_PRIORITY);
-      Status = CHILDMGR_Constructor(CHILDMGR_OBJ, 
-                                    ChildMgr_TaskMainCallback,
-                                    SAT_CTRL_ChildTask, 
-                                    &ChildTaskInit); 
+      CFE_MSG_Init(CFE_MSG_PTR(TblSat.MemTlm.TelemetryHeader), CFE_SB_ValueToMsgId(INITBL_GetIntConfig(INITBL_OBJ, CFG_TBL_SAT_MEM_TLM_TOPICID)), sizeof(TBL_SAT_MemTlm_t));
    
       /*
       ** Application startup event message
@@ -219,7 +221,7 @@ OS_printf("*****sizeof(TBL_SAT_SetCtrlMode_Payload_t)=%d\n", (uint32)sizeof(TBL_
                         "TBL_SAT App Initialized. Version %d.%d.%d",
                         TBL_SAT_MAJOR_VER, TBL_SAT_MINOR_VER, TBL_SAT_PLATFORM_REV);
                         
-   } /* End if CHILDMGR constructed */
+   } /* End if INITBL constructed */
    
    return(Status);
 
@@ -262,6 +264,7 @@ static int32 ProcessCommands(void)
          {
 
             SendStatusTlm();
+            SendMemTlm();
             
          }
          else
@@ -293,54 +296,214 @@ static int32 ProcessCommands(void)
 } /* End ProcessCommands() */
 
 
+/******************************************************************************
+** Function: SendMemTlm
+**
+** Notes:
+**   1. The command pipe is read one message at a time so its peak usage is
+**      only available from SB's pipe statistics.
+**
+*/
+static void SendMemTlm(void)
+{
+   
+   TBL_SAT_MemTlm_Payload_t *MemTlmPayload = &TblSat.MemTlm.Payload;
+   const RIG_MGR_Class_t    *RigMgr = &TblSat.RigMgr;
+   uint8 i;
+   
+   MemTlmPayload->StackPaint = TblSat.MemMon.StackPaint;
+   MemTlmPayload->StackCnt   = MEM_MON_GetStackUsage(MemTlmPayload->Stack, MEM_MON_MAX_STACK);
+   
+   MemTlmPayload->TblSatObjSize     = sizeof(TBL_SAT_Class_t);
+   MemTlmPayload->RigMgrObjSize     = sizeof(RIG_MGR_Class_t);
+   MemTlmPayload->SatCtrlObjSize    = sizeof(SAT_CTRL_Class_t);
+   MemTlmPayload->SatCtrlTblObjSize = sizeof(SAT_CTRL_TBL_Class_t);
+   MemTlmPayload->FanObjSize        = sizeof(FAN_Class_t);
+   MemTlmPayload->FanTblObjSize     = sizeof(FAN_TBL_Class_t);
+   MemTlmPayload->TachObjSize       = sizeof(TACH_Class_t);
+   MemTlmPayload->PwmFifoObjSize    = sizeof(PWM_FIFO_Class_t);
+   MemTlmPayload->JsonBufSize       = SAT_CTRL_TBL_JSON_FILE_MAX_CHAR + FAN_TBL_JSON_FILE_MAX_CHAR +
+                                      RIG_MGR_JSON_FILE_MAX_CHAR + SEQ_TBL_JSON_FILE_MAX_CHAR +
+                                      SENSOR_TBL_JSON_FILE_MAX_CHAR;
+   
+   MemTlmPayload->CmdPipeDepth = TblSat.CmdPipeDepth;
+   MemTlmPayload->WorkerCnt    = RigMgr->WorkerCnt;
+   for (i=0; i < RigMgr->WorkerCnt; i++)
+   {
+      MemTlmPayload->WorkerPipe[i].Depth      = RigMgr->Worker[i].PipeDepth;
+      MemTlmPayload->WorkerPipe[i].PeakMsgCnt = RigMgr->Worker[i].PipePeakMsgCnt;
+      MemTlmPayload->WorkerPipe[i].PeakBytes  = RigMgr->Worker[i].PipePeakBytes;
+   }
+
+   CFE_SB_TimeStampMsg(CFE_MSG_PTR(TblSat.MemTlm.TelemetryHeader));
+   CFE_SB_TransmitMsg(CFE_MSG_PTR(TblSat.MemTlm.TelemetryHeader), true);
+   
+} /* End SendMemTlm() */
+
+
 /******************************************************************************
 ** Function: SendStatusTlm
 **
+** Notes:
+**   1. One packet is sent for each rig. RigIdx identifies the rig and the
+**      shared PWM playback and tach fields are the same in every packet.
+**
 */
 static void SendStatusTlm(void)
 {
    
    TBL_SAT_StatusTlm_Payload_t *StatusTlmPayload = &TblSat.StatusTlm.Payload;
+   const RIG_MGR_Class_t   *RigMgr = &TblSat.RigMgr;
+   const SAT_CTRL_Class_t  *SatCtrl;
+   const FAULT_INJ_Class_t *FaultInj;
+   VIB_MON_Result_t VibResult;
+   uint8 Rig, i;
    
    StatusTlmPayload->ValidCmdCnt   = TblSat.CmdMgr.ValidCmdCnt;
    StatusTlmPayload->InvalidCmdCnt = TblSat.CmdMgr.InvalidCmdCnt;
+   StatusTlmPayload->RigCnt        = RigMgr->RigCnt;
 
-   /*
-   ** Hardware Interface and Sensor Data
-   */ 
+   StatusTlmPayload->PwmPlaybackState       = RigMgr->PwmFifo.State;
+   StatusTlmPayload->PwmPlaybackWordCnt     = RigMgr->PwmFifo.WordsWritten;
+   StatusTlmPayload->PwmPlaybackUnderrunCnt = RigMgr->PwmFifo.UnderrunCnt;
+   StatusTlmPayload->TachDroppedEdgeCnt     = RigMgr->Tach.DroppedEdgeCnt;
+
+   for (Rig=0; Rig < RigMgr->RigCnt; Rig++)
+   {
    
-   StatusTlmPayload->FanIoMapped      = TblSat.SatCtrl.Fan.PwmMapped;
-   StatusTlmPayload->VisibleLight     = TblSat.SatCtrl.Mqtt.SensorTlm.Payload.LuxA;
-   StatusTlmPayload->UltravioletLight = TblSat.SatCtrl.Mqtt.SensorTlm.Payload.LuxB;
-   StatusTlmPayload->RawRateX         = TblSat.SatCtrl.Mqtt.SensorTlm.Payload.RateX;
-   StatusTlmPayload->RawRateY         = TblSat.SatCtrl.Mqtt.SensorTlm.Payload.RateY;
-   StatusTlmPayload->RawRateZ         = TblSat.SatCtrl.Mqtt.SensorTlm.Payload.RateZ;
-   StatusTlmPayload->DeltaTime        = TblSat.SatCtrl.Mqtt.SensorTlm.Payload.DeltaTime;
+      SatCtrl = &RigMgr->Rig[Rig];
+      
+      StatusTlmPayload->RigIdx = Rig;
+      
+      /*
+      ** Hardware Interface and Sensor Data
+      */ 
    
+      StatusTlmPayload->FanIoMapped         = SatCtrl->Fan.PwmMapped;
+      StatusTlmPayload->VisibleLight        = SatCtrl->Sensor.LuxA;
+      StatusTlmPayload->UltravioletLight    = SatCtrl->Sensor.LuxB;
+      StatusTlmPayload->RawRateX            = SatCtrl->Sensor.RateX;
+      StatusTlmPayload->RawRateY            = SatCtrl->Sensor.RateY;
+      StatusTlmPayload->RawRateZ            = SatCtrl->Sensor.RateZ;
+      StatusTlmPayload->DeltaTime           = SatCtrl->Sensor.DeltaTime;
+      StatusTlmPayload->SensorFreshMask     = SatCtrl->Mqtt.FreshMask;
+      StatusTlmPayload->CalRateX            = SatCtrl->SensorCal[SENSOR_TBL_CHAN_RATE_X];
+      StatusTlmPayload->CalRateY            = SatCtrl->SensorCal[SENSOR_TBL_CHAN_RATE_Y];
+      StatusTlmPayload->CalRateZ            = SatCtrl->SensorCal[SENSOR_TBL_CHAN_RATE_Z];
+      StatusTlmPayload->CalVisibleLight     = SatCtrl->SensorCal[SENSOR_TBL_CHAN_LUX_A];
+      StatusTlmPayload->CalUltravioletLight = SatCtrl->SensorCal[SENSOR_TBL_CHAN_LUX_B];
    
-   /*
-   ** Controller 
-   */ 
+      /*
+      ** Controller 
+      */ 
    
-   StatusTlmPayload->CtrlMode           = TblSat.SatCtrl.Mode;
-   StatusTlmPayload->TimeInCtrlMode     = TblSat.SatCtrl.TimeInMode;
-   StatusTlmPayload->TotalLight         = TblSat.SatCtrl.Sensor.TotalLight;
-   StatusTlmPayload->SpinRate           = TblSat.SatCtrl.Sensor.SpinRate;
-   StatusTlmPayload->SunAcqState        = TblSat.SatCtrl.SunAcqMode.State;
-   StatusTlmPayload->PosErr             = TblSat.SatCtrl.SunAcqMode.PosErr;
-   StatusTlmPayload->RateErr            = TblSat.SatCtrl.SunAcqMode.RateErr;
-   StatusTlmPayload->PosGain            = TblSat.SatCtrl.Tbl.Data.PosGain;
-   StatusTlmPayload->RateGain           = TblSat.SatCtrl.Tbl.Data.RateGain;
-   StatusTlmPayload->FanAPwmCmd         = TblSat.SatCtrl.Fan.A.PwmCmd;
-   StatusTlmPayload->FanBPwmCmd         = TblSat.SatCtrl.Fan.B.PwmCmd;
-   StatusTlmPayload->FanOverrideEnabled = TblSat.SatCtrl.Fan.OverridePwmCmdEnabled;
-   StatusTlmPayload->FanOverrideCnt     = TblSat.SatCtrl.Fan.OverridePwmCmdCount;
-   StatusTlmPayload->FanAOverridePwmCmd = TblSat.SatCtrl.Fan.A.OverridePwmCmd;
-   StatusTlmPayload->FanBOverridePwmCmd = TblSat.SatCtrl.Fan.B.OverridePwmCmd;
-
-   CFE_SB_TimeStampMsg(CFE_MSG_PTR(TblSat.StatusTlm.TelemetryHeader));
-   CFE_SB_TransmitMsg(CFE_MSG_PTR(TblSat.StatusTlm.TelemetryHeader), true);
+      StatusTlmPayload->CtrlMode           = SatCtrl->Mode;
+      StatusTlmPayload->TimeInCtrlMode     = SatCtrl->TimeInMode;
+      StatusTlmPayload->TotalLight         = SatCtrl->Sensor.TotalLight;
+      StatusTlmPayload->SpinRate           = SatCtrl->Sensor.SpinRate;
+      StatusTlmPayload->SunAcqState        = SatCtrl->SunAcqMode.State;
+      StatusTlmPayload->PosErr             = SatCtrl->SunAcqMode.PosErr;
+      StatusTlmPayload->RateErr            = SatCtrl->SunAcqMode.RateErr;
+      StatusTlmPayload->SourceAngle        = SatCtrl->SunAcqMode.SourceAngle;
+      StatusTlmPayload->SlewPhase          = SatCtrl->SunAcqMode.Slew.Phase;
+      StatusTlmPayload->SlewModelValid     = SatCtrl->SunAcqMode.Slew.ModelValid;
+      StatusTlmPayload->SlewAccel          = SatCtrl->SunAcqMode.Slew.Accel;
+      StatusTlmPayload->SlewFriction       = SatCtrl->SunAcqMode.Slew.Friction;
+      StatusTlmPayload->SlewTargetRate     = SatCtrl->SunAcqMode.Slew.TargetRate;
+      StatusTlmPayload->PosGain            = SatCtrl->Tbl.Data.PosGain;
+      StatusTlmPayload->RateGain           = SatCtrl->Tbl.Data.RateGain;
+      StatusTlmPayload->FanAPwmCmd         = SatCtrl->Fan.Actuator[0].PwmCmd;
+      StatusTlmPayload->FanBPwmCmd         = SatCtrl->Fan.Actuator[1].PwmCmd;
+      StatusTlmPayload->FanOverrideEnabled = SatCtrl->Fan.OverridePwmCmdEnabled;
+      StatusTlmPayload->FanOverrideCnt     = SatCtrl->Fan.OverridePwmCmdCount;
+      StatusTlmPayload->FanAOverridePwmCmd = SatCtrl->Fan.Actuator[0].OverridePwmCmd;
+      StatusTlmPayload->FanBOverridePwmCmd = SatCtrl->Fan.Actuator[1].OverridePwmCmd;
+      StatusTlmPayload->FanCnt             = SatCtrl->Fan.FanCnt;
+      for (i=0; i < FAN_TBL_MAX_FAN; i++)
+      {
+         StatusTlmPayload->FanPwmOutput[i] = SatCtrl->Fan.Actuator[i].PwmOutput;
+         StatusTlmPayload->FanRpm[i]       = SatCtrl->Fan.Actuator[i].Rpm;
+      }
+
+      /*
+      ** Command Sequence
+      */ 
    
-} /* End SendStatusTlm() */
+      StatusTlmPayload->SeqState    = SEQ_GetState(&SatCtrl->Seq);
+      StatusTlmPayload->SeqEntry    = SatCtrl->Seq.Entry;
+      StatusTlmPayload->SeqEntryCnt = SatCtrl->Seq.Tbl.Data.EntryCnt;
+      StatusTlmPayload->SeqCycle    = SatCtrl->Seq.Cycle;
+      StatusTlmPayload->SeqTimeMs   = SatCtrl->Seq.TimeMs;
+      StatusTlmPayload->SeqCmdCnt   = SatCtrl->Seq.CmdCnt;
 
+      /*
+      ** Sensor Fault Injection
+      */ 
+   
+      FaultInj = &RigMgr->FaultInj[Rig];
+      StatusTlmPayload->SensorFaultEnabled = FaultInj->Enabled;
+      StatusTlmPayload->SensorFaultInCnt   = FaultInj->InCnt;
+      StatusTlmPayload->SensorDropCnt      = FaultInj->DropCnt;
+      StatusTlmPayload->SensorDupCnt       = FaultInj->DupCnt;
+      StatusTlmPayload->SensorReorderCnt   = FaultInj->ReorderCnt;
+      StatusTlmPayload->SensorSpikeCnt     = FaultInj->SpikeCnt;
+      StatusTlmPayload->SensorOverflowCnt  = FaultInj->OverflowCnt;
+      StatusTlmPayload->SensorMaxDelayMs   = FaultInj->MaxDelayMs;
 
+      /*
+      ** Command Mailbox
+      */ 
+   
+      StatusTlmPayload->CmdAppliedCnt   = SatCtrl->CmdMbox.AppliedCnt;
+      StatusTlmPayload->CmdMboxFullCnt  = SatCtrl->CmdMbox.FullCnt;
+      StatusTlmPayload->CmdLatencyUs    = SatCtrl->CmdMbox.LastLatencyUs;
+      StatusTlmPayload->CmdMaxLatencyUs = SatCtrl->CmdMbox.MaxLatencyUs;
+
+      /*
+      ** Vibration Monitor
+      */ 
+   
+      VIB_MON_GetResult(&SatCtrl->VibMon, &VibResult);
+      StatusTlmPayload->VibSpectrumCnt = VibResult.SpectrumCnt;
+      StatusTlmPayload->VibOverrunCnt  = VibResult.OverrunCnt;
+      for (i=0; i < VIB_MON_PEAK_CNT; i++)
+      {
+         StatusTlmPayload->VibPeakHz[i]  = VibResult.Peak[i].Hz;
+         StatusTlmPayload->VibPeakAmp[i] = VibResult.Peak[i].Amp;
+      }
+      StatusTlmPayload->VibNotchActive = VibResult.NotchActive;
+      StatusTlmPayload->VibNotchHz     = VibResult.NotchHz;
+
+      /*
+      ** Gyro Bias Estimator
+      */ 
+   
+      StatusTlmPayload->GyroTempValid = SatCtrl->DieTempValid;
+      StatusTlmPayload->GyroTemp      = SatCtrl->DieTemp;
+      StatusTlmPayload->GyroStill     = SatCtrl->GyroBias.Still;
+      StatusTlmPayload->GyroStillCnt  = SatCtrl->GyroBias.StillCnt;
+      StatusTlmPayload->GyroMovingCnt = SatCtrl->GyroBias.MovingCnt;
+      for (i=0; i < GYRO_BIAS_AXIS_CNT; i++)
+      {
+         StatusTlmPayload->GyroBias[i]         = SatCtrl->GyroBias.Bias[i];
+         StatusTlmPayload->GyroBiasTempCoef[i] = SatCtrl->GyroBias.TempCoef[i];
+      }
+
+      /*
+      ** Attitude Estimator
+      */ 
+   
+      for (i=0; i < ATT_EST_STATE_CNT; i++)
+      {
+         StatusTlmPayload->AttEst[i] = (float)SatCtrl->AttEst.X[i];
+      }
+      ATT_EST_GetCov(&SatCtrl->AttEst, StatusTlmPayload->AttEstCov);
+      StatusTlmPayload->AttEstLightCnt  = SatCtrl->AttEst.LightCnt;
+      StatusTlmPayload->AttEstRejectCnt = SatCtrl->AttEst.LightRejectCnt;
+
+      CFE_SB_TimeStampMsg(CFE_MSG_PTR(TblSat.StatusTlm.TelemetryHeader));
+      CFE_SB_TransmitMsg(CFE_MSG_PTR(TblSat.StatusTlm.TelemetryHeader), true);
+      
+   } /* End rig loop */
+   
+} /* End SendStatusTlm() */
@@ -21,6 +21,11 @@
 **       and as long as the term 'fan' can be used for the functional 
 **       interface name then the only files that may have to change are
 **       app_cfg.h, cpu1_tbl_sat_ini.json, and the fan.h, fan.c
+**    2. One app instance can control several rigs, see rig_mgr.h. A status
+**       telemetry packet is sent for each rig.
+**    3. A memory telemetry packet is sent with each status request. It
+**       reports stack high-water marks (see mem_mon.h), object sizes and
+**       worker pipe usage for sizing stacks and buffers.
 **
 */
 
@@ -32,7 +37,9 @@
 */
 
 #include "app_cfg.h"
-#include "sat_ctrl.h"
+#include "rig_mgr.h"
+#include "mem_mon.h"
+#include "rt_profile.h"
 
 /***********************/
 /** Macro Definitions **/
@@ -79,13 +86,13 @@ typedef struct
    CFE_SB_PipeId_t    CmdPipe;
    CMDMGR_Class_t     CmdMgr;
    TBLMGR_Class_t     TblMgr;
-   CHILDMGR_Class_t   ChildMgr;   
    
    /*
    ** Telemetry Packets
    */
    
    TBL_SAT_StatusTlm_t  StatusTlm;
+   TBL_SAT_MemTlm_t     MemTlm;
 
    /*
    ** App State & Objects
@@ -94,8 +101,11 @@ typedef struct
    uint32             PerfId;
    CFE_SB_MsgId_t     CmdMid;
    CFE_SB_MsgId_t     SendStatusMid;
+   uint16             CmdPipeDepth;
    
-   SAT_CTRL_Class_t   SatCtrl;
+   RT_PROFILE_Class_t RtProfile;
+   MEM_MON_Class_t    MemMon;
+   RIG_MGR_Class_t    RigMgr;
  
 } TBL_SAT_Class_t;
 
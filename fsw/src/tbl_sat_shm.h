@@ -0,0 +1,155 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Define the binary layout of the shared memory telemetry segment
+**
+**  Notes:
+**    1. This header is shared by the app and by local reader processes so
+**       it only depends on the C standard headers. Every field has a fixed
+**       width and explicit padding keeps the layout identical for any
+**       compiler targeting the same byte order.
+**    2. The segment starts with a header followed by one slot per rig.
+**       The app writes Magic last when it creates the segment, so a reader
+**       must verify Magic, Version and Size before using any other field.
+**       Version is incremented whenever the layout changes.
+**    3. Each rig slot is protected by a sequence lock. The rig's worker
+**       makes Seq odd, updates the snapshot and appends to the history and
+**       then makes Seq even again. A reader copies the slot between two
+**       reads of Seq and retries if Seq was odd or changed. Readers never
+**       write the segment so they can't delay or corrupt the controller.
+**    4. The history is a ring of the last TBL_SAT_SHM_HISTORY_LEN control
+**       cycles. HistoryCnt counts every cycle written so the newest entry is
+**       History[(HistoryCnt-1) % TBL_SAT_SHM_HISTORY_LEN].
+**    5. Times are the controller's CLOCK_MONOTONIC milliseconds, or the
+**       simulation's virtual clock for the rigs on the simulated rig's
+**       worker when the app is built with TBL_SAT_SIM_HW.
+**    6. See tools/shm for the reader library.
+**
+*/
+
+#ifndef _tbl_sat_shm_
+#define _tbl_sat_shm_
+
+#include <stdint.h>
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define TBL_SAT_SHM_MAGIC        0x54534154u  /* "TSAT" */
+#define TBL_SAT_SHM_VERSION      1
+#define TBL_SAT_SHM_MAX_RIG      4            /* Must match RIG_MGR_MAX_RIG, checked in shm_export.c */
+#define TBL_SAT_SHM_MAX_FAN      8            /* Must match FAN_TBL_MAX_FAN, checked in shm_export.c */
+#define TBL_SAT_SHM_HISTORY_LEN  64           /* Must be a power of 2 */
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+
+/******************************************************************************
+** Controller snapshot after the rig's last control cycle
+*/
+
+typedef struct
+{
+
+   uint64_t  TimeMs;
+   uint32_t  Cycle;             /* Control cycles executed */
+   uint8_t   CtrlMode;          /* TBL_SAT_CtrlMode_Enum_t */
+   uint8_t   SunAcqState;       /* TBL_SAT_SunAcqState_Enum_t */
+   uint8_t   SeqState;          /* TBL_SAT_SeqState_Enum_t */
+   uint8_t   FanOverride;       /* Non-zero when the fan override is active */
+
+   uint32_t  LuxA;              /* Raw light sensors */
+   uint32_t  LuxB;
+   float     RawRate[3];        /* X, Y, Z, radians/sec */
+   float     CalRate[3];        /* Calibrated X, Y, Z, radians/sec */
+   float     DeltaTime;
+   uint16_t  SensorFreshMask;
+   uint16_t  Spare;
+
+   uint32_t  TotalLight;        /* Filtered */
+   float     SpinRate;          /* Filtered, degrees/sec */
+   float     PosErr;
+   float     RateErr;
+   float     PosGain;
+   float     RateGain;
+
+   uint32_t  FanCnt;
+   uint16_t  FanPwmCmd[TBL_SAT_SHM_MAX_FAN];
+   float     FanRpm[TBL_SAT_SHM_MAX_FAN];
+
+} TBL_SAT_SHM_Snapshot_t;
+
+
+/******************************************************************************
+** Control cycle history entry
+*/
+
+typedef struct
+{
+
+   uint64_t  TimeMs;
+   uint32_t  Cycle;
+   uint8_t   CtrlMode;
+   uint8_t   SunAcqState;
+   uint16_t  Spare;
+   uint32_t  TotalLight;
+   float     SpinRate;
+   float     PosErr;
+   float     RateErr;
+   uint16_t  FanPwmCmd[2];
+
+} TBL_SAT_SHM_Cycle_t;
+
+
+/******************************************************************************
+** Rig slot
+*/
+
+typedef struct
+{
+
+   uint32_t  Seq;               /* Sequence lock, odd while the slot is written */
+   uint32_t  HistoryCnt;
+
+   TBL_SAT_SHM_Snapshot_t  Snapshot;
+   TBL_SAT_SHM_Cycle_t     History[TBL_SAT_SHM_HISTORY_LEN];
+
+} TBL_SAT_SHM_Rig_t;
+
+
+/******************************************************************************
+** Segment
+*/
+
+typedef struct
+{
+
+   uint32_t  Magic;
+   uint16_t  Version;
+   uint16_t  RigCnt;
+   uint32_t  Size;              /* sizeof(TBL_SAT_SHM_Segment_t) */
+   uint32_t  HistoryLen;
+
+   TBL_SAT_SHM_Rig_t  Rig[TBL_SAT_SHM_MAX_RIG];
+
+} TBL_SAT_SHM_Segment_t;
+
+
+#endif /* _tbl_sat_shm_ */
@@ -0,0 +1,518 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Implement the vibration spectrum monitor class
+**
+**  Notes:
+**    1. See vib_mon.h for details.
+**    2. The real FFT packs the even samples into the real part and the odd
+**       samples into the imaginary part of a VIB_MON_FFT_LEN/2 point
+**       complex FFT. The even and odd sample spectra are separated from its
+**       output using conjugate symmetry and combined with one more twiddle
+**       multiply per bin. One twiddle table of exp(-j*2*pi*k/N), k < N/2,
+**       serves the complex FFT stages and the final combine.
+**    3. The analysis buffers are shared by every rig because only the
+**       background task calls VIB_MON_Analyze().
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <math.h>
+#include <string.h>
+#include "vib_mon.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define HALF_LEN    (VIB_MON_FFT_LEN/2)   /* Complex FFT length */
+#define READ_RETRY  4
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+
+/************************************/
+/** Local File Function Prototypes **/
+/************************************/
+
+static void ComputeSpectrum(void);
+static void DesignNotch(VIB_MON_NotchCoef_t *Coef, float Hz, float SampleHz, float Q);
+static void FindPeaks(VIB_MON_Peak_t *Peak, float SampleHz);
+static void InitTables(void);
+static void Publish(VIB_MON_Class_t *VibMon, const VIB_MON_Result_t *Result);
+
+
+/**********************/
+/** Global File Data **/
+/**********************/
+
+static bool  TablesReady = false;
+static float Window[VIB_MON_FFT_LEN];
+static float WindowSum;
+static float TwCos[HALF_LEN];
+static float TwSin[HALF_LEN];
+static uint8 BitRev[HALF_LEN];
+
+static float Sample[VIB_MON_FFT_LEN];
+static float Re[HALF_LEN];
+static float Im[HALF_LEN];
+static float Mag[HALF_LEN+1];   /* Bins 0 to Nyquist */
+
+
+/******************************************************************************
+** Function: VIB_MON_Constructor
+**
+*/
+void VIB_MON_Constructor(VIB_MON_Class_t *VibMon, uint8 RigIdx)
+{
+
+   memset(VibMon, 0, sizeof(VIB_MON_Class_t));
+
+   VibMon->RigIdx = RigIdx;
+
+   if (!TablesReady)
+   {
+      InitTables();
+   }
+
+} /* End VIB_MON_Constructor() */
+
+
+/******************************************************************************
+** Function: VIB_MON_Analyze
+**
+** Notes:
+**   1. The window is copied without stopping the worker. The worker may
+**      write new samples during the copy and the window is discarded if
+**      the ring wrapped into it before the copy finished.
+**
+*/
+bool VIB_MON_Analyze(VIB_MON_Class_t *VibMon, float SampleHz,
+                     const VIB_MON_NotchParam_t *Param)
+{
+
+   VIB_MON_Result_t Result = VibMon->Result;  /* Only this task writes Result */
+   uint32 Head, First;
+   float  Mean = 0.0;
+   float  ActivateAmp;
+   bool   NotchActive;
+   uint16 i;
+
+   Head = __atomic_load_n(&VibMon->Head, __ATOMIC_ACQUIRE);
+   if (Head < VIB_MON_FFT_LEN || Head == VibMon->AnalyzedHead || !(SampleHz > 0.0))
+   {
+      return false;
+   }
+
+   First = Head - VIB_MON_FFT_LEN;
+   for (i=0; i < VIB_MON_FFT_LEN; i++)
+   {
+      Sample[i] = VibMon->Ring[(First + i) & (VIB_MON_RING_LEN-1)];
+   }
+
+   __atomic_thread_fence(__ATOMIC_ACQUIRE);
+   VibMon->AnalyzedHead = Head;
+   if ((__atomic_load_n(&VibMon->Head, __ATOMIC_RELAXED) - First) >= VIB_MON_RING_LEN)
+   {
+      Result.OverrunCnt++;
+      Publish(VibMon, &Result);
+      return false;
+   }
+
+   for (i=0; i < VIB_MON_FFT_LEN; i++)
+   {
+      Mean += Sample[i];
+   }
+   Mean /= VIB_MON_FFT_LEN;
+   for (i=0; i < VIB_MON_FFT_LEN; i++)
+   {
+      Sample[i] = (Sample[i] - Mean) * Window[i];
+   }
+
+   ComputeSpectrum();
+   FindPeaks(Result.Peak, SampleHz);
+   Result.SpectrumCnt++;
+
+   ActivateAmp = Result.NotchActive ? 0.5*Param->MinAmp : Param->MinAmp;
+   NotchActive = Param->Enabled && Result.Peak[0].Amp > 0.0 && Result.Peak[0].Amp >= ActivateAmp &&
+                 Result.Peak[0].Hz > 0.0 && Result.Peak[0].Hz < 0.5*SampleHz;
+
+   if (NotchActive)
+   {
+      DesignNotch(&Result.NotchCoef, Result.Peak[0].Hz, SampleHz, Param->Q);
+      Result.NotchHz = Result.Peak[0].Hz;
+   }
+   else
+   {
+      Result.NotchHz = 0.0;
+   }
+
+   if (NotchActive != Result.NotchActive)
+   {
+      CFE_EVS_SendEvent(VIB_MON_NOTCH_EID, CFE_EVS_EventType_INFORMATION,
+                        "Rig %d vibration notch %s, strongest peak %0.3f Hz with amplitude %0.5f",
+                        VibMon->RigIdx, NotchActive ? "activated" : "deactivated",
+                        Result.Peak[0].Hz, Result.Peak[0].Amp);
+   }
+   Result.NotchActive = NotchActive;
+
+   Publish(VibMon, &Result);
+
+   return true;
+
+} /* End VIB_MON_Analyze() */
+
+
+/******************************************************************************
+** Function: VIB_MON_Filter
+**
+** Notes:
+**   1. The filter state is primed with the first sample after the notch
+**      activates. The notch has unity gain at DC so a constant rate passes
+**      without a transient.
+**
+*/
+float VIB_MON_Filter(VIB_MON_Class_t *VibMon, float Rate)
+{
+
+   uint32 Head = VibMon->Head;
+   uint32 Seq;
+   bool   NotchActive;
+   VIB_MON_NotchCoef_t Coef;
+   const VIB_MON_NotchCoef_t *C = &VibMon->NotchCoef;
+   float  Y;
+
+   VibMon->Ring[Head & (VIB_MON_RING_LEN-1)] = Rate;
+   __atomic_store_n(&VibMon->Head, Head + 1, __ATOMIC_RELEASE);
+
+   Seq = __atomic_load_n(&VibMon->ResultSeq, __ATOMIC_ACQUIRE);
+   if (Seq != VibMon->NotchSeq && !(Seq & 1))
+   {
+      NotchActive = VibMon->Result.NotchActive;
+      Coef        = VibMon->Result.NotchCoef;
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      if (__atomic_load_n(&VibMon->ResultSeq, __ATOMIC_RELAXED) == Seq)
+      {
+         if (NotchActive && !VibMon->NotchActive)
+         {
+            VIB_MON_ResetFilter(VibMon);
+         }
+         VibMon->NotchActive = NotchActive;
+         VibMon->NotchCoef   = Coef;
+         VibMon->NotchSeq    = Seq;
+      }
+   }
+
+   if (!VibMon->NotchActive)
+   {
+      return Rate;
+   }
+
+   if (!VibMon->NotchPrimed)
+   {
+      VibMon->X1 = VibMon->X2 = Rate;
+      VibMon->Y1 = VibMon->Y2 = Rate;
+      VibMon->NotchPrimed = true;
+   }
+
+   Y = C->B0*Rate + C->B1*VibMon->X1 + C->B2*VibMon->X2 - C->A1*VibMon->Y1 - C->A2*VibMon->Y2;
+
+   VibMon->X2 = VibMon->X1;
+   VibMon->X1 = Rate;
+   VibMon->Y2 = VibMon->Y1;
+   VibMon->Y1 = Y;
+
+   return Y;
+
+} /* End VIB_MON_Filter() */
+
+
+/******************************************************************************
+** Function: VIB_MON_GetResult
+**
+*/
+bool VIB_MON_GetResult(const VIB_MON_Class_t *VibMon, VIB_MON_Result_t *Result)
+{
+
+   uint32 Seq;
+   uint16 Try;
+
+   for (Try=0; Try < READ_RETRY; Try++)
+   {
+
+      Seq = __atomic_load_n(&VibMon->ResultSeq, __ATOMIC_ACQUIRE);
+      if (Seq & 1)
+      {
+         continue;
+      }
+
+      *Result = VibMon->Result;
+
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      if (__atomic_load_n(&VibMon->ResultSeq, __ATOMIC_RELAXED) == Seq)
+      {
+         return true;
+      }
+
+   }
+
+   *Result = VibMon->Result;
+
+   return false;
+
+} /* End VIB_MON_GetResult() */
+
+
+/******************************************************************************
+** Function: VIB_MON_ResetFilter
+**
+*/
+void VIB_MON_ResetFilter(VIB_MON_Class_t *VibMon)
+{
+
+   VibMon->NotchPrimed = false;
+   VibMon->X1 = VibMon->X2 = 0.0;
+   VibMon->Y1 = VibMon->Y2 = 0.0;
+
+} /* End VIB_MON_ResetFilter() */
+
+
+/******************************************************************************
+** Function: VIB_MON_ValidNotch
+**
+*/
+bool VIB_MON_ValidNotch(const VIB_MON_NotchParam_t *Param)
+{
+
+   if (Param->Enabled > 1)
+   {
+      CFE_EVS_SendEvent(VIB_MON_NOTCH_EID, CFE_EVS_EventType_ERROR,
+                        "Invalid vibration notch enabled value %d. Must be 0 or 1", Param->Enabled);
+      return false;
+   }
+
+   if (!(Param->Q > 0.0))
+   {
+      CFE_EVS_SendEvent(VIB_MON_NOTCH_EID, CFE_EVS_EventType_ERROR,
+                        "Invalid vibration notch Q %0.4f. Must be greater than 0", Param->Q);
+      return false;
+   }
+
+   if (!(Param->MinAmp > 0.0))
+   {
+      CFE_EVS_SendEvent(VIB_MON_NOTCH_EID, CFE_EVS_EventType_ERROR,
+                        "Invalid vibration notch minimum amplitude %0.6f. Must be greater than 0",
+                        Param->MinAmp);
+      return false;
+   }
+
+   return true;
+
+} /* End VIB_MON_ValidNotch() */
+
+
+/******************************************************************************
+** Function: ComputeSpectrum
+**
+** Compute the magnitude of each bin of the real FFT of Sample.
+*/
+static void ComputeSpectrum(void)
+{
+
+   uint16 Len, Half, Step, Start, j, k, m;
+   uint16 a, b;
+   float  Wr, Wi, Tr, Ti;
+   float  FeR, FeI, FoR, FoI, Xr, Xi;
+
+   for (k=0; k < HALF_LEN; k++)
+   {
+      Re[BitRev[k]] = Sample[2*k];
+      Im[BitRev[k]] = Sample[2*k+1];
+   }
+
+   for (Len=2; Len <= HALF_LEN; Len <<= 1)
+   {
+      Half = Len/2;
+      Step = VIB_MON_FFT_LEN/Len;
+      for (Start=0; Start < HALF_LEN; Start += Len)
+      {
+         for (j=0; j < Half; j++)
+         {
+            Wr = TwCos[j*Step];
+            Wi = -TwSin[j*Step];
+            a  = Start + j;
+            b  = a + Half;
+            Tr = Re[b]*Wr - Im[b]*Wi;
+            Ti = Re[b]*Wi + Im[b]*Wr;
+            Re[b] = Re[a] - Tr;
+            Im[b] = Im[a] - Ti;
+            Re[a] += Tr;
+            Im[a] += Ti;
+         }
+      }
+   }
+
+   for (k=0; k < HALF_LEN; k++)
+   {
+      m   = (HALF_LEN - k) & (HALF_LEN-1);
+      FeR = 0.5*(Re[k] + Re[m]);
+      FeI = 0.5*(Im[k] - Im[m]);
+      FoR = 0.5*(Im[k] + Im[m]);
+      FoI = -0.5*(Re[k] - Re[m]);
+      Wr  = TwCos[k];
+      Wi  = -TwSin[k];
+      Xr  = FeR + Wr*FoR - Wi*FoI;
+      Xi  = FeI + Wr*FoI + Wi*FoR;
+      Mag[k] = sqrtf(Xr*Xr + Xi*Xi);
+   }
+   Mag[HALF_LEN] = fabsf(Re[0] - Im[0]);
+
+} /* End ComputeSpectrum() */
+
+
+/******************************************************************************
+** Function: DesignNotch
+**
+** Design a second order notch at Hz with the bilinear transform.
+*/
+static void DesignNotch(VIB_MON_NotchCoef_t *Coef, float Hz, float SampleHz, float Q)
+{
+
+   double W0    = 2.0*M_PI*Hz/SampleHz;
+   double Alpha = sin(W0)/(2.0*Q);
+   double A0    = 1.0 + Alpha;
+
+   Coef->B0 = 1.0/A0;
+   Coef->B1 = -2.0*cos(W0)/A0;
+   Coef->B2 = Coef->B0;
+   Coef->A1 = Coef->B1;
+   Coef->A2 = (1.0 - Alpha)/A0;
+
+} /* End DesignNotch() */
+
+
+/******************************************************************************
+** Function: FindPeaks
+**
+** Find the strongest local maxima of Mag, strongest first.
+**
+** Notes:
+**   1. A sinusoid's amplitude is 2*|X|/sum(Window) at its frequency.
+**
+*/
+static void FindPeaks(VIB_MON_Peak_t *Peak, float SampleHz)
+{
+
+   VIB_MON_Peak_t New;
+   float  A, B, C, Den, Delta;
+   uint16 k, p;
+
+   memset(Peak, 0, VIB_MON_PEAK_CNT*sizeof(VIB_MON_Peak_t));
+
+   for (k=1; k < HALF_LEN; k++)
+   {
+
+      A = Mag[k-1];
+      B = Mag[k];
+      C = Mag[k+1];
+      if (!(B > A && B >= C))
+      {
+         continue;
+      }
+
+      Den   = A - 2.0*B + C;
+      Delta = (Den < 0.0) ? 0.5*(A - C)/Den : 0.0;
+
+      New.Hz  = ((float)k + Delta) * SampleHz / VIB_MON_FFT_LEN;
+      New.Amp = 2.0*(B - 0.25*(A - C)*Delta) / WindowSum;
+
+      for (p=VIB_MON_PEAK_CNT; p > 0 && New.Amp > Peak[p-1].Amp; p--)
+      {
+         if (p < VIB_MON_PEAK_CNT)
+         {
+            Peak[p] = Peak[p-1];
+         }
+      }
+      if (p < VIB_MON_PEAK_CNT)
+      {
+         Peak[p] = New;
+      }
+
+   } /* End bin loop */
+
+} /* End FindPeaks() */
+
+
+/******************************************************************************
+** Function: InitTables
+**
+*/
+static void InitTables(void)
+{
+
+   uint16 i, Bit, Rev;
+
+   WindowSum = 0.0;
+   for (i=0; i < VIB_MON_FFT_LEN; i++)
+   {
+      Window[i]  = 0.5 - 0.5*cos(2.0*M_PI*i/VIB_MON_FFT_LEN);
+      WindowSum += Window[i];
+   }
+
+   for (i=0; i < HALF_LEN; i++)
+   {
+      TwCos[i] = cos(2.0*M_PI*i/VIB_MON_FFT_LEN);
+      TwSin[i] = sin(2.0*M_PI*i/VIB_MON_FFT_LEN);
+
+      Rev = 0;
+      for (Bit=1; Bit < HALF_LEN; Bit <<= 1)
+      {
+         Rev <<= 1;
+         if (i & Bit)
+         {
+            Rev |= 1;
+         }
+      }
+      BitRev[i] = (uint8)Rev;
+   }
+
+   TablesReady = true;
+
+} /* End InitTables() */
+
+
+/******************************************************************************
+** Function: Publish
+**
+*/
+static void Publish(VIB_MON_Class_t *VibMon, const VIB_MON_Result_t *Result)
+{
+
+   uint32 Seq = __atomic_load_n(&VibMon->ResultSeq, __ATOMIC_RELAXED);
+
+   __atomic_store_n(&VibMon->ResultSeq, Seq + 1, __ATOMIC_RELAXED);
+   __atomic_thread_fence(__ATOMIC_RELEASE);
+
+   VibMon->Result = *Result;
+
+   __atomic_store_n(&VibMon->ResultSeq, Seq + 2, __ATOMIC_RELEASE);
+
+} /* End Publish() */
@@ -0,0 +1,232 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Define the vibration spectrum monitor class
+**
+**  Notes:
+**    1. Each rig owns one VIB_MON object. The rig's worker pushes every
+**       calibrated Z rate sample into a ring and passes it through a notch
+**       filter with VIB_MON_Filter(). The ring holds the samples before the
+**       notch so the analysis sees the vibration the notch is removing.
+**    2. A low priority background task calls VIB_MON_Analyze() for each
+**       rig every few seconds. The newest VIB_MON_FFT_LEN samples have
+**       their mean removed and a Hann window applied, then a real FFT is
+**       computed with one half length complex FFT. The twiddles, window and
+**       bit reversal tables are computed once by the first constructor and
+**       the analysis buffers are file static so nothing is allocated.
+**    3. The VIB_MON_PEAK_CNT strongest spectral peaks are reported. Each
+**       peak's frequency and amplitude are refined by parabolic
+**       interpolation of the peak bin and its neighbors. Frequencies are in
+**       Hz of the control table's filter sample rate and amplitudes are in
+**       the calibrated rate units, radians/sec.
+**    4. When the control table's notch is enabled and the strongest peak
+**       reaches the table's minimum amplitude the analysis designs a notch
+**       at the peak frequency. The notch stays active until the peak falls
+**       below half the minimum so it doesn't chatter at the threshold.
+**    5. The analysis publishes its result with a sequence lock. The worker
+**       copies the notch coefficients when the sequence changes and keeps
+**       its filter state across retunes so tracking a drifting peak doesn't
+**       cause a step. A torn copy is retried on the next sample.
+**
+*/
+
+#ifndef _vib_mon_
+#define _vib_mon_
+
+/*
+** Includes
+*/
+
+#include "app_cfg.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define VIB_MON_RING_LEN   256   /* Power of 2 */
+#define VIB_MON_FFT_LEN    128   /* Power of 2, at most half of VIB_MON_RING_LEN */
+#define VIB_MON_PEAK_CNT     3   /* Must match EDS VibPeakArray */
+
+/*
+** Event Message IDs
+*/
+
+#define VIB_MON_NOTCH_EID  (VIB_MON_BASE_EID + 0)
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+
+/******************************************************************************
+** Table parameters
+*/
+
+typedef struct
+{
+
+   uint16  Enabled;   /* 0 leaves the rate path unfiltered */
+   float   Q;         /* Notch quality factor, center frequency over width */
+   float   MinAmp;    /* Peak amplitude that activates the notch, rad/s */
+
+} VIB_MON_NotchParam_t;
+
+
+/******************************************************************************
+** Notch biquad coefficients, normalized so A0 is 1
+*/
+
+typedef struct
+{
+
+   float   B0, B1, B2;
+   float   A1, A2;
+
+} VIB_MON_NotchCoef_t;
+
+
+typedef struct
+{
+
+   float   Hz;
+   float   Amp;
+
+} VIB_MON_Peak_t;
+
+
+/******************************************************************************
+** Analysis result
+*/
+
+typedef struct
+{
+
+   uint32  SpectrumCnt;    /* Spectra computed */
+   uint32  OverrunCnt;     /* Windows discarded because the ring advanced past them */
+   VIB_MON_Peak_t  Peak[VIB_MON_PEAK_CNT];  /* Strongest first, zero if unused */
+
+   bool    NotchActive;
+   float   NotchHz;
+   VIB_MON_NotchCoef_t  NotchCoef;
+
+} VIB_MON_Result_t;
+
+
+/******************************************************************************
+** VIB_MON_Class
+*/
+
+typedef struct
+{
+
+   uint8   RigIdx;
+
+   /*
+   ** Sample ring, written by the worker
+   */
+
+   float   Ring[VIB_MON_RING_LEN];
+   uint32  Head;           /* Atomic, samples written */
+
+   /*
+   ** Analysis result, written by the background task
+   */
+
+   uint32  ResultSeq;      /* Atomic, odd while Result is written */
+   uint32  AnalyzedHead;   /* Head of the last window analyzed */
+   VIB_MON_Result_t  Result;
+
+   /*
+   ** Notch filter, worker only
+   */
+
+   uint32  NotchSeq;       /* ResultSeq of the coefficients in use */
+   bool    NotchActive;
+   bool    NotchPrimed;
+   VIB_MON_NotchCoef_t  NotchCoef;
+   float   X1, X2;
+   float   Y1, Y2;
+
+} VIB_MON_Class_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: VIB_MON_Constructor
+**
+** Initialize a rig's monitor with an empty ring and the notch inactive.
+**
+** Notes:
+**   1. This must be called prior to any other function and before the
+**      background task starts.
+**
+*/
+void VIB_MON_Constructor(VIB_MON_Class_t *VibMon, uint8 RigIdx);
+
+
+/******************************************************************************
+** Function: VIB_MON_Analyze
+**
+** Compute the spectrum of the newest window and publish its peaks and the
+** notch. Called by the background task. SampleHz is the rate sample rate.
+** Returns false if the ring doesn't hold a new window.
+*/
+bool VIB_MON_Analyze(VIB_MON_Class_t *VibMon, float SampleHz,
+                     const VIB_MON_NotchParam_t *Param);
+
+
+/******************************************************************************
+** Function: VIB_MON_Filter
+**
+** Push a rate sample into the ring and return the notched sample. Only
+** called by the rig's worker.
+*/
+float VIB_MON_Filter(VIB_MON_Class_t *VibMon, float Rate);
+
+
+/******************************************************************************
+** Function: VIB_MON_GetResult
+**
+** Copy the last published analysis result. Returns false if every retry
+** overlapped a publish, Result holds the last torn copy.
+*/
+bool VIB_MON_GetResult(const VIB_MON_Class_t *VibMon, VIB_MON_Result_t *Result);
+
+
+/******************************************************************************
+** Function: VIB_MON_ResetFilter
+**
+** Clear the notch filter state. Called by the worker when the rate path's
+** filters restart.
+*/
+void VIB_MON_ResetFilter(VIB_MON_Class_t *VibMon);
+
+
+/******************************************************************************
+** Function: VIB_MON_ValidNotch
+**
+** Validate the notch table parameters. Sends an error event and returns
+** false if a parameter is invalid.
+*/
+bool VIB_MON_ValidNotch(const VIB_MON_NotchParam_t *Param);
+
+
+#endif /* _vib_mon_ */
@@ -16,7 +16,18 @@
 **   Manage TableSat's sensor topic
 **
 ** Notes:
-**   None
+**   1. Version 1 payloads must contain every sensor field. Version 2
+**      payloads may contain any subset of the fields that is merged into
+**      the last-known-value (LKV) record. Payloads without a "schema"
+**      field are version 1. The gyro die temperature "temp" is optional in
+**      both versions.
+**   2. Every SB message carries the complete LKV record. FreshMask has a
+**      MQTT_GW_TblSatSensorFresh bit set for each field that was in the
+**      message's JSON payload.
+**   3. Sensor messages are built in an SB message buffer and sent with
+**      CFE_SB_TransmitBuffer() so SB doesn't copy them. JsonToCfe returns
+**      false with a NULL message so MQTT_GW doesn't send it again, see
+**      mqtt_install.txt.
 **
 */
 
@@ -40,10 +51,12 @@ static bool LoadJsonData(const char *JsonMsgPayload, uint16 PayloadLen);
 static MQTT_TOPIC_TBLSAT_Class_t *MqttTopicTblSat = NULL;
 
 static MQTT_GW_TblSatSensorTlm_Payload_t TblSatSensor; /* Working buffer for loads */
+static uint32 Schema;
 
 /*
 ** tablesat/sensor payload: 
 ** {
+**     "schema": uint32, optional 1 (default) or 2
 **     "delta-time": uint32,
 **     "rate": {
 **         "x": float,
@@ -53,7 +66,8 @@ static MQTT_GW_TblSatSensorTlm_Payload_t TblSatSensor; /* Working buffer for loa
 **     "lux": {
 **         "a": unit32,
 **         "b": unit32,
-**         }
+**         },
+**     "temp": float, optional
 ** }
 */
 
@@ -68,11 +82,30 @@ static CJSON_Obj_t JsonTblObjs[] =
    { &TblSatSensor.RateY,      4,     false,  JSONNumber, true,   { "rate.y",     (sizeof("rate.y")-1)} },
    { &TblSatSensor.RateZ,      4,     false,  JSONNumber, true,   { "rate.z",     (sizeof("rate.z")-1)} },
    { &TblSatSensor.LuxA,       4,     false,  JSONNumber, false,  { "lux.a",      (sizeof("lux.a")-1)}  },
-   { &TblSatSensor.LuxB,       4,     false,  JSONNumber, false,  { "lux.b",      (sizeof("lux.b")-1)}  }
+   { &TblSatSensor.LuxB,       4,     false,  JSONNumber, false,  { "lux.b",      (sizeof("lux.b")-1)}  },
+   { &TblSatSensor.Temp,       4,     false,  JSONNumber, true,   { "temp",       (sizeof("temp")-1)}   },
+   { &Schema,                  4,     false,  JSONNumber, false,  { "schema",     (sizeof("schema")-1)} }
    
 };
 
-static const char *NullTblSatMsg = "{\"delta-time\": 0,\"rate\":{\"x\": 0.0,\"y\": 0.0,\"z\": 0.0},\"lux\":{\"a\": 0,\"b\": 0}}";
+/* Freshness bit for each sensor object in JsonTblObjs, the schema object is last */
+static const uint16 JsonObjFresh[] = 
+{
+
+   MQTT_GW_TblSatSensorFresh_DELTA_TIME,
+   MQTT_GW_TblSatSensorFresh_RATE_X,
+   MQTT_GW_TblSatSensorFresh_RATE_Y,
+   MQTT_GW_TblSatSensorFresh_RATE_Z,
+   MQTT_GW_TblSatSensorFresh_LUX_A,
+   MQTT_GW_TblSatSensorFresh_LUX_B,
+   MQTT_GW_TblSatSensorFresh_TEMP
+
+};
+
+#define SENSOR_OBJ_CNT   (sizeof(JsonObjFresh)/sizeof(uint16))
+#define SCHEMA_OBJ       SENSOR_OBJ_CNT
+
+static const char *NullTblSatMsg = "{\"delta-time\": 0,\"rate\":{\"x\": 0.0,\"y\": 0.0,\"z\": 0.0},\"lux\":{\"a\": 0,\"b\": 0},\"temp\": 0.0}";
 
 /******************************************************************************
 ** Function: MQTT_TOPIC_TBLSAT_Constructor
@@ -91,6 +124,7 @@ void MQTT_TOPIC_TBLSAT_Constructor(MQTT_TOPIC_TBLSAT_Class_t *MqttTopicTblSatPtr
    memset(MqttTopicTblSat, 0, sizeof(MQTT_TOPIC_TBLSAT_Class_t));
 
    MqttTopicTblSat->JsonObjCnt = (sizeof(JsonTblObjs)/sizeof(CJSON_Obj_t));
+   MqttTopicTblSat->TlmMsgMid  = TlmMsgMid;
    
    CFE_MSG_Init(CFE_MSG_PTR(MqttTopicTblSat->SensorTlmMsg), TlmMsgMid, sizeof(MQTT_GW_TblSatSensorTlm_t));
       
@@ -114,9 +148,9 @@ bool MQTT_TOPIC_TBLSAT_CfeToJson(const char **JsonMsgPayload,
    *JsonMsgPayload = NullTblSatMsg;
    
    PayloadLen = sprintf(MqttTopicTblSat->JsonMsgPayload,
-                "{\"delta-time\": %d,\"rate\":{\"x\": %0.6f,\"y\": %0.6f,\"z\": %0.6f},\"lux\":{\"a\": %d,\"b\": %d}}",
+                "{\"delta-time\": %d,\"rate\":{\"x\": %0.6f,\"y\": %0.6f,\"z\": %0.6f},\"lux\":{\"a\": %d,\"b\": %d},\"temp\": %0.2f}",
                 TblSatMsg->DeltaTime, TblSatMsg->RateX, TblSatMsg->RateY, TblSatMsg->RateZ,
-                TblSatMsg->LuxA, TblSatMsg->LuxB);
+                TblSatMsg->LuxA, TblSatMsg->LuxB, TblSatMsg->Temp);
 
    if (PayloadLen > 0)
    {
@@ -133,28 +167,57 @@ bool MQTT_TOPIC_TBLSAT_CfeToJson(const char **JsonMsgPayload,
 /******************************************************************************
 ** Function: MQTT_TOPIC_TBLSAT_JsonToCfe
 **
-** Convert a cFE tblsat message on the SB causing MQTT_TOPIC_TBLSAT_CfeToJson()
-** to be called which the converts the SB message to a MQTT JSON tblsat topic. 
-** The topic can be observed
+** Convert a JSON tblsat topic message to a cFE tblsat message and send it
+** on the SB.
+**
+** Notes:
+**   1. MQTT_GW only transmits the returned message when this returns true
+**      so false is returned after the zero copy transmit. Returning true
+**      with a NULL CfeMsg would need an MQTT_GW change to skip the NULL
+**      message. JsonToCfeCnt counts the messages that were sent.
 **
 */
 bool MQTT_TOPIC_TBLSAT_JsonToCfe(CFE_MSG_Message_t **CfeMsg, 
                                  const char *JsonMsgPayload, uint16 PayloadLen)
 {
    
-   bool RetStatus = false;
+   CFE_SB_Buffer_t *SbBufPtr;
+   MQTT_GW_TblSatSensorTlm_t *SensorTlmMsg;
+   int32 SbStatus;
    
    *CfeMsg = NULL;
    
    if (LoadJsonData(JsonMsgPayload, PayloadLen))
    {
-      *CfeMsg = (CFE_MSG_Message_t *)&MqttTopicTblSat->SensorTlmMsg;
-
-      ++MqttTopicTblSat->JsonToCfeCnt;
-      RetStatus = true;
+      
+      SbBufPtr = CFE_SB_AllocateMessageBuffer(sizeof(MQTT_GW_TblSatSensorTlm_t));
+      if (SbBufPtr == NULL)
+      {
+         CFE_EVS_SendEvent(MQTT_TOPIC_TBLSAT_JSON_TO_CCSDS_ERR_EID, CFE_EVS_EventType_ERROR, 
+                           "Error sending tblsat message, SB message buffer allocation failed");
+         return false;
+      }
+      
+      SensorTlmMsg = (MQTT_GW_TblSatSensorTlm_t *)SbBufPtr;
+      CFE_MSG_Init(CFE_MSG_PTR(SensorTlmMsg->TelemetryHeader), MqttTopicTblSat->TlmMsgMid, 
+                   sizeof(MQTT_GW_TblSatSensorTlm_t));
+      SensorTlmMsg->Payload = MqttTopicTblSat->Lkv;
+      CFE_SB_TimeStampMsg(CFE_MSG_PTR(SensorTlmMsg->TelemetryHeader));
+      
+      SbStatus = CFE_SB_TransmitBuffer(SbBufPtr, true);
+      if (SbStatus == CFE_SUCCESS)
+      {
+         ++MqttTopicTblSat->JsonToCfeCnt;
+      }
+      else
+      {
+         CFE_SB_ReleaseMessageBuffer(SbBufPtr);
+         CFE_EVS_SendEvent(MQTT_TOPIC_TBLSAT_JSON_TO_CCSDS_ERR_EID, CFE_EVS_EventType_ERROR, 
+                           "Error sending tblsat message, SB transmit status 0x%08X", (unsigned int)SbStatus);
+      }
    }
 
-   return RetStatus;
+   return false;
    
 } /* End MQTT_TOPIC_TBLSAT_JsonToCfe() */
 
@@ -182,6 +245,7 @@ void MQTT_TOPIC_TBLSAT_SbMsgTest(bool Init, int16 Param)
       MqttTopicTblSat->SensorTlmMsg.Payload.RateX     = 3.0;
       MqttTopicTblSat->SensorTlmMsg.Payload.LuxA      = 100;
       MqttTopicTblSat->SensorTlmMsg.Payload.LuxA      = 200;
+      MqttTopicTblSat->SensorTlmMsg.Payload.FreshMask = MQTT_TOPIC_TBLSAT_FRESH_ALL;
 
       CFE_EVS_SendEvent(MQTT_TOPIC_TBLSAT_INIT_SB_MSG_TEST_EID, CFE_EVS_EventType_INFORMATION,
                         "TblSat topic test started");
@@ -202,33 +266,76 @@ void MQTT_TOPIC_TBLSAT_SbMsgTest(bool Init, int16 Param)
 ** Function: LoadJsonData
 **
 ** Notes:
-**  1. See file prologue for full/partial table load scenarios
+**  1. See file prologue for full/partial payload versions
+**  2. The LKV record is only updated by a valid payload.
 */
 static bool LoadJsonData(const char *JsonMsgPayload, uint16 PayloadLen)
 {
 
+   MQTT_GW_TblSatSensorTlm_Payload_t *Lkv = &MqttTopicTblSat->Lkv;
    bool      RetStatus = false;
    size_t    ObjLoadCnt;
+   size_t    SensorCnt = 0;
+   uint16    FreshMask = 0;
+   uint8     i;
 
-   memset(&MqttTopicTblSat->SensorTlmMsg.Payload, 0, sizeof(MQTT_GW_TblSatSensorTlm_Payload_t));
+   for (i=0; i < MqttTopicTblSat->JsonObjCnt; i++)
+   {
+      JsonTblObjs[i].Updated = false;
+   }
+   Schema = MQTT_TOPIC_TBLSAT_SCHEMA_FULL;
+   
    ObjLoadCnt = CJSON_LoadObjArray(JsonTblObjs, MqttTopicTblSat->JsonObjCnt, 
                                    JsonMsgPayload, PayloadLen);
    CFE_EVS_SendEvent(MQTT_TOPIC_TBLSAT_LOAD_JSON_DATA_EID, CFE_EVS_EventType_DEBUG,
                      "TblSat LoadJsonData() processed %d JSON objects", (uint16)ObjLoadCnt);
 
-   if (ObjLoadCnt == MqttTopicTblSat->JsonObjCnt)
+   for (i=0; i < SENSOR_OBJ_CNT; i++)
    {
-      memcpy(&MqttTopicTblSat->SensorTlmMsg.Payload, &TblSatSensor, sizeof(MQTT_GW_TblSatSensorTlm_Payload_t));      
-      RetStatus = true;
+      if (JsonTblObjs[i].Updated)
+      {
+         FreshMask |= JsonObjFresh[i];
+         SensorCnt++;
+      }
    }
-   else
+
+   if (Schema == MQTT_TOPIC_TBLSAT_SCHEMA_FULL && 
+       (FreshMask & MQTT_TOPIC_TBLSAT_FRESH_ALL) != MQTT_TOPIC_TBLSAT_FRESH_ALL)
    {
       CFE_EVS_SendEvent(MQTT_TOPIC_TBLSAT_JSON_TO_CCSDS_ERR_EID, CFE_EVS_EventType_ERROR, 
-                        "Error processing tblsat message, payload contained %d of %d data objects",
-                        (unsigned int)ObjLoadCnt, (unsigned int)MqttTopicTblSat->JsonObjCnt);
+                        "Error processing tblsat message, payload fresh mask 0x%04X is missing required objects 0x%04X",
+                        FreshMask, MQTT_TOPIC_TBLSAT_FRESH_ALL);
+   }
+   else if (Schema == MQTT_TOPIC_TBLSAT_SCHEMA_PARTIAL && SensorCnt == 0)
+   {
+      CFE_EVS_SendEvent(MQTT_TOPIC_TBLSAT_JSON_TO_CCSDS_ERR_EID, CFE_EVS_EventType_ERROR, 
+                        "Error processing tblsat message, partial payload contained no data objects");
+   }
+   else if (Schema != MQTT_TOPIC_TBLSAT_SCHEMA_FULL && Schema != MQTT_TOPIC_TBLSAT_SCHEMA_PARTIAL)
+   {
+      CFE_EVS_SendEvent(MQTT_TOPIC_TBLSAT_JSON_TO_CCSDS_ERR_EID, CFE_EVS_EventType_ERROR, 
+                        "Error processing tblsat message, unsupported schema version %u",
+                        (unsigned int)Schema);
+   }
+   else
+   {
+      
+      if (FreshMask & MQTT_GW_TblSatSensorFresh_DELTA_TIME) Lkv->DeltaTime = TblSatSensor.DeltaTime;
+      if (FreshMask & MQTT_GW_TblSatSensorFresh_RATE_X)     Lkv->RateX     = TblSatSensor.RateX;
+      if (FreshMask & MQTT_GW_TblSatSensorFresh_RATE_Y)     Lkv->RateY     = TblSatSensor.RateY;
+      if (FreshMask & MQTT_GW_TblSatSensorFresh_RATE_Z)     Lkv->RateZ     = TblSatSensor.RateZ;
+      if (FreshMask & MQTT_GW_TblSatSensorFresh_LUX_A)      Lkv->LuxA      = TblSatSensor.LuxA;
+      if (FreshMask & MQTT_GW_TblSatSensorFresh_LUX_B)      Lkv->LuxB      = TblSatSensor.LuxB;
+      if (FreshMask & MQTT_GW_TblSatSensorFresh_TEMP)       Lkv->Temp      = TblSatSensor.Temp;
+      Lkv->FreshMask = FreshMask;
+      
+      if (Schema == MQTT_TOPIC_TBLSAT_SCHEMA_PARTIAL)
+      {
+         MqttTopicTblSat->PartialMsgCnt++;
+      }
+      RetStatus = true;
    }
    
    return RetStatus;
    
 } /* End LoadJsonData() */
-
@@ -17,6 +17,8 @@
 **
 ** Notes:
 **   1. The JSON payload format is defined in the .c file.
+**   2. Partial (schema 2) payloads are merged into a last-known-value
+**      record so slow sensors only need to publish new readings.
 **
 */
 
@@ -34,6 +36,17 @@
 /** Macro Definitions **/
 /***********************/
 
+#define MQTT_TOPIC_TBLSAT_SCHEMA_FULL     1  /* Every sensor field required */
+#define MQTT_TOPIC_TBLSAT_SCHEMA_PARTIAL  2  /* Any subset, merged into the LKV record */
+
+/* Fields a version 1 payload must contain, the die temperature is optional */
+#define MQTT_TOPIC_TBLSAT_FRESH_ALL  (MQTT_GW_TblSatSensorFresh_DELTA_TIME | \
+                                      MQTT_GW_TblSatSensorFresh_RATE_X     | \
+                                      MQTT_GW_TblSatSensorFresh_RATE_Y     | \
+                                      MQTT_GW_TblSatSensorFresh_RATE_Z     | \
+                                      MQTT_GW_TblSatSensorFresh_LUX_A      | \
+                                      MQTT_GW_TblSatSensorFresh_LUX_B)
+
 
 /*
 ** Event Message IDs
@@ -62,9 +75,12 @@ typedef struct
    ** Table Sat Telemetry
    */
    
-   MQTT_GW_TblSatSensorTlm_t  SensorTlmMsg;
+   CFE_SB_MsgId_t             TlmMsgMid;
+   MQTT_GW_TblSatSensorTlm_t  SensorTlmMsg;   /* Only used by SbMsgTest */
    char JsonMsgPayload[1024];
 
+   MQTT_GW_TblSatSensorTlm_Payload_t  Lkv;   /* Last known value of each sensor field */
+
    /*
    ** Subset of the standard CJSON table data because this isn't using the
    ** app_c_fw table manager service, but is using core-json in the same way
@@ -74,6 +90,7 @@ typedef struct
 
    uint32  CfeToJsonCnt;
    uint32  JsonToCfeCnt;
+   uint32  PartialMsgCnt;
    
    
 } MQTT_TOPIC_TBLSAT_Class_t;
@@ -112,10 +129,13 @@ bool MQTT_TOPIC_TBLSAT_CfeToJson(const char **JsonMsgPayload,
 /******************************************************************************
 ** Function: MQTT_TOPIC_TBLSAT_JsonToCfe
 **
-** Convert a JSON tblsat topic message to a cFE tblsat message 
+** Convert a JSON tblsat topic message to a cFE tblsat message and send it
+** using a zero copy SB buffer
 **
 ** Notes:
 **   1.  Signature must match MQTT_TOPIC_TBL_JsonToCfe_t
+**   2.  Always returns false with a NULL CfeMsg because the message has
+**       already been sent, see the .c file
 */
 bool MQTT_TOPIC_TBLSAT_JsonToCfe(CFE_MSG_Message_t **CfeMsg, 
                                  const char *JsonMsgPayload, uint16 PayloadLen);
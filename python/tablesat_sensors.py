@@ -52,6 +52,13 @@ EMQX_CLIENT_NAME = "tablesat"
 
 SENSOR_LOOP_DELAY = 0.5
 
+# Schema 2 payloads are partial, TBL_SAT merges them into its last known
+# values. Rates are sent every loop and light only when a reading changes
+# or LUX_PUBLISH_PERIOD seconds have passed since it was last sent. The
+# gyro's die temperature is sent every loop for TBL_SAT's bias estimator.
+SENSOR_SCHEMA      = 2
+LUX_PUBLISH_PERIOD = 5.0
+
 # This is for a second I2C bus but I couldn't get
 # busio.I2C(I2C_B_SCL,I2C_B_SDA) to work
 I2C_B_SCL = 12
@@ -62,6 +69,9 @@ I2C_B_SDA = 16
 mqtt_client    = None
 mqtt_connected = False
 
+lux_last_value = None
+lux_last_time  = 0.0
+
 def mqtt_on_connect(client, userdata, flags, rc):
     """
     """
@@ -180,14 +190,24 @@ def publish_sensor_data(delta_time,lsm330,ltr329,ltr390):
     """
     global mqtt_client, mqtt_connected 
     global emqx_client, emqx_connected 
+    global lux_last_value, lux_last_time
     #print("Acceleration: X:%.2f, Y: %.2f, Z: %.2f m/s^2" % (self.sensor.acceleration))
     #print("Gyro X:%.2f, Y: %.2f, Z: %.2f radians/s\n" % (self.sensor.gyro))
     coord_payload = '{ "coord": {"x": %2f, "y": %2f, "z": %2f} }' % \
                      (lsm330.gyro[0], lsm330.gyro[1], lsm330.gyro[2])         
     payload = '{ "ir_light": {"a": %d, "b": %2d} }' % \
               (ltr329.ir_light, ltr390.uvs)
-    payload = '{ "delta-time": %.9f,"rate": {"x": %0.6f, "y": %0.6f, "z": %0.6f}, "lux": { "a": %d, "b": %d}}' % \
-              ( delta_time, lsm330.gyro[0], lsm330.gyro[1], lsm330.gyro[2], ltr329.visible_plus_ir_light, ltr390.light)
+    lux = (ltr329.visible_plus_ir_light, ltr390.light)
+    lux_payload = ''
+    if lux != lux_last_value or (time.time() - lux_last_time) >= LUX_PUBLISH_PERIOD:
+        lux_payload = ', "lux": { "a": %d, "b": %d}' % lux
+        lux_last_value = lux
+        lux_last_time  = time.time()
+    temp_payload = ''
+    if hasattr(lsm330, 'temperature'):
+        temp_payload = ', "temp": %0.2f' % lsm330.temperature
+    payload = '{ "schema": %d, "delta-time": %.9f,"rate": {"x": %0.6f, "y": %0.6f, "z": %0.6f}%s%s}' % \
+              ( SENSOR_SCHEMA, delta_time, lsm330.gyro[0], lsm330.gyro[1], lsm330.gyro[2], temp_payload, lux_payload)
     if mqtt_connected:
         #print(f'Publishing telemetry {MQTT_TOPIC}, {payload}')
         mqtt_client.publish(MQTT_TOPIC, payload)
@@ -0,0 +1,164 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Print the Table Sat controller state from the shared memory segment
+**
+**  Notes:
+**    1. A minimal local dashboard and an example of the reader library.
+**       By default each rig's snapshot is printed every poll period. -c
+**       prints a rig's cycle history once and exits.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "tbl_sat_shm_reader.h"
+
+
+/************************************/
+/** Local File Function Prototypes **/
+/************************************/
+
+static void PrintHistory(const TBL_SAT_SHM_Rig_t *Copy, unsigned Rig);
+static void PrintSnapshot(const TBL_SAT_SHM_Rig_t *Copy, unsigned Rig);
+static void PrintUsage(const char *Prog);
+
+
+/******************************************************************************
+** Function: main
+**
+*/
+int main(int argc, char *argv[])
+{
+
+   TBL_SAT_SHM_Reader_t Reader;
+   TBL_SAT_SHM_Rig_t    Copy;
+   const char *Name = TBL_SAT_SHM_DEF_NAME;
+   unsigned PeriodMs = 500;
+   int      HistoryRig = -1;
+   unsigned Rig;
+   int      Opt, Err;
+
+   while ((Opt = getopt(argc, argv, "n:p:c:")) != -1)
+   {
+      switch (Opt)
+      {
+         case 'n': Name = optarg; break;
+         case 'p': PeriodMs = (unsigned)atoi(optarg); break;
+         case 'c': HistoryRig = atoi(optarg); break;
+         default:
+            PrintUsage(argv[0]);
+            return EXIT_FAILURE;
+      }
+   }
+
+   if ((Err = TBL_SAT_SHM_Open(&Reader, Name)) != 0)
+   {
+      fprintf(stderr, "Failed to open shared memory segment %s: %s\n", Name,
+              (Err == EPROTO) ? "layout mismatch" : strerror(Err));
+      return EXIT_FAILURE;
+   }
+
+   if (HistoryRig >= 0)
+   {
+      if (!TBL_SAT_SHM_ReadRig(&Reader, (unsigned)HistoryRig, &Copy))
+      {
+         fprintf(stderr, "Rig %d can't be read\n", HistoryRig);
+         TBL_SAT_SHM_Close(&Reader);
+         return EXIT_FAILURE;
+      }
+      PrintHistory(&Copy, (unsigned)HistoryRig);
+      TBL_SAT_SHM_Close(&Reader);
+      return EXIT_SUCCESS;
+   }
+
+   for (;;)
+   {
+      for (Rig=0; Rig < TBL_SAT_SHM_RigCnt(&Reader); Rig++)
+      {
+         if (TBL_SAT_SHM_ReadRig(&Reader, Rig, &Copy))
+         {
+            PrintSnapshot(&Copy, Rig);
+         }
+      }
+      fflush(stdout);
+      usleep(PeriodMs * 1000);
+   }
+
+   return EXIT_SUCCESS;
+
+} /* End main() */
+
+
+/******************************************************************************
+** Function: PrintHistory
+**
+*/
+static void PrintHistory(const TBL_SAT_SHM_Rig_t *Copy, unsigned Rig)
+{
+
+   TBL_SAT_SHM_Cycle_t Cycle[TBL_SAT_SHM_HISTORY_LEN];
+   unsigned Cnt = TBL_SAT_SHM_History(Copy, Cycle, TBL_SAT_SHM_HISTORY_LEN);
+   unsigned i;
+
+   printf("rig,time_ms,cycle,mode,sun_acq_state,total_light,spin_rate,pos_err,rate_err,fan_a_pwm,fan_b_pwm\n");
+   for (i=0; i < Cnt; i++)
+   {
+      printf("%u,%llu,%u,%u,%u,%u,%.4f,%.4f,%.4f,%u,%u\n", Rig,
+             (unsigned long long)Cycle[i].TimeMs, Cycle[i].Cycle, Cycle[i].CtrlMode,
+             Cycle[i].SunAcqState, Cycle[i].TotalLight, Cycle[i].SpinRate,
+             Cycle[i].PosErr, Cycle[i].RateErr, Cycle[i].FanPwmCmd[0], Cycle[i].FanPwmCmd[1]);
+   }
+
+} /* End PrintHistory() */
+
+
+/******************************************************************************
+** Function: PrintSnapshot
+**
+*/
+static void PrintSnapshot(const TBL_SAT_SHM_Rig_t *Copy, unsigned Rig)
+{
+
+   const TBL_SAT_SHM_Snapshot_t *Snap = &Copy->Snapshot;
+
+   printf("rig %u cycle %6u mode %u state %u light %6u spin %8.3f pos_err %8.3f rate_err %8.3f fan %4u %4u\n",
+          Rig, Snap->Cycle, Snap->CtrlMode, Snap->SunAcqState, Snap->TotalLight,
+          Snap->SpinRate, Snap->PosErr, Snap->RateErr, Snap->FanPwmCmd[0], Snap->FanPwmCmd[1]);
+
+} /* End PrintSnapshot() */
+
+
+/******************************************************************************
+** Function: PrintUsage
+**
+*/
+static void PrintUsage(const char *Prog)
+{
+
+   fprintf(stderr,
+      "Usage: %s [options]\n"
+      "  -n name   Shared memory object name (" TBL_SAT_SHM_DEF_NAME ")\n"
+      "  -p ms     Poll period (500)\n"
+      "  -c rig    Print the rig's cycle history as CSV and exit\n", Prog);
+
+} /* End PrintUsage() */
@@ -0,0 +1,196 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Implement the shared memory telemetry reader library
+**
+**  Notes:
+**    1. See tbl_sat_shm_reader.h for details. The acquire fence after the
+**       slot copy keeps the second read of Seq from being performed before
+**       the copy.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "tbl_sat_shm_reader.h"
+
+
+/******************************************************************************
+** Function: TBL_SAT_SHM_Open
+**
+*/
+int TBL_SAT_SHM_Open(TBL_SAT_SHM_Reader_t *Reader, const char *Name)
+{
+
+   const TBL_SAT_SHM_Segment_t *Segment;
+   struct stat Stat;
+   void *Addr;
+   int   Fd;
+   int   Err;
+
+   memset(Reader, 0, sizeof(TBL_SAT_SHM_Reader_t));
+
+   Fd = shm_open(Name, O_RDONLY, 0);
+   if (Fd < 0)
+   {
+      return errno;
+   }
+
+   if (fstat(Fd, &Stat) != 0)
+   {
+      Err = errno;
+      close(Fd);
+      return Err;
+   }
+
+   if ((size_t)Stat.st_size < sizeof(TBL_SAT_SHM_Segment_t))
+   {
+      close(Fd);
+      return EPROTO;
+   }
+
+   Addr = mmap(NULL, sizeof(TBL_SAT_SHM_Segment_t), PROT_READ, MAP_SHARED, Fd, 0);
+   Err  = errno;
+   close(Fd);
+
+   if (Addr == MAP_FAILED)
+   {
+      return Err;
+   }
+
+   Segment = (const TBL_SAT_SHM_Segment_t *)Addr;
+   if (__atomic_load_n(&Segment->Magic, __ATOMIC_ACQUIRE) != TBL_SAT_SHM_MAGIC ||
+       Segment->Version != TBL_SAT_SHM_VERSION ||
+       Segment->Size    != sizeof(TBL_SAT_SHM_Segment_t))
+   {
+      munmap(Addr, sizeof(TBL_SAT_SHM_Segment_t));
+      return EPROTO;
+   }
+
+   Reader->Segment = Segment;
+   Reader->MapSize = sizeof(TBL_SAT_SHM_Segment_t);
+
+   return 0;
+
+} /* End TBL_SAT_SHM_Open() */
+
+
+/******************************************************************************
+** Function: TBL_SAT_SHM_Close
+**
+*/
+void TBL_SAT_SHM_Close(TBL_SAT_SHM_Reader_t *Reader)
+{
+
+   if (Reader->Segment != NULL)
+   {
+      munmap((void *)Reader->Segment, Reader->MapSize);
+   }
+   memset(Reader, 0, sizeof(TBL_SAT_SHM_Reader_t));
+
+} /* End TBL_SAT_SHM_Close() */
+
+
+/******************************************************************************
+** Function: TBL_SAT_SHM_RigCnt
+**
+*/
+unsigned TBL_SAT_SHM_RigCnt(const TBL_SAT_SHM_Reader_t *Reader)
+{
+
+   return (Reader->Segment == NULL) ? 0 : Reader->Segment->RigCnt;
+
+} /* End TBL_SAT_SHM_RigCnt() */
+
+
+/******************************************************************************
+** Function: TBL_SAT_SHM_ReadRig
+**
+*/
+bool TBL_SAT_SHM_ReadRig(const TBL_SAT_SHM_Reader_t *Reader, unsigned Rig,
+                         TBL_SAT_SHM_Rig_t *Copy)
+{
+
+   const TBL_SAT_SHM_Rig_t *Slot;
+   uint32_t SeqBefore, SeqAfter;
+   unsigned Try;
+
+   if (Rig >= TBL_SAT_SHM_RigCnt(Reader) || Rig >= TBL_SAT_SHM_MAX_RIG)
+   {
+      return false;
+   }
+
+   Slot = &Reader->Segment->Rig[Rig];
+
+   for (Try=0; Try < TBL_SAT_SHM_READ_RETRY; Try++)
+   {
+
+      SeqBefore = __atomic_load_n(&Slot->Seq, __ATOMIC_ACQUIRE);
+      if (SeqBefore & 1)
+      {
+         continue;
+      }
+
+      memcpy(Copy, Slot, sizeof(TBL_SAT_SHM_Rig_t));
+
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      SeqAfter = __atomic_load_n(&Slot->Seq, __ATOMIC_RELAXED);
+
+      if (SeqAfter == SeqBefore)
+      {
+         return true;
+      }
+
+   }
+
+   return false;
+
+} /* End TBL_SAT_SHM_ReadRig() */
+
+
+/******************************************************************************
+** Function: TBL_SAT_SHM_History
+**
+*/
+unsigned TBL_SAT_SHM_History(const TBL_SAT_SHM_Rig_t *Copy, TBL_SAT_SHM_Cycle_t *Cycle,
+                             unsigned MaxCnt)
+{
+
+   unsigned Cnt = (Copy->HistoryCnt < TBL_SAT_SHM_HISTORY_LEN) ? Copy->HistoryCnt : TBL_SAT_SHM_HISTORY_LEN;
+   uint32_t First;
+   unsigned i;
+
+   if (Cnt > MaxCnt)
+   {
+      Cnt = MaxCnt;
+   }
+
+   First = Copy->HistoryCnt - Cnt;
+   for (i=0; i < Cnt; i++)
+   {
+      Cycle[i] = Copy->History[(First + i) & (TBL_SAT_SHM_HISTORY_LEN-1)];
+   }
+
+   return Cnt;
+
+} /* End TBL_SAT_SHM_History() */
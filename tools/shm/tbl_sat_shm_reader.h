@@ -0,0 +1,114 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Define the shared memory telemetry reader library
+**
+**  Notes:
+**    1. The reader maps the app's shared memory segment read-only and
+**       copies a consistent rig slot using the slot's sequence lock, see
+**       fsw/src/tbl_sat_shm.h. It has no cFS dependencies so any local
+**       process can link it.
+**    2. A reader never blocks the app. A copy that overlaps a write is
+**       retried up to TBL_SAT_SHM_READ_RETRY times.
+**    3. The app clears the segment when it restarts. A reader that sees
+**       a rig's Cycle or HistoryCnt go backwards should discard the history
+**       it has accumulated.
+**
+*/
+
+#ifndef _tbl_sat_shm_reader_
+#define _tbl_sat_shm_reader_
+
+/*
+** Includes
+*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "tbl_sat_shm.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define TBL_SAT_SHM_DEF_NAME     "/tbl_sat"   /* Default ini file SHM_EXPORT_NAME */
+#define TBL_SAT_SHM_READ_RETRY   100
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+typedef struct
+{
+
+   const TBL_SAT_SHM_Segment_t *Segment;
+   size_t  MapSize;
+
+} TBL_SAT_SHM_Reader_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: TBL_SAT_SHM_Open
+**
+** Map the named segment read-only and verify its layout. Returns 0 on
+** success, otherwise an errno value. EPROTO means the segment's magic,
+** version or size doesn't match this header.
+*/
+int TBL_SAT_SHM_Open(TBL_SAT_SHM_Reader_t *Reader, const char *Name);
+
+
+/******************************************************************************
+** Function: TBL_SAT_SHM_Close
+**
+*/
+void TBL_SAT_SHM_Close(TBL_SAT_SHM_Reader_t *Reader);
+
+
+/******************************************************************************
+** Function: TBL_SAT_SHM_RigCnt
+**
+** Return the number of rigs the app publishes.
+*/
+unsigned TBL_SAT_SHM_RigCnt(const TBL_SAT_SHM_Reader_t *Reader);
+
+
+/******************************************************************************
+** Function: TBL_SAT_SHM_ReadRig
+**
+** Copy a consistent snapshot of a rig's slot. Returns false if Rig is
+** invalid or every retry overlapped a write.
+*/
+bool TBL_SAT_SHM_ReadRig(const TBL_SAT_SHM_Reader_t *Reader, unsigned Rig,
+                         TBL_SAT_SHM_Rig_t *Copy);
+
+
+/******************************************************************************
+** Function: TBL_SAT_SHM_History
+**
+** Copy up to MaxCnt of the newest history entries from a slot copy into
+** Cycle, oldest first. Returns the number of entries copied.
+*/
+unsigned TBL_SAT_SHM_History(const TBL_SAT_SHM_Rig_t *Copy, TBL_SAT_SHM_Cycle_t *Cycle,
+                             unsigned MaxCnt);
+
+
+#endif /* _tbl_sat_shm_reader_ */
@@ -0,0 +1,26 @@
+/*
+**  Purpose:
+**    Provide the OSAL scalar types to the cFE-free flight modules when they
+**    are built into host tools.
+**
+**  Notes:
+**    1. Only the types used by sun_acq and sim_plant are defined.
+**
+*/
+
+#ifndef _common_types_
+#define _common_types_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef int8_t    int8;
+typedef int16_t   int16;
+typedef int32_t   int32;
+typedef int64_t   int64;
+typedef uint8_t   uint8;
+typedef uint16_t  uint16;
+typedef uint32_t  uint32;
+typedef uint64_t  uint64;
+
+#endif /* _common_types_ */
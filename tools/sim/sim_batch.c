@@ -0,0 +1,548 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Implement the batched Table Sat plant and sun acquisition kernel
+**
+**  Notes:
+**    1. See sim_batch.h for details.
+**    2. Keep the lane loop bodies free of calls and data dependent
+**       branches, conditional assignments compile to SIMD selects. Build
+**       with -fopt-info-vec to confirm the loops still vectorize after a
+**       change.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <string.h>
+#include <math.h>
+#include "sim_batch.h"
+
+#define DEG_2_RAD  0.017453292f
+#define RAD_2_DEG  57.29578f
+
+#define THRUST_SNAP  1.0e-9f  /* Newtons, see PlantUpdate() */
+
+#define U24_SCALE  (1.0f / 16777216.0f)
+#define SQRT_3     1.7320508f
+
+/* Advance a lane's xorshift32 state X and set U to a uniform in [0,1) */
+#define NEXT_UNIFORM(X,U) { X ^= X << 13; X ^= X >> 17; X ^= X << 5; \
+                            U = (float)(int32)(X >> 8) * U24_SCALE; }
+
+
+/************************************/
+/** Local File Function Prototypes **/
+/************************************/
+
+static void PlantUpdate(SIM_BATCH_Class_t *Batch, float Time);
+static void SensorUpdate(SIM_BATCH_Class_t *Batch, float Time, float SensorPeriod);
+
+
+/******************************************************************************
+** Function: SIM_BATCH_Constructor
+**
+*/
+void SIM_BATCH_Constructor(SIM_BATCH_Class_t *Batch, const SIM_PLANT_Param_t *Plant,
+                           const float *Alloc, double PlantStep, double SensorPeriod,
+                           double SettleTol)
+{
+
+   uint8 i;
+
+   memset(Batch, 0, sizeof(SIM_BATCH_Class_t));
+
+   Batch->Plant = *Plant;
+   for (i=0; i < Plant->FanCnt && i < SIM_PLANT_MAX_FAN; i++)
+   {
+      Batch->Alloc[i] = Alloc[i];
+   }
+
+   Batch->PlantStep    = (float)PlantStep;
+   Batch->FanLag       = (float)exp(-PlantStep / Plant->FanTimeConst);
+   Batch->ThrustPerPwm = (float)(Plant->FanMaxThrust / SIM_PLANT_PWM_MAX);
+   Batch->RateStep     = (float)(PlantStep / Plant->Inertia);
+   Batch->SettleTol    = (float)SettleTol;
+   Batch->LuxExponent  = (int32)lround(Plant->LuxExponent);
+   Batch->SensorSteps  = (uint32)lround(SensorPeriod / PlantStep);
+   if (Batch->SensorSteps < 1) Batch->SensorSteps = 1;
+
+} /* End SIM_BATCH_Constructor() */
+
+
+/******************************************************************************
+** Function: SIM_BATCH_InitLane
+**
+*/
+void SIM_BATCH_InitLane(SIM_BATCH_Class_t *Batch, uint32 Lane, const SUN_ACQ_Param_t *Ctrl,
+                        double Angle, double Rate, double GyroNoise, double LuxNoise,
+                        double Latency, uint32 Seed)
+{
+
+   uint8 i;
+
+   if (Lane >= SIM_BATCH_LANES) return;
+
+   Batch->State[Lane]        = SUN_ACQ_STATE_SURVEY;
+   Batch->SurveyFanPwm[Lane] = Ctrl->SurveyFanPwm;
+   Batch->PosGain[Lane]      = Ctrl->PosGain;
+   Batch->RateGain[Lane]     = Ctrl->RateGain;
+   Batch->Effort[Lane]       = 0.0f;
+   Batch->Ctrl[Lane]         = 0.0f;
+   Batch->SurveyMaxLight[Lane]      = 0.0f;
+   Batch->SurveyMaxLightAngle[Lane] = 0.0f;
+   Batch->SurveyRotation[Lane]      = 0.0f;
+   Batch->Rotation[Lane]            = 0.0f;
+   Batch->SourceAngle[Lane]         = 0.0f;
+   Batch->Slew = Ctrl->Slew;
+
+   Batch->FitCnt[Lane]       = 0;
+   Batch->FitPrevValid[Lane] = 0;
+   Batch->FitPrevRate[Lane]  = 0.0f;
+   Batch->FitX[Lane]         = 0.0f;
+   Batch->FitY[Lane]         = 0.0f;
+   Batch->FitXX[Lane]        = 0.0f;
+   Batch->FitXY[Lane]        = 0.0f;
+   Batch->ModelValid[Lane]   = 0;
+   Batch->SlewAccel[Lane]    = 0.0f;
+   Batch->SlewFriction[Lane] = 0.0f;
+
+   for (i=0; i < SUN_ACQ_PROFILE_BINS; i++)
+   {
+      Batch->ProfileLight[i][Lane] = 0.0f;
+      Batch->ProfileCnt[i][Lane]   = 0;
+   }
+
+   Batch->LatencySteps[Lane] = (int32)ceil(Latency / Batch->PlantStep);
+   Batch->Countdown[Lane]    = -1;
+   for (i=0; i < SIM_PLANT_MAX_FAN; i++)
+   {
+      Batch->PendingPwm[i][Lane] = 0.0f;
+      Batch->Pwm[i][Lane]        = 0.0f;
+      Batch->Thrust[i][Lane]     = 0.0f;
+   }
+
+   Batch->Angle[Lane]     = (float)(fmod(fmod(Angle, 360.0) + 360.0, 360.0));
+   Batch->Rate[Lane]      = (float)Rate;
+   Batch->GyroNoise[Lane] = (float)GyroNoise;
+   Batch->LuxNoise[Lane]  = (float)LuxNoise;
+   Batch->Rng[Lane]       = (Seed != 0) ? Seed : 0x9E3779B9;
+
+   Batch->Acquired[Lane]    = 0;
+   Batch->Settled[Lane]     = 0;
+   Batch->AcquireTime[Lane] = 0.0f;
+   Batch->SettleTime[Lane]  = 0.0f;
+   Batch->PointingErr[Lane] = 0.0f;
+
+} /* End SIM_BATCH_InitLane() */
+
+
+/******************************************************************************
+** Function: SIM_BATCH_Run
+**
+** Notes:
+**   1. Time is kept as a step count so every lane sees the same sensor
+**      schedule as the scalar path's accumulated time.
+**
+*/
+void SIM_BATCH_Run(SIM_BATCH_Class_t *Batch, double Duration)
+{
+
+   uint32 StepCnt = (uint32)ceil(Duration / Batch->PlantStep);
+   float  SensorPeriod = Batch->PlantStep * (float)Batch->SensorSteps;
+
+   for (Batch->Step=0; Batch->Step < StepCnt; Batch->Step++)
+   {
+      if ((Batch->Step % Batch->SensorSteps) == 0)
+      {
+         SensorUpdate(Batch, Batch->PlantStep * (float)Batch->Step, SensorPeriod);
+      }
+      PlantUpdate(Batch, Batch->PlantStep * (float)(Batch->Step + 1));
+   }
+
+} /* End SIM_BATCH_Run() */
+
+
+/******************************************************************************
+** Function: PlantUpdate
+**
+** Apply due fan commands, advance the plant one step and track settling.
+** Time is the time at the end of the step.
+**
+** Notes:
+**   1. Follows SIM_PLANT_Step() including the Coulomb friction stiction and
+**      no-reversal rules.
+**   2. A fan spinning down decays toward zero thrust and would reach single
+**      precision denormals, which are many times slower on most FPUs, within
+**      a minute. The thrust snaps to its target once it's within THRUST_SNAP.
+**
+*/
+static void PlantUpdate(SIM_BATCH_Class_t *Batch, float Time)
+{
+
+   const float Lag   = Batch->FanLag;
+   const float Visc  = (float)Batch->Plant.ViscousFriction;
+   const float Coul  = (float)Batch->Plant.CoulombFriction;
+   const float Sun   = (float)Batch->Plant.SunAngle;
+   const float Dt    = Batch->PlantStep;
+   const float Tol   = Batch->SettleTol;
+   float  Arm, Target, Thrust, Pending, Current, Torque, Sign, NewRate, Err, AbsErr, AbsFan;
+   int32  Stuck, Reversed, InTol;
+   uint32 i;
+   uint8  f;
+
+   for (f=0; f < Batch->Plant.FanCnt; f++)
+   {
+      for (i=0; i < SIM_BATCH_LANES; i++)
+      {
+         Pending = Batch->PendingPwm[f][i];
+         Current = Batch->Pwm[f][i];
+         Batch->Pwm[f][i] = (Batch->Countdown[i] == 0) ? Pending : Current;
+      }
+   }
+
+   for (i=0; i < SIM_BATCH_LANES; i++)
+   {
+      Batch->Countdown[i] = (Batch->Countdown[i] >= 0) ? Batch->Countdown[i] - 1 : -1;
+      Batch->FanTorque[i] = 0.0f;
+   }
+
+   for (f=0; f < Batch->Plant.FanCnt; f++)
+   {
+      Arm = (float)Batch->Plant.FanArm[f];
+      for (i=0; i < SIM_BATCH_LANES; i++)
+      {
+         Target = Batch->Pwm[f][i] * Batch->ThrustPerPwm;
+         Thrust = Target + (Batch->Thrust[f][i] - Target) * Lag;
+         Batch->Thrust[f][i]  = (fabsf(Thrust - Target) < THRUST_SNAP) ? Target : Thrust;
+         Batch->FanTorque[i] += Arm * Batch->Thrust[f][i];
+      }
+   }
+
+   for (i=0; i < SIM_BATCH_LANES; i++)
+   {
+      AbsFan = fabsf(Batch->FanTorque[i]);
+      Stuck  = (Batch->Rate[i] == 0.0f) & (AbsFan <= Coul);
+
+      Sign = (Batch->Rate[i] != 0.0f) ? Batch->Rate[i] : Batch->FanTorque[i];
+      Sign = (Sign > 0.0f) ? 1.0f : -1.0f;
+      Torque  = Batch->FanTorque[i] - Visc * Batch->Rate[i] - Coul * Sign;
+      NewRate = Batch->Rate[i] + Torque * Batch->RateStep;
+
+      Reversed = (Batch->Rate[i] * NewRate < 0.0f) & (AbsFan <= Coul);
+      Batch->Rate[i] = (Stuck | Reversed) ? 0.0f : NewRate;
+
+      Batch->Angle[i] += Batch->Rate[i] * RAD_2_DEG * Dt;
+      Batch->Angle[i]  = (Batch->Angle[i] < 0.0f)    ? Batch->Angle[i] + 360.0f : Batch->Angle[i];
+      Batch->Angle[i]  = (Batch->Angle[i] >= 360.0f) ? Batch->Angle[i] - 360.0f : Batch->Angle[i];
+
+      Err = Sun - Batch->Angle[i];
+      Err = (Err > 180.0f)   ? Err - 360.0f : Err;
+      Err = (Err <= -180.0f) ? Err + 360.0f : Err;
+      AbsErr = fabsf(Err);
+
+      InTol = (AbsErr <= Tol);
+      Batch->SettleTime[i]  = (InTol & !Batch->Settled[i]) ? Time : Batch->SettleTime[i];
+      Batch->Settled[i]     = InTol;
+      Batch->PointingErr[i] = Err;
+   }
+
+} /* End PlantUpdate() */
+
+
+/******************************************************************************
+** Function: SensorUpdate
+**
+** Sample the sensors, run one SUN_ACQ step and queue the fan commands.
+**
+** Notes:
+**   1. The state flags are evaluated before any transition so each lane
+**      takes exactly the path SUN_ACQ_Step()'s switch would.
+**   2. cos() uses its Taylor series through x^10, the error is below 1e-7
+**      within +/-90 degrees where the light is visible.
+**   3. The profile update and the source location loop over the bins
+**      outside the lane loops so every lane loop stays branch free. The
+**      source and the slew model are computed for every lane each step and
+**      only kept by lanes entering ACQUIRE.
+**
+*/
+static void SensorUpdate(SIM_BATCH_Class_t *Batch, float Time, float SensorPeriod)
+{
+
+   float  LuxGain[SIM_BATCH_LANES] __attribute__((aligned(SIM_BATCH_ALIGN)));
+   float  CosErr[SIM_BATCH_LANES] __attribute__((aligned(SIM_BATCH_ALIGN)));
+   float  TotalLight[SIM_BATCH_LANES] __attribute__((aligned(SIM_BATCH_ALIGN)));
+   float  SpinRate[SIM_BATCH_LANES] __attribute__((aligned(SIM_BATCH_ALIGN)));
+
+   const float Sun      = (float)Batch->Plant.SunAngle;
+   const float Bias     = (float)Batch->Plant.GyroBias;
+   const float Peak0    = (float)Batch->Plant.LuxPeak[0];
+   const float Peak1    = (float)Batch->Plant.LuxPeak[1];
+   const float Ambient0 = (float)Batch->Plant.LuxAmbient[0];
+   const float Ambient1 = (float)Batch->Plant.LuxAmbient[1];
+   float  PeakLight[SIM_BATCH_LANES] __attribute__((aligned(SIM_BATCH_ALIGN)));
+   float  PrevLight[SIM_BATCH_LANES] __attribute__((aligned(SIM_BATCH_ALIGN)));
+   float  NextLight[SIM_BATCH_LANES] __attribute__((aligned(SIM_BATCH_ALIGN)));
+   int32  ProfileBin[SIM_BATCH_LANES] __attribute__((aligned(SIM_BATCH_ALIGN)));
+   int32  PeakBin[SIM_BATCH_LANES] __attribute__((aligned(SIM_BATCH_ALIGN)));
+   int32  Empty[SIM_BATCH_LANES] __attribute__((aligned(SIM_BATCH_ALIGN)));
+   int32  ToAcquire[SIM_BATCH_LANES] __attribute__((aligned(SIM_BATCH_ALIGN)));
+
+   float  Err, X, Cos, U0, U1, U2, U3, Noise, Lux0, Lux1;
+   float  AngleDelta, Pwm, Light, Rotation, Total, PosErr, MaxLight, MaxAngle, Prof;
+   float  Source, Located, Curve, Offset, PosCtrl, SlewEffort, SurveyPwm;
+   float  Ctrl, Effort, AcqTime, Rate;
+   float  FitN, FitX, FitY, VarX, Friction, FitAccel, Dir, Accel, Brake, Lead, Target, SlewPwm, FallRate;
+   float  EndGameDist = Batch->Slew.MaxRate * Batch->Slew.PosTol / Batch->Slew.RateTol;
+   uint32 Rng;
+   int32  State, Acquired, Bin, Cnt, Hit;
+   int32  IsSurvey, IsAcquire, IsHold, Surveying, NewMax, InTol, ToHold;
+   int32  AddFit, Fitted, Valid;
+   int32  k;
+   uint32 i;
+   uint8  f;
+
+   for (i=0; i < SIM_BATCH_LANES; i++)
+   {
+      Err = Sun - Batch->Angle[i];
+      Err = (Err > 180.0f)   ? Err - 360.0f : Err;
+      Err = (Err <= -180.0f) ? Err + 360.0f : Err;
+      X   = Err * DEG_2_RAD;
+      X   = X * X;
+      Cos = 1.0f + X*(-1.0f/2.0f + X*(1.0f/24.0f + X*(-1.0f/720.0f +
+            X*(1.0f/40320.0f + X*(-1.0f/3628800.0f)))));
+      CosErr[i]  = (fabsf(Err) < 90.0f && Cos > 0.0f) ? Cos : 0.0f;
+      LuxGain[i] = 1.0f;
+   }
+
+   for (k=0; k < Batch->LuxExponent; k++)
+   {
+      for (i=0; i < SIM_BATCH_LANES; i++)
+      {
+         LuxGain[i] *= CosErr[i];
+      }
+   }
+
+   /* Sensors, same order as SIM_PLANT_ReadSensors() */
+   for (i=0; i < SIM_BATCH_LANES; i++)
+   {
+
+      Rng = Batch->Rng[i];
+      NEXT_UNIFORM(Rng, U0); NEXT_UNIFORM(Rng, U1); NEXT_UNIFORM(Rng, U2); NEXT_UNIFORM(Rng, U3);
+      Noise = (U0 + U1 + U2 + U3 - 2.0f) * SQRT_3;
+      SpinRate[i] = (Batch->Rate[i] + Bias + Batch->GyroNoise[i] * Noise) * RAD_2_DEG;
+
+      NEXT_UNIFORM(Rng, U0); NEXT_UNIFORM(Rng, U1); NEXT_UNIFORM(Rng, U2); NEXT_UNIFORM(Rng, U3);
+      Noise = (U0 + U1 + U2 + U3 - 2.0f) * SQRT_3;
+      Lux0  = (Ambient0 + Peak0 * LuxGain[i]) * (1.0f + Batch->LuxNoise[i] * Noise);
+      Lux0  = (Lux0 > 0.0f) ? Lux0 : 0.0f;
+
+      NEXT_UNIFORM(Rng, U0); NEXT_UNIFORM(Rng, U1); NEXT_UNIFORM(Rng, U2); NEXT_UNIFORM(Rng, U3);
+      Noise = (U0 + U1 + U2 + U3 - 2.0f) * SQRT_3;
+      Lux1  = (Ambient1 + Peak1 * LuxGain[i]) * (1.0f + Batch->LuxNoise[i] * Noise);
+      Lux1  = (Lux1 > 0.0f) ? Lux1 : 0.0f;
+      Batch->Rng[i] = Rng;
+
+      TotalLight[i] = Lux0 + Lux1;
+   }
+
+   /* SUN_ACQ_Step() survey and transition flags */
+   for (i=0; i < SIM_BATCH_LANES; i++)
+   {
+
+      State      = Batch->State[i];
+      Rotation   = Batch->SurveyRotation[i];
+      MaxLight   = Batch->SurveyMaxLight[i];
+      MaxAngle   = Batch->SurveyMaxLightAngle[i];
+      Light      = TotalLight[i];
+      AngleDelta = SpinRate[i] * SensorPeriod;
+
+      IsSurvey  = (State == SUN_ACQ_STATE_SURVEY);
+      Rotation += IsSurvey ? AngleDelta : 0.0f;
+      Surveying = IsSurvey & (Rotation < SUN_ACQ_SURVEY_ROTATION);
+      NewMax    = Surveying & (Light > MaxLight);
+      MaxLight  = NewMax ? Light : MaxLight;
+      MaxAngle  = NewMax ? Rotation : MaxAngle;
+
+      /* SLEW_AddSample() */
+      Rate   = SpinRate[i];
+      AddFit = Surveying & Batch->FitPrevValid[i];
+      FitX   = 0.5f*(Rate + Batch->FitPrevRate[i]);
+      FitY   = (Rate - Batch->FitPrevRate[i]) / SensorPeriod;
+      Batch->FitCnt[i] += AddFit;
+      Batch->FitX[i]   += AddFit ? FitX : 0.0f;
+      Batch->FitY[i]   += AddFit ? FitY : 0.0f;
+      Batch->FitXX[i]  += AddFit ? FitX*FitX : 0.0f;
+      Batch->FitXY[i]  += AddFit ? FitX*FitY : 0.0f;
+      Batch->FitPrevRate[i]   = Surveying ? Rate : Batch->FitPrevRate[i];
+      Batch->FitPrevValid[i] |= Surveying;
+
+      Bin = (int32)(Rotation * (SUN_ACQ_PROFILE_BINS / (float)SUN_ACQ_SURVEY_ROTATION));
+      Bin = (Bin < SUN_ACQ_PROFILE_BINS - 1) ? Bin : SUN_ACQ_PROFILE_BINS - 1;
+      ProfileBin[i] = (Surveying & (Rotation >= 0.0f)) ? Bin : -1;
+      ToAcquire[i]  = IsSurvey & !Surveying;
+
+      Batch->SurveyRotation[i]      = Rotation;
+      Batch->SurveyMaxLight[i]      = MaxLight;
+      Batch->SurveyMaxLightAngle[i] = MaxAngle;
+
+   }
+
+   /* Profile running means */
+   for (k=0; k < SUN_ACQ_PROFILE_BINS; k++)
+   {
+      for (i=0; i < SIM_BATCH_LANES; i++)
+      {
+         Hit  = (ProfileBin[i] == k);
+         Cnt  = Batch->ProfileCnt[k][i] + Hit;
+         Cnt  = (Cnt < 0xFFFF) ? Cnt : 0xFFFF;
+         Prof = Batch->ProfileLight[k][i];
+         Batch->ProfileLight[k][i] = Hit ? Prof + (TotalLight[i] - Prof) / (float)Cnt : Prof;
+         Batch->ProfileCnt[k][i]   = Cnt;
+      }
+   }
+
+   /* LocateSource(), evaluated for every lane and used by those entering ACQUIRE */
+   for (i=0; i < SIM_BATCH_LANES; i++)
+   {
+      PeakBin[i]   = 0;
+      PeakLight[i] = Batch->ProfileLight[0][i];
+      Empty[i]     = (Batch->ProfileCnt[0][i] == 0);
+   }
+   for (k=1; k < SUN_ACQ_PROFILE_BINS; k++)
+   {
+      for (i=0; i < SIM_BATCH_LANES; i++)
+      {
+         NewMax       = (Batch->ProfileLight[k][i] > PeakLight[i]);
+         PeakBin[i]   = NewMax ? k : PeakBin[i];
+         PeakLight[i] = NewMax ? Batch->ProfileLight[k][i] : PeakLight[i];
+         Empty[i]    |= (Batch->ProfileCnt[k][i] == 0);
+      }
+   }
+   for (i=0; i < SIM_BATCH_LANES; i++)
+   {
+      PrevLight[i] = 0.0f;
+      NextLight[i] = 0.0f;
+   }
+   for (k=0; k < SUN_ACQ_PROFILE_BINS; k++)
+   {
+      for (i=0; i < SIM_BATCH_LANES; i++)
+      {
+         Prof = Batch->ProfileLight[k][i];
+         PrevLight[i] = (k == (PeakBin[i] + SUN_ACQ_PROFILE_BINS - 1) % SUN_ACQ_PROFILE_BINS) ? Prof : PrevLight[i];
+         NextLight[i] = (k == (PeakBin[i] + 1) % SUN_ACQ_PROFILE_BINS) ? Prof : NextLight[i];
+      }
+   }
+
+   /* SUN_ACQ_Step() state machine */
+   for (i=0; i < SIM_BATCH_LANES; i++)
+   {
+
+      State    = Batch->State[i];
+      Valid    = Batch->ModelValid[i];
+      Total    = Batch->Rotation[i];
+      Source   = Batch->SourceAngle[i];
+      Ctrl     = Batch->Ctrl[i];
+      Effort   = Batch->Effort[i];
+      Acquired = Batch->Acquired[i];
+      AcqTime  = Batch->AcquireTime[i];
+      Rate     = SpinRate[i];
+      SurveyPwm = Batch->SurveyFanPwm[i];
+      SlewPwm   = (float)Batch->Slew.FanPwm;
+
+      Curve  = PrevLight[i] - 2.0f*PeakLight[i] + NextLight[i];
+      Offset = (Curve < 0.0f) ? 0.5f*(PrevLight[i] - NextLight[i]) / Curve : 0.0f;
+      Offset = (Offset < 0.5f) ? Offset : 0.5f;
+      Offset = (Offset > -0.5f) ? Offset : -0.5f;
+      Located = Empty[i] ? Batch->SurveyMaxLightAngle[i] :
+                ((float)PeakBin[i] + 0.5f + Offset) * (float)(SUN_ACQ_SURVEY_ROTATION / SUN_ACQ_PROFILE_BINS);
+
+      /* SLEW_FitModel() */
+      FitN     = (Batch->FitCnt[i] > 0) ? (float)Batch->FitCnt[i] : 1.0f;
+      FitX     = Batch->FitX[i] / FitN;
+      FitY     = Batch->FitY[i] / FitN;
+      VarX     = Batch->FitXX[i] / FitN - FitX*FitX;
+      Friction = (VarX > 0.0f) ? -(Batch->FitXY[i] / FitN - FitX*FitY) / VarX : 0.0f;
+      Friction = (Friction > 0.0f) ? Friction : 0.0f;
+      FitAccel = (SurveyPwm > 0.0f) ? (FitY + Friction*FitX) / SurveyPwm : 0.0f;
+      Fitted   = (Batch->FitCnt[i] >= SLEW_MIN_FIT_CNT) & (SurveyPwm > 0.0f) &
+                 (VarX >= (float)(SLEW_MIN_RATE_STD*SLEW_MIN_RATE_STD)) & (FitAccel > 0.0f);
+
+      IsSurvey  = (State == SUN_ACQ_STATE_SURVEY);
+      IsAcquire = (State == SUN_ACQ_STATE_ACQUIRE);
+      IsHold    = (State == SUN_ACQ_STATE_HOLD);
+
+      Total     += Rate * SensorPeriod;
+      PosErr     = Total - Source;
+      PosErr     = PosErr - 360.0f * rintf(PosErr * (1.0f/360.0f));
+      PosCtrl    = Rate * Batch->RateGain[i] + PosErr * Batch->PosGain[i];
+      InTol      = (fabsf(PosErr) < Batch->Slew.PosTol) & (fabsf(Rate) < Batch->Slew.RateTol);
+      ToHold     = IsAcquire & InTol;
+
+      /* SLEW_Step() */
+      Dir        = (PosErr > 0.0f) ? -1.0f : 1.0f;
+      Accel      = Valid ? Batch->SlewAccel[i] : 1.0f;
+      Brake      = Accel * SlewPwm;
+      Lead       = Brake * SensorPeriod;
+      Target     = sqrtf(Lead*Lead + 2.0f*Brake*fabsf(PosErr)) - Lead;
+      Target     = (Target < Batch->Slew.MaxRate) ? Target : Batch->Slew.MaxRate;
+      Pwm        = (Batch->SlewFriction[i]*Target + (Target - Dir*Rate) / SensorPeriod) / Accel;
+      Pwm        = (Pwm < SlewPwm) ? Pwm : SlewPwm;
+      Pwm        = (Pwm > -SlewPwm) ? Pwm : -SlewPwm;
+      /* End game and fallback without a slew model */
+      FallRate   = -PosErr * Batch->Slew.RateTol / Batch->Slew.PosTol;
+      FallRate   = (FallRate < Batch->Slew.MaxRate) ? FallRate : Batch->Slew.MaxRate;
+      FallRate   = (FallRate > -Batch->Slew.MaxRate) ? FallRate : -Batch->Slew.MaxRate;
+      SlewEffort = (Valid & (fabsf(PosErr) > EndGameDist)) ? -Dir*Pwm : ((Rate < FallRate) ? -SurveyPwm : SurveyPwm);
+
+      Source = ToAcquire[i] ? Located : Source;
+      Batch->ModelValid[i]   = ToAcquire[i] ? Fitted : Valid;
+      Batch->SlewAccel[i]    = ToAcquire[i] ? FitAccel : Batch->SlewAccel[i];
+      Batch->SlewFriction[i] = ToAcquire[i] ? Friction : Batch->SlewFriction[i];
+      State  = ToAcquire[i] ? SUN_ACQ_STATE_ACQUIRE : State;
+      State  = ToHold ? SUN_ACQ_STATE_HOLD : State;
+      Ctrl   = (IsAcquire | IsHold) ? PosCtrl : Ctrl;
+      Effort = IsSurvey ? -SurveyPwm : Effort;
+      Effort = IsAcquire ? (InTol ? 0.0f : SlewEffort) : Effort;
+      Effort = IsHold ? 0.0f : Effort;
+
+      AcqTime   = (ToHold & !Acquired) ? Time : AcqTime;
+      Acquired |= ToHold;
+
+      Batch->State[i]       = State;
+      Batch->Rotation[i]    = Total;
+      Batch->SourceAngle[i] = Source;
+      Batch->Ctrl[i]        = Ctrl;
+      Batch->Effort[i]      = Effort;
+      Batch->Acquired[i]    = Acquired;
+      Batch->AcquireTime[i] = AcqTime;
+      Batch->Countdown[i]   = Batch->LatencySteps[i];
+
+   }
+
+   /* Same allocation and limits as FAN_SetEffort() */
+   for (f=0; f < Batch->Plant.FanCnt; f++)
+   {
+      for (i=0; i < SIM_BATCH_LANES; i++)
+      {
+         Pwm = Batch->Alloc[f] * Batch->Effort[i];
+         Pwm = (Pwm > 0.0f) ? Pwm : 0.0f;
+         Batch->PendingPwm[f][i] = (Pwm < (float)SIM_PLANT_PWM_MAX) ? Pwm : (float)SIM_PLANT_PWM_MAX;
+      }
+   }
+
+} /* End SensorUpdate() */
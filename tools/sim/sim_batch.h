@@ -0,0 +1,176 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Define a batched Table Sat plant and sun acquisition kernel
+**
+**  Notes:
+**    1. SIM_BATCH_LANES tables are stored as a structure of arrays and
+**       advance in lockstep. Every per-lane loop has a fixed trip count and
+**       a branch-free body so the compiler vectorizes it for the target's
+**       SIMD unit (SSE, AVX or NEON). Only decisions common to all lanes,
+**       like a sensor period boundary, are branches.
+**    2. The plant follows SIM_PLANT and the controller mirrors SUN_ACQ_Step
+**       with the state machine written as selects. The batch runs in single
+**       precision, uses a polynomial cosine and an integer lux exponent, and
+**       approximates Gaussian noise with a sum of four uniforms from a per
+**       lane xorshift32 generator. Results are statistically equivalent to
+**       the scalar path rather than bit identical.
+**    3. Fan PWM commands are clamped like FAN_SetEffort() but not rounded
+**       to integers.
+**
+*/
+
+#ifndef _sim_batch_
+#define _sim_batch_
+
+/*
+** Includes
+*/
+
+#include "sim_plant.h"
+#include "sun_acq.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define SIM_BATCH_LANES  256
+#define SIM_BATCH_ALIGN  64
+
+#define SIM_BATCH_LANE_ARRAY(Type, Name)  Type Name[SIM_BATCH_LANES] __attribute__((aligned(SIM_BATCH_ALIGN)))
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+
+/******************************************************************************
+** SIM_BATCH_Class
+**
+** Flags are int32 0/1 so they share the 32-bit lane width of the floats.
+*/
+
+typedef struct
+{
+
+   /* Shared by all lanes */
+   SIM_PLANT_Param_t  Plant;
+   float   Alloc[SIM_PLANT_MAX_FAN];
+   float   PlantStep;
+   float   FanLag;            /* exp(-PlantStep/FanTimeConst) */
+   float   ThrustPerPwm;
+   float   RateStep;          /* PlantStep/Inertia */
+   float   SettleTol;
+   int32   LuxExponent;
+   uint32  SensorSteps;       /* Plant steps per sensor period */
+   uint32  Step;
+   SLEW_Param_t  Slew;
+
+   /* Controller */
+   SIM_BATCH_LANE_ARRAY(int32, State);
+   SIM_BATCH_LANE_ARRAY(float, SurveyFanPwm);
+   SIM_BATCH_LANE_ARRAY(float, PosGain);
+   SIM_BATCH_LANE_ARRAY(float, RateGain);
+   SIM_BATCH_LANE_ARRAY(float, Effort);
+   SIM_BATCH_LANE_ARRAY(float, Ctrl);
+   SIM_BATCH_LANE_ARRAY(float, SurveyMaxLight);
+   SIM_BATCH_LANE_ARRAY(float, SurveyMaxLightAngle);
+   SIM_BATCH_LANE_ARRAY(float, SurveyRotation);
+   SIM_BATCH_LANE_ARRAY(float, Rotation);
+   SIM_BATCH_LANE_ARRAY(float, SourceAngle);
+   float   ProfileLight[SUN_ACQ_PROFILE_BINS][SIM_BATCH_LANES] __attribute__((aligned(SIM_BATCH_ALIGN)));
+   int32   ProfileCnt[SUN_ACQ_PROFILE_BINS][SIM_BATCH_LANES] __attribute__((aligned(SIM_BATCH_ALIGN)));
+
+   /* Slew response fit and model */
+   SIM_BATCH_LANE_ARRAY(int32, FitCnt);
+   SIM_BATCH_LANE_ARRAY(int32, FitPrevValid);
+   SIM_BATCH_LANE_ARRAY(float, FitPrevRate);
+   SIM_BATCH_LANE_ARRAY(float, FitX);
+   SIM_BATCH_LANE_ARRAY(float, FitY);
+   SIM_BATCH_LANE_ARRAY(float, FitXX);
+   SIM_BATCH_LANE_ARRAY(float, FitXY);
+   SIM_BATCH_LANE_ARRAY(int32, ModelValid);
+   SIM_BATCH_LANE_ARRAY(float, SlewAccel);
+   SIM_BATCH_LANE_ARRAY(float, SlewFriction);
+
+   /* Fan command latency */
+   SIM_BATCH_LANE_ARRAY(int32, LatencySteps);
+   SIM_BATCH_LANE_ARRAY(int32, Countdown);
+   float   PendingPwm[SIM_PLANT_MAX_FAN][SIM_BATCH_LANES] __attribute__((aligned(SIM_BATCH_ALIGN)));
+   float   Pwm[SIM_PLANT_MAX_FAN][SIM_BATCH_LANES] __attribute__((aligned(SIM_BATCH_ALIGN)));
+
+   /* Plant */
+   float   Thrust[SIM_PLANT_MAX_FAN][SIM_BATCH_LANES] __attribute__((aligned(SIM_BATCH_ALIGN)));
+   SIM_BATCH_LANE_ARRAY(float, FanTorque);
+   SIM_BATCH_LANE_ARRAY(float, Angle);       /* Degrees in [0,360) */
+   SIM_BATCH_LANE_ARRAY(float, Rate);        /* rad/s */
+   SIM_BATCH_LANE_ARRAY(float, GyroNoise);
+   SIM_BATCH_LANE_ARRAY(float, LuxNoise);
+   SIM_BATCH_LANE_ARRAY(uint32, Rng);
+
+   /* Results */
+   SIM_BATCH_LANE_ARRAY(int32, Acquired);
+   SIM_BATCH_LANE_ARRAY(int32, Settled);
+   SIM_BATCH_LANE_ARRAY(float, AcquireTime);
+   SIM_BATCH_LANE_ARRAY(float, SettleTime);
+   SIM_BATCH_LANE_ARRAY(float, PointingErr);
+
+} SIM_BATCH_Class_t;
+
+
+/************************/
+/** Exported Functions **/
+/************************/
+
+
+/******************************************************************************
+** Function: SIM_BATCH_Constructor
+**
+** Set the parameters shared by every lane and park each lane at rest with
+** zero gains.
+**
+** Notes:
+**   1. Alloc is the torque-Z row of the fan allocation, one entry per fan.
+**   2. The object is large, allocate it with SIM_BATCH_ALIGN alignment.
+**
+*/
+void SIM_BATCH_Constructor(SIM_BATCH_Class_t *Batch, const SIM_PLANT_Param_t *Plant,
+                           const float *Alloc, double PlantStep, double SensorPeriod,
+                           double SettleTol);
+
+
+/******************************************************************************
+** Function: SIM_BATCH_InitLane
+**
+** Start a lane's sun acquisition. Angle is in degrees, Rate in rad/s and
+** Latency is the sensor to fan command delay in seconds.
+*/
+void SIM_BATCH_InitLane(SIM_BATCH_Class_t *Batch, uint32 Lane, const SUN_ACQ_Param_t *Ctrl,
+                        double Angle, double Rate, double GyroNoise, double LuxNoise,
+                        double Latency, uint32 Seed);
+
+
+/******************************************************************************
+** Function: SIM_BATCH_Run
+**
+** Advance every lane Duration seconds. The results are in the Acquired,
+** AcquireTime, Settled, SettleTime and PointingErr arrays.
+*/
+void SIM_BATCH_Run(SIM_BATCH_Class_t *Batch, double Duration);
+
+
+#endif /* _sim_batch_ */
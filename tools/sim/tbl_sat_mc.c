@@ -0,0 +1,826 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Monte Carlo closed-loop simulation of the SAT_CTRL sun acquisition
+**
+**  Notes:
+**    1. Each run drives the flight SUN_ACQ control law with the SIM_PLANT
+**       model the same way SAT_CTRL does on a rig: a sensor message every
+**       sensor period, the effort mapped through the fan allocation and
+**       clamped to 0..FAN_MAX_PWM, and the fan command applied after the
+**       run's latency.
+**    2. Each run varies the table gains, sensor noise, latency and initial
+**       conditions. Run N always uses seed + N so a single run can be
+**       reproduced with -s and -n 1.
+**    3. Runs are spread over a work-stealing thread pool. Each worker owns
+**       a [Head,Tail) range of run indices packed into one 64-bit word.
+**       The owner takes runs from the head and an idle worker steals the
+**       upper half of another worker's range, both with compare-and-swap.
+**    4. Acquisition time is when the control law reaches HOLD. Settling
+**       time is when the pointing error last entered the tolerance and
+**       stayed there until the end of the run. A run that doesn't do both
+**       fails.
+**    5. -b runs blocks of SIM_BATCH_LANES runs through the SIMD batch
+**       kernel and a block is the unit of work. A run's gains, latency and
+**       initial conditions are the same in both modes, only the noise
+**       samples differ. See sim_batch.h.
+**
+*/
+
+/*
+** Include Files:
+*/
+
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "sim_batch.h"
+#include "sim_plant.h"
+#include "sun_acq.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define MC_MAX_THREADS   256
+#define MC_RUN_MAX       (1u << 30)
+#define MC_JSON_MAX_CHAR 16384
+
+#define RAD_2_DEG  57.29577951326093
+
+#define RANGE_PACK(H,T)  (((uint64)(H) << 32) | (uint64)(T))
+#define RANGE_HEAD(R)    ((uint32)((R) >> 32))
+#define RANGE_TAIL(R)    ((uint32)(R))
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+typedef struct
+{
+
+   uint32  RunCnt;
+   uint32  ThreadCnt;
+   uint64  Seed;
+   double  Duration;       /* Seconds per run */
+   double  SensorPeriod;   /* Seconds between sensor messages */
+   double  PlantStep;      /* Seconds */
+   double  SettleTol;      /* Pointing error degrees */
+   double  GainSpread;     /* +/- fraction */
+   double  NoiseSpread;    /* +/- fraction */
+   double  LatencyMax;     /* Seconds */
+   double  InitRateSigma;  /* rad/s */
+   bool    Batch;
+   uint32  UnitCnt;        /* Runs or batches */
+   const char *CsvFile;
+
+   SUN_ACQ_Param_t    Ctrl;
+   SIM_PLANT_Param_t  Plant;
+   float   Alloc[SIM_PLANT_MAX_FAN];  /* Torque-Z allocation row */
+
+} MC_Config_t;
+
+typedef struct
+{
+
+   bool    Acquired;
+   bool    Settled;
+   double  AcquireTime;
+   double  SettleTime;
+   double  FinalErr;
+   double  Latency;
+   SUN_ACQ_Param_t  Ctrl;
+
+} MC_Result_t;
+
+typedef struct
+{
+
+   uint64  Range;          /* Atomic, packed [Head,Tail) of units */
+   uint32  Index;
+   uint32  RunCnt;
+   uint32  StealCnt;
+   pthread_t  Thread;
+   SIM_BATCH_Class_t *SimBatch;
+   char    Pad[64];        /* Keep ranges on separate cache lines */
+
+} MC_Worker_t;
+
+
+/************************************/
+/** Local File Function Prototypes **/
+/************************************/
+
+static int    CompareDouble(const void *A, const void *B);
+static void   DrawRun(uint32 Run, SIM_PLANT_Class_t *Plant, MC_Result_t *Result);
+static bool   LoadCtrlTbl(MC_Config_t *Config, const char *Filename);
+static bool   LoadFanTbl(MC_Config_t *Config, const char *Filename);
+static char  *ReadFile(const char *Filename);
+static bool   NextPopUnit(MC_Worker_t *Worker, uint32 *Unit);
+static void   PrintStats(const char *Label, double *Value, uint32 Cnt);
+static void   PrintUsage(const char *Prog);
+static void   RunBatch(MC_Worker_t *Worker, uint32 Block);
+static void   RunSim(uint32 Run, MC_Result_t *Result);
+static bool   ScanNumber(const char *Json, const char *Key, double *Value);
+static bool   StealUnits(MC_Worker_t *Thief);
+static double Vary(SIM_PLANT_Class_t *Plant, double Value, double Spread);
+static void  *WorkerMain(void *Arg);
+static bool   WriteCsv(const char *Filename);
+
+
+/**********************/
+/** Global File Data **/
+/**********************/
+
+static MC_Config_t   Config;
+static MC_Result_t  *Result;
+static MC_Worker_t   Worker[MC_MAX_THREADS];
+
+
+/******************************************************************************
+** Function: main
+**
+*/
+int main(int argc, char *argv[])
+{
+
+   int    Opt;
+   uint32 i, Start, Cnt, Next;
+   uint32 AcqCnt = 0, SettleCnt = 0;
+   double *AcqTime, *SettleTime;
+   struct timespec T0, T1;
+   double WallTime;
+   long   CpuCnt = sysconf(_SC_NPROCESSORS_ONLN);
+
+   memset(&Config, 0, sizeof(Config));
+   Config.RunCnt        = 1000;
+   Config.ThreadCnt     = (CpuCnt > 0) ? (uint32)CpuCnt : 1;
+   Config.Seed          = 1;
+   Config.Duration      = 180.0;
+   Config.SensorPeriod  = 0.5;
+   Config.PlantStep     = 0.005;
+   Config.SettleTol     = 10.0;
+   Config.GainSpread    = 0.1;
+   Config.NoiseSpread   = 0.5;
+   Config.LatencyMax    = 0.2;
+   Config.InitRateSigma = 0.05;
+   Config.Alloc[0]      =  1.0;
+   Config.Alloc[1]      = -1.0;
+   SIM_PLANT_DefaultParam(&Config.Plant);
+
+   while ((Opt = getopt(argc, argv, "n:t:s:d:p:e:g:r:l:w:f:o:bh")) != -1)
+   {
+      switch (Opt)
+      {
+         case 'n': Config.RunCnt        = (uint32)strtoul(optarg, NULL, 0); break;
+         case 't': Config.ThreadCnt     = (uint32)strtoul(optarg, NULL, 0); break;
+         case 's': Config.Seed          = strtoull(optarg, NULL, 0);        break;
+         case 'd': Config.Duration      = atof(optarg); break;
+         case 'p': Config.SensorPeriod  = atof(optarg); break;
+         case 'e': Config.SettleTol     = atof(optarg); break;
+         case 'g': Config.GainSpread    = atof(optarg); break;
+         case 'r': Config.NoiseSpread   = atof(optarg); break;
+         case 'l': Config.LatencyMax    = atof(optarg); break;
+         case 'w': Config.InitRateSigma = atof(optarg); break;
+         case 'f':
+            if (!LoadFanTbl(&Config, optarg)) return EXIT_FAILURE;
+            break;
+         case 'o': Config.CsvFile = optarg; break;
+         case 'b': Config.Batch   = true;   break;
+         default:
+            PrintUsage(argv[0]);
+            return (Opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+      }
+   }
+
+   if (optind != argc - 1)
+   {
+      PrintUsage(argv[0]);
+      return EXIT_FAILURE;
+   }
+   if (!LoadCtrlTbl(&Config, argv[optind])) return EXIT_FAILURE;
+
+   if (Config.RunCnt == 0 || Config.RunCnt > MC_RUN_MAX ||
+       Config.ThreadCnt == 0 || Config.ThreadCnt > MC_MAX_THREADS ||
+       Config.Duration <= 0.0 || Config.SensorPeriod < Config.PlantStep)
+   {
+      fprintf(stderr, "Invalid options: runs 1..%u, threads 1..%u, duration > 0, sensor period >= %.3f\n",
+              MC_RUN_MAX, MC_MAX_THREADS, Config.PlantStep);
+      return EXIT_FAILURE;
+   }
+   Config.UnitCnt = Config.Batch ? (Config.RunCnt + SIM_BATCH_LANES - 1) / SIM_BATCH_LANES : Config.RunCnt;
+   if (Config.ThreadCnt > Config.UnitCnt) Config.ThreadCnt = Config.UnitCnt;
+
+   Result = calloc(Config.RunCnt, sizeof(MC_Result_t));
+   AcqTime = malloc(Config.RunCnt * sizeof(double));
+   SettleTime = malloc(Config.RunCnt * sizeof(double));
+   if (Result == NULL || AcqTime == NULL || SettleTime == NULL)
+   {
+      fprintf(stderr, "Failed to allocate results for %u runs\n", Config.RunCnt);
+      return EXIT_FAILURE;
+   }
+
+   /* Deal the units out evenly, stealing balances the uneven run times */
+   Start = 0;
+   for (i=0; i < Config.ThreadCnt; i++)
+   {
+      Cnt  = Config.UnitCnt / Config.ThreadCnt + (i < Config.UnitCnt % Config.ThreadCnt);
+      Next = Start + Cnt;
+      Worker[i].Index = i;
+      if (Config.Batch)
+      {
+         if (posix_memalign((void **)&Worker[i].SimBatch, SIM_BATCH_ALIGN, sizeof(SIM_BATCH_Class_t)) != 0)
+         {
+            fprintf(stderr, "Failed to allocate the batch for worker %u\n", i);
+            return EXIT_FAILURE;
+         }
+      }
+      __atomic_store_n(&Worker[i].Range, RANGE_PACK(Start, Next), __ATOMIC_RELAXED);
+      Start = Next;
+   }
+
+   clock_gettime(CLOCK_MONOTONIC, &T0);
+   for (i=0; i < Config.ThreadCnt; i++)
+   {
+      if (pthread_create(&Worker[i].Thread, NULL, WorkerMain, &Worker[i]) != 0)
+      {
+         fprintf(stderr, "Failed to create worker thread %u\n", i);
+         return EXIT_FAILURE;
+      }
+   }
+   for (i=0; i < Config.ThreadCnt; i++)
+   {
+      pthread_join(Worker[i].Thread, NULL);
+      free(Worker[i].SimBatch);
+   }
+   clock_gettime(CLOCK_MONOTONIC, &T1);
+   WallTime = (double)(T1.tv_sec - T0.tv_sec) + (double)(T1.tv_nsec - T0.tv_nsec) * 1.0e-9;
+
+   for (i=0; i < Config.RunCnt; i++)
+   {
+      if (Result[i].Acquired) AcqTime[AcqCnt++] = Result[i].AcquireTime;
+      if (Result[i].Acquired && Result[i].Settled) SettleTime[SettleCnt++] = Result[i].SettleTime;
+   }
+
+   printf("Table: %s\n", argv[optind]);
+   printf("  survey-fan-pwm %.3f, pos-gain %.4f, rate-gain %.4f, +/-%.0f%% per run\n",
+          Config.Ctrl.SurveyFanPwm, Config.Ctrl.PosGain, Config.Ctrl.RateGain, Config.GainSpread*100.0);
+   printf("Runs: %u, seed %llu, %.1f s each, sensor period %.3f s, latency 0..%.3f s, tolerance %.1f deg\n",
+          Config.RunCnt, (unsigned long long)Config.Seed, Config.Duration, Config.SensorPeriod,
+          Config.LatencyMax, Config.SettleTol);
+   printf("Threads: %u, %s, %.2f s wall, %.0f runs/s, %.0f simulated s per s\n", Config.ThreadCnt,
+          Config.Batch ? "batch" : "scalar", WallTime, Config.RunCnt/WallTime,
+          Config.RunCnt*Config.Duration/WallTime);
+   for (i=0; i < Config.ThreadCnt; i++)
+   {
+      printf("  Worker %2u: %6u runs, %4u steals\n", i, Worker[i].RunCnt, Worker[i].StealCnt);
+   }
+   printf("Failure rate: %.2f%% (%u not acquired, %u acquired but not settled)\n",
+          100.0 * (Config.RunCnt - SettleCnt) / Config.RunCnt,
+          Config.RunCnt - AcqCnt, AcqCnt - SettleCnt);
+   PrintStats("Acquisition time (s)", AcqTime, AcqCnt);
+   PrintStats("Settling time (s)", SettleTime, SettleCnt);
+
+   if (Config.CsvFile != NULL && !WriteCsv(Config.CsvFile))
+   {
+      return EXIT_FAILURE;
+   }
+
+   free(SettleTime);
+   free(AcqTime);
+   free(Result);
+
+   return EXIT_SUCCESS;
+
+} /* End main() */
+
+
+/******************************************************************************
+** Function: CompareDouble
+**
+*/
+static int CompareDouble(const void *A, const void *B)
+{
+
+   double DA = *(const double *)A, DB = *(const double *)B;
+
+   return (DA > DB) - (DA < DB);
+
+} /* End CompareDouble() */
+
+
+/******************************************************************************
+** Function: DrawRun
+**
+** Create a run's plant and draw its variations.
+**
+** Notes:
+**   1. The variations are drawn from the plant's generator before the run
+**      starts so the sensor noise sequence is also a function of the seed.
+**
+*/
+static void DrawRun(uint32 Run, SIM_PLANT_Class_t *Plant, MC_Result_t *Result)
+{
+
+   SIM_PLANT_Constructor(Plant, &Config.Plant, 0.0, 0.0, Config.Seed + Run);
+
+   Plant->Angle = 360.0 * SIM_PLANT_Uniform(Plant);
+   Plant->Rate  = Config.InitRateSigma * SIM_PLANT_Gauss(Plant);
+   Plant->Param.GyroNoise = Vary(Plant, Config.Plant.GyroNoise, Config.NoiseSpread);
+   Plant->Param.LuxNoise  = Vary(Plant, Config.Plant.LuxNoise, Config.NoiseSpread);
+   Result->Latency        = Config.LatencyMax * SIM_PLANT_Uniform(Plant);
+   Result->Ctrl.SurveyFanPwm = (float)Vary(Plant, Config.Ctrl.SurveyFanPwm, Config.GainSpread);
+   Result->Ctrl.PosGain      = (float)Vary(Plant, Config.Ctrl.PosGain, Config.GainSpread);
+   Result->Ctrl.RateGain     = (float)Vary(Plant, Config.Ctrl.RateGain, Config.GainSpread);
+   Result->Ctrl.Slew         = Config.Ctrl.Slew;
+
+} /* End DrawRun() */
+
+
+/******************************************************************************
+** Function: LoadCtrlTbl
+**
+** Notes:
+**   1. Only the parameters SUN_ACQ uses are read, with the same keys as
+**      sat_ctrl_tbl.c.
+**
+*/
+static bool LoadCtrlTbl(MC_Config_t *Config, const char *Filename)
+{
+
+   char  *Json = ReadFile(Filename);
+   double SurveyFanPwm, PosGain, RateGain;
+   double FanPwm, MaxRate, PosTol, RateTol;
+   bool   RetStatus = false;
+
+   if (Json == NULL) return false;
+
+   if (ScanNumber(Json, "survey-fan-pwm", &SurveyFanPwm) &&
+       ScanNumber(Json, "pos-gain", &PosGain) &&
+       ScanNumber(Json, "rate-gain", &RateGain) &&
+       ScanNumber(Json, "fan-pwm", &FanPwm) &&
+       ScanNumber(Json, "max-rate", &MaxRate) &&
+       ScanNumber(Json, "pos-tol", &PosTol) &&
+       ScanNumber(Json, "rate-tol", &RateTol))
+   {
+      Config->Ctrl.SurveyFanPwm = (float)SurveyFanPwm;
+      Config->Ctrl.PosGain      = (float)PosGain;
+      Config->Ctrl.RateGain     = (float)RateGain;
+      Config->Ctrl.Slew.FanPwm  = (uint16)FanPwm;
+      Config->Ctrl.Slew.MaxRate = (float)MaxRate;
+      Config->Ctrl.Slew.PosTol  = (float)PosTol;
+      Config->Ctrl.Slew.RateTol = (float)RateTol;
+      RetStatus = true;
+   }
+   else
+   {
+      fprintf(stderr, "%s must define survey-fan-pwm, pos-gain, rate-gain and the slew's fan-pwm, max-rate, pos-tol and rate-tol\n", Filename);
+   }
+
+   free(Json);
+
+   return RetStatus;
+
+} /* End LoadCtrlTbl() */
+
+
+/******************************************************************************
+** Function: LoadFanTbl
+**
+** Notes:
+**   1. Reads each fan entry's torque-z allocation in order.
+**
+*/
+static bool LoadFanTbl(MC_Config_t *Config, const char *Filename)
+{
+
+   char  *Json = ReadFile(Filename);
+   char  *Pos;
+   double Alloc;
+   uint8  FanCnt = 0;
+
+   if (Json == NULL) return false;
+
+   Pos = Json;
+   while (FanCnt < SIM_PLANT_MAX_FAN && ScanNumber(Pos, "torque-z", &Alloc))
+   {
+      Config->Alloc[FanCnt++] = (float)Alloc;
+      Pos = strstr(Pos, "\"torque-z\"") + 1;
+   }
+   free(Json);
+
+   if (FanCnt < 1)
+   {
+      fprintf(stderr, "%s doesn't define any torque-z fan allocations\n", Filename);
+      return false;
+   }
+
+   Config->Plant.FanCnt = FanCnt;
+   if (FanCnt != 2)
+   {
+      fprintf(stderr, "Warning: %u fans allocated, the plant model's default moment arms assume 2\n", FanCnt);
+   }
+
+   return true;
+
+} /* End LoadFanTbl() */
+
+
+/******************************************************************************
+** Function: NextPopUnit
+**
+** Take the next unit from the head of the worker's own range.
+*/
+static bool NextPopUnit(MC_Worker_t *Worker, uint32 *Unit)
+{
+
+   uint64 Range = __atomic_load_n(&Worker->Range, __ATOMIC_ACQUIRE);
+
+   while (RANGE_HEAD(Range) < RANGE_TAIL(Range))
+   {
+      if (__atomic_compare_exchange_n(&Worker->Range, &Range,
+                                      RANGE_PACK(RANGE_HEAD(Range) + 1, RANGE_TAIL(Range)),
+                                      false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+      {
+         *Unit = RANGE_HEAD(Range);
+         return true;
+      }
+   }
+
+   return false;
+
+} /* End NextPopUnit() */
+
+
+/******************************************************************************
+** Function: PrintStats
+**
+*/
+static void PrintStats(const char *Label, double *Value, uint32 Cnt)
+{
+
+   double Sum = 0.0;
+   uint32 i;
+
+   if (Cnt == 0)
+   {
+      printf("%-22s: no samples\n", Label);
+      return;
+   }
+
+   qsort(Value, Cnt, sizeof(double), CompareDouble);
+   for (i=0; i < Cnt; i++) Sum += Value[i];
+
+   printf("%-22s: mean %7.2f, p50 %7.2f, p90 %7.2f, max %7.2f (%u runs)\n", Label,
+          Sum/Cnt, Value[(Cnt-1)/2], Value[(uint32)((Cnt-1)*0.9)], Value[Cnt-1], Cnt);
+
+} /* End PrintStats() */
+
+
+/******************************************************************************
+** Function: PrintUsage
+**
+*/
+static void PrintUsage(const char *Prog)
+{
+
+   fprintf(stderr,
+      "Usage: %s [options] <sat_ctrl_tbl.json>\n"
+      "  -n runs          Number of runs (1000)\n"
+      "  -t threads       Worker threads (online CPUs)\n"
+      "  -s seed          Base seed, run N uses seed+N (1)\n"
+      "  -d seconds       Simulated time per run (180)\n"
+      "  -p seconds       Sensor message period (0.5)\n"
+      "  -e degrees       Settling pointing tolerance (10)\n"
+      "  -g fraction      Gain spread, +/- (0.1)\n"
+      "  -r fraction      Sensor noise spread, +/- (0.5)\n"
+      "  -l seconds       Maximum sensor to fan latency (0.2)\n"
+      "  -w rad/s         Initial rate 1 sigma (0.05)\n"
+      "  -f fan_tbl.json  Fan allocation table (torque-z 1,-1)\n"
+      "  -o file.csv      Write each run's result\n"
+      "  -b               Use the SIMD batch kernel\n", Prog);
+
+} /* End PrintUsage() */
+
+
+/******************************************************************************
+** Function: ReadFile
+**
+*/
+static char *ReadFile(const char *Filename)
+{
+
+   FILE  *File = fopen(Filename, "r");
+   char  *Buf;
+   size_t Len;
+
+   if (File == NULL)
+   {
+      fprintf(stderr, "Failed to open %s: %s\n", Filename, strerror(errno));
+      return NULL;
+   }
+
+   Buf = malloc(MC_JSON_MAX_CHAR);
+   if (Buf != NULL)
+   {
+      Len = fread(Buf, 1, MC_JSON_MAX_CHAR - 1, File);
+      Buf[Len] = '\0';
+   }
+   fclose(File);
+
+   return Buf;
+
+} /* End ReadFile() */
+
+
+/******************************************************************************
+** Function: RunBatch
+**
+** Notes:
+**   1. The lane generators are seeded from each run's plant generator after
+**      its variations are drawn. Lanes past the last run are simulated and
+**      ignored so the kernel's trip counts stay fixed.
+**
+*/
+static void RunBatch(MC_Worker_t *Worker, uint32 Block)
+{
+
+   SIM_BATCH_Class_t *Batch = Worker->SimBatch;
+   SIM_PLANT_Class_t  Plant;
+   MC_Result_t *Res;
+   uint32 Lane, Run;
+
+   SIM_BATCH_Constructor(Batch, &Config.Plant, Config.Alloc, Config.PlantStep,
+                         Config.SensorPeriod, Config.SettleTol);
+
+   for (Lane=0; Lane < SIM_BATCH_LANES; Lane++)
+   {
+      Run = Block * SIM_BATCH_LANES + Lane;
+      if (Run >= Config.RunCnt) break;
+      Res = &Result[Run];
+      DrawRun(Run, &Plant, Res);
+      SIM_BATCH_InitLane(Batch, Lane, &Res->Ctrl, Plant.Angle, Plant.Rate,
+                         Plant.Param.GyroNoise, Plant.Param.LuxNoise, Res->Latency,
+                         (uint32)(Plant.Rng >> 32));
+   }
+
+   SIM_BATCH_Run(Batch, Config.Duration);
+
+   for (Lane=0; Lane < SIM_BATCH_LANES; Lane++)
+   {
+      Run = Block * SIM_BATCH_LANES + Lane;
+      if (Run >= Config.RunCnt) break;
+      Res = &Result[Run];
+      Res->Acquired    = Batch->Acquired[Lane];
+      Res->AcquireTime = Batch->AcquireTime[Lane];
+      Res->Settled     = Batch->Settled[Lane];
+      Res->SettleTime  = Batch->SettleTime[Lane];
+      Res->FinalErr    = Batch->PointingErr[Lane];
+      Worker->RunCnt++;
+   }
+
+} /* End RunBatch() */
+
+
+/******************************************************************************
+** Function: RunSim
+**
+*/
+static void RunSim(uint32 Run, MC_Result_t *Result)
+{
+
+   SIM_PLANT_Class_t   Plant;
+   SIM_PLANT_Sensor_t  Sensor;
+   SUN_ACQ_Class_t     SunAcq;
+   uint16  FanPwm[SIM_PLANT_MAX_FAN];
+   uint16  PendingPwm[SIM_PLANT_MAX_FAN];
+   double  Time = 0.0, NextSensor = 0.0, ApplyTime = -1.0;
+   double  SpinRate, Err, Pwm;
+   uint8   i;
+
+   DrawRun(Run, &Plant, Result);
+
+   SUN_ACQ_Init(&SunAcq);
+   memset(FanPwm, 0, sizeof(FanPwm));
+   memset(PendingPwm, 0, sizeof(PendingPwm));
+   Result->Settled = false;
+
+   while (Time < Config.Duration)
+   {
+      if (Time >= NextSensor)
+      {
+         NextSensor += Config.SensorPeriod;
+
+         /* Same conversions as SAT_CTRL_SetSensorTlm() and FAN_SetEffort() */
+         SIM_PLANT_ReadSensors(&Plant, &Sensor);
+         SpinRate = Sensor.Rate[2] * RAD_2_DEG;
+         SUN_ACQ_Step(&SunAcq, &Result->Ctrl, Sensor.Lux[0] + Sensor.Lux[1],
+                      SpinRate, SpinRate * Config.SensorPeriod, Config.SensorPeriod);
+
+         for (i=0; i < Plant.Param.FanCnt; i++)
+         {
+            Pwm = fmin(fmax(Config.Alloc[i] * SunAcq.Effort[SUN_ACQ_AXIS_TORQUE_Z], 0.0), SIM_PLANT_PWM_MAX);
+            PendingPwm[i] = (uint16)lround(Pwm);
+         }
+         ApplyTime = Time + Result->Latency;
+
+         if (!Result->Acquired && SunAcq.State == SUN_ACQ_STATE_HOLD)
+         {
+            Result->Acquired    = true;
+            Result->AcquireTime = Time;
+         }
+      }
+
+      if (ApplyTime >= 0.0 && Time >= ApplyTime)
+      {
+         memcpy(FanPwm, PendingPwm, sizeof(FanPwm));
+         ApplyTime = -1.0;
+      }
+
+      SIM_PLANT_Step(&Plant, FanPwm, Config.PlantStep);
+      Time += Config.PlantStep;
+
+      Err = fabs(SIM_PLANT_PointingErr(&Plant));
+      if (Err <= Config.SettleTol)
+      {
+         if (!Result->Settled)
+         {
+            Result->Settled    = true;
+            Result->SettleTime = Time;
+         }
+      }
+      else
+      {
+         Result->Settled = false;
+      }
+   }
+
+   Result->FinalErr = SIM_PLANT_PointingErr(&Plant);
+
+} /* End RunSim() */
+
+
+/******************************************************************************
+** Function: ScanNumber
+**
+** Find "Key": <number> in a JSON string.
+*/
+static bool ScanNumber(const char *Json, const char *Key, double *Value)
+{
+
+   char  Quoted[64];
+   const char *Pos;
+   char *End;
+
+   snprintf(Quoted, sizeof(Quoted), "\"%s\"", Key);
+   Pos = strstr(Json, Quoted);
+   if (Pos == NULL) return false;
+
+   Pos += strlen(Quoted);
+   while (*Pos == ' ' || *Pos == '\t' || *Pos == '\r' || *Pos == '\n') Pos++;
+   if (*Pos++ != ':') return false;
+
+   *Value = strtod(Pos, &End);
+
+   return (End != Pos);
+
+} /* End ScanNumber() */
+
+
+/******************************************************************************
+** Function: StealUnits
+**
+** Move the upper half of the first non-empty victim range to the thief.
+**
+** Notes:
+**   1. The thief's range is empty so only the thief writes it here.
+**   2. Returns false when every range is empty which ends the worker. A run
+**      in flight between a victim and another thief is still executed by
+**      that thief.
+**
+*/
+static bool StealUnits(MC_Worker_t *Thief)
+{
+
+   uint32 i, Victim, Head, Tail, Take;
+   uint64 Range;
+
+   for (i=1; i < Config.ThreadCnt; i++)
+   {
+      Victim = (Thief->Index + i) % Config.ThreadCnt;
+      Range  = __atomic_load_n(&Worker[Victim].Range, __ATOMIC_ACQUIRE);
+
+      while ((Head = RANGE_HEAD(Range)) < (Tail = RANGE_TAIL(Range)))
+      {
+         Take = (Tail - Head + 1) / 2;
+         if (__atomic_compare_exchange_n(&Worker[Victim].Range, &Range,
+                                         RANGE_PACK(Head, Tail - Take),
+                                         false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+         {
+            __atomic_store_n(&Thief->Range, RANGE_PACK(Tail - Take, Tail), __ATOMIC_RELEASE);
+            Thief->StealCnt++;
+            return true;
+         }
+      }
+   }
+
+   return false;
+
+} /* End StealUnits() */
+
+
+/******************************************************************************
+** Function: Vary
+**
+** Return Value scaled by a uniform factor in [1-Spread,1+Spread].
+*/
+static double Vary(SIM_PLANT_Class_t *Plant, double Value, double Spread)
+{
+
+   return Value * (1.0 + Spread * (2.0 * SIM_PLANT_Uniform(Plant) - 1.0));
+
+} /* End Vary() */
+
+
+/******************************************************************************
+** Function: WorkerMain
+**
+*/
+static void *WorkerMain(void *Arg)
+{
+
+   MC_Worker_t *Self = (MC_Worker_t *)Arg;
+   uint32 Unit;
+
+   do
+   {
+      while (NextPopUnit(Self, &Unit))
+      {
+         if (Config.Batch)
+         {
+            RunBatch(Self, Unit);
+         }
+         else
+         {
+            RunSim(Unit, &Result[Unit]);
+            Self->RunCnt++;
+         }
+      }
+   } while (StealUnits(Self));
+
+   return NULL;
+
+} /* End WorkerMain() */
+
+
+/******************************************************************************
+** Function: WriteCsv
+**
+*/
+static bool WriteCsv(const char *Filename)
+{
+
+   FILE  *File = fopen(Filename, "w");
+   uint32 i;
+
+   if (File == NULL)
+   {
+      fprintf(stderr, "Failed to create %s: %s\n", Filename, strerror(errno));
+      return false;
+   }
+
+   fprintf(File, "run,seed,survey_fan_pwm,pos_gain,rate_gain,latency,acquired,acquire_time,settled,settle_time,final_err\n");
+   for (i=0; i < Config.RunCnt; i++)
+   {
+      fprintf(File, "%u,%llu,%.3f,%.5f,%.5f,%.4f,%d,%.3f,%d,%.3f,%.3f\n", i,
+              (unsigned long long)(Config.Seed + i), Result[i].Ctrl.SurveyFanPwm,
+              Result[i].Ctrl.PosGain, Result[i].Ctrl.RateGain, Result[i].Latency,
+              Result[i].Acquired, Result[i].Acquired ? Result[i].AcquireTime : -1.0,
+              Result[i].Settled, Result[i].Settled ? Result[i].SettleTime : -1.0,
+              Result[i].FinalErr);
+   }
+   fclose(File);
+
+   return true;
+
+} /* End WriteCsv() */
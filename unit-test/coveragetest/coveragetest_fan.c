@@ -0,0 +1,232 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Unit tests for the fan class's PWM output path
+**
+**  Notes:
+**    1. The tests run against the simulated register bank and observe the
+**       data registers that FAN_WritePwm() writes.
+**    2. The fan object is constructed once because the hardware PWM
+**       channel assignments are shared by every fan object in the app.
+**       Each test reloads the fan table data it needs.
+**
+*/
+
+/*
+** Includes
+*/
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fan.h"
+#include "utassert.h"
+#include "utstubs.h"
+#include "uttest.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define TEST_PWM_RANGE        1023
+#define TEST_PWM_CLK_DIVISOR     9
+#define TEST_WRITE_CNT        1000
+
+
+/**********************/
+/** Global File Data **/
+/**********************/
+
+static INITBL_Class_t  IniTbl;
+static FAN_Class_t     Fan;
+static bool            FanConstructed = false;
+
+/* BCM 18 and 19 are routed to PWM channels 0 and 1 */
+static const FAN_Config_t FanConfig =
+{
+   0, 2, "18,19", "17,27", "fan_tbl.json", true, true, NULL
+};
+
+
+/******************************************************************************
+** Function: Fan_Test_Setup
+**
+*/
+static void Fan_Test_Setup(void)
+{
+
+   uint8 i;
+
+   UT_ResetState(0);
+
+   if (!FanConstructed)
+   {
+      IO_REG_MapGpio();
+      IO_REG_MapPwm();
+      FAN_Constructor(&Fan, &IniTbl, &FanConfig);
+      FanConstructed = true;
+   }
+
+   memset(&Fan.Tbl.Data, 0, sizeof(Fan.Tbl.Data));
+   Fan.Tbl.Loaded = true;
+   Fan.Tbl.Data.Pwm.Range      = TEST_PWM_RANGE;
+   Fan.Tbl.Data.Pwm.ClkDivisor = TEST_PWM_CLK_DIVISOR;
+   Fan.Tbl.Data.Alloc[FAN_TBL_AXIS_TORQUE_Z][0] = 1.0;
+   Fan.Tbl.Data.Alloc[FAN_TBL_AXIS_TORQUE_Z][1] = 0.5;
+
+   for (i=0; i < Fan.FanCnt; i++)
+   {
+      Fan.Actuator[i].DitherErr = 0.0;
+   }
+
+} /* End Fan_Test_Setup() */
+
+
+/******************************************************************************
+** Function: WritePwmAverage
+**
+** Write the current effort TEST_WRITE_CNT times and return the average
+** value written to each channel's data register.
+*/
+static void WritePwmAverage(double *AvgDat1, double *AvgDat2)
+{
+
+   IO_REG_SimBank_t *SimBank = IO_REG_SimBank();
+   double Sum1 = 0.0, Sum2 = 0.0;
+   uint32 i;
+
+   for (i=0; i < TEST_WRITE_CNT; i++)
+   {
+      FAN_WritePwm(&Fan);
+      Sum1 += SimBank->Pwm[IO_REG_PWM_DAT1];
+      Sum2 += SimBank->Pwm[IO_REG_PWM_DAT2];
+   }
+
+   *AvgDat1 = Sum1 / TEST_WRITE_CNT;
+   *AvgDat2 = Sum2 / TEST_WRITE_CNT;
+
+} /* End WritePwmAverage() */
+
+
+/******************************************************************************
+** Function: Test_FAN_WritePwm_Dither
+**
+** Fractional commands are dithered so the average data register value
+** tracks the scaled command rather than the nearest register value.
+*/
+static void Test_FAN_WritePwm_Dither(void)
+{
+
+   IO_REG_SimBank_t *SimBank = IO_REG_SimBank();
+   float  Effort[FAN_TBL_AXIS_CNT] = { 1000.3, 0.0, 0.0 };
+   double Expected1 = 1000.3  * TEST_PWM_RANGE / FAN_MAX_PWM;
+   double Expected2 = 500.15 * TEST_PWM_RANGE / FAN_MAX_PWM;
+   double AvgDat1, AvgDat2;
+   uint32 WriteCnt1 = SimBank->PwmWriteCnt[0];
+   uint32 WriteCnt2 = SimBank->PwmWriteCnt[1];
+
+   Fan.Tbl.Data.Pwm.Dither = 1;
+
+   UtAssert_True(!FAN_SetEffort(&Fan, Effort), "Effort isn't limited");
+   WritePwmAverage(&AvgDat1, &AvgDat2);
+
+   UtAssert_True(SimBank->Pwm[IO_REG_PWM_RNG1] == TEST_PWM_RANGE && SimBank->PwmClkDivisor[0] == TEST_PWM_CLK_DIVISOR,
+                 "Channel 0 range %u and clock divisor %u were applied from the table",
+                 (unsigned int)SimBank->Pwm[IO_REG_PWM_RNG1], (unsigned int)SimBank->PwmClkDivisor[0]);
+   UtAssert_True(SimBank->PwmWriteCnt[0] - WriteCnt1 == TEST_WRITE_CNT &&
+                 SimBank->PwmWriteCnt[1] - WriteCnt2 == TEST_WRITE_CNT,
+                 "Each data register was written once per call");
+   UtAssert_True(fabs(AvgDat1 - Expected1) < 0.01,
+                 "Fan A average %.4f tracks the fractional target %.4f", AvgDat1, Expected1);
+   UtAssert_True(fabs(AvgDat2 - Expected2) < 0.01,
+                 "Fan B average %.4f tracks the fractional target %.4f", AvgDat2, Expected2);
+   UtAssert_True(fabs(Fan.Actuator[0].DitherErr) <= 0.5 && fabs(Fan.Actuator[1].DitherErr) <= 0.5,
+                 "Dither error is bounded by half a register count");
+
+} /* End Test_FAN_WritePwm_Dither() */
+
+
+/******************************************************************************
+** Function: Test_FAN_WritePwm_NoDither
+**
+** Without dithering every write is the nearest register value so the
+** average keeps the rounding error.
+*/
+static void Test_FAN_WritePwm_NoDither(void)
+{
+
+   float  Effort[FAN_TBL_AXIS_CNT] = { 1000.3, 0.0, 0.0 };
+   double Expected1 = 1000.3 * TEST_PWM_RANGE / FAN_MAX_PWM;
+   double AvgDat1, AvgDat2;
+
+   Fan.Tbl.Data.Pwm.Dither = 0;
+
+   FAN_SetEffort(&Fan, Effort);
+   WritePwmAverage(&AvgDat1, &AvgDat2);
+
+   UtAssert_True(AvgDat1 == round(Expected1),
+                 "Fan A average %.4f is the rounded target %.0f", AvgDat1, round(Expected1));
+   UtAssert_True(Fan.Actuator[0].DitherErr == 0.0, "Dither error isn't accumulated");
+
+} /* End Test_FAN_WritePwm_NoDither() */
+
+
+/******************************************************************************
+** Function: Test_FAN_WritePwm_Saturated
+**
+** A saturated command writes the full range and the dither error doesn't
+** wind up, so a following fractional command is tracked immediately.
+*/
+static void Test_FAN_WritePwm_Saturated(void)
+{
+
+   IO_REG_SimBank_t *SimBank = IO_REG_SimBank();
+   float  Effort[FAN_TBL_AXIS_CNT] = { 3000.0, 0.0, 0.0 };
+   double AvgDat1, AvgDat2;
+
+   Fan.Tbl.Data.Pwm.Dither = 1;
+
+   UtAssert_True(FAN_SetEffort(&Fan, Effort), "Effort is limited");
+   WritePwmAverage(&AvgDat1, &AvgDat2);
+
+   UtAssert_True(SimBank->Pwm[IO_REG_PWM_DAT1] == TEST_PWM_RANGE && AvgDat1 == TEST_PWM_RANGE,
+                 "Fan A holds the full range %d", TEST_PWM_RANGE);
+   UtAssert_True(fabs(Fan.Actuator[0].DitherErr) <= 1.0, "Dither error %.4f is bounded",
+                 Fan.Actuator[0].DitherErr);
+
+   Effort[FAN_TBL_AXIS_TORQUE_Z] = 1000.3;
+   FAN_SetEffort(&Fan, Effort);
+   FAN_WritePwm(&Fan);
+
+   UtAssert_True(abs((int)SimBank->Pwm[IO_REG_PWM_DAT1] - 500) <= 1,
+                 "Fan A output %u recovers on the first write after saturation",
+                 (unsigned int)SimBank->Pwm[IO_REG_PWM_DAT1]);
+
+} /* End Test_FAN_WritePwm_Saturated() */
+
+
+/******************************************************************************
+** Function: UtTest_Setup
+**
+*/
+void UtTest_Setup(void)
+{
+
+   UtTest_Add(Test_FAN_WritePwm_Dither,    Fan_Test_Setup, NULL, "FAN_WritePwm dither");
+   UtTest_Add(Test_FAN_WritePwm_NoDither,  Fan_Test_Setup, NULL, "FAN_WritePwm no dither");
+   UtTest_Add(Test_FAN_WritePwm_Saturated, Fan_Test_Setup, NULL, "FAN_WritePwm saturated");
+
+} /* End UtTest_Setup() */
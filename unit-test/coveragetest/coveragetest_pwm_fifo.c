@@ -0,0 +1,299 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Unit tests for the PWM FIFO playback class
+**
+**  Notes:
+**    1. The refill task is captured when the constructor creates it and is
+**       run in the test's context. OS_BinSemTake() fails on its second call
+**       so the task returns after one playback.
+**    2. The simulated PWM block is emulated by an OS_TaskDelay() hook that
+**       pops a fixed number of words from the simulated FIFO for each
+**       refill delay.
+**
+*/
+
+/*
+** Includes
+*/
+
+#include <string.h>
+#include "pwm_fifo.h"
+#include "utassert.h"
+#include "utstubs.h"
+#include "uttest.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define TEST_PROFILE_WORDS   40
+#define TEST_REPEAT_CNT       3
+#define TEST_WORD_PERIOD   1000      /* Microseconds, gives an 8ms refill delay */
+#define TEST_MAX_DELAYS   10000      /* Bound the refill loop if a test fails */
+#define TEST_MAX_POPPED   (TEST_PROFILE_WORDS * 64)
+
+
+/**********************/
+/** Type Definitions **/
+/**********************/
+
+typedef struct
+{
+
+   uint32  PopPerDelay;   /* Words the PWM block reads during one refill delay */
+   uint32  StopAfter;     /* Request a stop after this many delays, 0 disables */
+   uint32  DelayCnt;
+   uint32  PoppedCnt;
+   uint32  Popped[TEST_MAX_POPPED];
+
+} PwmBlock_t;
+
+
+/**********************/
+/** Global File Data **/
+/**********************/
+
+static PWM_FIFO_Class_t  PwmFifo;
+static PwmBlock_t        PwmBlock;
+
+static CFE_ES_ChildTaskMainFuncPtr_t RefillTask = NULL;
+
+
+/******************************************************************************
+** Function: CreateChildTaskHook
+**
+** Capture the refill task's entry point.
+*/
+static int32 CreateChildTaskHook(void *UserObj, int32 StubRetcode, uint32 CallCount,
+                                 const UT_StubContext_t *Context)
+{
+
+   RefillTask = UT_Hook_GetArgValueByName(Context, "FunctionPtr", CFE_ES_ChildTaskMainFuncPtr_t);
+
+   return StubRetcode;
+
+} /* End CreateChildTaskHook() */
+
+
+/******************************************************************************
+** Function: TaskDelayHook
+**
+** Emulate the PWM block reading the FIFO for one refill delay. A read from
+** an empty FIFO stops the reads and sets the simulated read error flag.
+*/
+static int32 TaskDelayHook(void *UserObj, int32 StubRetcode, uint32 CallCount,
+                           const UT_StubContext_t *Context)
+{
+
+   PwmBlock_t *Block = UserObj;
+   uint32 Word;
+   uint32 i;
+
+   Block->DelayCnt++;
+
+   for (i=0; i < Block->PopPerDelay && IO_REG_SimPwmFifoPop(&Word); i++)
+   {
+      if (Block->PoppedCnt < TEST_MAX_POPPED)
+      {
+         Block->Popped[Block->PoppedCnt++] = Word;
+      }
+   }
+
+   if (Block->DelayCnt == Block->StopAfter || Block->DelayCnt >= TEST_MAX_DELAYS)
+   {
+      PWM_FIFO_Stop();
+   }
+
+   return StubRetcode;
+
+} /* End TaskDelayHook() */
+
+
+/******************************************************************************
+** Function: PwmFifo_Test_Setup
+**
+*/
+static void PwmFifo_Test_Setup(void)
+{
+
+   uint32 i;
+
+   UT_ResetState(0);
+   memset(&PwmBlock, 0, sizeof(PwmBlock));
+
+   UT_SetHookFunction(UT_KEY(CFE_ES_CreateChildTask), CreateChildTaskHook, NULL);
+   UT_SetHookFunction(UT_KEY(OS_TaskDelay), TaskDelayHook, &PwmBlock);
+   UT_SetDeferredRetcode(UT_KEY(OS_BinSemTake), 2, OS_ERROR);
+
+   IO_REG_MapPwm();
+   PWM_FIFO_Constructor(&PwmFifo, 0);
+
+   PwmFifo.ChannelCnt = 1;
+   PwmFifo.WordCnt    = TEST_PROFILE_WORDS;
+   for (i=0; i < TEST_PROFILE_WORDS; i++)
+   {
+      PwmFifo.Word[i] = 100 + i;
+   }
+
+} /* End PwmFifo_Test_Setup() */
+
+
+/******************************************************************************
+** Function: CheckPoppedSequence
+**
+** Verify the PWM block read the profile words in order.
+*/
+static bool CheckPoppedSequence(void)
+{
+
+   uint32 i;
+
+   for (i=0; i < PwmBlock.PoppedCnt; i++)
+   {
+      if (PwmBlock.Popped[i] != PwmFifo.Word[i % TEST_PROFILE_WORDS])
+      {
+         return false;
+      }
+   }
+
+   return true;
+
+} /* End CheckPoppedSequence() */
+
+
+/******************************************************************************
+** Function: Test_PWM_FIFO_Start
+**
+** Start prefills the FIFO and releases the refill task.
+*/
+static void Test_PWM_FIFO_Start(void)
+{
+
+   IO_REG_SimBank_t *SimBank = IO_REG_SimBank();
+
+   UtAssert_True(RefillTask != NULL, "Constructor created the refill task");
+   UtAssert_True(PWM_FIFO_Start(TEST_WORD_PERIOD, TEST_REPEAT_CNT), "Playback started");
+
+   UtAssert_True(PWM_FIFO_Active(), "Playback is active");
+   UtAssert_True(SimBank->PwmFifoCnt == IO_REG_PWM_FIFO_DEPTH && PwmFifo.WordsWritten == IO_REG_PWM_FIFO_DEPTH,
+                 "Prefill wrote %u words", (unsigned int)PwmFifo.WordsWritten);
+   UtAssert_True(SimBank->Pwm[IO_REG_PWM_STA] & IO_REG_PWM_STA_FULL1, "FIFO is full");
+   UtAssert_True(!(SimBank->Pwm[IO_REG_PWM_STA] & (IO_REG_PWM_STA_WERR1 | IO_REG_PWM_STA_RERR1)),
+                 "Prefill left no error flags");
+   UtAssert_True(PwmFifo.RefillDelay == (TEST_WORD_PERIOD * IO_REG_PWM_FIFO_DEPTH/2) / 1000,
+                 "Refill delay is %u ms", (unsigned int)PwmFifo.RefillDelay);
+   UtAssert_True(UT_GetStubCount(UT_KEY(OS_BinSemGive)) == 1, "Refill task was released");
+
+   UtAssert_True(!PWM_FIFO_Start(TEST_WORD_PERIOD, TEST_REPEAT_CNT), "Start rejected while playing");
+
+} /* End Test_PWM_FIFO_Start() */
+
+
+/******************************************************************************
+** Function: Test_PWM_FIFO_Refill
+**
+** The refill task keeps the FIFO topped up for every pass and returns to
+** idle once the FIFO has drained.
+*/
+static void Test_PWM_FIFO_Refill(void)
+{
+
+   IO_REG_SimBank_t *SimBank = IO_REG_SimBank();
+
+   PwmBlock.PopPerDelay = IO_REG_PWM_FIFO_DEPTH/2;
+
+   PWM_FIFO_Start(TEST_WORD_PERIOD, TEST_REPEAT_CNT);
+   RefillTask();
+
+   UtAssert_True(PwmFifo.State == PWM_FIFO_IDLE && !PWM_FIFO_Active(), "Playback completed");
+   UtAssert_True(PwmFifo.PassCnt == TEST_REPEAT_CNT, "Completed %d passes", PwmFifo.PassCnt);
+   UtAssert_True(PwmFifo.WordsWritten == TEST_PROFILE_WORDS * TEST_REPEAT_CNT,
+                 "Wrote %u words", (unsigned int)PwmFifo.WordsWritten);
+   UtAssert_True(PwmBlock.PoppedCnt == TEST_PROFILE_WORDS * TEST_REPEAT_CNT,
+                 "PWM block read %u words", (unsigned int)PwmBlock.PoppedCnt);
+   UtAssert_True(CheckPoppedSequence(), "Words were read in profile order");
+   UtAssert_True(PwmFifo.UnderrunCnt == 0, "No underruns");
+   UtAssert_True(SimBank->PwmFifoCnt == 0, "FIFO is empty");
+
+} /* End Test_PWM_FIFO_Refill() */
+
+
+/******************************************************************************
+** Function: Test_PWM_FIFO_Underrun
+**
+** The PWM block reads more than a full FIFO during each refill delay so
+** the FIFO runs dry while the profile is playing.
+*/
+static void Test_PWM_FIFO_Underrun(void)
+{
+
+   PwmBlock.PopPerDelay = IO_REG_PWM_FIFO_DEPTH + 8;
+
+   PWM_FIFO_Start(TEST_WORD_PERIOD, TEST_REPEAT_CNT);
+   RefillTask();
+
+   UtAssert_True(PwmFifo.State == PWM_FIFO_IDLE, "Playback completed");
+   UtAssert_True(PwmFifo.UnderrunCnt > 0, "Counted %d underruns", PwmFifo.UnderrunCnt);
+   UtAssert_True(PwmBlock.PoppedCnt == TEST_PROFILE_WORDS * TEST_REPEAT_CNT && CheckPoppedSequence(),
+                 "Every word was still read in profile order");
+
+   PWM_FIFO_ResetStatus();
+   UtAssert_True(PwmFifo.UnderrunCnt == 0, "Reset status cleared the underrun count");
+
+} /* End Test_PWM_FIFO_Underrun() */
+
+
+/******************************************************************************
+** Function: Test_PWM_FIFO_Stop
+**
+** A stop request ends a continuous playback and clears the FIFO.
+*/
+static void Test_PWM_FIFO_Stop(void)
+{
+
+   IO_REG_SimBank_t *SimBank = IO_REG_SimBank();
+
+   PwmBlock.PopPerDelay = IO_REG_PWM_FIFO_DEPTH/2;
+   PwmBlock.StopAfter   = 20;
+
+   PWM_FIFO_Start(TEST_WORD_PERIOD, 0);
+   RefillTask();
+
+   UtAssert_True(PwmFifo.State == PWM_FIFO_IDLE, "Playback stopped");
+   UtAssert_True(PwmBlock.DelayCnt == PwmBlock.StopAfter, "Stopped after %u refills",
+                 (unsigned int)PwmBlock.DelayCnt);
+   UtAssert_True(PwmFifo.PassCnt >= 3, "Continuous playback repeated %d passes", PwmFifo.PassCnt);
+   UtAssert_True(SimBank->PwmFifoCnt == 0 && (SimBank->Pwm[IO_REG_PWM_STA] & IO_REG_PWM_STA_EMPT1),
+                 "FIFO was cleared");
+   UtAssert_True(CheckPoppedSequence() && PwmFifo.UnderrunCnt == 0, "Words were read in order without underruns");
+
+} /* End Test_PWM_FIFO_Stop() */
+
+
+/******************************************************************************
+** Function: UtTest_Setup
+**
+*/
+void UtTest_Setup(void)
+{
+
+   UtTest_Add(Test_PWM_FIFO_Start,    PwmFifo_Test_Setup, NULL, "PWM_FIFO_Start");
+   UtTest_Add(Test_PWM_FIFO_Refill,   PwmFifo_Test_Setup, NULL, "PWM_FIFO refill");
+   UtTest_Add(Test_PWM_FIFO_Underrun, PwmFifo_Test_Setup, NULL, "PWM_FIFO underrun");
+   UtTest_Add(Test_PWM_FIFO_Stop,     PwmFifo_Test_Setup, NULL, "PWM_FIFO stop");
+
+} /* End UtTest_Setup() */
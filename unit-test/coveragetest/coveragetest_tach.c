@@ -0,0 +1,286 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Unit tests for the fan tachometer capture class
+**
+**  Notes:
+**    1. The tests use the synthetic edge source. The capture task's entry
+**       point is saved when TACH_Start() creates it and is run in a thread
+**       because the synthetic source paces its edges with the monotonic
+**       clock. The thread is cancelled at the end of each test.
+**    2. The RPM and stale checks depend on wall clock time so each test
+**       takes up to a couple of seconds.
+**
+*/
+
+/*
+** Includes
+*/
+
+#include <math.h>
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+#include "tach.h"
+#include "utassert.h"
+#include "utstubs.h"
+#include "uttest.h"
+
+
+/***********************/
+/** Macro Definitions **/
+/***********************/
+
+#define TEST_PULSE_PER_REV   2
+#define TEST_LINE_CNT        2
+
+#define TEST_SETTLE_MS     300    /* Time for several edges at the test rates */
+#define TEST_STALE_MS     1200    /* Longer than TACH_STALE_TIME_NS */
+
+
+/**********************/
+/** Global File Data **/
+/**********************/
+
+static INITBL_Class_t  IniTbl;
+static TACH_Class_t    Tach;
+
+static const uint8 TachBcmId[TEST_LINE_CNT] = { 17, 27 };
+
+static CFE_ES_ChildTaskMainFuncPtr_t TachTask = NULL;
+static pthread_t TachThread;
+static bool      TachThreadCreated = false;
+
+
+/******************************************************************************
+** Function: IniTblIntHandler
+**
+*/
+static void IniTblIntHandler(void *UserObj, UT_EntryKey_t FuncKey, const UT_StubContext_t *Context)
+{
+
+   uint16 Param = UT_Hook_GetArgValueByName(Context, "Param", uint16);
+   uint32 Value = 0;
+
+   if (Param == CFG_FAN_TACH_PULSE_PER_REV)
+   {
+      Value = TEST_PULSE_PER_REV;
+   }
+
+   UT_Stub_SetReturnValue(FuncKey, Value);
+
+} /* End IniTblIntHandler() */
+
+
+/******************************************************************************
+** Function: IniTblStrHandler
+**
+*/
+static void IniTblStrHandler(void *UserObj, UT_EntryKey_t FuncKey, const UT_StubContext_t *Context)
+{
+
+   uint16 Param = UT_Hook_GetArgValueByName(Context, "Param", uint16);
+   const char *Value = "";
+
+   if (Param == CFG_FAN_TACH_SOURCE)
+   {
+      Value = TACH_SOURCE_SYNTHETIC;
+   }
+
+   UT_Stub_SetReturnValue(FuncKey, Value);
+
+} /* End IniTblStrHandler() */
+
+
+/******************************************************************************
+** Function: CreateChildTaskHook
+**
+** Capture the tach task's entry point.
+*/
+static int32 CreateChildTaskHook(void *UserObj, int32 StubRetcode, uint32 CallCount,
+                                 const UT_StubContext_t *Context)
+{
+
+   TachTask = UT_Hook_GetArgValueByName(Context, "FunctionPtr", CFE_ES_ChildTaskMainFuncPtr_t);
+
+   return StubRetcode;
+
+} /* End CreateChildTaskHook() */
+
+
+/******************************************************************************
+** Function: TachThreadMain
+**
+*/
+static void *TachThreadMain(void *Arg)
+{
+
+   TachTask();
+
+   return NULL;
+
+} /* End TachThreadMain() */
+
+
+/******************************************************************************
+** Function: SleepMs
+**
+** OS_TaskDelay() is a stub so the tests sleep with the host clock.
+*/
+static void SleepMs(uint32 Ms)
+{
+
+   struct timespec Delay;
+
+   Delay.tv_sec  = Ms / 1000;
+   Delay.tv_nsec = (Ms % 1000) * 1000000L;
+
+   while (nanosleep(&Delay, &Delay) != 0);
+
+} /* End SleepMs() */
+
+
+/******************************************************************************
+** Function: Tach_Test_Setup
+**
+** Construct a tach object with two synthetic lines and start its task.
+*/
+static void Tach_Test_Setup(void)
+{
+
+   UT_ResetState(0);
+
+   UT_SetHandlerFunction(UT_KEY(INITBL_GetIntConfig), IniTblIntHandler, NULL);
+   UT_SetHandlerFunction(UT_KEY(INITBL_GetStrConfig), IniTblStrHandler, NULL);
+   UT_SetHookFunction(UT_KEY(CFE_ES_CreateChildTask), CreateChildTaskHook, NULL);
+
+   TachTask = NULL;
+   TACH_Constructor(&Tach, &IniTbl);
+   TACH_AddLines(TachBcmId, TEST_LINE_CNT);
+   TACH_Start(&IniTbl);
+
+   TachThreadCreated = (Tach.TaskCreated && TachTask != NULL &&
+                        pthread_create(&TachThread, NULL, TachThreadMain, NULL) == 0);
+
+} /* End Tach_Test_Setup() */
+
+
+/******************************************************************************
+** Function: Tach_Test_Teardown
+**
+*/
+static void Tach_Test_Teardown(void)
+{
+
+   if (TachThreadCreated)
+   {
+      pthread_cancel(TachThread);
+      pthread_join(TachThread, NULL);
+      TachThreadCreated = false;
+   }
+
+} /* End Tach_Test_Teardown() */
+
+
+/******************************************************************************
+** Function: Test_TACH_SyntheticRpm
+**
+** The measured RPM and pulse rate match the synthetic rate on each line.
+*/
+static void Test_TACH_SyntheticRpm(void)
+{
+
+   const TACH_Line_t *Line0 = TACH_GetLine(0);
+   const TACH_Line_t *Line1 = TACH_GetLine(1);
+
+   UtAssert_True(TachThreadCreated, "Tach task started with the %s source", TACH_SOURCE_SYNTHETIC);
+   if (!TachThreadCreated)
+   {
+      return;
+   }
+
+   TACH_SetSyntheticRpm(0, 3000.0);
+   TACH_SetSyntheticRpm(1, 1500.0);
+   SleepMs(TEST_SETTLE_MS);
+
+   TACH_Update(0, TEST_LINE_CNT);
+   SleepMs(500);
+   TACH_Update(0, TEST_LINE_CNT);
+
+   UtAssert_True(fabs(Line0->Rpm - 3000.0) < 0.5, "Line 0 RPM %.1f", Line0->Rpm);
+   UtAssert_True(fabs(Line1->Rpm - 1500.0) < 0.5, "Line 1 RPM %.1f", Line1->Rpm);
+   UtAssert_True(fabs(Line0->PeriodUsec - 10000.0) < 1.0, "Line 0 period %.1f usec", Line0->PeriodUsec);
+
+   /* 3000 RPM at 2 pulses per revolution is 100 pulses per second */
+   UtAssert_True(fabs(Line0->PulsePerSec - 100.0) < 10.0, "Line 0 pulse rate %.1f/sec", Line0->PulsePerSec);
+   UtAssert_True(fabs(Line1->PulsePerSec - 50.0) < 5.0, "Line 1 pulse rate %.1f/sec", Line1->PulsePerSec);
+
+   UtAssert_True(__atomic_load_n(&Tach.DroppedEdgeCnt, __ATOMIC_RELAXED) == 0, "No dropped edges");
+   UtAssert_True(__atomic_load_n(&Tach.SourceErrCnt, __ATOMIC_RELAXED) == 0, "No source errors");
+
+} /* End Test_TACH_SyntheticRpm() */
+
+
+/******************************************************************************
+** Function: Test_TACH_StaleLine
+**
+** A line without edges for longer than the stale time reports zero RPM
+** while the other line keeps reporting its rate.
+*/
+static void Test_TACH_StaleLine(void)
+{
+
+   const TACH_Line_t *Line0 = TACH_GetLine(0);
+   const TACH_Line_t *Line1 = TACH_GetLine(1);
+
+   UtAssert_True(TachThreadCreated, "Tach task started with the %s source", TACH_SOURCE_SYNTHETIC);
+   if (!TachThreadCreated)
+   {
+      return;
+   }
+
+   TACH_SetSyntheticRpm(0, 3000.0);
+   TACH_SetSyntheticRpm(1, 1500.0);
+   SleepMs(TEST_SETTLE_MS);
+   TACH_Update(0, TEST_LINE_CNT);
+
+   UtAssert_True(fabs(Line0->Rpm - 3000.0) < 0.5, "Line 0 RPM %.1f before it stops", Line0->Rpm);
+
+   TACH_SetSyntheticRpm(0, 0.0);
+   SleepMs(TEST_STALE_MS);
+   TACH_Update(0, TEST_LINE_CNT);
+   SleepMs(200);
+   TACH_Update(0, TEST_LINE_CNT);
+
+   UtAssert_True(Line0->Rpm == 0.0 && Line0->PeriodUsec == 0.0, "Stale line 0 RPM %.1f, period %.1f usec",
+                 Line0->Rpm, Line0->PeriodUsec);
+   UtAssert_True(Line0->PulsePerSec == 0.0, "Stale line 0 pulse rate %.1f/sec", Line0->PulsePerSec);
+   UtAssert_True(fabs(Line1->Rpm - 1500.0) < 0.5, "Line 1 RPM %.1f is unaffected", Line1->Rpm);
+   UtAssert_True(__atomic_load_n(&Tach.DroppedEdgeCnt, __ATOMIC_RELAXED) == 0, "No dropped edges");
+
+} /* End Test_TACH_StaleLine() */
+
+
+/******************************************************************************
+** Function: UtTest_Setup
+**
+*/
+void UtTest_Setup(void)
+{
+
+   UtTest_Add(Test_TACH_SyntheticRpm, Tach_Test_Setup, Tach_Test_Teardown, "TACH synthetic RPM");
+   UtTest_Add(Test_TACH_StaleLine,    Tach_Test_Setup, Tach_Test_Teardown, "TACH stale line");
+
+} /* End UtTest_Setup() */
@@ -0,0 +1,108 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Unit test stubs for the fan table class
+**
+*/
+
+#include "fan_tbl.h"
+#include "utgenstub.h"
+
+
+/******************************************************************************
+** Function: FAN_TBL_Activate
+**
+*/
+bool FAN_TBL_Activate(FAN_TBL_Class_t *FanTbl)
+{
+
+   UT_GenStub_SetupReturnBuffer(FAN_TBL_Activate, bool);
+
+   UT_GenStub_AddParam(FAN_TBL_Activate, FAN_TBL_Class_t *, FanTbl);
+
+   UT_GenStub_Execute(FAN_TBL_Activate, Basic, NULL);
+
+   return UT_GenStub_GetReturnValue(FAN_TBL_Activate, bool);
+
+} /* End FAN_TBL_Activate() */
+
+
+/******************************************************************************
+** Function: FAN_TBL_Constructor
+**
+*/
+void FAN_TBL_Constructor(FAN_TBL_Class_t *FanTbl, uint8 FanCnt)
+{
+
+   UT_GenStub_AddParam(FAN_TBL_Constructor, FAN_TBL_Class_t *, FanTbl);
+   UT_GenStub_AddParam(FAN_TBL_Constructor, uint8, FanCnt);
+
+   UT_GenStub_Execute(FAN_TBL_Constructor, Basic, NULL);
+
+} /* End FAN_TBL_Constructor() */
+
+
+/******************************************************************************
+** Function: FAN_TBL_Dump
+**
+*/
+bool FAN_TBL_Dump(FAN_TBL_Class_t *FanTbl, osal_id_t FileHandle)
+{
+
+   UT_GenStub_SetupReturnBuffer(FAN_TBL_Dump, bool);
+
+   UT_GenStub_AddParam(FAN_TBL_Dump, FAN_TBL_Class_t *, FanTbl);
+   UT_GenStub_AddParam(FAN_TBL_Dump, osal_id_t, FileHandle);
+
+   UT_GenStub_Execute(FAN_TBL_Dump, Basic, NULL);
+
+   return UT_GenStub_GetReturnValue(FAN_TBL_Dump, bool);
+
+} /* End FAN_TBL_Dump() */
+
+
+/******************************************************************************
+** Function: FAN_TBL_Load
+**
+*/
+bool FAN_TBL_Load(FAN_TBL_Class_t *FanTbl, APP_C_FW_TblLoadOptions_Enum_t LoadType,
+                  const char *Filename)
+{
+
+   UT_GenStub_SetupReturnBuffer(FAN_TBL_Load, bool);
+
+   UT_GenStub_AddParam(FAN_TBL_Load, FAN_TBL_Class_t *, FanTbl);
+   UT_GenStub_AddParam(FAN_TBL_Load, APP_C_FW_TblLoadOptions_Enum_t, LoadType);
+   UT_GenStub_AddParam(FAN_TBL_Load, const char *, Filename);
+
+   UT_GenStub_Execute(FAN_TBL_Load, Basic, NULL);
+
+   return UT_GenStub_GetReturnValue(FAN_TBL_Load, bool);
+
+} /* End FAN_TBL_Load() */
+
+
+/******************************************************************************
+** Function: FAN_TBL_ResetStatus
+**
+*/
+void FAN_TBL_ResetStatus(FAN_TBL_Class_t *FanTbl)
+{
+
+   UT_GenStub_AddParam(FAN_TBL_ResetStatus, FAN_TBL_Class_t *, FanTbl);
+
+   UT_GenStub_Execute(FAN_TBL_ResetStatus, Basic, NULL);
+
+} /* End FAN_TBL_ResetStatus() */
@@ -0,0 +1,63 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Unit test stubs for the app_c_fw ini table services used by the app objects
+**
+*/
+
+#include "app_cfg.h"
+#include "utgenstub.h"
+
+
+/******************************************************************************
+** Function: INITBL_GetIntConfig
+**
+*/
+uint32 INITBL_GetIntConfig(INITBL_Class_t *IniTbl, uint16 Param)
+{
+
+   UT_GenStub_SetupReturnBuffer(INITBL_GetIntConfig, uint32);
+
+   UT_GenStub_AddParam(INITBL_GetIntConfig, INITBL_Class_t *, IniTbl);
+   UT_GenStub_AddParam(INITBL_GetIntConfig, uint16, Param);
+
+   UT_GenStub_Execute(INITBL_GetIntConfig, Basic, NULL);
+
+   return UT_GenStub_GetReturnValue(INITBL_GetIntConfig, uint32);
+
+} /* End INITBL_GetIntConfig() */
+
+
+/******************************************************************************
+** Function: INITBL_GetStrConfig
+**
+** Notes:
+**   1. Tests that exercise a string parameter must register a handler that
+**      sets the return value.
+**
+*/
+const char *INITBL_GetStrConfig(INITBL_Class_t *IniTbl, uint16 Param)
+{
+
+   UT_GenStub_SetupReturnBuffer(INITBL_GetStrConfig, const char *);
+
+   UT_GenStub_AddParam(INITBL_GetStrConfig, INITBL_Class_t *, IniTbl);
+   UT_GenStub_AddParam(INITBL_GetStrConfig, uint16, Param);
+
+   UT_GenStub_Execute(INITBL_GetStrConfig, Basic, NULL);
+
+   return UT_GenStub_GetReturnValue(INITBL_GetStrConfig, const char *);
+
+} /* End INITBL_GetStrConfig() */
@@ -0,0 +1,70 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Unit test stubs for the memory monitor class
+**
+*/
+
+#include "mem_mon.h"
+#include "utgenstub.h"
+
+
+/******************************************************************************
+** Function: MEM_MON_Constructor
+**
+*/
+void MEM_MON_Constructor(MEM_MON_Class_t *MemMonPtr, INITBL_Class_t *IniTbl)
+{
+
+   UT_GenStub_AddParam(MEM_MON_Constructor, MEM_MON_Class_t *, MemMonPtr);
+   UT_GenStub_AddParam(MEM_MON_Constructor, INITBL_Class_t *, IniTbl);
+
+   UT_GenStub_Execute(MEM_MON_Constructor, Basic, NULL);
+
+} /* End MEM_MON_Constructor() */
+
+
+/******************************************************************************
+** Function: MEM_MON_GetStackUsage
+**
+*/
+uint8 MEM_MON_GetStackUsage(TBL_SAT_StackUsage_t *Usage, uint8 MaxCnt)
+{
+
+   UT_GenStub_SetupReturnBuffer(MEM_MON_GetStackUsage, uint8);
+
+   UT_GenStub_AddParam(MEM_MON_GetStackUsage, TBL_SAT_StackUsage_t *, Usage);
+   UT_GenStub_AddParam(MEM_MON_GetStackUsage, uint8, MaxCnt);
+
+   UT_GenStub_Execute(MEM_MON_GetStackUsage, Basic, NULL);
+
+   return UT_GenStub_GetReturnValue(MEM_MON_GetStackUsage, uint8);
+
+} /* End MEM_MON_GetStackUsage() */
+
+
+/******************************************************************************
+** Function: MEM_MON_PaintStack
+**
+*/
+void MEM_MON_PaintStack(TBL_SAT_MemTask_Enum_t Task, uint8 Instance)
+{
+
+   UT_GenStub_AddParam(MEM_MON_PaintStack, TBL_SAT_MemTask_Enum_t, Task);
+   UT_GenStub_AddParam(MEM_MON_PaintStack, uint8, Instance);
+
+   UT_GenStub_Execute(MEM_MON_PaintStack, Basic, NULL);
+
+} /* End MEM_MON_PaintStack() */
@@ -0,0 +1,116 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Unit test stubs for the PWM FIFO playback class
+**
+*/
+
+
+#include "pwm_fifo.h"
+#include "utgenstub.h"
+
+
+/******************************************************************************
+** Function: PWM_FIFO_Constructor
+**
+*/
+void PWM_FIFO_Constructor(PWM_FIFO_Class_t *PwmFifoPtr, uint32 TaskPriority)
+{
+
+   UT_GenStub_AddParam(PWM_FIFO_Constructor, PWM_FIFO_Class_t *, PwmFifoPtr);
+   UT_GenStub_AddParam(PWM_FIFO_Constructor, uint32, TaskPriority);
+
+   UT_GenStub_Execute(PWM_FIFO_Constructor, Basic, NULL);
+
+} /* End PWM_FIFO_Constructor() */
+
+
+/******************************************************************************
+** Function: PWM_FIFO_Active
+**
+*/
+bool PWM_FIFO_Active(void)
+{
+
+   UT_GenStub_SetupReturnBuffer(PWM_FIFO_Active, bool);
+
+   UT_GenStub_Execute(PWM_FIFO_Active, Basic, NULL);
+
+   return UT_GenStub_GetReturnValue(PWM_FIFO_Active, bool);
+
+} /* End PWM_FIFO_Active() */
+
+
+/******************************************************************************
+** Function: PWM_FIFO_LoadProfile
+**
+*/
+bool PWM_FIFO_LoadProfile(const char *Filename, uint8 ChannelCnt, uint32 MaxValue)
+{
+
+   UT_GenStub_SetupReturnBuffer(PWM_FIFO_LoadProfile, bool);
+
+   UT_GenStub_AddParam(PWM_FIFO_LoadProfile, const char *, Filename);
+   UT_GenStub_AddParam(PWM_FIFO_LoadProfile, uint8, ChannelCnt);
+   UT_GenStub_AddParam(PWM_FIFO_LoadProfile, uint32, MaxValue);
+
+   UT_GenStub_Execute(PWM_FIFO_LoadProfile, Basic, NULL);
+
+   return UT_GenStub_GetReturnValue(PWM_FIFO_LoadProfile, bool);
+
+} /* End PWM_FIFO_LoadProfile() */
+
+
+/******************************************************************************
+** Function: PWM_FIFO_ResetStatus
+**
+*/
+void PWM_FIFO_ResetStatus(void)
+{
+
+   UT_GenStub_Execute(PWM_FIFO_ResetStatus, Basic, NULL);
+
+} /* End PWM_FIFO_ResetStatus() */
+
+
+/******************************************************************************
+** Function: PWM_FIFO_Start
+**
+*/
+bool PWM_FIFO_Start(uint32 WordPeriod, uint16 RepeatCnt)
+{
+
+   UT_GenStub_SetupReturnBuffer(PWM_FIFO_Start, bool);
+
+   UT_GenStub_AddParam(PWM_FIFO_Start, uint32, WordPeriod);
+   UT_GenStub_AddParam(PWM_FIFO_Start, uint16, RepeatCnt);
+
+   UT_GenStub_Execute(PWM_FIFO_Start, Basic, NULL);
+
+   return UT_GenStub_GetReturnValue(PWM_FIFO_Start, bool);
+
+} /* End PWM_FIFO_Start() */
+
+
+/******************************************************************************
+** Function: PWM_FIFO_Stop
+**
+*/
+void PWM_FIFO_Stop(void)
+{
+
+   UT_GenStub_Execute(PWM_FIFO_Stop, Basic, NULL);
+
+} /* End PWM_FIFO_Stop() */
@@ -0,0 +1,130 @@
+/*
+**  Copyright 2022 bitValence, Inc.
+**  All Rights Reserved.
+**
+**  This program is free software; you can modify and/or redistribute it
+**  under the terms of the GNU Affero General Public License
+**  as published by the Free Software Foundation; version 3 with
+**  attribution addendums as found in the LICENSE.txt
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  Purpose:
+**    Unit test stubs for the fan tachometer capture class
+**
+*/
+
+
+#include "tach.h"
+#include "utgenstub.h"
+
+
+/******************************************************************************
+** Function: TACH_Constructor
+**
+*/
+void TACH_Constructor(TACH_Class_t *TachPtr, INITBL_Class_t *IniTbl)
+{
+
+   UT_GenStub_AddParam(TACH_Constructor, TACH_Class_t *, TachPtr);
+   UT_GenStub_AddParam(TACH_Constructor, INITBL_Class_t *, IniTbl);
+
+   UT_GenStub_Execute(TACH_Constructor, Basic, NULL);
+
+} /* End TACH_Constructor() */
+
+
+/******************************************************************************
+** Function: TACH_AddLines
+**
+*/
+uint8 TACH_AddLines(const uint8 *BcmId, uint8 LineCnt)
+{
+
+   UT_GenStub_SetupReturnBuffer(TACH_AddLines, uint8);
+
+   UT_GenStub_AddParam(TACH_AddLines, const uint8 *, BcmId);
+   UT_GenStub_AddParam(TACH_AddLines, uint8, LineCnt);
+
+   UT_GenStub_Execute(TACH_AddLines, Basic, NULL);
+
+   return UT_GenStub_GetReturnValue(TACH_AddLines, uint8);
+
+} /* End TACH_AddLines() */
+
+
+/******************************************************************************
+** Function: TACH_GetLine
+**
+*/
+const TACH_Line_t *TACH_GetLine(uint8 Line)
+{
+
+   UT_GenStub_SetupReturnBuffer(TACH_GetLine, const TACH_Line_t *);
+
+   UT_GenStub_AddParam(TACH_GetLine, uint8, Line);
+
+   UT_GenStub_Execute(TACH_GetLine, Basic, NULL);
+
+   return UT_GenStub_GetReturnValue(TACH_GetLine, const TACH_Line_t *);
+
+} /* End TACH_GetLine() */
+
+
+/******************************************************************************
+** Function: TACH_ResetStatus
+**
+*/
+void TACH_ResetStatus(void)
+{
+
+   UT_GenStub_Execute(TACH_ResetStatus, Basic, NULL);
+
+} /* End TACH_ResetStatus() */
+
+
+/******************************************************************************
+** Function: TACH_SetSyntheticRpm
+**
+*/
+void TACH_SetSyntheticRpm(uint8 Line, float Rpm)
+{
+
+   UT_GenStub_AddParam(TACH_SetSyntheticRpm, uint8, Line);
+   UT_GenStub_AddParam(TACH_SetSyntheticRpm, float, Rpm);
+
+   UT_GenStub_Execute(TACH_SetSyntheticRpm, Basic, NULL);
+
+} /* End TACH_SetSyntheticRpm() */
+
+
+/******************************************************************************
+** Function: TACH_Start
+**
+*/
+void TACH_Start(INITBL_Class_t *IniTbl)
+{
+
+   UT_GenStub_AddParam(TACH_Start, INITBL_Class_t *, IniTbl);
+
+   UT_GenStub_Execute(TACH_Start, Basic, NULL);
+
+} /* End TACH_Start() */
+
+
+/******************************************************************************
+** Function: TACH_Update
+**
+*/
+void TACH_Update(uint8 FirstLine, uint8 LineCnt)
+{
+
+   UT_GenStub_AddParam(TACH_Update, uint8, FirstLine);
+   UT_GenStub_AddParam(TACH_Update, uint8, LineCnt);
+
+   UT_GenStub_Execute(TACH_Update, Basic, NULL);
+
+} /* End TACH_Update() */